@@ -13,7 +13,8 @@
 #include <yarp/os/RFModule.h>
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/IJoypadController.h>
-#include <yarp/os/RpcClient.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/sig/Vector.h>
 
 /**
  * RFModule useful to handle the Joypad
@@ -34,7 +35,14 @@ private:
 
     std::string m_joypadOutputPortName; /**< Name of the joypad output port name. */
     std::string m_joypadInputPortName; /**< Name of the joypad input port name (This is the name of the port opened by the main module). */
-    yarp::os::RpcClient m_rpcPort; /**< RPC port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_goalPort; /**< Goal port (sequence number, timestamp, x, y). */
+
+    unsigned long m_sequenceNumber{0}; /**< Sequence number of the next goal. */
+    double m_goalTolerance; /**< A new goal is sent if it differs from the last one more than this value. */
+    double m_keepAlivePeriod; /**< The last goal is sent again after this period [s]. */
+    double m_lastGoalTime{0.0}; /**< Time of the last sent goal. */
+    double m_lastX{0.0}; /**< Last sent x. */
+    double m_lastY{0.0}; /**< Last sent y. */
 
     /**
      * Standard deadzone function.
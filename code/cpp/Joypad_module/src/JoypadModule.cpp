@@ -6,10 +6,16 @@
  * @date 2018
  */
 
+// std
+#include <cmath>
+
 // YARP
 #include "yarp/os/LogStream.h"
 #include <yarp/os/Property.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/ContactStyle.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
 
 #include "JoypadModule.hpp"
 
@@ -175,11 +181,24 @@ bool JoypadModule::configure(yarp::os::ResourceFinder &rf)
     }
     m_joypadInputPortName = value->asString();
 
-    m_rpcPort.open(m_joypadOutputPortName);
-    if(!yarp::os::Network::connect(m_joypadOutputPortName, m_joypadInputPortName))
+    m_goalTolerance = rf.check("goal_tolerance", yarp::os::Value(0.01)).asDouble();
+    m_keepAlivePeriod = rf.check("keep_alive_period", yarp::os::Value(0.25)).asDouble();
+
+    if(!m_goalPort.open(m_joypadOutputPortName))
+    {
+        yError() << "[configure] Unable to open the port " << m_joypadOutputPortName;
+        return false;
+    }
+
+    // the connection is persistent: it is restored by the name server when the walking
+    // module is restarted, so the connection is never checked in the updateModule
+    yarp::os::ContactStyle style;
+    style.persistent = true;
+    style.carrier = rf.check("Joypad_carrier", yarp::os::Value("")).asString();
+    if(!yarp::os::Network::connect(m_joypadOutputPortName, m_joypadInputPortName, style))
         yInfo() << "Unable to connect to port " << m_joypadOutputPortName << " to "
                 << m_joypadInputPortName
-                << " I'll try to connect the port in the updateModule";
+                << " the connection will be established when the port is available";
 
     return true;
 }
@@ -198,37 +217,42 @@ bool JoypadModule::close()
     }
 
     // close the ports
-    m_rpcPort.close();
+    m_goalPort.close();
 
     return true;
 }
 
 bool JoypadModule::updateModule()
 {
-    if(yarp::os::Network::isConnected(m_joypadOutputPortName,
-                                      m_joypadInputPortName))
-    {
-        double x, y;
-        m_joypadController->getAxis(0, x);
-        m_joypadController->getAxis(1, y);
+    double x, y;
+    m_joypadController->getAxis(0, x);
+    m_joypadController->getAxis(1, y);
 
-        x = -m_scaleX * deadzone(x);
-        y = -m_scaleY * deadzone(y);
+    x = -m_scaleX * deadzone(x);
+    y = -m_scaleY * deadzone(y);
 
-        std::swap(x,y);
+    std::swap(x,y);
 
-        yarp::os::Bottle cmd, outcome;
-        cmd.addString("setGoal");
-        cmd.addDouble(x);
-        cmd.addDouble(y);
-        m_rpcPort.write(cmd, outcome);
-    }
-    else
-    {
-        // try to connect the ports
-        yarp::os::Network::connect(m_joypadOutputPortName,
-                                   m_joypadInputPortName);
-    }
+    // the goal is sent only if it changed (or to keep the walking module updated)
+    double now = yarp::os::Time::now();
+    bool isChanged = std::fabs(x - m_lastX) > m_goalTolerance
+        || std::fabs(y - m_lastY) > m_goalTolerance
+        || (x == 0 && y == 0 && (m_lastX != 0 || m_lastY != 0));
+    if(!isChanged && now - m_lastGoalTime < m_keepAlivePeriod)
+        return true;
+
+    // the port is one-way, the joypad never waits for the walking module
+    yarp::sig::Vector& goal = m_goalPort.prepare();
+    goal.resize(4);
+    goal(0) = m_sequenceNumber++;
+    goal(1) = now;
+    goal(2) = x;
+    goal(3) = y;
+    m_goalPort.write();
+
+    m_lastX = x;
+    m_lastY = y;
+    m_lastGoalTime = now;
     return true;
 }
 
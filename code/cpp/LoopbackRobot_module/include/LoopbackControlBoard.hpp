@@ -0,0 +1,231 @@
+/**
+ * @file LoopbackControlBoard.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef LOOPBACK_CONTROL_BOARD_HPP
+#define LOOPBACK_CONTROL_BOARD_HPP
+
+// std
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+#include <yarp/dev/DeviceDriver.h>
+#include <yarp/dev/IAxisInfo.h>
+#include <yarp/dev/IControlLimits.h>
+#include <yarp/dev/IControlMode.h>
+#include <yarp/dev/IEncodersTimed.h>
+#include <yarp/dev/IPidControl.h>
+#include <yarp/dev/IPositionControl.h>
+#include <yarp/dev/IPositionDirect.h>
+#include <yarp/dev/IRemoteVariables.h>
+#include <yarp/dev/IVelocityControl.h>
+
+/**
+ * LoopbackControlBoard is a fake control board used to run the walking controller without the
+ * robot or the simulator. Each joint tracks its reference with a first order dynamics after a
+ * pure delay. The device is exposed on the network by controlboardwrapper2, so the walking
+ * module reaches it through the remotecontrolboardremapper as a real robot.
+ * The following parameters are read:
+ * - axesNames: list of the names of the joints;
+ * - initialPositions: initial joint positions [deg] (default 0);
+ * - time_constant: time constant of the joint dynamics [s] (default 0.02);
+ * - delay: delay between the command and the joint response [s] (default 0);
+ * - period: integration period [s] (default 0.001);
+ * - position_limit, velocity_limit: symmetric joint limits [deg], [deg/s] (default 180, 100).
+ */
+class LoopbackControlBoard : public yarp::dev::DeviceDriver,
+                             public yarp::dev::IEncodersTimed,
+                             public yarp::dev::IPositionControl,
+                             public yarp::dev::IPositionDirect,
+                             public yarp::dev::IVelocityControl,
+                             public yarp::dev::IControlMode,
+                             public yarp::dev::IControlLimits,
+                             public yarp::dev::IPidControl,
+                             public yarp::dev::IRemoteVariables,
+                             public yarp::dev::IAxisInfo
+{
+    std::vector<std::string> m_axesNames; /**< Names of the joints. */
+    int m_numberOfAxes{0}; /**< Number of joints. */
+
+    double m_timeConstant{0.02}; /**< Time constant of the joint dynamics [s]. */
+    double m_period{0.001}; /**< Integration period [s]. */
+    size_t m_delaySteps{0}; /**< Delay of the joint response (number of periods). */
+
+    std::vector<double> m_positions; /**< Joint positions [deg]. */
+    std::vector<double> m_velocities; /**< Joint velocities [deg/s]. */
+    std::vector<double> m_accelerations; /**< Joint accelerations [deg/s^2]. */
+    double m_timestamp{0.0}; /**< Time of the last update. */
+
+    std::vector<double> m_references; /**< Position references (position direct and velocity modes) [deg]. */
+    std::vector<double> m_targets; /**< Targets of the position mode [deg]. */
+    std::vector<double> m_refSpeeds; /**< Reference speeds of the position mode [deg/s]. */
+    std::vector<double> m_refAccelerations; /**< Reference accelerations [deg/s^2]. */
+    std::vector<double> m_refVelocities; /**< References of the velocity mode [deg/s]. */
+    std::vector<int> m_controlModes; /**< Control mode of each joint. */
+    std::deque<std::vector<double>> m_delayedReferences; /**< References not yet applied. */
+
+    std::vector<double> m_minPositions; /**< Lower position limits [deg]. */
+    std::vector<double> m_maxPositions; /**< Upper position limits [deg]. */
+    std::vector<double> m_minVelocities; /**< Lower velocity limits [deg/s]. */
+    std::vector<double> m_maxVelocities; /**< Upper velocity limits [deg/s]. */
+
+    std::map<yarp::dev::PidControlTypeEnum, std::vector<yarp::dev::Pid>> m_pids; /**< Gains (stored, not used). */
+    std::map<yarp::dev::PidControlTypeEnum, std::vector<bool>> m_isPidEnabled; /**< Enabled PIDs. */
+    std::map<std::string, yarp::os::Bottle> m_remoteVariables; /**< Remote variables. */
+
+    std::thread m_thread; /**< Integration thread. */
+    std::mutex m_mutex; /**< Mutex. */
+    bool m_isRunning{false}; /**< True if the integration thread is running. */
+
+    /**
+     * Main loop of the integration thread.
+     */
+    void run();
+
+    /**
+     * Integrate the joint dynamics for a period. The mutex has to be locked.
+     */
+    void step();
+
+    /**
+     * Return true if the joint index is valid.
+     */
+    bool isValid(const int& joint) const;
+
+    /**
+     * Set the control mode of a joint. The mutex has to be locked.
+     */
+    bool setMode(const int& joint, const int& mode);
+
+    /**
+     * Set the target of the position mode of a joint. The mutex has to be locked.
+     */
+    bool setTarget(const int& joint, const double& target);
+
+public:
+
+    // DeviceDriver
+    bool open(yarp::os::Searchable& config) override;
+    bool close() override;
+
+    // IEncoders and IEncodersTimed
+    bool getAxes(int *ax) override;
+    bool resetEncoder(int j) override;
+    bool resetEncoders() override;
+    bool setEncoder(int j, double val) override;
+    bool setEncoders(const double *vals) override;
+    bool getEncoder(int j, double *v) override;
+    bool getEncoders(double *encs) override;
+    bool getEncoderSpeed(int j, double *sp) override;
+    bool getEncoderSpeeds(double *spds) override;
+    bool getEncoderAcceleration(int j, double *acc) override;
+    bool getEncoderAccelerations(double *accs) override;
+    bool getEncodersTimed(double *encs, double *time) override;
+    bool getEncoderTimed(int j, double *encs, double *time) override;
+
+    // IPositionControl
+    bool positionMove(int j, double ref) override;
+    bool positionMove(const double *refs) override;
+    bool positionMove(const int n_joint, const int *joints, const double *refs) override;
+    bool relativeMove(int j, double delta) override;
+    bool relativeMove(const double *deltas) override;
+    bool relativeMove(const int n_joint, const int *joints, const double *deltas) override;
+    bool checkMotionDone(int j, bool *flag) override;
+    bool checkMotionDone(bool *flag) override;
+    bool checkMotionDone(const int n_joint, const int *joints, bool *flag) override;
+    bool setRefSpeed(int j, double sp) override;
+    bool setRefSpeeds(const double *spds) override;
+    bool setRefSpeeds(const int n_joint, const int *joints, const double *spds) override;
+    bool getRefSpeed(int j, double *ref) override;
+    bool getRefSpeeds(double *spds) override;
+    bool getRefSpeeds(const int n_joint, const int *joints, double *spds) override;
+    bool getTargetPosition(const int joint, double *ref) override;
+    bool getTargetPositions(double *refs) override;
+    bool getTargetPositions(const int n_joint, const int *joints, double *refs) override;
+
+    // IPositionControl and IVelocityControl
+    bool setRefAcceleration(int j, double acc) override;
+    bool setRefAccelerations(const double *accs) override;
+    bool setRefAccelerations(const int n_joint, const int *joints, const double *accs) override;
+    bool getRefAcceleration(int j, double *acc) override;
+    bool getRefAccelerations(double *accs) override;
+    bool getRefAccelerations(const int n_joint, const int *joints, double *accs) override;
+    bool stop(int j) override;
+    bool stop() override;
+    bool stop(const int n_joint, const int *joints) override;
+
+    // IPositionDirect
+    bool setPosition(int j, double ref) override;
+    bool setPositions(const int n_joint, const int *joints, const double *refs) override;
+    bool setPositions(const double *refs) override;
+    bool getRefPosition(const int joint, double *ref) override;
+    bool getRefPositions(double *refs) override;
+    bool getRefPositions(const int n_joint, const int *joints, double *refs) override;
+
+    // IVelocityControl
+    bool velocityMove(int j, double sp) override;
+    bool velocityMove(const double *sp) override;
+    bool velocityMove(const int n_joint, const int *joints, const double *spds) override;
+    bool getRefVelocity(const int joint, double *vel) override;
+    bool getRefVelocities(double *vels) override;
+    bool getRefVelocities(const int n_joint, const int *joints, double *vels) override;
+
+    // IControlMode
+    bool getControlMode(int j, int *mode) override;
+    bool getControlModes(int *modes) override;
+    bool getControlModes(const int n_joint, const int *joints, int *modes) override;
+    bool setControlMode(const int j, const int mode) override;
+    bool setControlModes(const int n_joint, const int *joints, int *modes) override;
+    bool setControlModes(int *modes) override;
+
+    // IControlLimits
+    bool setLimits(int axis, double min, double max) override;
+    bool getLimits(int axis, double *min, double *max) override;
+    bool setVelLimits(int axis, double min, double max) override;
+    bool getVelLimits(int axis, double *min, double *max) override;
+
+    // IPidControl
+    bool setPid(const yarp::dev::PidControlTypeEnum& pidtype, int j, const yarp::dev::Pid &pid) override;
+    bool setPids(const yarp::dev::PidControlTypeEnum& pidtype, const yarp::dev::Pid *pids) override;
+    bool setPidReference(const yarp::dev::PidControlTypeEnum& pidtype, int j, double ref) override;
+    bool setPidReferences(const yarp::dev::PidControlTypeEnum& pidtype, const double *refs) override;
+    bool setPidErrorLimit(const yarp::dev::PidControlTypeEnum& pidtype, int j, double limit) override;
+    bool setPidErrorLimits(const yarp::dev::PidControlTypeEnum& pidtype, const double *limits) override;
+    bool getPidError(const yarp::dev::PidControlTypeEnum& pidtype, int j, double *err) override;
+    bool getPidErrors(const yarp::dev::PidControlTypeEnum& pidtype, double *errs) override;
+    bool getPidOutput(const yarp::dev::PidControlTypeEnum& pidtype, int j, double *out) override;
+    bool getPidOutputs(const yarp::dev::PidControlTypeEnum& pidtype, double *outs) override;
+    bool getPid(const yarp::dev::PidControlTypeEnum& pidtype, int j, yarp::dev::Pid *pid) override;
+    bool getPids(const yarp::dev::PidControlTypeEnum& pidtype, yarp::dev::Pid *pids) override;
+    bool getPidReference(const yarp::dev::PidControlTypeEnum& pidtype, int j, double *ref) override;
+    bool getPidReferences(const yarp::dev::PidControlTypeEnum& pidtype, double *refs) override;
+    bool getPidErrorLimit(const yarp::dev::PidControlTypeEnum& pidtype, int j, double *limit) override;
+    bool getPidErrorLimits(const yarp::dev::PidControlTypeEnum& pidtype, double *limits) override;
+    bool resetPid(const yarp::dev::PidControlTypeEnum& pidtype, int j) override;
+    bool disablePid(const yarp::dev::PidControlTypeEnum& pidtype, int j) override;
+    bool enablePid(const yarp::dev::PidControlTypeEnum& pidtype, int j) override;
+    bool setPidOffset(const yarp::dev::PidControlTypeEnum& pidtype, int j, double v) override;
+    bool isPidEnabled(const yarp::dev::PidControlTypeEnum& pidtype, int j, bool* enabled) override;
+
+    // IRemoteVariables
+    bool getRemoteVariable(std::string key, yarp::os::Bottle& val) override;
+    bool setRemoteVariable(std::string key, const yarp::os::Bottle& val) override;
+    bool getRemoteVariablesList(yarp::os::Bottle* listOfKeys) override;
+
+    // IAxisInfo
+    bool getAxisName(int axis, std::string& name) override;
+    bool getJointType(int axis, yarp::dev::JointTypeEnum& type) override;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file LoopbackRobotModule.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef LOOPBACK_ROBOT_MODULE_HPP
+#define LOOPBACK_ROBOT_MODULE_HPP
+
+// std
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/RFModule.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/dev/IEncoders.h>
+#include <yarp/dev/PolyDriver.h>
+
+// iDynTree
+#include <iDynTree/Core/Position.h>
+#include <iDynTree/Core/Transform.h>
+#include <iDynTree/Core/VectorDynSize.h>
+#include <iDynTree/Model/Indices.h>
+#include <iDynTree/KinDynComputations.h>
+
+/**
+ * LoopbackRobotModule is a fake robot used to benchmark the walking controller in closed loop
+ * without the simulator. Each part of the robot is a LoopbackControlBoard exposed by a
+ * controlboardwrapper2 (i.e. /<robot>/<part>), so the walking module uses the same YARP interfaces
+ * and ports of the real robot. The module also replaces wholeBodyDynamics: the CoM is computed from
+ * the joint positions, the ZMP is evaluated with the LIPM and the ground reaction force is split
+ * between the feet in contact and streamed on the foot wrench ports.
+ */
+class LoopbackRobotModule : public yarp::os::RFModule
+{
+    double m_period; /**< RFModule period (period of the wrench ports). */
+
+    std::vector<std::unique_ptr<yarp::dev::PolyDriver>> m_boards; /**< Loopback control boards. */
+    std::vector<std::unique_ptr<yarp::dev::PolyDriver>> m_wrappers; /**< Control board wrappers. */
+    std::vector<yarp::dev::IEncoders*> m_encodersInterfaces; /**< Encoders of the parts. */
+    std::vector<int> m_partsAxes; /**< Number of axes of each part. */
+
+    iDynTree::KinDynComputations m_kinDyn; /**< KinDynComputations solver. */
+    iDynTree::FrameIndex m_frameLeftIndex; /**< Index of the frame attached to the left foot. */
+    iDynTree::FrameIndex m_frameRightIndex; /**< Index of the frame attached to the right foot. */
+    double m_mass; /**< Total mass of the robot [kg]. */
+    double m_gravityAcceleration; /**< Gravity acceleration [m/s^2]. */
+    double m_contactThreshold; /**< Max height of a foot in contact with the ground [m]. */
+
+    std::vector<double> m_positionsInDegrees; /**< Joint positions [deg]. */
+    iDynTree::VectorDynSize m_positionsInRadians; /**< Joint positions [rad]. */
+    iDynTree::VectorDynSize m_velocities; /**< Joint velocities (always zero) [rad/s]. */
+
+    bool m_isLeftStance{true}; /**< True if the left foot is the stance foot. */
+    iDynTree::Transform m_worldToStanceTransform; /**< Pose of the stance foot in the world frame. */
+    std::deque<iDynTree::Position> m_comHistory; /**< Last three CoM positions. */
+    std::deque<double> m_timeHistory; /**< Times of the last three CoM positions. */
+
+    yarp::os::BufferedPort<yarp::sig::Vector> m_leftWrenchPort; /**< Left foot wrench port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_rightWrenchPort; /**< Right foot wrench port. */
+
+    /**
+     * Open the loopback control board and the wrapper of each part.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configureParts(const yarp::os::ResourceFinder& rf);
+
+    /**
+     * Load the model and open the wrench ports.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configureWrenches(const yarp::os::ResourceFinder& rf);
+
+    /**
+     * Send the wrench acting on a foot.
+     * @param worldToFootTransform pose of the foot;
+     * @param force force acting on the foot (world frame);
+     * @param centerOfPressure center of pressure of the foot (world frame);
+     * @param port wrench port.
+     */
+    void sendWrench(const iDynTree::Transform& worldToFootTransform, const iDynTree::Vector3& force,
+                    const iDynTree::Position& centerOfPressure,
+                    yarp::os::BufferedPort<yarp::sig::Vector>& port);
+
+public:
+
+    /**
+     * Get the period of the RFModule.
+     * @return the period of the module.
+     */
+    double getPeriod() override;
+
+    /**
+     * Main function of the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool updateModule() override;
+
+    /**
+     * Configure the RFModule.
+     * @param rf is the reference to a resource finder object
+     * @return true in case of success and false otherwise.
+     */
+    bool configure(yarp::os::ResourceFinder& rf) override;
+
+    /**
+     * Close the RFModule.
+     * @return true in case of success and false otherwise.
+     */
+    bool close() override;
+};
+
+#endif
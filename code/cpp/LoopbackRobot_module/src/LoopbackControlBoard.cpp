@@ -0,0 +1,1102 @@
+/**
+ * @file LoopbackControlBoard.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/Vocab.h>
+
+#include "LoopbackControlBoard.hpp"
+
+namespace
+{
+    /**
+     * Read a list of doubles from the configuration. If the key is not found the vector is
+     * filled with the default value.
+     */
+    bool getListOfDoubles(const yarp::os::Searchable& config, const std::string& key,
+                          const double& defaultValue, const size_t& size,
+                          std::vector<double>& values)
+    {
+        values.assign(size, defaultValue);
+
+        yarp::os::Value* value;
+        if(!config.check(key, value))
+            return true;
+
+        if(value->isDouble() || value->isInt())
+        {
+            values.assign(size, value->asDouble());
+            return true;
+        }
+
+        yarp::os::Bottle* list = value->asList();
+        if(list == nullptr || list->size() != static_cast<int>(size))
+        {
+            yError() << "[getListOfDoubles] The size of " << key
+                     << " is different from the number of axes.";
+            return false;
+        }
+
+        for(int i = 0; i < list->size(); i++)
+            values[i] = list->get(i).asDouble();
+
+        return true;
+    }
+
+    /**
+     * Threshold used to consider a position move completed [deg].
+     */
+    const double s_motionDoneThreshold = 0.1;
+}
+
+bool LoopbackControlBoard::open(yarp::os::Searchable& config)
+{
+    yarp::os::Value* axesNames;
+    if(!config.check("axesNames", axesNames) || axesNames->asList() == nullptr)
+    {
+        yError() << "[open] Unable to find the list axesNames.";
+        return false;
+    }
+
+    yarp::os::Bottle* axesList = axesNames->asList();
+    m_numberOfAxes = axesList->size();
+    if(m_numberOfAxes == 0)
+    {
+        yError() << "[open] The list axesNames is empty.";
+        return false;
+    }
+
+    for(int i = 0; i < m_numberOfAxes; i++)
+        m_axesNames.push_back(axesList->get(i).asString());
+
+    m_timeConstant = config.check("time_constant", yarp::os::Value(0.02)).asDouble();
+    m_period = config.check("period", yarp::os::Value(0.001)).asDouble();
+    double delay = config.check("delay", yarp::os::Value(0.0)).asDouble();
+    if(m_timeConstant <= 0 || m_period <= 0 || delay < 0)
+    {
+        yError() << "[open] The time constant and the period have to be positive, "
+                 << "the delay cannot be negative.";
+        return false;
+    }
+    m_delaySteps = static_cast<size_t>(std::round(delay / m_period));
+
+    std::vector<double> positionLimits, velocityLimits;
+    if(!getListOfDoubles(config, "initialPositions", 0.0, m_numberOfAxes, m_positions)
+       || !getListOfDoubles(config, "position_limit", 180.0, m_numberOfAxes, positionLimits)
+       || !getListOfDoubles(config, "velocity_limit", 100.0, m_numberOfAxes, velocityLimits))
+    {
+        yError() << "[open] Unable to read the joint parameters.";
+        return false;
+    }
+
+    for(int i = 0; i < m_numberOfAxes; i++)
+    {
+        m_minPositions.push_back(-positionLimits[i]);
+        m_maxPositions.push_back(positionLimits[i]);
+        m_minVelocities.push_back(-velocityLimits[i]);
+        m_maxVelocities.push_back(velocityLimits[i]);
+    }
+
+    m_velocities.assign(m_numberOfAxes, 0.0);
+    m_accelerations.assign(m_numberOfAxes, 0.0);
+    m_references = m_positions;
+    m_targets = m_positions;
+    m_refSpeeds.assign(m_numberOfAxes, 10.0);
+    m_refAccelerations.assign(m_numberOfAxes, 0.0);
+    m_refVelocities.assign(m_numberOfAxes, 0.0);
+    m_controlModes.assign(m_numberOfAxes, VOCAB_CM_POSITION);
+    m_timestamp = yarp::os::Time::now();
+
+    for(const auto& pidType : {yarp::dev::VOCAB_PIDTYPE_POSITION, yarp::dev::VOCAB_PIDTYPE_VELOCITY,
+                yarp::dev::VOCAB_PIDTYPE_TORQUE, yarp::dev::VOCAB_PIDTYPE_CURRENT})
+    {
+        m_pids[pidType] = std::vector<yarp::dev::Pid>(m_numberOfAxes);
+        m_isPidEnabled[pidType] = std::vector<bool>(m_numberOfAxes, true);
+    }
+
+    // the walking PID handler sets the smoothing time of the position PIDs
+    yarp::os::Bottle& slopeTime = m_remoteVariables["posPidSlopeTime"];
+    yarp::os::Bottle& slopeTimeList = slopeTime.addList();
+    for(int i = 0; i < m_numberOfAxes; i++)
+        slopeTimeList.addInt(0);
+
+    m_isRunning = true;
+    m_thread = std::thread(&LoopbackControlBoard::run, this);
+
+    yInfo() << "[open] Loopback control board with" << m_numberOfAxes << "axes, time constant"
+            << m_timeConstant << "s and delay" << m_delaySteps * m_period << "s.";
+    return true;
+}
+
+bool LoopbackControlBoard::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+    }
+
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+        m_thread = std::thread();
+    }
+
+    return true;
+}
+
+void LoopbackControlBoard::run()
+{
+    auto nextStep = std::chrono::steady_clock::now();
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>
+        (std::chrono::duration<double>(m_period));
+
+    while(true)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if(!m_isRunning)
+                break;
+
+            step();
+        }
+
+        nextStep += period;
+        std::this_thread::sleep_until(nextStep);
+    }
+}
+
+void LoopbackControlBoard::step()
+{
+    // update the references
+    for(int i = 0; i < m_numberOfAxes; i++)
+    {
+        switch(m_controlModes[i])
+        {
+        case VOCAB_CM_POSITION_DIRECT:
+            break;
+
+        case VOCAB_CM_POSITION:
+        {
+            double maxStep = std::abs(m_refSpeeds[i]) * m_period;
+            double error = m_targets[i] - m_references[i];
+            m_references[i] += std::max(-maxStep, std::min(maxStep, error));
+            break;
+        }
+
+        case VOCAB_CM_VELOCITY:
+            m_references[i] += m_refVelocities[i] * m_period;
+            break;
+
+        default:
+            // the joint is not controlled
+            m_references[i] = m_positions[i];
+            break;
+        }
+
+        m_references[i] = std::max(m_minPositions[i], std::min(m_maxPositions[i], m_references[i]));
+    }
+
+    // the references reach the joints after the delay
+    m_delayedReferences.push_back(m_references);
+    const std::vector<double> references = m_delayedReferences.front();
+    if(m_delayedReferences.size() > m_delaySteps)
+        m_delayedReferences.pop_front();
+
+    // exact discretization of the first order dynamics
+    double gain = 1 - std::exp(-m_period / m_timeConstant);
+    for(int i = 0; i < m_numberOfAxes; i++)
+    {
+        double position = m_positions[i] + gain * (references[i] - m_positions[i]);
+        double velocity = (position - m_positions[i]) / m_period;
+        m_accelerations[i] = (velocity - m_velocities[i]) / m_period;
+        m_velocities[i] = velocity;
+        m_positions[i] = position;
+    }
+
+    m_timestamp = yarp::os::Time::now();
+}
+
+bool LoopbackControlBoard::isValid(const int& joint) const
+{
+    return joint >= 0 && joint < m_numberOfAxes;
+}
+
+bool LoopbackControlBoard::setMode(const int& joint, const int& mode)
+{
+    if(!isValid(joint))
+        return false;
+
+    switch(mode)
+    {
+    case VOCAB_CM_POSITION:
+    case VOCAB_CM_POSITION_DIRECT:
+    case VOCAB_CM_VELOCITY:
+    case VOCAB_CM_IDLE:
+        break;
+
+    case VOCAB_CM_FORCE_IDLE:
+        m_controlModes[joint] = VOCAB_CM_IDLE;
+        return true;
+
+    default:
+        yError() << "[setMode] The control mode" << yarp::os::Vocab::decode(mode)
+                 << "is not supported by the loopback control board.";
+        return false;
+    }
+
+    // the joint starts from the last reference to avoid jumps
+    if(m_controlModes[joint] != mode)
+    {
+        m_targets[joint] = m_references[joint];
+        m_refVelocities[joint] = 0.0;
+    }
+
+    m_controlModes[joint] = mode;
+    return true;
+}
+
+bool LoopbackControlBoard::setTarget(const int& joint, const double& target)
+{
+    if(!isValid(joint) || m_controlModes[joint] != VOCAB_CM_POSITION)
+        return false;
+
+    m_targets[joint] = std::max(m_minPositions[joint], std::min(m_maxPositions[joint], target));
+    return true;
+}
+
+// IEncoders and IEncodersTimed
+
+bool LoopbackControlBoard::getAxes(int *ax)
+{
+    *ax = m_numberOfAxes;
+    return true;
+}
+
+bool LoopbackControlBoard::resetEncoder(int j)
+{
+    return setEncoder(j, 0.0);
+}
+
+bool LoopbackControlBoard::resetEncoders()
+{
+    std::vector<double> values(m_numberOfAxes, 0.0);
+    return setEncoders(values.data());
+}
+
+bool LoopbackControlBoard::setEncoder(int j, double val)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    m_positions[j] = val;
+    m_references[j] = val;
+    m_targets[j] = val;
+    m_delayedReferences.clear();
+    return true;
+}
+
+bool LoopbackControlBoard::setEncoders(const double *vals)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setEncoder(i, vals[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoder(int j, double *v)
+{
+    double time;
+    return getEncoderTimed(j, v, &time);
+}
+
+bool LoopbackControlBoard::getEncoders(double *encs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_positions.begin(), m_positions.end(), encs);
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoderSpeed(int j, double *sp)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *sp = m_velocities[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoderSpeeds(double *spds)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_velocities.begin(), m_velocities.end(), spds);
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoderAcceleration(int j, double *acc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *acc = m_accelerations[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoderAccelerations(double *accs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_accelerations.begin(), m_accelerations.end(), accs);
+    return true;
+}
+
+bool LoopbackControlBoard::getEncodersTimed(double *encs, double *time)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_positions.begin(), m_positions.end(), encs);
+    std::fill(time, time + m_numberOfAxes, m_timestamp);
+    return true;
+}
+
+bool LoopbackControlBoard::getEncoderTimed(int j, double *encs, double *time)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *encs = m_positions[j];
+    *time = m_timestamp;
+    return true;
+}
+
+// IPositionControl
+
+bool LoopbackControlBoard::positionMove(int j, double ref)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return setTarget(j, ref);
+}
+
+bool LoopbackControlBoard::positionMove(const double *refs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < m_numberOfAxes; i++)
+        ok = setTarget(i, refs[i]) && ok;
+    return ok;
+}
+
+bool LoopbackControlBoard::positionMove(const int n_joint, const int *joints, const double *refs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < n_joint; i++)
+        ok = setTarget(joints[i], refs[i]) && ok;
+    return ok;
+}
+
+bool LoopbackControlBoard::relativeMove(int j, double delta)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return isValid(j) && setTarget(j, m_targets[j] + delta);
+}
+
+bool LoopbackControlBoard::relativeMove(const double *deltas)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < m_numberOfAxes; i++)
+        ok = setTarget(i, m_targets[i] + deltas[i]) && ok;
+    return ok;
+}
+
+bool LoopbackControlBoard::relativeMove(const int n_joint, const int *joints, const double *deltas)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < n_joint; i++)
+        ok = isValid(joints[i]) && setTarget(joints[i], m_targets[joints[i]] + deltas[i]) && ok;
+    return ok;
+}
+
+bool LoopbackControlBoard::checkMotionDone(int j, bool *flag)
+{
+    return checkMotionDone(1, &j, flag);
+}
+
+bool LoopbackControlBoard::checkMotionDone(bool *flag)
+{
+    std::vector<int> joints(m_numberOfAxes);
+    for(int i = 0; i < m_numberOfAxes; i++)
+        joints[i] = i;
+    return checkMotionDone(m_numberOfAxes, joints.data(), flag);
+}
+
+bool LoopbackControlBoard::checkMotionDone(const int n_joint, const int *joints, bool *flag)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    *flag = true;
+    for(int i = 0; i < n_joint; i++)
+    {
+        int j = joints[i];
+        if(!isValid(j))
+            return false;
+
+        if(m_controlModes[j] == VOCAB_CM_POSITION
+           && std::abs(m_targets[j] - m_positions[j]) > s_motionDoneThreshold)
+            *flag = false;
+    }
+    return true;
+}
+
+bool LoopbackControlBoard::setRefSpeed(int j, double sp)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    m_refSpeeds[j] = std::min(std::abs(sp), m_maxVelocities[j]);
+    return true;
+}
+
+bool LoopbackControlBoard::setRefSpeeds(const double *spds)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setRefSpeed(i, spds[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::setRefSpeeds(const int n_joint, const int *joints, const double *spds)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!setRefSpeed(joints[i], spds[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getRefSpeed(int j, double *ref)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *ref = m_refSpeeds[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getRefSpeeds(double *spds)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_refSpeeds.begin(), m_refSpeeds.end(), spds);
+    return true;
+}
+
+bool LoopbackControlBoard::getRefSpeeds(const int n_joint, const int *joints, double *spds)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!getRefSpeed(joints[i], &spds[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getTargetPosition(const int joint, double *ref)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(joint))
+        return false;
+
+    *ref = m_targets[joint];
+    return true;
+}
+
+bool LoopbackControlBoard::getTargetPositions(double *refs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_targets.begin(), m_targets.end(), refs);
+    return true;
+}
+
+bool LoopbackControlBoard::getTargetPositions(const int n_joint, const int *joints, double *refs)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!getTargetPosition(joints[i], &refs[i]))
+            return false;
+    return true;
+}
+
+// IPositionControl and IVelocityControl (the accelerations are stored but not used)
+
+bool LoopbackControlBoard::setRefAcceleration(int j, double acc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    m_refAccelerations[j] = acc;
+    return true;
+}
+
+bool LoopbackControlBoard::setRefAccelerations(const double *accs)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setRefAcceleration(i, accs[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::setRefAccelerations(const int n_joint, const int *joints, const double *accs)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!setRefAcceleration(joints[i], accs[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getRefAcceleration(int j, double *acc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *acc = m_refAccelerations[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getRefAccelerations(double *accs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_refAccelerations.begin(), m_refAccelerations.end(), accs);
+    return true;
+}
+
+bool LoopbackControlBoard::getRefAccelerations(const int n_joint, const int *joints, double *accs)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!getRefAcceleration(joints[i], &accs[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::stop(int j)
+{
+    return stop(1, &j);
+}
+
+bool LoopbackControlBoard::stop()
+{
+    std::vector<int> joints(m_numberOfAxes);
+    for(int i = 0; i < m_numberOfAxes; i++)
+        joints[i] = i;
+    return stop(m_numberOfAxes, joints.data());
+}
+
+bool LoopbackControlBoard::stop(const int n_joint, const int *joints)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for(int i = 0; i < n_joint; i++)
+    {
+        int j = joints[i];
+        if(!isValid(j))
+            return false;
+
+        m_targets[j] = m_references[j];
+        m_refVelocities[j] = 0.0;
+    }
+    return true;
+}
+
+// IPositionDirect
+
+bool LoopbackControlBoard::setPosition(int j, double ref)
+{
+    return setPositions(1, &j, &ref);
+}
+
+bool LoopbackControlBoard::setPositions(const int n_joint, const int *joints, const double *refs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < n_joint; i++)
+    {
+        int j = joints[i];
+        if(!isValid(j) || m_controlModes[j] != VOCAB_CM_POSITION_DIRECT)
+        {
+            ok = false;
+            continue;
+        }
+        m_references[j] = refs[i];
+    }
+    return ok;
+}
+
+bool LoopbackControlBoard::setPositions(const double *refs)
+{
+    std::vector<int> joints(m_numberOfAxes);
+    for(int i = 0; i < m_numberOfAxes; i++)
+        joints[i] = i;
+    return setPositions(m_numberOfAxes, joints.data(), refs);
+}
+
+bool LoopbackControlBoard::getRefPosition(const int joint, double *ref)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(joint))
+        return false;
+
+    *ref = m_references[joint];
+    return true;
+}
+
+bool LoopbackControlBoard::getRefPositions(double *refs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_references.begin(), m_references.end(), refs);
+    return true;
+}
+
+bool LoopbackControlBoard::getRefPositions(const int n_joint, const int *joints, double *refs)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!getRefPosition(joints[i], &refs[i]))
+            return false;
+    return true;
+}
+
+// IVelocityControl
+
+bool LoopbackControlBoard::velocityMove(int j, double sp)
+{
+    return velocityMove(1, &j, &sp);
+}
+
+bool LoopbackControlBoard::velocityMove(const double *sp)
+{
+    std::vector<int> joints(m_numberOfAxes);
+    for(int i = 0; i < m_numberOfAxes; i++)
+        joints[i] = i;
+    return velocityMove(m_numberOfAxes, joints.data(), sp);
+}
+
+bool LoopbackControlBoard::velocityMove(const int n_joint, const int *joints, const double *spds)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < n_joint; i++)
+    {
+        int j = joints[i];
+        if(!isValid(j) || m_controlModes[j] != VOCAB_CM_VELOCITY)
+        {
+            ok = false;
+            continue;
+        }
+        m_refVelocities[j] = std::max(m_minVelocities[j], std::min(m_maxVelocities[j], spds[i]));
+    }
+    return ok;
+}
+
+bool LoopbackControlBoard::getRefVelocity(const int joint, double *vel)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(joint))
+        return false;
+
+    *vel = m_refVelocities[joint];
+    return true;
+}
+
+bool LoopbackControlBoard::getRefVelocities(double *vels)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_refVelocities.begin(), m_refVelocities.end(), vels);
+    return true;
+}
+
+bool LoopbackControlBoard::getRefVelocities(const int n_joint, const int *joints, double *vels)
+{
+    for(int i = 0; i < n_joint; i++)
+        if(!getRefVelocity(joints[i], &vels[i]))
+            return false;
+    return true;
+}
+
+// IControlMode
+
+bool LoopbackControlBoard::getControlMode(int j, int *mode)
+{
+    return getControlModes(1, &j, mode);
+}
+
+bool LoopbackControlBoard::getControlModes(int *modes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::copy(m_controlModes.begin(), m_controlModes.end(), modes);
+    return true;
+}
+
+bool LoopbackControlBoard::getControlModes(const int n_joint, const int *joints, int *modes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for(int i = 0; i < n_joint; i++)
+    {
+        if(!isValid(joints[i]))
+            return false;
+        modes[i] = m_controlModes[joints[i]];
+    }
+    return true;
+}
+
+bool LoopbackControlBoard::setControlMode(const int j, const int mode)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return setMode(j, mode);
+}
+
+bool LoopbackControlBoard::setControlModes(const int n_joint, const int *joints, int *modes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < n_joint; i++)
+        ok = setMode(joints[i], modes[i]) && ok;
+    return ok;
+}
+
+bool LoopbackControlBoard::setControlModes(int *modes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    bool ok = true;
+    for(int i = 0; i < m_numberOfAxes; i++)
+        ok = setMode(i, modes[i]) && ok;
+    return ok;
+}
+
+// IControlLimits
+
+bool LoopbackControlBoard::setLimits(int axis, double min, double max)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(axis) || min > max)
+        return false;
+
+    m_minPositions[axis] = min;
+    m_maxPositions[axis] = max;
+    return true;
+}
+
+bool LoopbackControlBoard::getLimits(int axis, double *min, double *max)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(axis))
+        return false;
+
+    *min = m_minPositions[axis];
+    *max = m_maxPositions[axis];
+    return true;
+}
+
+bool LoopbackControlBoard::setVelLimits(int axis, double min, double max)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(axis) || min > max)
+        return false;
+
+    m_minVelocities[axis] = min;
+    m_maxVelocities[axis] = max;
+    return true;
+}
+
+bool LoopbackControlBoard::getVelLimits(int axis, double *min, double *max)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(axis))
+        return false;
+
+    *min = m_minVelocities[axis];
+    *max = m_maxVelocities[axis];
+    return true;
+}
+
+// IPidControl (the gains are stored and returned, the joint dynamics does not depend on them)
+
+bool LoopbackControlBoard::setPid(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                  const yarp::dev::Pid &pid)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto pids = m_pids.find(pidtype);
+    if(pids == m_pids.end() || !isValid(j))
+        return false;
+
+    pids->second[j] = pid;
+    return true;
+}
+
+bool LoopbackControlBoard::setPids(const yarp::dev::PidControlTypeEnum& pidtype,
+                                   const yarp::dev::Pid *pids)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setPid(pidtype, i, pids[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::setPidReference(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                           double ref)
+{
+    if(pidtype != yarp::dev::VOCAB_PIDTYPE_POSITION)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    m_references[j] = ref;
+    return true;
+}
+
+bool LoopbackControlBoard::setPidReferences(const yarp::dev::PidControlTypeEnum& pidtype,
+                                            const double *refs)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setPidReference(pidtype, i, refs[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::setPidErrorLimit(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                            double limit)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto pids = m_pids.find(pidtype);
+    if(pids == m_pids.end() || !isValid(j))
+        return false;
+
+    pids->second[j].max_int = limit;
+    return true;
+}
+
+bool LoopbackControlBoard::setPidErrorLimits(const yarp::dev::PidControlTypeEnum& pidtype,
+                                             const double *limits)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!setPidErrorLimit(pidtype, i, limits[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getPidError(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                       double *err)
+{
+    if(pidtype != yarp::dev::VOCAB_PIDTYPE_POSITION)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(!isValid(j))
+        return false;
+
+    *err = m_references[j] - m_positions[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getPidErrors(const yarp::dev::PidControlTypeEnum& pidtype, double *errs)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!getPidError(pidtype, i, &errs[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getPidOutput(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                        double *out)
+{
+    if(!isValid(j))
+        return false;
+
+    *out = 0.0;
+    return true;
+}
+
+bool LoopbackControlBoard::getPidOutputs(const yarp::dev::PidControlTypeEnum& pidtype, double *outs)
+{
+    std::fill(outs, outs + m_numberOfAxes, 0.0);
+    return true;
+}
+
+bool LoopbackControlBoard::getPid(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                  yarp::dev::Pid *pid)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto pids = m_pids.find(pidtype);
+    if(pids == m_pids.end() || !isValid(j))
+        return false;
+
+    *pid = pids->second[j];
+    return true;
+}
+
+bool LoopbackControlBoard::getPids(const yarp::dev::PidControlTypeEnum& pidtype,
+                                   yarp::dev::Pid *pids)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!getPid(pidtype, i, &pids[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::getPidReference(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                           double *ref)
+{
+    if(pidtype != yarp::dev::VOCAB_PIDTYPE_POSITION)
+        return false;
+
+    return getRefPosition(j, ref);
+}
+
+bool LoopbackControlBoard::getPidReferences(const yarp::dev::PidControlTypeEnum& pidtype,
+                                            double *refs)
+{
+    if(pidtype != yarp::dev::VOCAB_PIDTYPE_POSITION)
+        return false;
+
+    return getRefPositions(refs);
+}
+
+bool LoopbackControlBoard::getPidErrorLimit(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                            double *limit)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto pids = m_pids.find(pidtype);
+    if(pids == m_pids.end() || !isValid(j))
+        return false;
+
+    *limit = pids->second[j].max_int;
+    return true;
+}
+
+bool LoopbackControlBoard::getPidErrorLimits(const yarp::dev::PidControlTypeEnum& pidtype,
+                                             double *limits)
+{
+    for(int i = 0; i < m_numberOfAxes; i++)
+        if(!getPidErrorLimit(pidtype, i, &limits[i]))
+            return false;
+    return true;
+}
+
+bool LoopbackControlBoard::resetPid(const yarp::dev::PidControlTypeEnum& pidtype, int j)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_pids.find(pidtype) != m_pids.end() && isValid(j);
+}
+
+bool LoopbackControlBoard::disablePid(const yarp::dev::PidControlTypeEnum& pidtype, int j)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto enabled = m_isPidEnabled.find(pidtype);
+    if(enabled == m_isPidEnabled.end() || !isValid(j))
+        return false;
+
+    enabled->second[j] = false;
+    return true;
+}
+
+bool LoopbackControlBoard::enablePid(const yarp::dev::PidControlTypeEnum& pidtype, int j)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto enabled = m_isPidEnabled.find(pidtype);
+    if(enabled == m_isPidEnabled.end() || !isValid(j))
+        return false;
+
+    enabled->second[j] = true;
+    return true;
+}
+
+bool LoopbackControlBoard::setPidOffset(const yarp::dev::PidControlTypeEnum& pidtype, int j, double v)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto pids = m_pids.find(pidtype);
+    if(pids == m_pids.end() || !isValid(j))
+        return false;
+
+    pids->second[j].offset = v;
+    return true;
+}
+
+bool LoopbackControlBoard::isPidEnabled(const yarp::dev::PidControlTypeEnum& pidtype, int j,
+                                        bool* enabled)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto isEnabled = m_isPidEnabled.find(pidtype);
+    if(isEnabled == m_isPidEnabled.end() || !isValid(j))
+        return false;
+
+    *enabled = isEnabled->second[j];
+    return true;
+}
+
+// IRemoteVariables
+
+bool LoopbackControlBoard::getRemoteVariable(std::string key, yarp::os::Bottle& val)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto variable = m_remoteVariables.find(key);
+    if(variable == m_remoteVariables.end())
+        return false;
+
+    val = variable->second;
+    return true;
+}
+
+bool LoopbackControlBoard::setRemoteVariable(std::string key, const yarp::os::Bottle& val)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto variable = m_remoteVariables.find(key);
+    if(variable == m_remoteVariables.end())
+    {
+        yError() << "[setRemoteVariable] Unknown remote variable" << key;
+        return false;
+    }
+
+    variable->second = val;
+    return true;
+}
+
+bool LoopbackControlBoard::getRemoteVariablesList(yarp::os::Bottle* listOfKeys)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    listOfKeys->clear();
+    for(const auto& variable : m_remoteVariables)
+        listOfKeys->addString(variable.first);
+    return true;
+}
+
+// IAxisInfo
+
+bool LoopbackControlBoard::getAxisName(int axis, std::string& name)
+{
+    if(!isValid(axis))
+        return false;
+
+    name = m_axesNames[axis];
+    return true;
+}
+
+bool LoopbackControlBoard::getJointType(int axis, yarp::dev::JointTypeEnum& type)
+{
+    if(!isValid(axis))
+        return false;
+
+    type = yarp::dev::VOCAB_JOINTTYPE_REVOLUTE;
+    return true;
+}
@@ -0,0 +1,367 @@
+/**
+ * @file LoopbackRobotModule.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+#include <yarp/dev/Wrapper.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/Twist.h>
+#include <iDynTree/Core/Utils.h>
+#include <iDynTree/Model/Model.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+// eigen
+#include <Eigen/Dense>
+
+#include "LoopbackRobotModule.hpp"
+
+bool LoopbackRobotModule::configureParts(const yarp::os::ResourceFinder& rf)
+{
+    std::string robot = rf.check("robot", yarp::os::Value("loopback")).asString();
+    int wrapperPeriod = rf.check("wrapper_period", yarp::os::Value(10)).asInt();
+
+    yarp::os::Value* partsValue;
+    if(!rf.check("parts", partsValue) || partsValue->asList() == nullptr)
+    {
+        yError() << "[configureParts] Unable to find the list of parts.";
+        return false;
+    }
+    yarp::os::Bottle* parts = partsValue->asList();
+
+    // the parameters of the joint dynamics are shared by all the parts (unless a part overrides them)
+    yarp::os::Bottle& jointDynamics = rf.findGroup("JOINT_DYNAMICS");
+
+    for(int i = 0; i < parts->size(); i++)
+    {
+        std::string part = parts->get(i).asString();
+        yarp::os::Bottle& partGroup = rf.findGroup(part);
+        if(partGroup.isNull())
+        {
+            yError() << "[configureParts] Unable to find the group" << part;
+            return false;
+        }
+
+        yarp::os::Property boardOptions;
+        boardOptions.fromString(partGroup.toString());
+        boardOptions.put("device", "walkingLoopbackControlBoard");
+        for(const auto& key : {"time_constant", "delay", "period"})
+            if(!boardOptions.check(key) && jointDynamics.check(key))
+                boardOptions.put(key, jointDynamics.find(key));
+
+        m_boards.push_back(std::make_unique<yarp::dev::PolyDriver>());
+        if(!m_boards.back()->open(boardOptions))
+        {
+            yError() << "[configureParts] Unable to open the loopback control board of" << part;
+            return false;
+        }
+
+        yarp::dev::IEncoders* encodersInterface;
+        int axes;
+        if(!m_boards.back()->view(encodersInterface) || !encodersInterface
+           || !encodersInterface->getAxes(&axes))
+        {
+            yError() << "[configureParts] Cannot obtain IEncoders interface of" << part;
+            return false;
+        }
+        m_encodersInterfaces.push_back(encodersInterface);
+        m_partsAxes.push_back(axes);
+
+        // the wrapper exposes the board with the same ports of the real robot
+        yarp::os::Property wrapperOptions;
+        wrapperOptions.put("device", "controlboardwrapper2");
+        wrapperOptions.put("name", "/" + robot + "/" + part);
+        wrapperOptions.put("period", wrapperPeriod);
+        wrapperOptions.put("joints", axes);
+        wrapperOptions.fromString("(networks (" + part + ")) (" + part + " (0 "
+                                  + std::to_string(axes - 1) + " 0 " + std::to_string(axes - 1)
+                                  + "))", false);
+
+        m_wrappers.push_back(std::make_unique<yarp::dev::PolyDriver>());
+        yarp::dev::IMultipleWrapper* wrapperInterface;
+        if(!m_wrappers.back()->open(wrapperOptions) || !m_wrappers.back()->view(wrapperInterface)
+           || !wrapperInterface)
+        {
+            yError() << "[configureParts] Unable to open the control board wrapper of" << part;
+            return false;
+        }
+
+        yarp::dev::PolyDriverList drivers;
+        drivers.push(m_boards.back().get(), part.c_str());
+        if(!wrapperInterface->attachAll(drivers))
+        {
+            yError() << "[configureParts] Unable to attach the loopback control board of" << part;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LoopbackRobotModule::configureWrenches(const yarp::os::ResourceFinder& rf)
+{
+    yarp::os::Bottle& config = rf.findGroup("WRENCHES");
+
+    // the controlled joints are the ones of all the parts
+    std::vector<std::string> axesList;
+    yarp::os::Bottle* parts = rf.find("parts").asList();
+    for(int i = 0; i < parts->size(); i++)
+    {
+        yarp::os::Bottle* axesNames = rf.findGroup(parts->get(i).asString()).find("axesNames").asList();
+        for(int j = 0; j < axesNames->size(); j++)
+            axesList.push_back(axesNames->get(j).asString());
+    }
+
+    std::string model = rf.check("model", yarp::os::Value("model.urdf")).asString();
+    std::string pathToModel = yarp::os::ResourceFinder::getResourceFinderSingleton().findFileByName(model);
+
+    iDynTree::ModelLoader loader;
+    if(!loader.loadReducedModelFromFile(pathToModel, axesList))
+    {
+        yError() << "[configureWrenches] Error while loading the model from " << pathToModel;
+        return false;
+    }
+
+    if(!m_kinDyn.loadRobotModel(loader.model()))
+    {
+        yError() << "[configureWrenches] Error while loading into KinDynComputations object.";
+        return false;
+    }
+
+    std::string leftFootFrame = config.check("left_foot_frame", yarp::os::Value("l_sole")).asString();
+    std::string rightFootFrame = config.check("right_foot_frame", yarp::os::Value("r_sole")).asString();
+    m_frameLeftIndex = m_kinDyn.model().getFrameIndex(leftFootFrame);
+    m_frameRightIndex = m_kinDyn.model().getFrameIndex(rightFootFrame);
+    if(m_frameLeftIndex == iDynTree::FRAME_INVALID_INDEX
+       || m_frameRightIndex == iDynTree::FRAME_INVALID_INDEX)
+    {
+        yError() << "[configureWrenches] Unable to find the frames of the feet.";
+        return false;
+    }
+
+    m_mass = 0.0;
+    for(size_t i = 0; i < m_kinDyn.model().getNrOfLinks(); i++)
+        m_mass += m_kinDyn.model().getLink(i)->getInertia().getMass();
+
+    m_gravityAcceleration = config.check("gravity_acceleration", yarp::os::Value(9.81)).asDouble();
+    m_contactThreshold = config.check("contact_threshold", yarp::os::Value(0.01)).asDouble();
+
+    std::string leftPortName = config.check("left_foot_port_name",
+                                            yarp::os::Value("/wholeBodyDynamics/left_foot/cartesianEndEffectorWrench:o")).asString();
+    std::string rightPortName = config.check("right_foot_port_name",
+                                             yarp::os::Value("/wholeBodyDynamics/right_foot/cartesianEndEffectorWrench:o")).asString();
+    if(!m_leftWrenchPort.open(leftPortName) || !m_rightWrenchPort.open(rightPortName))
+    {
+        yError() << "[configureWrenches] Unable to open the wrench ports.";
+        return false;
+    }
+
+    m_positionsInDegrees.resize(axesList.size(), 0.0);
+    m_positionsInRadians.resize(axesList.size());
+    m_velocities.resize(axesList.size());
+    m_velocities.zero();
+
+    // the world frame is the initial left foot frame
+    m_isLeftStance = true;
+    m_worldToStanceTransform = iDynTree::Transform::Identity();
+
+    yInfo() << "[configureWrenches] The mass of the robot is" << m_mass << "kg.";
+    return true;
+}
+
+bool LoopbackRobotModule::configure(yarp::os::ResourceFinder& rf)
+{
+    setName(rf.check("name", yarp::os::Value("loopback-robot")).asString());
+    m_period = rf.check("period", yarp::os::Value(0.01)).asDouble();
+
+    if(!configureParts(rf))
+    {
+        yError() << "[configure] Unable to configure the parts of the robot.";
+        return false;
+    }
+
+    if(!configureWrenches(rf))
+    {
+        yError() << "[configure] Unable to configure the wrench synthesis.";
+        return false;
+    }
+
+    yInfo() << "[configure] Loopback robot ready.";
+    return true;
+}
+
+double LoopbackRobotModule::getPeriod()
+{
+    return m_period;
+}
+
+void LoopbackRobotModule::sendWrench(const iDynTree::Transform& worldToFootTransform,
+                                     const iDynTree::Vector3& force,
+                                     const iDynTree::Position& centerOfPressure,
+                                     yarp::os::BufferedPort<yarp::sig::Vector>& port)
+{
+    // the wrench is expressed in the foot frame (as the one estimated by wholeBodyDynamics)
+    Eigen::Matrix3d rotation = iDynTree::toEigen(worldToFootTransform.getRotation());
+    Eigen::Vector3d arm = iDynTree::toEigen(centerOfPressure)
+        - iDynTree::toEigen(worldToFootTransform.getPosition());
+    Eigen::Vector3d localForce = rotation.transpose() * iDynTree::toEigen(force);
+    Eigen::Vector3d localTorque = rotation.transpose() * arm.cross(iDynTree::toEigen(force));
+
+    yarp::sig::Vector& wrench = port.prepare();
+    wrench.resize(6);
+    for(int i = 0; i < 3; i++)
+    {
+        wrench(i) = localForce(i);
+        wrench(i + 3) = localTorque(i);
+    }
+    port.write();
+}
+
+bool LoopbackRobotModule::updateModule()
+{
+    size_t offset = 0;
+    for(size_t i = 0; i < m_encodersInterfaces.size(); i++)
+    {
+        if(!m_encodersInterfaces[i]->getEncoders(m_positionsInDegrees.data() + offset))
+        {
+            yError() << "[updateModule] Unable to read the encoders.";
+            return false;
+        }
+        offset += m_partsAxes[i];
+    }
+
+    for(size_t i = 0; i < m_positionsInDegrees.size(); i++)
+        m_positionsInRadians(i) = iDynTree::deg2rad(m_positionsInDegrees[i]);
+
+    iDynTree::Vector3 gravity;
+    gravity.zero();
+    gravity(2) = -m_gravityAcceleration;
+    if(!m_kinDyn.setRobotState(iDynTree::Transform::Identity(), m_positionsInRadians,
+                               iDynTree::Twist::Zero(), m_velocities, gravity))
+    {
+        yError() << "[updateModule] Error while updating the state.";
+        return false;
+    }
+
+    // the stance foot is fixed in the world frame
+    iDynTree::Transform baseToLeft = m_kinDyn.getWorldTransform(m_frameLeftIndex);
+    iDynTree::Transform baseToRight = m_kinDyn.getWorldTransform(m_frameRightIndex);
+    iDynTree::Transform worldToBase = m_worldToStanceTransform
+        * (m_isLeftStance ? baseToLeft : baseToRight).inverse();
+    iDynTree::Transform worldToLeft = worldToBase * baseToLeft;
+    iDynTree::Transform worldToRight = worldToBase * baseToRight;
+    iDynTree::Position com = worldToBase * m_kinDyn.getCenterOfMassPosition();
+
+    // the stance foot changes when the swing foot becomes the lowest one
+    double groundHeight = m_worldToStanceTransform.getPosition()(2);
+    if(m_isLeftStance && worldToRight.getPosition()(2) < groundHeight)
+    {
+        m_isLeftStance = false;
+        m_worldToStanceTransform = worldToRight;
+    }
+    else if(!m_isLeftStance && worldToLeft.getPosition()(2) < groundHeight)
+    {
+        m_isLeftStance = true;
+        m_worldToStanceTransform = worldToLeft;
+    }
+    groundHeight = m_worldToStanceTransform.getPosition()(2);
+
+    // CoM acceleration (finite differences)
+    m_comHistory.push_back(com);
+    m_timeHistory.push_back(yarp::os::Time::now());
+    if(m_comHistory.size() > 3)
+    {
+        m_comHistory.pop_front();
+        m_timeHistory.pop_front();
+    }
+
+    Eigen::Vector3d comAcceleration = Eigen::Vector3d::Zero();
+    if(m_comHistory.size() == 3)
+    {
+        double dt1 = m_timeHistory[1] - m_timeHistory[0];
+        double dt2 = m_timeHistory[2] - m_timeHistory[1];
+        if(dt1 > 0 && dt2 > 0)
+        {
+            Eigen::Vector3d velocity1 = (iDynTree::toEigen(m_comHistory[1])
+                                         - iDynTree::toEigen(m_comHistory[0])) / dt1;
+            Eigen::Vector3d velocity2 = (iDynTree::toEigen(m_comHistory[2])
+                                         - iDynTree::toEigen(m_comHistory[1])) / dt2;
+            comAcceleration = (velocity2 - velocity1) / ((dt1 + dt2) / 2);
+        }
+    }
+
+    // ground reaction force and ZMP of the LIPM
+    double verticalAcceleration = std::max(0.0, m_gravityAcceleration + comAcceleration(2));
+    iDynTree::Vector3 force;
+    force(0) = m_mass * comAcceleration(0);
+    force(1) = m_mass * comAcceleration(1);
+    force(2) = m_mass * verticalAcceleration;
+    if(verticalAcceleration == 0.0)
+        force.zero();
+
+    Eigen::Vector2d zmp = iDynTree::toEigen(com).head<2>();
+    if(verticalAcceleration > 0.0)
+        zmp -= (com(2) - groundHeight) / verticalAcceleration * comAcceleration.head<2>();
+
+    // the force is split between the feet according to the position of the ZMP
+    Eigen::Vector2d leftPosition = iDynTree::toEigen(worldToLeft.getPosition()).head<2>();
+    Eigen::Vector2d rightPosition = iDynTree::toEigen(worldToRight.getPosition()).head<2>();
+    bool isLeftInContact = worldToLeft.getPosition()(2) - groundHeight < m_contactThreshold;
+    bool isRightInContact = worldToRight.getPosition()(2) - groundHeight < m_contactThreshold;
+
+    double rightShare = m_isLeftStance ? 0.0 : 1.0;
+    if(isLeftInContact && isRightInContact)
+    {
+        Eigen::Vector2d feetDistance = rightPosition - leftPosition;
+        if(feetDistance.squaredNorm() > 0)
+            rightShare = std::max(0.0, std::min(1.0, (zmp - leftPosition).dot(feetDistance)
+                                                / feetDistance.squaredNorm()));
+    }
+
+    // the centers of pressure of the feet are shifted so that their weighted mean is the ZMP
+    Eigen::Vector2d offset = zmp - ((1 - rightShare) * leftPosition + rightShare * rightPosition);
+    iDynTree::Position leftCoP = worldToLeft.getPosition();
+    iDynTree::Position rightCoP = worldToRight.getPosition();
+    iDynTree::toEigen(leftCoP).head<2>() += offset;
+    iDynTree::toEigen(rightCoP).head<2>() += offset;
+
+    iDynTree::Vector3 leftForce, rightForce;
+    iDynTree::toEigen(leftForce) = (1 - rightShare) * iDynTree::toEigen(force);
+    iDynTree::toEigen(rightForce) = rightShare * iDynTree::toEigen(force);
+
+    sendWrench(worldToLeft, leftForce, leftCoP, m_leftWrenchPort);
+    sendWrench(worldToRight, rightForce, rightCoP, m_rightWrenchPort);
+
+    return true;
+}
+
+bool LoopbackRobotModule::close()
+{
+    m_leftWrenchPort.close();
+    m_rightWrenchPort.close();
+
+    // the wrappers have to be closed before the boards
+    for(auto& wrapper : m_wrappers)
+        wrapper->close();
+    for(auto& board : m_boards)
+        board->close();
+
+    m_wrappers.clear();
+    m_boards.clear();
+    m_encodersInterfaces.clear();
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/RFModule.h>
+#include <yarp/dev/Drivers.h>
+
+#include "LoopbackControlBoard.hpp"
+#include "LoopbackRobotModule.hpp"
+
+int main(int argc, char * argv[])
+{
+    // initialise yarp network
+    yarp::os::Network yarp;
+    if (!yarp.checkNetwork())
+    {
+        yError()<<"[main] Unable to find YARP network";
+        return EXIT_FAILURE;
+    }
+
+    // the loopback control board is available only in this process
+    yarp::dev::Drivers::factory().add(new yarp::dev::DriverCreatorOf<LoopbackControlBoard>
+                                      ("walkingLoopbackControlBoard", "controlboardwrapper2",
+                                       "LoopbackControlBoard"));
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder& rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+
+    rf.setDefaultConfigFile("loopbackRobot.ini");
+    rf.setDefaultContext("dcmWalkingLoopbackRobot");
+
+    rf.configure(argc, argv);
+
+    LoopbackRobotModule module;
+    int result = module.runModule(rf);
+
+    // the devices are closed also if the module cannot be configured
+    module.close();
+    return result;
+}
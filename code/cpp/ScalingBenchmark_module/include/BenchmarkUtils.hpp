@@ -0,0 +1,117 @@
+/**
+ * @file BenchmarkUtils.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef BENCHMARK_UTILS_HPP
+#define BENCHMARK_UTILS_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+
+// iDynTree
+#include <iDynTree/Core/VectorFixSize.h>
+#include <iDynTree/Core/Transform.h>
+#include <iDynTree/Core/Twist.h>
+
+#include "TrajectoryGenerator.hpp"
+
+/**
+ * Walking trajectory followed by the stages of the controller during the benchmarks.
+ */
+struct ReferenceTrajectory
+{
+    std::vector<iDynTree::Transform> leftTrajectory; /**< Left foot trajectory. */
+    std::vector<iDynTree::Transform> rightTrajectory; /**< Right foot trajectory. */
+    std::vector<iDynTree::Twist> leftTwistTrajectory; /**< Left foot twist. */
+    std::vector<iDynTree::Twist> rightTwistTrajectory; /**< Right foot twist. */
+    std::vector<bool> leftInContact; /**< Left foot contact. */
+    std::vector<bool> rightInContact; /**< Right foot contact. */
+    std::vector<bool> isLeftFixedFrame; /**< True if the left foot is the fixed frame. */
+    std::vector<iDynTree::Vector2> DCMPositionDesired; /**< DCM position. */
+    std::vector<iDynTree::Vector2> DCMVelocityDesired; /**< DCM velocity. */
+    std::vector<double> comHeightTrajectory; /**< CoM height. */
+    std::vector<double> comHeightVelocity; /**< CoM height velocity. */
+};
+
+namespace BenchmarkHelper
+{
+    /**
+     * Load the configuration of the walking module (controller_config key of the benchmark).
+     * @param rf resource finder of the benchmark;
+     * @param config configuration of the walking module.
+     * @return true/false in case of success/failure.
+     */
+    bool loadControllerConfig(yarp::os::ResourceFinder& rf, yarp::os::Property& config);
+
+    /**
+     * Get a group of the walking configuration merged with the GENERAL group.
+     * @param config configuration of the walking module;
+     * @param groupName name of the group;
+     * @param options options of the group.
+     * @return true/false in case of success/failure.
+     */
+    bool getOptions(yarp::os::Property& config, const std::string& groupName, yarp::os::Property& options);
+
+    /**
+     * Ask the planner for a new trajectory starting from the first merge point of the
+     * current one. The function does not wait for the trajectory.
+     * @param generator trajectory generator (a trajectory has to be already computed);
+     * @param dT sampling time of the planner [s];
+     * @param goal goal expressed in the unicycle frame;
+     * @param initTime initial time of the current trajectory, it is updated with the
+     * initial time of the new one [s].
+     * @return true/false in case of success/failure.
+     */
+    bool askWalkingTrajectory(TrajectoryGenerator& generator, const double& dT,
+                              const iDynTree::Vector2& goal, double& initTime);
+
+    /**
+     * Compute a new trajectory starting from the first merge point of the current one.
+     * @param generator trajectory generator (a trajectory has to be already computed);
+     * @param dT sampling time of the planner [s];
+     * @param goal goal expressed in the unicycle frame;
+     * @param initTime initial time of the current trajectory, it is updated with the
+     * initial time of the new one [s];
+     * @param planningDuration duration of the planning [s].
+     * @return true/false in case of success/failure.
+     */
+    bool planWalkingTrajectory(TrajectoryGenerator& generator, const double& dT,
+                               const iDynTree::Vector2& goal, double& initTime,
+                               double& planningDuration);
+
+    /**
+     * Compute a walking trajectory: the planner computes the standing trajectory and
+     * then a trajectory toward the goal.
+     * @param plannerOptions options of the planner;
+     * @param goal goal expressed in the unicycle frame;
+     * @param trajectory computed trajectory.
+     * @return true/false in case of success/failure.
+     */
+    bool computeReferenceTrajectory(const yarp::os::Searchable& plannerOptions,
+                                    const iDynTree::Vector2& goal, ReferenceTrajectory& trajectory);
+
+    /**
+     * Resident memory of the process.
+     * @return resident memory [B].
+     */
+    long residentMemory();
+
+    /**
+     * Percentile of a set of sorted samples.
+     * @param sortedSamples samples sorted in ascending order;
+     * @param percentile percentile (between 0 and 1).
+     * @return the percentile (0 if there are no samples).
+     */
+    double percentile(const std::vector<double>& sortedSamples, const double& percentile);
+}
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file CoRunner.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef CO_RUNNER_HPP
+#define CO_RUNNER_HPP
+
+// std
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+/**
+ * Resource loaded by a co-runner.
+ */
+enum class CoRunnerType {CPU, Memory, Cache, IO};
+
+/**
+ * CoRunner class is a thread that loads a resource shared with the control thread, as the
+ * processes that run on the robot PC (perception, logger, YARP servers):
+ * - cpu: floating point operations (it competes for the core);
+ * - memory: copies between two buffers larger than the last level cache (memory bandwidth);
+ * - cache: random reads in a buffer as large as the last level cache (it evicts the lines
+ *   of the control thread);
+ * - io: blocks written on a file and synchronized with the disk.
+ */
+class CoRunner
+{
+    CoRunnerType m_type{CoRunnerType::CPU}; /**< Loaded resource. */
+    int m_cpu{-1}; /**< CPU of the thread (-1 to use all the CPUs). */
+
+    std::vector<char> m_buffer; /**< Buffer of the memory co-runner. */
+    std::vector<size_t> m_chain; /**< Random cycle visited by the cache co-runner. */
+    std::string m_fileName; /**< File written by the I/O co-runner. */
+    std::vector<char> m_block; /**< Block written by the I/O co-runner. */
+    size_t m_fileSize{0}; /**< Size of the file [B]. */
+
+    std::thread m_thread; /**< Co-runner thread. */
+    std::atomic<bool> m_isRunning{false}; /**< True if the thread is running. */
+    std::atomic<unsigned long> m_iterations{0}; /**< Number of iterations of the load. */
+
+    /**
+     * Main loop of the CPU co-runner.
+     */
+    void loadCPU();
+
+    /**
+     * Main loop of the memory co-runner.
+     */
+    void loadMemory();
+
+    /**
+     * Main loop of the cache co-runner.
+     */
+    void loadCache();
+
+    /**
+     * Main loop of the I/O co-runner.
+     */
+    void loadIO();
+
+public:
+
+    /**
+     * Destructor. The thread is stopped.
+     */
+    ~CoRunner();
+
+    /**
+     * Configure the co-runner and allocate its buffers.
+     * @param type type of the co-runner (cpu, memory, cache or io);
+     * @param config options of the co-runners (memory_buffer_size, cache_buffer_size,
+     * io_file, io_block_size and io_file_size);
+     * @param cpu CPU of the thread (-1 to use all the CPUs);
+     * @param index index of the co-runner (used to name the file of the I/O co-runners).
+     * @return true/false in case of success/failure.
+     */
+    bool configure(const std::string& type, const yarp::os::Searchable& config,
+                   const int& cpu, const int& index);
+
+    /**
+     * Start the thread.
+     * @return true/false in case of success/failure.
+     */
+    bool start();
+
+    /**
+     * Stop the thread.
+     */
+    void stop();
+
+    /**
+     * Get the number of iterations of the load since the thread was started.
+     * @return number of iterations.
+     */
+    unsigned long getIterations() const;
+};
+
+#endif
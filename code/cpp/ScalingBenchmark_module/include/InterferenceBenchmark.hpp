@@ -0,0 +1,150 @@
+/**
+ * @file InterferenceBenchmark.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef INTERFERENCE_BENCHMARK_HPP
+#define INTERFERENCE_BENCHMARK_HPP
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+
+// iDynTree
+#include <iDynTree/Core/VectorDynSize.h>
+#include <iDynTree/Core/VectorFixSize.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include "BenchmarkUtils.hpp"
+#include "RealTimeSettings.hpp"
+#include "TrajectoryGenerator.hpp"
+#include "WalkingController.hpp"
+#include "WalkingForwardKinematics.hpp"
+#include "WalkingQPInverseKinematics_osqp.hpp"
+#include "WalkingQPInverseKinematics_qpOASES.hpp"
+
+/**
+ * Latency of a stage measured in a scenario.
+ */
+struct InterferenceResult
+{
+    std::string scheduling; /**< Scheduling of the control thread (default or realtime). */
+    std::string scenario; /**< Name of the scenario. */
+    std::string stage; /**< Name of the stage (wakeup, planner, mpc, fk, ik or total). */
+
+    int samples{0}; /**< Number of samples. */
+    double median{0.0}; /**< Median latency [s]. */
+    double p99{0.0}; /**< 99th percentile of the latency [s]. */
+    double p999{0.0}; /**< 99.9th percentile of the latency [s]. */
+    double max{0.0}; /**< Maximum latency [s]. */
+    double p99Degradation{0.0}; /**< Ratio between the 99th percentile and the one of the baseline scenario. */
+    int overruns{0}; /**< Number of ticks longer than the period (total stage only). */
+};
+
+/**
+ * Set of co-runners that load the machine together with the controller.
+ */
+struct InterferenceScenario
+{
+    std::string name; /**< Name of the scenario. */
+    std::vector<std::string> coRunners; /**< Types of the co-runners. */
+};
+
+/**
+ * InterferenceBenchmark class runs the control pipeline of the walking module (planner, MPC,
+ * FK and QP-IK) at the controller period while co-runner threads load the CPU, the memory
+ * bandwidth, the cache and the disk. Each scenario is run with the default scheduler and,
+ * optionally, with the real-time settings of the control thread, and the tail latency of each
+ * stage is compared with the one of the baseline scenario (without co-runners).
+ * The pipeline follows a walking trajectory computed by the planner, so no robot is needed.
+ */
+class InterferenceBenchmark
+{
+    yarp::os::Property m_controllerConfig; /**< Configuration of the walking module. */
+    std::string m_modelName; /**< Name of the URDF model. */
+    std::vector<std::string> m_joints; /**< Controlled joints. */
+    bool m_useOSQP; /**< True if the QP-IK is solved with osqp. */
+    double m_jointVelocityLimit; /**< Velocity limit of all the joints [deg/s]. */
+
+    double m_dT; /**< Period of the controller [s]. */
+    iDynTree::Vector2 m_goal; /**< Goal of the planner (expressed in the unicycle frame). */
+    int m_replanningTicks; /**< Number of ticks between two planner calls. */
+    int m_numberOfTicks; /**< Number of measured ticks of each scenario. */
+    int m_warmupTicks; /**< Number of ticks before the measure. */
+
+    std::vector<InterferenceScenario> m_scenarios; /**< Scenarios. */
+    std::string m_baselineScenario; /**< Name of the scenario used as reference. */
+    yarp::os::Property m_coRunnersOptions; /**< Options of the co-runners. */
+    std::vector<int> m_coRunnersCPUs; /**< CPUs assigned (round robin) to the co-runners. */
+    RealTimeSettings m_realTimeSettings; /**< Real-time settings of the control thread. */
+    bool m_compareRealTime; /**< True if the scenarios are run also with the real-time settings. */
+    std::string m_outputPrefix; /**< Prefix of the files where the results are saved. */
+
+    ReferenceTrajectory m_reference; /**< Trajectory followed by the pipeline. */
+    iDynTree::ModelLoader m_loader; /**< Model loader. */
+    std::unique_ptr<WalkingThreadPool> m_threadPool; /**< Pool that runs the planner. */
+    std::unique_ptr<TrajectoryGenerator> m_trajectoryGenerator; /**< Trajectory planner. */
+    std::unique_ptr<WalkingController> m_walkingController; /**< MPC controller. */
+    std::unique_ptr<WalkingFK> m_FKSolver; /**< FK solver. */
+    std::unique_ptr<WalkingQPIK_osqp> m_QPIKSolver_osqp; /**< QP-IK solver (osqp). */
+    std::unique_ptr<WalkingQPIK_qpOASES> m_QPIKSolver_qpOASES; /**< QP-IK solver (qpOASES). */
+    iDynTree::VectorDynSize m_initialJointPosition; /**< Posture at the beginning of a scenario [rad]. */
+    double m_trajectoryInitTime; /**< Initial time of the last trajectory of the planner [s]. */
+
+    std::vector<InterferenceResult> m_results; /**< Results. */
+
+    /**
+     * Initialize the stages of the pipeline.
+     * @return true/false in case of success/failure.
+     */
+    bool configurePipeline();
+
+    /**
+     * Run the pipeline at the controller period. The function is executed by the control thread.
+     * @param ticks number of ticks;
+     * @param durations latency of each stage (wakeup, planner, mpc, fk, ik and total) [s];
+     * @param overruns number of ticks longer than the period.
+     * @return true/false in case of success/failure.
+     */
+    bool runPipeline(const int& ticks, std::vector<std::vector<double>>& durations, int& overruns);
+
+    /**
+     * Run a scenario.
+     * @param scenario scenario;
+     * @param useRealTimeSettings true if the control thread uses the real-time settings.
+     * @return true/false in case of success/failure.
+     */
+    bool runScenario(const InterferenceScenario& scenario, const bool& useRealTimeSettings);
+
+    /**
+     * Save the results in a CSV and in a JSON file.
+     * @return true/false in case of success/failure.
+     */
+    bool writeResults();
+
+public:
+
+    /**
+     * Configure the benchmark.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configure(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Run all the scenarios.
+     * @return true/false in case of success/failure.
+     */
+    bool run();
+};
+
+#endif
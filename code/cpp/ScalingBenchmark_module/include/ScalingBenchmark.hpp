@@ -0,0 +1,136 @@
+/**
+ * @file ScalingBenchmark.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef SCALING_BENCHMARK_HPP
+#define SCALING_BENCHMARK_HPP
+
+// std
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+
+// iDynTree
+#include <iDynTree/Core/VectorDynSize.h>
+#include <iDynTree/Core/VectorFixSize.h>
+
+#include "BenchmarkUtils.hpp"
+
+/**
+ * Durations and memory of a stage measured with a given configuration.
+ */
+struct ScalingResult
+{
+    std::string stage; /**< Name of the stage (planner, mpc, fk, qp_ik_osqp, qp_ik_qpoases). */
+    std::string dofConfiguration; /**< Name of the DoF configuration. */
+    int dofs{0}; /**< Number of controlled joints. */
+    double controllerHorizon{0.0}; /**< Horizon of the MPC controller [s]. */
+    double plannerHorizon{0.0}; /**< Horizon of the trajectory planner [s]. */
+
+    int samples{0}; /**< Number of measured calls. */
+    int failures{0}; /**< Number of failed calls. */
+    double initDuration{0.0}; /**< Duration of the initialization [s]. */
+    double median{0.0}; /**< Median duration of a call [s]. */
+    double p99{0.0}; /**< 99th percentile of the duration of a call [s]. */
+    double max{0.0}; /**< Maximum duration of a call [s]. */
+    long memory{0}; /**< Resident memory allocated by the initialization and by the first call [B]. */
+};
+
+/**
+ * Set of joints controlled by the kinematics stages.
+ */
+struct DoFConfiguration
+{
+    std::string name; /**< Name of the configuration. */
+    std::vector<std::string> joints; /**< Controlled joints. */
+};
+
+/**
+ * ScalingBenchmark class measures how the stages of the controller scale with the horizon of
+ * the MPC controller, the horizon of the trajectory planner and the number of controlled joints.
+ * Each parameter is swept on the stages that depend on it (the MPC with the controller horizon,
+ * the planner with the planner horizon, the FK and the QP-IK with the joints), while the others
+ * keep the value of the walking configuration. The stages are fed with a walking trajectory
+ * computed by the planner, so no robot (nor simulator) is needed.
+ */
+class ScalingBenchmark
+{
+    yarp::os::Property m_controllerConfig; /**< Configuration of the walking module. */
+    std::string m_modelName; /**< Name of the URDF model. */
+
+    std::vector<double> m_controllerHorizons; /**< Horizons of the MPC controller under test [s]. */
+    std::vector<double> m_plannerHorizons; /**< Horizons of the planner under test [s]. */
+    std::vector<DoFConfiguration> m_dofConfigurations; /**< Sets of joints under test. */
+
+    std::vector<std::string> m_defaultJoints; /**< Joints controlled by the walking module. */
+    iDynTree::VectorDynSize m_defaultRegularization; /**< Joint regularization of the walking module [deg]. */
+    iDynTree::VectorDynSize m_defaultRegularizationWeights; /**< Joint regularization weights. */
+    iDynTree::VectorDynSize m_defaultRegularizationGains; /**< Joint regularization gains. */
+    double m_additionalJointRegularization; /**< Regularization of the joints not controlled by the module [deg]. */
+    double m_additionalJointWeight; /**< Regularization weight of the joints not controlled by the module. */
+    double m_additionalJointGain; /**< Regularization gain of the joints not controlled by the module. */
+    double m_jointVelocityLimit; /**< Velocity limit of all the joints [deg/s]. */
+
+    double m_dT; /**< Sampling time of the controller [s]. */
+    double m_defaultControllerHorizon; /**< Horizon of the MPC controller of the walking module [s]. */
+    double m_defaultPlannerHorizon; /**< Horizon of the planner of the walking module [s]. */
+    iDynTree::Vector2 m_goal; /**< Goal of the planner (expressed in the unicycle frame). */
+    int m_numberOfTicks; /**< Number of ticks of the MPC and of the kinematics stages. */
+    int m_plannerSamples; /**< Number of trajectories computed by the planner. */
+    std::string m_outputPrefix; /**< Prefix of the files where the results are saved. */
+
+    ReferenceTrajectory m_reference; /**< Trajectory followed by the MPC and by the kinematics stages. */
+
+    std::vector<ScalingResult> m_results; /**< Results. */
+
+    /**
+     * Measure the planner.
+     * @param plannerHorizon horizon of the planner [s].
+     * @return true/false in case of success/failure.
+     */
+    bool benchmarkPlanner(const double& plannerHorizon);
+
+    /**
+     * Measure the MPC controller.
+     * @param controllerHorizon horizon of the controller [s].
+     * @return true/false in case of success/failure.
+     */
+    bool benchmarkController(const double& controllerHorizon);
+
+    /**
+     * Measure the FK and the QP-IK (osqp and qpOASES) solvers.
+     * @param configuration controlled joints.
+     * @return true/false in case of success/failure.
+     */
+    bool benchmarkKinematics(const DoFConfiguration& configuration);
+
+    /**
+     * Save the results in a CSV and in a JSON file.
+     * @return true/false in case of success/failure.
+     */
+    bool writeResults();
+
+public:
+
+    /**
+     * Configure the benchmark.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configure(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Measure all the stages with all the configurations.
+     * @return true/false in case of success/failure.
+     */
+    bool run();
+};
+
+#endif
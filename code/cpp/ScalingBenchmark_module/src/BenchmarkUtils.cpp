@@ -0,0 +1,163 @@
+/**
+ * @file BenchmarkUtils.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <fstream>
+#include <unistd.h>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+
+#include "BenchmarkUtils.hpp"
+
+bool BenchmarkHelper::loadControllerConfig(yarp::os::ResourceFinder& rf, yarp::os::Property& config)
+{
+    std::string controllerConfig = rf.check("controller_config",
+                                            yarp::os::Value("dcmWalkingCoordinator.ini")).asString();
+    std::string pathToConfig = rf.findFileByName(controllerConfig);
+    if(pathToConfig.empty() || !config.fromConfigFile(pathToConfig))
+    {
+        yError() << "[loadControllerConfig] Unable to load the configuration of the controller "
+                 << controllerConfig;
+        return false;
+    }
+    return true;
+}
+
+bool BenchmarkHelper::getOptions(yarp::os::Property& config, const std::string& groupName,
+                                 yarp::os::Property& options)
+{
+    yarp::os::Bottle& group = config.findGroup(groupName);
+    if(group.isNull())
+    {
+        yError() << "[getOptions] Unable to find the group " << groupName;
+        return false;
+    }
+
+    // the first element is the name of the group
+    options.fromString(group.tail().toString());
+    options.fromString(config.findGroup("GENERAL").tail().toString(), false);
+    return true;
+}
+
+bool BenchmarkHelper::askWalkingTrajectory(TrajectoryGenerator& generator, const double& dT,
+                                           const iDynTree::Vector2& goal, double& initTime)
+{
+    std::vector<size_t> mergePoints;
+    std::vector<iDynTree::Vector2> DCMPosition, DCMVelocity;
+    std::vector<iDynTree::Transform> leftTrajectory, rightTrajectory;
+    std::vector<bool> isLeftFixedFrame;
+    if(!generator.getMergePoints(mergePoints) || !generator.getDCMPositionTrajectory(DCMPosition)
+       || !generator.getDCMVelocityTrajectory(DCMVelocity)
+       || !generator.getFeetTrajectories(leftTrajectory, rightTrajectory)
+       || !generator.getWhenUseLeftAsFixed(isLeftFixedFrame))
+    {
+        yError() << "[askWalkingTrajectory] Unable to get the current trajectory.";
+        return false;
+    }
+
+    // the new trajectory is merged as in the walking module
+    auto mergePoint = std::find_if(mergePoints.begin(), mergePoints.end(),
+                                   [&](const size_t& point){return point > 0 && point < DCMPosition.size();});
+    if(mergePoint == mergePoints.end())
+    {
+        yError() << "[askWalkingTrajectory] The current trajectory has no merge points.";
+        return false;
+    }
+
+    iDynTree::Transform measuredTransform = isLeftFixedFrame.front() ?
+        rightTrajectory[*mergePoint] : leftTrajectory[*mergePoint];
+
+    initTime += *mergePoint * dT;
+    if(!generator.updateTrajectories(initTime, DCMPosition[*mergePoint], DCMVelocity[*mergePoint],
+                                     !isLeftFixedFrame.front(), measuredTransform, goal))
+    {
+        yError() << "[askWalkingTrajectory] Unable to ask for a new trajectory.";
+        return false;
+    }
+
+    return true;
+}
+
+bool BenchmarkHelper::planWalkingTrajectory(TrajectoryGenerator& generator, const double& dT,
+                                            const iDynTree::Vector2& goal, double& initTime,
+                                            double& planningDuration)
+{
+    if(!askWalkingTrajectory(generator, dT, goal, initTime))
+        return false;
+
+    while(generator.isTrajectoryAsked())
+        yarp::os::Time::delay(0.0005);
+
+    if(!generator.getPlanningDuration(planningDuration))
+    {
+        yError() << "[planWalkingTrajectory] The planner failed.";
+        return false;
+    }
+
+    return true;
+}
+
+bool BenchmarkHelper::computeReferenceTrajectory(const yarp::os::Searchable& plannerOptions,
+                                                 const iDynTree::Vector2& goal,
+                                                 ReferenceTrajectory& trajectory)
+{
+    double dT = plannerOptions.check("sampling_time", yarp::os::Value(0.016)).asDouble();
+
+    // the pool has to outlive the generator
+    WalkingThreadPool threadPool;
+    TrajectoryGenerator generator;
+    double initTime = 0.0;
+    double planningDuration;
+    if(!threadPool.initialize(yarp::os::Property()) || !generator.initialize(plannerOptions, threadPool)
+       || !generator.generateFirstTrajectories()
+       || !planWalkingTrajectory(generator, dT, goal, initTime, planningDuration))
+    {
+        yError() << "[computeReferenceTrajectory] Unable to compute the reference trajectory.";
+        return false;
+    }
+
+    if(!generator.getFeetTrajectories(trajectory.leftTrajectory, trajectory.rightTrajectory)
+       || !generator.getFeetTwist(trajectory.leftTwistTrajectory, trajectory.rightTwistTrajectory)
+       || !generator.getFeetStandingPeriods(trajectory.leftInContact, trajectory.rightInContact)
+       || !generator.getWhenUseLeftAsFixed(trajectory.isLeftFixedFrame)
+       || !generator.getDCMPositionTrajectory(trajectory.DCMPositionDesired)
+       || !generator.getDCMVelocityTrajectory(trajectory.DCMVelocityDesired)
+       || !generator.getCoMHeightTrajectory(trajectory.comHeightTrajectory)
+       || !generator.getCoMHeightVelocity(trajectory.comHeightVelocity))
+    {
+        yError() << "[computeReferenceTrajectory] Unable to get the reference trajectory.";
+        return false;
+    }
+
+    yInfo() << "[computeReferenceTrajectory] The reference trajectory has "
+            << trajectory.DCMPositionDesired.size() << " samples.";
+    return true;
+}
+
+long BenchmarkHelper::residentMemory()
+{
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+double BenchmarkHelper::percentile(const std::vector<double>& sortedSamples, const double& percentile)
+{
+    if(sortedSamples.empty())
+        return 0.0;
+
+    size_t index = static_cast<size_t>(percentile * sortedSamples.size());
+    return sortedSamples[std::min(sortedSamples.size() - 1, index)];
+}
@@ -0,0 +1,234 @@
+/**
+ * @file CoRunner.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <numeric>
+#include <pthread.h>
+#include <random>
+#include <sched.h>
+#include <unistd.h>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "CoRunner.hpp"
+
+namespace
+{
+    /**
+     * Size of a cache line [B].
+     */
+    const size_t cacheLineSize = 64;
+
+    /**
+     * Number of operations of an iteration of the CPU and of the cache co-runners.
+     */
+    const int operationsPerIteration = 100000;
+}
+
+CoRunner::~CoRunner()
+{
+    stop();
+}
+
+bool CoRunner::configure(const std::string& type, const yarp::os::Searchable& config,
+                         const int& cpu, const int& index)
+{
+    m_cpu = cpu;
+
+    if(type == "cpu")
+        m_type = CoRunnerType::CPU;
+    else if(type == "memory")
+    {
+        m_type = CoRunnerType::Memory;
+
+        // the buffer has to be much larger than the last level cache
+        double size = config.check("memory_buffer_size", yarp::os::Value(256.0)).asDouble();
+        m_buffer.assign(static_cast<size_t>(size * 1024 * 1024), 1);
+    }
+    else if(type == "cache")
+    {
+        m_type = CoRunnerType::Cache;
+
+        // each element is on a different cache line. The elements form a single random cycle
+        // (Sattolo's algorithm), so the prefetcher cannot anticipate the next read
+        double size = config.check("cache_buffer_size", yarp::os::Value(8.0)).asDouble();
+        size_t lines = std::max<size_t>(2, static_cast<size_t>(size * 1024 * 1024) / cacheLineSize);
+        size_t stride = cacheLineSize / sizeof(size_t);
+        std::vector<size_t> order(lines);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 generator(index);
+        for(size_t i = lines - 1; i > 0; i--)
+        {
+            std::uniform_int_distribution<size_t> distribution(0, i - 1);
+            std::swap(order[i], order[distribution(generator)]);
+        }
+
+        m_chain.assign(lines * stride, 0);
+        for(size_t i = 0; i < lines; i++)
+            m_chain[order[i] * stride] = order[(i + 1) % lines] * stride;
+    }
+    else if(type == "io")
+    {
+        m_type = CoRunnerType::IO;
+
+        m_fileName = config.check("io_file", yarp::os::Value("interferenceBenchmark")).asString()
+            + "_" + std::to_string(index) + ".tmp";
+        double blockSize = config.check("io_block_size", yarp::os::Value(1024.0)).asDouble();
+        double fileSize = config.check("io_file_size", yarp::os::Value(64.0)).asDouble();
+        m_block.assign(static_cast<size_t>(blockSize * 1024), 1);
+        m_fileSize = static_cast<size_t>(fileSize * 1024 * 1024);
+        if(m_block.empty() || m_fileSize < m_block.size())
+        {
+            yError() << "[configure] The I/O file has to be larger than a block.";
+            return false;
+        }
+    }
+    else
+    {
+        yError() << "[configure] Unknown co-runner " << type << ". The available co-runners are "
+                 << "cpu, memory, cache and io.";
+        return false;
+    }
+
+    return true;
+}
+
+bool CoRunner::start()
+{
+    stop();
+
+    m_iterations = 0;
+    m_isRunning = true;
+    switch(m_type)
+    {
+    case CoRunnerType::CPU:
+        m_thread = std::thread(&CoRunner::loadCPU, this);
+        break;
+    case CoRunnerType::Memory:
+        m_thread = std::thread(&CoRunner::loadMemory, this);
+        break;
+    case CoRunnerType::Cache:
+        m_thread = std::thread(&CoRunner::loadCache, this);
+        break;
+    case CoRunnerType::IO:
+        m_thread = std::thread(&CoRunner::loadIO, this);
+        break;
+    }
+
+    if(m_cpu >= 0)
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(m_cpu, &cpuSet);
+        int error = pthread_setaffinity_np(m_thread.native_handle(), sizeof(cpuSet), &cpuSet);
+        if(error != 0)
+        {
+            yError() << "[start] Unable to set the CPU of the co-runner: " << std::strerror(error);
+            stop();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CoRunner::stop()
+{
+    m_isRunning = false;
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+        m_thread = std::thread();
+    }
+
+    if(m_type == CoRunnerType::IO && !m_fileName.empty())
+        unlink(m_fileName.c_str());
+}
+
+unsigned long CoRunner::getIterations() const
+{
+    return m_iterations;
+}
+
+void CoRunner::loadCPU()
+{
+    volatile double sink = 0.0;
+    double value = 1.0;
+    while(m_isRunning)
+    {
+        for(int i = 0; i < operationsPerIteration; i++)
+            value = std::sqrt(value + i) * 1.0001;
+
+        sink = value;
+        m_iterations++;
+    }
+}
+
+void CoRunner::loadMemory()
+{
+    size_t half = m_buffer.size() / 2;
+    while(m_isRunning)
+    {
+        std::memcpy(m_buffer.data() + half, m_buffer.data(), half);
+        std::memcpy(m_buffer.data(), m_buffer.data() + half, half);
+        m_iterations++;
+    }
+}
+
+void CoRunner::loadCache()
+{
+    volatile size_t sink = 0;
+    size_t index = 0;
+    while(m_isRunning)
+    {
+        for(int i = 0; i < operationsPerIteration; i++)
+            index = m_chain[index];
+
+        sink = index;
+        m_iterations++;
+    }
+}
+
+void CoRunner::loadIO()
+{
+    int file = open(m_fileName.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if(file < 0)
+    {
+        yError() << "[loadIO] Unable to open the file " << m_fileName << ": " << std::strerror(errno);
+        return;
+    }
+
+    // the file is written block by block and synchronized with the disk, then it is rewritten
+    size_t written = 0;
+    while(m_isRunning)
+    {
+        if(write(file, m_block.data(), m_block.size()) < 0)
+        {
+            yError() << "[loadIO] Unable to write the file " << m_fileName << ": " << std::strerror(errno);
+            break;
+        }
+        fdatasync(file);
+        m_iterations++;
+
+        written += m_block.size();
+        if(written + m_block.size() > m_fileSize)
+        {
+            lseek(file, 0, SEEK_SET);
+            written = 0;
+        }
+    }
+
+    close(file);
+}
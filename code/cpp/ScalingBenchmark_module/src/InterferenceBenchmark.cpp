@@ -0,0 +1,571 @@
+/**
+ * @file InterferenceBenchmark.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/MatrixDynSize.h>
+#include <iDynTree/Core/Utils.h>
+
+#include "InterferenceBenchmark.hpp"
+#include "CoRunner.hpp"
+#include "Utils.hpp"
+
+namespace
+{
+    /**
+     * Stages of the pipeline. The wakeup stage is the delay between the deadline of the tick
+     * and the instant when the control thread wakes up.
+     */
+    enum Stage {Wakeup = 0, Planner, MPC, FK, IK, Total, NumberOfStages};
+
+    const std::vector<std::string> stageNames{"wakeup", "planner", "mpc", "fk", "ik", "total"};
+
+    /**
+     * Duration in seconds.
+     */
+    double toSeconds(const std::chrono::steady_clock::duration& duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+bool InterferenceBenchmark::configure(yarp::os::ResourceFinder& rf)
+{
+    // the pipeline is configured as the walking module
+    if(!BenchmarkHelper::loadControllerConfig(rf, m_controllerConfig))
+    {
+        yError() << "[configure] Unable to load the configuration of the controller.";
+        return false;
+    }
+
+    m_modelName = rf.check("model", m_controllerConfig.check("model", yarp::os::Value("model.urdf"))).asString();
+
+    yarp::os::Value* axesListYarp;
+    if(!m_controllerConfig.check("joints_list", axesListYarp)
+       || !YarpHelper::yarpListToStringVector(axesListYarp, m_joints))
+    {
+        yError() << "[configure] Unable to read the joints_list of the controller.";
+        return false;
+    }
+
+    m_useOSQP = m_controllerConfig.check("use_osqp", yarp::os::Value(false)).asBool();
+    m_jointVelocityLimit = rf.check("joint_velocity_limit", yarp::os::Value(100.0)).asDouble();
+    m_dT = m_controllerConfig.findGroup("GENERAL").check("sampling_time", yarp::os::Value(0.016)).asDouble();
+
+    yarp::os::Value goal = rf.find("goal");
+    m_goal(0) = goal.isList() && goal.asList()->size() == 2 ? goal.asList()->get(0).asDouble() : 1.0;
+    m_goal(1) = goal.isList() && goal.asList()->size() == 2 ? goal.asList()->get(1).asDouble() : 0.0;
+
+    double replanningPeriod = rf.check("replanning_period", yarp::os::Value(1.0)).asDouble();
+    m_replanningTicks = std::max(1, static_cast<int>(std::round(replanningPeriod / m_dT)));
+    m_numberOfTicks = rf.check("ticks", yarp::os::Value(5000)).asInt();
+    m_warmupTicks = rf.check("warmup_ticks", yarp::os::Value(200)).asInt();
+    if(m_numberOfTicks <= 0 || m_warmupTicks < 0 || m_jointVelocityLimit <= 0)
+    {
+        yError() << "[configure] ticks and joint_velocity_limit have to be positive, "
+                 << "warmup_ticks cannot be negative.";
+        return false;
+    }
+
+    // scenarios
+    yarp::os::Value scenarios = rf.find("scenarios");
+    for(int i = 0; scenarios.isList() && i < scenarios.asList()->size(); i++)
+    {
+        InterferenceScenario scenario;
+        scenario.name = scenarios.asList()->get(i).asString();
+
+        yarp::os::Bottle& scenarioOptions = rf.findGroup(scenario.name);
+        yarp::os::Value coRunners = scenarioOptions.find("co_runners");
+        if(scenarioOptions.isNull() || !coRunners.isList())
+        {
+            yError() << "[configure] Unable to read the co_runners of the scenario " << scenario.name;
+            return false;
+        }
+
+        for(int j = 0; j < coRunners.asList()->size(); j++)
+            scenario.coRunners.push_back(coRunners.asList()->get(j).asString());
+
+        m_scenarios.push_back(scenario);
+    }
+
+    if(m_scenarios.empty())
+    {
+        yError() << "[configure] The list of the scenarios cannot be empty.";
+        return false;
+    }
+
+    m_baselineScenario = rf.check("baseline_scenario", yarp::os::Value(m_scenarios.front().name)).asString();
+
+    // co-runners
+    yarp::os::Bottle& coRunnersOptions = rf.findGroup("CO_RUNNERS");
+    m_coRunnersOptions.fromString(coRunnersOptions.tail().toString());
+    yarp::os::Value cpus = coRunnersOptions.find("cpus");
+    for(int i = 0; cpus.isList() && i < cpus.asList()->size(); i++)
+        m_coRunnersCPUs.push_back(cpus.asList()->get(i).asInt());
+
+    // real-time settings of the control thread
+    m_compareRealTime = rf.check("compare_realtime", yarp::os::Value(true)).asBool();
+    if(!m_realTimeSettings.initialize(rf.findGroup("REALTIME")))
+    {
+        yError() << "[configure] Unable to read the real-time settings.";
+        return false;
+    }
+
+    if(m_compareRealTime && !m_realTimeSettings.isEnabled())
+    {
+        yWarning() << "[configure] The REALTIME group does not change the default settings, "
+                   << "the scenarios are run only with the default scheduler.";
+        m_compareRealTime = false;
+    }
+
+    m_outputPrefix = rf.check("output_prefix", yarp::os::Value("interferenceBenchmark")).asString();
+
+    yarp::os::Property plannerOptions;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "TRAJECTORY_PLANNER", plannerOptions)
+       || !BenchmarkHelper::computeReferenceTrajectory(plannerOptions, m_goal, m_reference))
+    {
+        yError() << "[configure] Unable to compute the reference trajectory.";
+        return false;
+    }
+
+    return configurePipeline();
+}
+
+bool InterferenceBenchmark::configurePipeline()
+{
+    yarp::os::Property plannerOptions, controllerOptions, forwardKinematicsOptions, inverseKinematicsOptions;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "TRAJECTORY_PLANNER", plannerOptions)
+       || !BenchmarkHelper::getOptions(m_controllerConfig, "DCM_MPC_CONTROLLER", controllerOptions)
+       || !BenchmarkHelper::getOptions(m_controllerConfig, "FORWARD_KINEMATICS_SOLVER",
+                                       forwardKinematicsOptions)
+       || !BenchmarkHelper::getOptions(m_controllerConfig, "INVERSE_KINEMATICS_QP_SOLVER",
+                                       inverseKinematicsOptions))
+    {
+        yError() << "[configurePipeline] Unable to get the options of the stages.";
+        return false;
+    }
+
+    // the planner runs in a worker of the pool, as in the walking module
+    m_threadPool = std::make_unique<WalkingThreadPool>();
+    if(!m_threadPool->initialize(yarp::os::Property()))
+    {
+        yError() << "[configurePipeline] Unable to initialize the thread pool.";
+        return false;
+    }
+
+    m_trajectoryGenerator = std::make_unique<TrajectoryGenerator>();
+    m_trajectoryInitTime = 0.0;
+    if(!m_trajectoryGenerator->initialize(plannerOptions, *m_threadPool)
+       || !m_trajectoryGenerator->generateFirstTrajectories())
+    {
+        yError() << "[configurePipeline] Unable to initialize the planner.";
+        return false;
+    }
+
+    m_walkingController = std::make_unique<WalkingController>();
+    if(!m_walkingController->initialize(controllerOptions))
+    {
+        yError() << "[configurePipeline] Unable to initialize the controller.";
+        return false;
+    }
+
+    std::string pathToModel = yarp::os::ResourceFinder::getResourceFinderSingleton().findFileByName(m_modelName);
+    if(!m_loader.loadReducedModelFromFile(pathToModel, m_joints))
+    {
+        yError() << "[configurePipeline] Error while loading the model from " << pathToModel;
+        return false;
+    }
+
+    m_FKSolver = std::make_unique<WalkingFK>();
+    if(!m_FKSolver->initialize(forwardKinematicsOptions, m_loader.model()))
+    {
+        yError() << "[configurePipeline] Unable to initialize the FK solver.";
+        return false;
+    }
+
+    int actuatedDOFs = m_joints.size();
+    iDynTree::VectorDynSize minJointsLimit(actuatedDOFs), maxJointsLimit(actuatedDOFs);
+    for(int i = 0; i < actuatedDOFs; i++)
+    {
+        minJointsLimit(i) = -iDynTree::deg2rad(m_jointVelocityLimit);
+        maxJointsLimit(i) = iDynTree::deg2rad(m_jointVelocityLimit);
+    }
+
+    if(m_useOSQP)
+    {
+        m_QPIKSolver_osqp = std::make_unique<WalkingQPIK_osqp>();
+        if(!m_QPIKSolver_osqp->initialize(inverseKinematicsOptions, actuatedDOFs,
+                                          minJointsLimit, maxJointsLimit))
+        {
+            yError() << "[configurePipeline] Unable to initialize the QP-IK solver (osqp).";
+            return false;
+        }
+    }
+    else
+    {
+        m_QPIKSolver_qpOASES = std::make_unique<WalkingQPIK_qpOASES>();
+        if(!m_QPIKSolver_qpOASES->initialize(inverseKinematicsOptions, actuatedDOFs,
+                                             minJointsLimit, maxJointsLimit))
+        {
+            yError() << "[configurePipeline] Unable to initialize the QP-IK solver (qpOASES).";
+            return false;
+        }
+    }
+
+    // the robot starts from the regularization posture
+    m_initialJointPosition.resize(actuatedDOFs);
+    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(inverseKinematicsOptions.find("jointRegularization"),
+                                                    m_initialJointPosition))
+    {
+        yError() << "[configurePipeline] Unable to read the joint regularization.";
+        return false;
+    }
+    iDynTree::toEigen(m_initialJointPosition) = iDynTree::toEigen(m_initialJointPosition) * iDynTree::deg2rad(1);
+
+    return true;
+}
+
+bool InterferenceBenchmark::runPipeline(const int& ticks, std::vector<std::vector<double>>& durations,
+                                        int& overruns)
+{
+    int actuatedDOFs = m_joints.size();
+
+    std::deque<iDynTree::Transform> leftTrajectory, rightTrajectory;
+    std::deque<bool> leftInContact, rightInContact;
+    std::deque<iDynTree::Vector2> DCMPositionDesired;
+    size_t index = 0;
+    iDynTree::Vector2 desiredZMP;
+    bool resetTrajectory = true;
+
+    iDynTree::VectorDynSize jointPosition(m_initialJointPosition);
+    iDynTree::VectorDynSize jointVelocity(actuatedDOFs), dqDesired(actuatedDOFs);
+    jointVelocity.zero();
+
+    iDynTree::MatrixDynSize leftFootJacobian(6, actuatedDOFs + 6), rightFootJacobian(6, actuatedDOFs + 6);
+    iDynTree::MatrixDynSize neckJacobian(6, actuatedDOFs + 6), comJacobian(3, actuatedDOFs + 6);
+    iDynTree::Position comPosition, desiredCoMPosition;
+    iDynTree::Vector3 desiredCoMVelocity;
+
+    // the neck Jacobian is evaluated only if the neck task is in the QP-IK problem
+    bool isNeckTaskEnabled = m_useOSQP ? m_QPIKSolver_osqp->getTaskSet().isNeckEnabled()
+        : m_QPIKSolver_qpOASES->getTaskSet().isNeckEnabled();
+
+    auto solveQPIK = [&](auto& solver)
+    {
+        bool isSolved = solver->setRobotState(jointPosition, m_FKSolver->getLeftFootToWorldTransform(),
+                                              m_FKSolver->getRightFootToWorldTransform(),
+                                              m_FKSolver->getNeckOrientation(), comPosition);
+        solver->setDesiredNeckOrientation(iDynTree::Rotation::Identity());
+        solver->setDesiredFeetTransformation(m_reference.leftTrajectory[index],
+                                             m_reference.rightTrajectory[index]);
+        solver->setDesiredFeetTwist(m_reference.leftTwistTrajectory[index],
+                                    m_reference.rightTwistTrajectory[index]);
+        solver->setDesiredCoMVelocity(desiredCoMVelocity);
+        solver->setDesiredCoMPosition(desiredCoMPosition);
+        return isSolved && solver->setLeftFootJacobian(leftFootJacobian)
+            && solver->setRightFootJacobian(rightFootJacobian)
+            && (!isNeckTaskEnabled || solver->setNeckJacobian(neckJacobian))
+            && solver->setCoMJacobian(comJacobian)
+            && solver->solve() && solver->getSolution(dqDesired);
+    };
+
+    bool isPlannerPending = false;
+    durations.assign(NumberOfStages, std::vector<double>());
+    for(auto& stageDurations : durations)
+        stageDurations.reserve(ticks);
+    overruns = 0;
+
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>
+        (std::chrono::duration<double>(m_dT));
+    auto nextTick = std::chrono::steady_clock::now() + period;
+    for(int tick = 0; tick < ticks; tick++)
+    {
+        std::this_thread::sleep_until(nextTick);
+        auto wakeUp = std::chrono::steady_clock::now();
+        durations[Wakeup].push_back(toSeconds(wakeUp - nextTick));
+
+        // the trajectory is computed by the thread pool, as in the walking module
+        if(isPlannerPending && !m_trajectoryGenerator->isTrajectoryAsked())
+        {
+            double planningDuration;
+            if(m_trajectoryGenerator->getPlanningDuration(planningDuration))
+                durations[Planner].push_back(planningDuration);
+            isPlannerPending = false;
+        }
+
+        if(!isPlannerPending && tick % m_replanningTicks == 0)
+        {
+            if(!BenchmarkHelper::askWalkingTrajectory(*m_trajectoryGenerator, m_dT, m_goal,
+                                                      m_trajectoryInitTime))
+            {
+                yError() << "[runPipeline] Unable to ask for a new trajectory.";
+                return false;
+            }
+            isPlannerPending = true;
+        }
+
+        // the reference is restarted when the trajectory ends
+        if(DCMPositionDesired.size() < 2)
+        {
+            leftTrajectory.assign(m_reference.leftTrajectory.begin(), m_reference.leftTrajectory.end());
+            rightTrajectory.assign(m_reference.rightTrajectory.begin(), m_reference.rightTrajectory.end());
+            leftInContact.assign(m_reference.leftInContact.begin(), m_reference.leftInContact.end());
+            rightInContact.assign(m_reference.rightInContact.begin(), m_reference.rightInContact.end());
+            DCMPositionDesired.assign(m_reference.DCMPositionDesired.begin(),
+                                      m_reference.DCMPositionDesired.end());
+            index = 0;
+            resetTrajectory = true;
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        if(!m_walkingController->setConvexHullConstraint(leftTrajectory, rightTrajectory,
+                                                         leftInContact, rightInContact)
+           || !m_walkingController->setFeedback(DCMPositionDesired.front())
+           || !m_walkingController->setReferenceSignal(DCMPositionDesired, resetTrajectory)
+           || !m_walkingController->solve() || !m_walkingController->getControllerOutput(desiredZMP))
+        {
+            yError() << "[runPipeline] Unable to solve the MPC problem.";
+            return false;
+        }
+        auto endTime = std::chrono::steady_clock::now();
+        durations[MPC].push_back(toSeconds(endTime - startTime));
+
+        startTime = endTime;
+        if(!m_FKSolver->evaluateWorldToBaseTransformation(m_reference.leftTrajectory[index],
+                                                          m_reference.rightTrajectory[index],
+                                                          m_reference.isLeftFixedFrame[index])
+           || !m_FKSolver->setInternalRobotState(jointPosition, jointVelocity)
+           || !m_FKSolver->evaluateCoM() || !m_FKSolver->evaluateDCM()
+           || !m_FKSolver->getCoMPosition(comPosition)
+           || !m_FKSolver->getLeftFootJacobian(leftFootJacobian)
+           || !m_FKSolver->getRightFootJacobian(rightFootJacobian)
+           || (isNeckTaskEnabled && !m_FKSolver->getNeckJacobian(neckJacobian))
+           || !m_FKSolver->getCoMJacobian(comJacobian))
+        {
+            yError() << "[runPipeline] Unable to evaluate the FK.";
+            return false;
+        }
+        endTime = std::chrono::steady_clock::now();
+        durations[FK].push_back(toSeconds(endTime - startTime));
+
+        // the desired CoM follows the DCM reference
+        desiredCoMPosition(0) = m_reference.DCMPositionDesired[index](0);
+        desiredCoMPosition(1) = m_reference.DCMPositionDesired[index](1);
+        desiredCoMPosition(2) = m_reference.comHeightTrajectory[index];
+        desiredCoMVelocity(0) = m_reference.DCMVelocityDesired[index](0);
+        desiredCoMVelocity(1) = m_reference.DCMVelocityDesired[index](1);
+        desiredCoMVelocity(2) = m_reference.comHeightVelocity[index];
+
+        startTime = endTime;
+        bool isSolved = m_useOSQP ? solveQPIK(m_QPIKSolver_osqp) : solveQPIK(m_QPIKSolver_qpOASES);
+        endTime = std::chrono::steady_clock::now();
+        durations[IK].push_back(toSeconds(endTime - startTime));
+
+        // a failure of the QP-IK is not fatal, the robot keeps the previous posture
+        if(isSolved)
+        {
+            iDynTree::toEigen(jointVelocity) = iDynTree::toEigen(dqDesired);
+            iDynTree::toEigen(jointPosition) += iDynTree::toEigen(dqDesired) * m_dT;
+        }
+
+        durations[Total].push_back(toSeconds(endTime - wakeUp));
+
+        // the ticks that are lost after an overrun are skipped, as in a periodic thread
+        nextTick += period;
+        if(endTime > nextTick)
+        {
+            overruns++;
+            while(nextTick < endTime)
+                nextTick += period;
+        }
+
+        resetTrajectory = false;
+        leftTrajectory.pop_front();
+        rightTrajectory.pop_front();
+        leftInContact.pop_front();
+        rightInContact.pop_front();
+        DCMPositionDesired.pop_front();
+        index++;
+    }
+
+    // the next run starts with the planner idle
+    while(m_trajectoryGenerator->isTrajectoryAsked())
+        yarp::os::Time::delay(0.001);
+
+    return true;
+}
+
+bool InterferenceBenchmark::runScenario(const InterferenceScenario& scenario, const bool& useRealTimeSettings)
+{
+    std::vector<std::unique_ptr<CoRunner>> coRunners;
+    for(int i = 0; i < scenario.coRunners.size(); i++)
+    {
+        int cpu = m_coRunnersCPUs.empty() ? -1 : m_coRunnersCPUs[i % m_coRunnersCPUs.size()];
+        coRunners.push_back(std::make_unique<CoRunner>());
+        if(!coRunners.back()->configure(scenario.coRunners[i], m_coRunnersOptions, cpu, i))
+        {
+            yError() << "[runScenario] Unable to configure the co-runners of the scenario " << scenario.name;
+            return false;
+        }
+    }
+
+    for(auto& coRunner : coRunners)
+    {
+        if(!coRunner->start())
+        {
+            yError() << "[runScenario] Unable to start the co-runners of the scenario " << scenario.name;
+            return false;
+        }
+    }
+
+    // the settings are applied to a new thread, so the main thread keeps the default ones
+    std::vector<std::vector<double>> durations;
+    int overruns = 0;
+    bool isOk = true;
+    std::thread controlThread([&]()
+                              {
+                                  if(useRealTimeSettings && !m_realTimeSettings.apply())
+                                  {
+                                      isOk = false;
+                                      return;
+                                  }
+
+                                  std::vector<std::vector<double>> warmupDurations;
+                                  int warmupOverruns;
+                                  isOk = runPipeline(m_warmupTicks, warmupDurations, warmupOverruns)
+                                      && runPipeline(m_numberOfTicks, durations, overruns);
+                              });
+    controlThread.join();
+
+    std::stringstream iterations;
+    for(int i = 0; i < coRunners.size(); i++)
+    {
+        iterations << scenario.coRunners[i] << ": " << coRunners[i]->getIterations() << " ";
+        coRunners[i]->stop();
+    }
+
+    if(!isOk)
+    {
+        yError() << "[runScenario] Unable to run the pipeline in the scenario " << scenario.name;
+        return false;
+    }
+
+    for(int stage = 0; stage < NumberOfStages; stage++)
+    {
+        std::vector<double>& samples = durations[stage];
+        std::sort(samples.begin(), samples.end());
+
+        InterferenceResult result;
+        result.scheduling = useRealTimeSettings ? "realtime" : "default";
+        result.scenario = scenario.name;
+        result.stage = stageNames[stage];
+        result.samples = samples.size();
+        result.median = BenchmarkHelper::percentile(samples, 0.5);
+        result.p99 = BenchmarkHelper::percentile(samples, 0.99);
+        result.p999 = BenchmarkHelper::percentile(samples, 0.999);
+        result.max = samples.empty() ? 0.0 : samples.back();
+        result.overruns = stage == Total ? overruns : 0;
+        m_results.push_back(result);
+
+        if(stage == Total)
+            yInfo() << "[runScenario] " << result.scenario << " (" << result.scheduling << "): total p99 "
+                    << result.p99 * 1e3 << " ms, " << overruns << " overruns. Co-runner iterations "
+                    << iterations.str();
+    }
+
+    return true;
+}
+
+bool InterferenceBenchmark::writeResults()
+{
+    std::ofstream csv(m_outputPrefix + ".csv");
+    std::ofstream json(m_outputPrefix + ".json");
+    if(!csv.is_open() || !json.is_open())
+    {
+        yError() << "[writeResults] Unable to open the files " << m_outputPrefix << ".csv/.json";
+        return false;
+    }
+
+    csv << "scheduling,scenario,stage,samples,p50_ms,p99_ms,p999_ms,max_ms,p99_degradation,overruns"
+        << std::endl;
+
+    json << "[" << std::endl;
+    for(int i = 0; i < m_results.size(); i++)
+    {
+        const InterferenceResult& result = m_results[i];
+        csv << result.scheduling << "," << result.scenario << "," << result.stage << ","
+            << result.samples << "," << result.median * 1e3 << "," << result.p99 * 1e3 << ","
+            << result.p999 * 1e3 << "," << result.max * 1e3 << "," << result.p99Degradation << ","
+            << result.overruns << std::endl;
+
+        json << "  {\"scheduling\": \"" << result.scheduling << "\", "
+             << "\"scenario\": \"" << result.scenario << "\", "
+             << "\"stage\": \"" << result.stage << "\", "
+             << "\"samples\": " << result.samples << ", "
+             << "\"p50_ms\": " << result.median * 1e3 << ", "
+             << "\"p99_ms\": " << result.p99 * 1e3 << ", "
+             << "\"p999_ms\": " << result.p999 * 1e3 << ", "
+             << "\"max_ms\": " << result.max * 1e3 << ", "
+             << "\"p99_degradation\": " << result.p99Degradation << ", "
+             << "\"overruns\": " << result.overruns << "}"
+             << (i + 1 < m_results.size() ? "," : "") << std::endl;
+    }
+    json << "]" << std::endl;
+
+    yInfo() << "[writeResults] The results are saved in " << m_outputPrefix << ".csv and "
+            << m_outputPrefix << ".json";
+    return true;
+}
+
+bool InterferenceBenchmark::run()
+{
+    // the memory locking cannot be undone, so the default scheduling is measured first
+    std::vector<bool> schedulings{false};
+    if(m_compareRealTime)
+        schedulings.push_back(true);
+
+    for(const auto& useRealTimeSettings : schedulings)
+    {
+        for(const auto& scenario : m_scenarios)
+        {
+            yInfo() << "[run] Scenario " << scenario.name << " ("
+                    << (useRealTimeSettings ? "realtime" : "default") << " scheduling).";
+            if(!runScenario(scenario, useRealTimeSettings))
+                return false;
+        }
+    }
+
+    // the degradation is evaluated with respect to the baseline with the same scheduling
+    for(auto& result : m_results)
+    {
+        auto baseline = std::find_if(m_results.begin(), m_results.end(), [&](const InterferenceResult& other)
+                                     {
+                                         return other.scenario == m_baselineScenario
+                                             && other.scheduling == result.scheduling
+                                             && other.stage == result.stage;
+                                     });
+        if(baseline != m_results.end() && baseline->p99 > 0)
+            result.p99Degradation = result.p99 / baseline->p99;
+    }
+
+    return writeResults();
+}
@@ -0,0 +1,595 @@
+/**
+ * @file ScalingBenchmark.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <deque>
+#include <fstream>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+
+// iDynTree
+#include <iDynTree/Core/EigenHelpers.h>
+#include <iDynTree/Core/MatrixDynSize.h>
+#include <iDynTree/Core/Utils.h>
+#include <iDynTree/ModelIO/ModelLoader.h>
+
+#include "ScalingBenchmark.hpp"
+#include "WalkingController.hpp"
+#include "WalkingForwardKinematics.hpp"
+#include "WalkingQPInverseKinematics_osqp.hpp"
+#include "WalkingQPInverseKinematics_qpOASES.hpp"
+#include "Utils.hpp"
+
+namespace
+{
+    /**
+     * Read a list of doubles (or a single double).
+     */
+    std::vector<double> readDoubles(const yarp::os::Value& value)
+    {
+        std::vector<double> output;
+        if(value.isList())
+        {
+            for(int i = 0; i < value.asList()->size(); i++)
+                output.push_back(value.asList()->get(i).asDouble());
+        }
+        else if(!value.isNull())
+            output.push_back(value.asDouble());
+
+        return output;
+    }
+
+    /**
+     * Create a YARP list from an iDynTree vector.
+     */
+    yarp::os::Value* makeList(const iDynTree::VectorDynSize& vector)
+    {
+        yarp::os::Value* list = yarp::os::Value::makeList();
+        for(unsigned i = 0; i < vector.size(); i++)
+            list->asList()->addDouble(vector(i));
+
+        return list;
+    }
+
+    /**
+     * Median, 99th percentile and maximum of the durations.
+     */
+    void summarize(std::vector<double>& durations, ScalingResult& result)
+    {
+        result.samples = durations.size();
+        if(durations.empty())
+            return;
+
+        std::sort(durations.begin(), durations.end());
+        result.median = BenchmarkHelper::percentile(durations, 0.5);
+        result.p99 = BenchmarkHelper::percentile(durations, 0.99);
+        result.max = durations.back();
+    }
+}
+
+bool ScalingBenchmark::configure(yarp::os::ResourceFinder& rf)
+{
+    // the stages are configured as in the walking module
+    if(!BenchmarkHelper::loadControllerConfig(rf, m_controllerConfig))
+    {
+        yError() << "[configure] Unable to load the configuration of the controller.";
+        return false;
+    }
+
+    m_modelName = rf.check("model", m_controllerConfig.check("model", yarp::os::Value("model.urdf"))).asString();
+
+    yarp::os::Value* axesListYarp;
+    if(!m_controllerConfig.check("joints_list", axesListYarp)
+       || !YarpHelper::yarpListToStringVector(axesListYarp, m_defaultJoints))
+    {
+        yError() << "[configure] Unable to read the joints_list of the controller.";
+        return false;
+    }
+
+    yarp::os::Bottle& qpOptions = m_controllerConfig.findGroup("INVERSE_KINEMATICS_QP_SOLVER");
+    m_defaultRegularization.resize(m_defaultJoints.size());
+    m_defaultRegularizationWeights.resize(m_defaultJoints.size());
+    m_defaultRegularizationGains.resize(m_defaultJoints.size());
+    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(qpOptions.find("jointRegularization"),
+                                                    m_defaultRegularization)
+       || !YarpHelper::yarpListToiDynTreeVectorDynSize(qpOptions.find("jointRegularizationWeights"),
+                                                       m_defaultRegularizationWeights)
+       || !YarpHelper::yarpListToiDynTreeVectorDynSize(qpOptions.find("jointRegularizationGains"),
+                                                       m_defaultRegularizationGains))
+    {
+        yError() << "[configure] Unable to read the joint regularization of the QP-IK.";
+        return false;
+    }
+
+    m_dT = m_controllerConfig.findGroup("GENERAL").check("sampling_time", yarp::os::Value(0.016)).asDouble();
+    m_defaultControllerHorizon = m_controllerConfig.findGroup("DCM_MPC_CONTROLLER").check("controllerHorizon",
+                                                                                        yarp::os::Value(1.0)).asDouble();
+    m_defaultPlannerHorizon = m_controllerConfig.findGroup("TRAJECTORY_PLANNER").check("plannerHorizon",
+                                                                                     yarp::os::Value(20.0)).asDouble();
+
+    // parameters under test
+    m_controllerHorizons = readDoubles(rf.check("controller_horizons", yarp::os::Value(m_defaultControllerHorizon)));
+    m_plannerHorizons = readDoubles(rf.check("planner_horizons", yarp::os::Value(m_defaultPlannerHorizon)));
+
+    yarp::os::Value dofConfigurations = rf.find("dof_configurations");
+    for(int i = 0; dofConfigurations.isList() && i < dofConfigurations.asList()->size(); i++)
+    {
+        DoFConfiguration configuration;
+        configuration.name = dofConfigurations.asList()->get(i).asString();
+
+        yarp::os::Value* jointsList;
+        if(!rf.findGroup(configuration.name).check("joints_list", jointsList)
+           || !YarpHelper::yarpListToStringVector(jointsList, configuration.joints))
+        {
+            yError() << "[configure] Unable to read the joints_list of the configuration "
+                     << configuration.name;
+            return false;
+        }
+        m_dofConfigurations.push_back(configuration);
+    }
+
+    // by default the joints of the walking module are used
+    if(m_dofConfigurations.empty())
+    {
+        DoFConfiguration configuration;
+        configuration.name = "default";
+        configuration.joints = m_defaultJoints;
+        m_dofConfigurations.push_back(configuration);
+    }
+
+    m_additionalJointRegularization = rf.check("additional_joint_regularization", yarp::os::Value(0.0)).asDouble();
+    m_additionalJointWeight = rf.check("additional_joint_weight", yarp::os::Value(0.5)).asDouble();
+    m_additionalJointGain = rf.check("additional_joint_gain", yarp::os::Value(0.5)).asDouble();
+    m_jointVelocityLimit = rf.check("joint_velocity_limit", yarp::os::Value(100.0)).asDouble();
+
+    std::vector<double> goal = readDoubles(rf.find("goal"));
+    m_goal(0) = goal.size() == 2 ? goal[0] : 1.0;
+    m_goal(1) = goal.size() == 2 ? goal[1] : 0.0;
+
+    m_numberOfTicks = rf.check("ticks", yarp::os::Value(1000)).asInt();
+    m_plannerSamples = rf.check("planner_samples", yarp::os::Value(20)).asInt();
+    m_outputPrefix = rf.check("output_prefix", yarp::os::Value("scalingBenchmark")).asString();
+
+    if(m_controllerHorizons.empty() || m_plannerHorizons.empty())
+    {
+        yError() << "[configure] The lists of the horizons cannot be empty.";
+        return false;
+    }
+
+    if(m_numberOfTicks <= 0 || m_plannerSamples <= 0 || m_jointVelocityLimit <= 0)
+    {
+        yError() << "[configure] ticks, planner_samples and joint_velocity_limit have to be positive.";
+        return false;
+    }
+
+    return true;
+}
+
+bool ScalingBenchmark::benchmarkPlanner(const double& plannerHorizon)
+{
+    yarp::os::Property options;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "TRAJECTORY_PLANNER", options))
+    {
+        yError() << "[benchmarkPlanner] Unable to get the options of the planner.";
+        return false;
+    }
+    options.put("plannerHorizon", plannerHorizon);
+
+    ScalingResult result;
+    result.stage = "planner";
+    result.dofConfiguration = "default";
+    result.dofs = m_defaultJoints.size();
+    result.controllerHorizon = m_defaultControllerHorizon;
+    result.plannerHorizon = plannerHorizon;
+
+    // the planner runs in a worker of the pool (started before the measurement)
+    WalkingThreadPool threadPool;
+    if(!threadPool.initialize(yarp::os::Property()))
+    {
+        yError() << "[benchmarkPlanner] Unable to initialize the thread pool.";
+        return false;
+    }
+
+    // the initialization includes the first (standing) trajectory
+    long memory = BenchmarkHelper::residentMemory();
+    double initTime = yarp::os::Time::now();
+    TrajectoryGenerator generator;
+    if(!generator.initialize(options, threadPool) || !generator.generateFirstTrajectories())
+    {
+        yError() << "[benchmarkPlanner] Unable to initialize the planner with horizon " << plannerHorizon;
+        return false;
+    }
+    result.initDuration = yarp::os::Time::now() - initTime;
+
+    // every trajectory starts from the first merge point of the previous one
+    std::vector<double> durations;
+    double trajectoryInitTime = 0.0;
+    for(int i = 0; i < m_plannerSamples; i++)
+    {
+        double planningDuration;
+        if(!BenchmarkHelper::planWalkingTrajectory(generator, m_dT, m_goal, trajectoryInitTime,
+                                                   planningDuration))
+        {
+            // the planner cannot be called again after a failure
+            result.failures++;
+            break;
+        }
+        durations.push_back(planningDuration);
+
+        if(i == 0)
+            result.memory = BenchmarkHelper::residentMemory() - memory;
+    }
+
+    summarize(durations, result);
+    m_results.push_back(result);
+    return true;
+}
+
+bool ScalingBenchmark::benchmarkController(const double& controllerHorizon)
+{
+    yarp::os::Property options;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "DCM_MPC_CONTROLLER", options))
+    {
+        yError() << "[benchmarkController] Unable to get the options of the controller.";
+        return false;
+    }
+    options.put("controllerHorizon", controllerHorizon);
+
+    ScalingResult result;
+    result.stage = "mpc";
+    result.dofConfiguration = "default";
+    result.dofs = m_defaultJoints.size();
+    result.controllerHorizon = controllerHorizon;
+    result.plannerHorizon = m_defaultPlannerHorizon;
+
+    long memory = BenchmarkHelper::residentMemory();
+    double initTime = yarp::os::Time::now();
+    WalkingController controller;
+    if(!controller.initialize(options))
+    {
+        yError() << "[benchmarkController] Unable to initialize the controller with horizon "
+                 << controllerHorizon;
+        return false;
+    }
+    result.initDuration = yarp::os::Time::now() - initTime;
+
+    std::deque<iDynTree::Transform> leftTrajectory, rightTrajectory;
+    std::deque<bool> leftInContact, rightInContact;
+    std::deque<iDynTree::Vector2> DCMPositionDesired;
+    iDynTree::Vector2 desiredZMP;
+    bool resetTrajectory = true;
+
+    std::vector<double> durations;
+    durations.reserve(m_numberOfTicks);
+    for(int tick = 0; tick < m_numberOfTicks; tick++)
+    {
+        // the reference is restarted when the trajectory ends
+        if(DCMPositionDesired.size() < 2)
+        {
+            const ReferenceTrajectory& reference = m_reference;
+            leftTrajectory.assign(reference.leftTrajectory.begin(), reference.leftTrajectory.end());
+            rightTrajectory.assign(reference.rightTrajectory.begin(), reference.rightTrajectory.end());
+            leftInContact.assign(reference.leftInContact.begin(), reference.leftInContact.end());
+            rightInContact.assign(reference.rightInContact.begin(), reference.rightInContact.end());
+            DCMPositionDesired.assign(reference.DCMPositionDesired.begin(), reference.DCMPositionDesired.end());
+            resetTrajectory = true;
+        }
+
+        double startTime = yarp::os::Time::now();
+        bool isSolved = controller.setConvexHullConstraint(leftTrajectory, rightTrajectory,
+                                                           leftInContact, rightInContact)
+            && controller.setFeedback(DCMPositionDesired.front())
+            && controller.setReferenceSignal(DCMPositionDesired, resetTrajectory)
+            && controller.solve()
+            && controller.getControllerOutput(desiredZMP);
+        durations.push_back(yarp::os::Time::now() - startTime);
+
+        if(!isSolved)
+            result.failures++;
+
+        if(tick == 0)
+            result.memory = BenchmarkHelper::residentMemory() - memory;
+
+        resetTrajectory = false;
+        leftTrajectory.pop_front();
+        rightTrajectory.pop_front();
+        leftInContact.pop_front();
+        rightInContact.pop_front();
+        DCMPositionDesired.pop_front();
+    }
+
+    summarize(durations, result);
+    m_results.push_back(result);
+    return true;
+}
+
+bool ScalingBenchmark::benchmarkKinematics(const DoFConfiguration& configuration)
+{
+    int actuatedDOFs = configuration.joints.size();
+
+    // the regularization of the joints controlled by the walking module is kept
+    iDynTree::VectorDynSize regularization(actuatedDOFs);
+    iDynTree::VectorDynSize regularizationWeights(actuatedDOFs);
+    iDynTree::VectorDynSize regularizationGains(actuatedDOFs);
+    for(int i = 0; i < actuatedDOFs; i++)
+    {
+        auto joint = std::find(m_defaultJoints.begin(), m_defaultJoints.end(), configuration.joints[i]);
+        if(joint == m_defaultJoints.end())
+        {
+            regularization(i) = m_additionalJointRegularization;
+            regularizationWeights(i) = m_additionalJointWeight;
+            regularizationGains(i) = m_additionalJointGain;
+            continue;
+        }
+
+        int index = std::distance(m_defaultJoints.begin(), joint);
+        regularization(i) = m_defaultRegularization(index);
+        regularizationWeights(i) = m_defaultRegularizationWeights(index);
+        regularizationGains(i) = m_defaultRegularizationGains(index);
+    }
+
+    yarp::os::Property forwardKinematicsOptions, inverseKinematicsOptions;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "FORWARD_KINEMATICS_SOLVER",
+                                    forwardKinematicsOptions)
+       || !BenchmarkHelper::getOptions(m_controllerConfig, "INVERSE_KINEMATICS_QP_SOLVER",
+                                       inverseKinematicsOptions))
+    {
+        yError() << "[benchmarkKinematics] Unable to get the options of the kinematics solvers.";
+        return false;
+    }
+    inverseKinematicsOptions.put("jointRegularization", makeList(regularization));
+    inverseKinematicsOptions.put("jointRegularizationWeights", makeList(regularizationWeights));
+    inverseKinematicsOptions.put("jointRegularizationGains", makeList(regularizationGains));
+
+    std::vector<ScalingResult> results(3);
+    results[0].stage = "fk";
+    results[1].stage = "qp_ik_osqp";
+    results[2].stage = "qp_ik_qpoases";
+    for(auto& result : results)
+    {
+        result.dofConfiguration = configuration.name;
+        result.dofs = actuatedDOFs;
+        result.controllerHorizon = m_defaultControllerHorizon;
+        result.plannerHorizon = m_defaultPlannerHorizon;
+    }
+
+    // the model is part of the FK stage
+    long memory = BenchmarkHelper::residentMemory();
+    double initTime = yarp::os::Time::now();
+    iDynTree::ModelLoader loader;
+    std::string pathToModel = yarp::os::ResourceFinder::getResourceFinderSingleton().findFileByName(m_modelName);
+    if(!loader.loadReducedModelFromFile(pathToModel, configuration.joints))
+    {
+        yError() << "[benchmarkKinematics] Error while loading the model from " << pathToModel
+                 << " with the configuration " << configuration.name;
+        return false;
+    }
+
+    WalkingFK FKSolver;
+    if(!FKSolver.initialize(forwardKinematicsOptions, loader.model()))
+    {
+        yError() << "[benchmarkKinematics] Unable to initialize the FK solver.";
+        return false;
+    }
+    results[0].initDuration = yarp::os::Time::now() - initTime;
+    results[0].memory = BenchmarkHelper::residentMemory() - memory;
+
+    iDynTree::VectorDynSize minJointsLimit(actuatedDOFs), maxJointsLimit(actuatedDOFs);
+    for(int i = 0; i < actuatedDOFs; i++)
+    {
+        minJointsLimit(i) = -iDynTree::deg2rad(m_jointVelocityLimit);
+        maxJointsLimit(i) = iDynTree::deg2rad(m_jointVelocityLimit);
+    }
+
+    memory = BenchmarkHelper::residentMemory();
+    initTime = yarp::os::Time::now();
+    WalkingQPIK_osqp QPIKSolver_osqp;
+    if(!QPIKSolver_osqp.initialize(inverseKinematicsOptions, actuatedDOFs, minJointsLimit, maxJointsLimit))
+    {
+        yError() << "[benchmarkKinematics] Unable to initialize the QP-IK solver (osqp).";
+        return false;
+    }
+    results[1].initDuration = yarp::os::Time::now() - initTime;
+    results[1].memory = BenchmarkHelper::residentMemory() - memory;
+
+    memory = BenchmarkHelper::residentMemory();
+    initTime = yarp::os::Time::now();
+    WalkingQPIK_qpOASES QPIKSolver_qpOASES;
+    if(!QPIKSolver_qpOASES.initialize(inverseKinematicsOptions, actuatedDOFs, minJointsLimit, maxJointsLimit))
+    {
+        yError() << "[benchmarkKinematics] Unable to initialize the QP-IK solver (qpOASES).";
+        return false;
+    }
+    results[2].initDuration = yarp::os::Time::now() - initTime;
+    results[2].memory = BenchmarkHelper::residentMemory() - memory;
+
+    // the robot starts from the regularization posture and integrates the osqp solution
+    iDynTree::VectorDynSize jointPosition(actuatedDOFs), jointVelocity(actuatedDOFs);
+    iDynTree::VectorDynSize dqDesired_osqp(actuatedDOFs), dqDesired_qpOASES(actuatedDOFs);
+    iDynTree::toEigen(jointPosition) = iDynTree::toEigen(regularization) * iDynTree::deg2rad(1);
+    jointVelocity.zero();
+
+    iDynTree::MatrixDynSize leftFootJacobian(6, actuatedDOFs + 6), rightFootJacobian(6, actuatedDOFs + 6);
+    iDynTree::MatrixDynSize neckJacobian(6, actuatedDOFs + 6), comJacobian(3, actuatedDOFs + 6);
+
+    // the neck Jacobian is evaluated only if the neck task is in the QP-IK problem (both the
+    // solvers are initialized with the same tasks)
+    bool isNeckTaskEnabled = QPIKSolver_osqp.getTaskSet().isNeckEnabled();
+    iDynTree::Position comPosition, desiredCoMPosition;
+    iDynTree::Vector3 desiredCoMVelocity;
+
+    std::vector<std::vector<double>> durations(results.size());
+    for(auto& stageDurations : durations)
+        stageDurations.reserve(m_numberOfTicks);
+
+    for(int tick = 0; tick < m_numberOfTicks; tick++)
+    {
+        size_t index = tick % m_reference.DCMPositionDesired.size();
+
+        // the memory is read outside the measured interval
+        memory = tick == 0 ? BenchmarkHelper::residentMemory() : 0;
+        double startTime = yarp::os::Time::now();
+        bool isEvaluated = FKSolver.evaluateWorldToBaseTransformation(m_reference.leftTrajectory[index],
+                                                                      m_reference.rightTrajectory[index],
+                                                                      m_reference.isLeftFixedFrame[index])
+            && FKSolver.setInternalRobotState(jointPosition, jointVelocity)
+            && FKSolver.evaluateCoM() && FKSolver.evaluateDCM()
+            && FKSolver.getCoMPosition(comPosition)
+            && FKSolver.getLeftFootJacobian(leftFootJacobian)
+            && FKSolver.getRightFootJacobian(rightFootJacobian)
+            && (!isNeckTaskEnabled || FKSolver.getNeckJacobian(neckJacobian))
+            && FKSolver.getCoMJacobian(comJacobian);
+        durations[0].push_back(yarp::os::Time::now() - startTime);
+        if(tick == 0)
+            results[0].memory += BenchmarkHelper::residentMemory() - memory;
+
+        if(!isEvaluated)
+        {
+            results[0].failures++;
+            continue;
+        }
+
+        // the desired CoM follows the DCM reference
+        desiredCoMPosition(0) = m_reference.DCMPositionDesired[index](0);
+        desiredCoMPosition(1) = m_reference.DCMPositionDesired[index](1);
+        desiredCoMPosition(2) = m_reference.comHeightTrajectory[index];
+        desiredCoMVelocity(0) = m_reference.DCMVelocityDesired[index](0);
+        desiredCoMVelocity(1) = m_reference.DCMVelocityDesired[index](1);
+        desiredCoMVelocity(2) = m_reference.comHeightVelocity[index];
+
+        auto solveQPIK = [&](auto& solver, iDynTree::VectorDynSize& output, ScalingResult& result,
+                             std::vector<double>& stageDurations)
+        {
+            long memory = tick == 0 ? BenchmarkHelper::residentMemory() : 0;
+            double startTime = yarp::os::Time::now();
+            bool isSolved = solver.setRobotState(jointPosition, FKSolver.getLeftFootToWorldTransform(),
+                                                 FKSolver.getRightFootToWorldTransform(),
+                                                 FKSolver.getNeckOrientation(), comPosition);
+            solver.setDesiredNeckOrientation(iDynTree::Rotation::Identity());
+            solver.setDesiredFeetTransformation(m_reference.leftTrajectory[index],
+                                                m_reference.rightTrajectory[index]);
+            solver.setDesiredFeetTwist(m_reference.leftTwistTrajectory[index],
+                                       m_reference.rightTwistTrajectory[index]);
+            solver.setDesiredCoMVelocity(desiredCoMVelocity);
+            solver.setDesiredCoMPosition(desiredCoMPosition);
+            isSolved = isSolved && solver.setLeftFootJacobian(leftFootJacobian)
+                && solver.setRightFootJacobian(rightFootJacobian)
+                && (!isNeckTaskEnabled || solver.setNeckJacobian(neckJacobian))
+                && solver.setCoMJacobian(comJacobian)
+                && solver.solve() && solver.getSolution(output);
+            stageDurations.push_back(yarp::os::Time::now() - startTime);
+            if(tick == 0)
+                result.memory += BenchmarkHelper::residentMemory() - memory;
+
+            if(!isSolved)
+                result.failures++;
+            return isSolved;
+        };
+
+        bool isSolved = solveQPIK(QPIKSolver_osqp, dqDesired_osqp, results[1], durations[1]);
+        solveQPIK(QPIKSolver_qpOASES, dqDesired_qpOASES, results[2], durations[2]);
+
+        if(isSolved)
+        {
+            iDynTree::toEigen(jointVelocity) = iDynTree::toEigen(dqDesired_osqp);
+            iDynTree::toEigen(jointPosition) += iDynTree::toEigen(dqDesired_osqp) * m_dT;
+        }
+    }
+
+    for(int i = 0; i < results.size(); i++)
+    {
+        summarize(durations[i], results[i]);
+        m_results.push_back(results[i]);
+    }
+    return true;
+}
+
+bool ScalingBenchmark::writeResults()
+{
+    std::ofstream csv(m_outputPrefix + ".csv");
+    std::ofstream json(m_outputPrefix + ".json");
+    if(!csv.is_open() || !json.is_open())
+    {
+        yError() << "[writeResults] Unable to open the files " << m_outputPrefix << ".csv/.json";
+        return false;
+    }
+
+    csv << "stage,dof_configuration,dofs,controller_horizon_s,planner_horizon_s,samples,failures,"
+        << "init_ms,p50_ms,p99_ms,max_ms,memory_kB" << std::endl;
+
+    json << "[" << std::endl;
+    for(int i = 0; i < m_results.size(); i++)
+    {
+        const ScalingResult& result = m_results[i];
+        csv << result.stage << "," << result.dofConfiguration << "," << result.dofs << ","
+            << result.controllerHorizon << "," << result.plannerHorizon << ","
+            << result.samples << "," << result.failures << ","
+            << result.initDuration * 1e3 << "," << result.median * 1e3 << ","
+            << result.p99 * 1e3 << "," << result.max * 1e3 << "," << result.memory / 1024
+            << std::endl;
+
+        json << "  {\"stage\": \"" << result.stage << "\", "
+             << "\"dof_configuration\": \"" << result.dofConfiguration << "\", "
+             << "\"dofs\": " << result.dofs << ", "
+             << "\"controller_horizon_s\": " << result.controllerHorizon << ", "
+             << "\"planner_horizon_s\": " << result.plannerHorizon << ", "
+             << "\"samples\": " << result.samples << ", "
+             << "\"failures\": " << result.failures << ", "
+             << "\"init_ms\": " << result.initDuration * 1e3 << ", "
+             << "\"p50_ms\": " << result.median * 1e3 << ", "
+             << "\"p99_ms\": " << result.p99 * 1e3 << ", "
+             << "\"max_ms\": " << result.max * 1e3 << ", "
+             << "\"memory_kB\": " << result.memory / 1024 << "}"
+             << (i + 1 < m_results.size() ? "," : "") << std::endl;
+    }
+    json << "]" << std::endl;
+
+    yInfo() << "[writeResults] The results are saved in " << m_outputPrefix << ".csv and "
+            << m_outputPrefix << ".json";
+    return true;
+}
+
+bool ScalingBenchmark::run()
+{
+    yarp::os::Property plannerOptions;
+    if(!BenchmarkHelper::getOptions(m_controllerConfig, "TRAJECTORY_PLANNER", plannerOptions)
+       || !BenchmarkHelper::computeReferenceTrajectory(plannerOptions, m_goal, m_reference))
+    {
+        yError() << "[run] Unable to compute the reference trajectory.";
+        return false;
+    }
+
+    for(const auto& horizon : m_plannerHorizons)
+    {
+        yInfo() << "[run] Planner, horizon " << horizon << " s.";
+        if(!benchmarkPlanner(horizon))
+            return false;
+    }
+
+    for(const auto& horizon : m_controllerHorizons)
+    {
+        yInfo() << "[run] MPC, horizon " << horizon << " s.";
+        if(!benchmarkController(horizon))
+            return false;
+    }
+
+    for(const auto& configuration : m_dofConfigurations)
+    {
+        yInfo() << "[run] FK and QP-IK, configuration " << configuration.name
+                << " (" << configuration.joints.size() << " joints).";
+        if(!benchmarkKinematics(configuration))
+            return false;
+    }
+
+    return writeResults();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <string>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/os/Value.h>
+
+#include "InterferenceBenchmark.hpp"
+#include "ScalingBenchmark.hpp"
+
+int main(int argc, char * argv[])
+{
+    // the benchmark works offline, the name server is not required (only the clock is used)
+    yarp::os::Network yarp;
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder &rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+
+    rf.setDefaultConfigFile("scalingBenchmark.ini");
+    rf.setDefaultContext("dcmWalkingScalingBenchmark");
+
+    rf.configure(argc, argv);
+
+    // the same executable measures the scaling of the stages and the interference of other loads
+    std::string mode = rf.check("mode", yarp::os::Value("scaling")).asString();
+    if(mode == "interference")
+    {
+        InterferenceBenchmark benchmark;
+        if(!benchmark.configure(rf))
+        {
+            yError() << "[main] Unable to configure the interference benchmark.";
+            return EXIT_FAILURE;
+        }
+
+        if(!benchmark.run())
+        {
+            yError() << "[main] Unable to run the interference benchmark.";
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    if(mode != "scaling")
+    {
+        yError() << "[main] Unknown mode " << mode << ". The available modes are scaling and interference.";
+        return EXIT_FAILURE;
+    }
+
+    ScalingBenchmark benchmark;
+    if(!benchmark.configure(rf))
+    {
+        yError() << "[main] Unable to configure the scaling benchmark.";
+        return EXIT_FAILURE;
+    }
+
+    if(!benchmark.run())
+    {
+        yError() << "[main] Unable to run the scaling benchmark.";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
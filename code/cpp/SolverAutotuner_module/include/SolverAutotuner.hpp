@@ -0,0 +1,183 @@
+/**
+ * @file SolverAutotuner.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef SOLVER_AUTOTUNER_HPP
+#define SOLVER_AUTOTUNER_HPP
+
+// std
+#include <functional>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/ResourceFinder.h>
+
+#include "SolverSettings.hpp"
+#include "QPProblemRecorder.hpp"
+
+/**
+ * Result of the replay of the problem sequence with a given set of settings.
+ */
+struct SolverBenchmark
+{
+    OsqpSettings osqpSettings; /**< osqp settings (used if the backend is osqp). */
+    QpOASESSettings qpOASESSettings; /**< qpOASES settings (used if the backend is qpOASES). */
+
+    double medianTime{0.0}; /**< Median solve time (in seconds). */
+    double p99Time{0.0}; /**< 99th percentile of the solve time (in seconds). */
+    double maxTime{0.0}; /**< Maximum solve time (in seconds). */
+    double maxSolutionError{0.0}; /**< Maximum distance from the reference solution (infinity norm). */
+    double maxConstraintViolation{0.0}; /**< Maximum constraint violation (infinity norm). */
+    int failures{0}; /**< Number of problems that the solver was unable to solve. */
+    bool isAccurate{false}; /**< True if the accuracy constraints are satisfied. */
+};
+
+/**
+ * Problem of the recording where a shard can start (solved by a new solver or with a checkpoint).
+ */
+struct QPStartPoint
+{
+    int index{0}; /**< Index of the problem. */
+    std::streamoff offset{0}; /**< Offset of the problem (or of its checkpoint) in the file. */
+};
+
+/**
+ * Contiguous subsequence of the recorded problems. A shard starts from a problem solved by a new
+ * solver or from a checkpoint, so it can be replayed independently of the previous problems.
+ */
+struct QPShard
+{
+    int begin{0}; /**< Index of the first problem. */
+    int end{0}; /**< Index after the last problem. */
+    std::streamoff offset{0}; /**< Offset of the first problem in the file. */
+};
+
+/**
+ * Result of the replay of a shard.
+ */
+struct ShardResult
+{
+    std::vector<double> solveTimes; /**< Solve time of the solved problems (in seconds). */
+    double maxSolutionError{0.0}; /**< Maximum distance from the reference solution (infinity norm). */
+    double maxConstraintViolation{0.0}; /**< Maximum constraint violation (infinity norm). */
+    int failures{0}; /**< Number of problems that the solver was unable to solve. */
+};
+
+/**
+ * SolverAutotuner class replays a sequence of recorded QP problems with different solver
+ * settings and selects the fastest settings (99th percentile of the solve time) that satisfy
+ * the accuracy constraints.
+ */
+class SolverAutotuner
+{
+    std::string m_backend; /**< Solver backend (osqp or qpOASES). */
+    std::string m_problemsFile; /**< File containing the recorded problems. */
+    std::string m_outputFile; /**< File where the selected settings are saved. */
+    int m_numberOfThreads; /**< Number of threads. */
+    int m_numberOfShards; /**< Maximum number of shards of the problem sequence. */
+
+    double m_maxSolutionError; /**< Maximum accepted distance from the reference solution. */
+    double m_maxConstraintViolation; /**< Maximum accepted constraint violation. */
+
+    int m_numberOfProblems{0}; /**< Number of recorded problems. */
+    std::vector<bool> m_isHessianChanged; /**< True if the hessian differs from the previous problem. */
+    std::vector<bool> m_isConstraintsMatrixChanged; /**< True if the constraints matrix differs from the previous problem. */
+    std::vector<Eigen::VectorXd> m_referenceSolutions; /**< Solutions evaluated with tight tolerances. */
+    std::vector<QPShard> m_shards; /**< Shards of the problem sequence. */
+
+    std::vector<SolverBenchmark> m_candidates; /**< Candidate settings. */
+
+    /**
+     * Build the grid of candidate settings.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool buildGrid(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Scan the recorded problems and index the shards. The problems are not kept in memory,
+     * each replay reads its shard from the file.
+     * @return true/false in case of success/failure.
+     */
+    bool loadProblems();
+
+    /**
+     * Split the problems in shards. The shards start from the problems with a checkpoint (or solved
+     * by a new solver) and have approximately the same length.
+     * @param startPoints problems where a shard can start.
+     */
+    void buildShards(const std::vector<QPStartPoint>& startPoints);
+
+    /**
+     * Replay a shard with the osqp solver.
+     * @param benchmark contains the settings;
+     * @param shard shard;
+     * @param result result of the replay;
+     * @param solutions if not null the solutions are stored (the vector contains all the problems).
+     */
+    void replayOsqp(const SolverBenchmark& benchmark, const QPShard& shard, ShardResult& result,
+                    std::vector<Eigen::VectorXd>* solutions);
+
+    /**
+     * Replay a shard with the qpOASES solver.
+     * @param benchmark contains the settings;
+     * @param shard shard;
+     * @param result result of the replay;
+     * @param solutions if not null the solutions are stored (the vector contains all the problems).
+     */
+    void replayQpOASES(const SolverBenchmark& benchmark, const QPShard& shard, ShardResult& result,
+                       std::vector<Eigen::VectorXd>* solutions);
+
+    /**
+     * Compare a solution with the reference one and update the result of the replay.
+     * @param index index of the problem;
+     * @param problem QP problem;
+     * @param solution solution of the problem;
+     * @param result result of the replay.
+     */
+    void evaluateSolution(const int& index, const QPProblem& problem, const Eigen::VectorXd& solution,
+                          ShardResult& result);
+
+    /**
+     * Merge the results of the shards and evaluate the timing statistics and the accuracy.
+     * @param results results of the shards;
+     * @param benchmark benchmark.
+     */
+    void evaluateBenchmark(const std::vector<ShardResult>& results, SolverBenchmark& benchmark);
+
+    /**
+     * Run the tasks on all the threads.
+     * @param numberOfTasks number of tasks;
+     * @param task function that runs the task with the given index.
+     */
+    void runTasks(const int& numberOfTasks, const std::function<void(int)>& task);
+
+    /**
+     * Save the settings in an ini snippet.
+     * @param benchmark selected settings.
+     * @return true/false in case of success/failure.
+     */
+    bool writeSettings(const SolverBenchmark& benchmark);
+
+public:
+
+    /**
+     * Configure the autotuner.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configure(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Evaluate all the candidate settings and save the best one.
+     * @return true/false in case of success/failure.
+     */
+    bool run();
+};
+
+#endif
@@ -0,0 +1,677 @@
+/**
+ * @file SolverAutotuner.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/Bottle.h>
+
+#include "SolverAutotuner.hpp"
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXdRowMajor;
+
+namespace
+{
+    /**
+     * Get the candidate values of a parameter. If the key is not found the default value is used.
+     */
+    bool getCandidates(const yarp::os::Searchable& group, const std::string& key,
+                       const double& defaultValue, std::vector<double>& candidates)
+    {
+        candidates.clear();
+        if(!group.check(key))
+        {
+            candidates.push_back(defaultValue);
+            return true;
+        }
+
+        yarp::os::Value value = group.find(key);
+        if(!value.isList())
+        {
+            candidates.push_back(value.asDouble());
+            return true;
+        }
+
+        yarp::os::Bottle* list = value.asList();
+        if(list->size() == 0)
+        {
+            yError() << "[getCandidates] The list " << key << " is empty.";
+            return false;
+        }
+
+        for(int i = 0; i < list->size(); i++)
+            candidates.push_back(list->get(i).asDouble());
+        return true;
+    }
+
+    /**
+     * Infinity norm of the violation of the constraints l <= Ax <= u (and of the bounds of the variables).
+     */
+    double constraintViolation(const QPProblem& problem, const Eigen::VectorXd& solution)
+    {
+        Eigen::VectorXd constraints = problem.constraintsMatrix * solution;
+        Eigen::VectorXd violation = (constraints - problem.upperBound).cwiseMax(problem.lowerBound - constraints);
+        double maxViolation = violation.size() > 0 ? violation.maxCoeff() : 0.0;
+        if(problem.hasVariableBounds)
+        {
+            violation = (solution - problem.upperVariableBound).cwiseMax(problem.lowerVariableBound - solution);
+            maxViolation = std::max(maxViolation, violation.maxCoeff());
+        }
+        return std::max(maxViolation, 0.0);
+    }
+
+    /**
+     * Store the bounds of the variables as additional rows of the constraints (osqp has no bounds).
+     * The multipliers of the checkpoint are moved after the ones of the constraints.
+     */
+    void foldVariableBounds(QPProblem& problem)
+    {
+        int numberOfVariables = problem.hessian.rows();
+        int numberOfConstraints = problem.constraintsMatrix.rows();
+
+        Eigen::SparseMatrix<double> constraintsMatrix(numberOfConstraints + numberOfVariables, numberOfVariables);
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(problem.constraintsMatrix.nonZeros() + numberOfVariables);
+        for(int k = 0; k < problem.constraintsMatrix.outerSize(); k++)
+            for(Eigen::SparseMatrix<double>::InnerIterator it(problem.constraintsMatrix, k); it; ++it)
+                triplets.emplace_back(it.row(), it.col(), it.value());
+        for(int i = 0; i < numberOfVariables; i++)
+            triplets.emplace_back(numberOfConstraints + i, i, 1.0);
+        constraintsMatrix.setFromTriplets(triplets.begin(), triplets.end());
+        problem.constraintsMatrix = std::move(constraintsMatrix);
+
+        Eigen::VectorXd lowerBound(numberOfConstraints + numberOfVariables);
+        lowerBound << problem.lowerBound, problem.lowerVariableBound;
+        problem.lowerBound = std::move(lowerBound);
+        Eigen::VectorXd upperBound(numberOfConstraints + numberOfVariables);
+        upperBound << problem.upperBound, problem.upperVariableBound;
+        problem.upperBound = std::move(upperBound);
+
+        if(problem.hasCheckpoint && problem.checkpointDual.size() == numberOfVariables + numberOfConstraints)
+        {
+            Eigen::VectorXd dual(numberOfConstraints + numberOfVariables);
+            dual << problem.checkpointDual.tail(numberOfConstraints), problem.checkpointDual.head(numberOfVariables);
+            problem.checkpointDual = std::move(dual);
+        }
+        problem.hasVariableBounds = false;
+    }
+
+    bool isEqual(const Eigen::SparseMatrix<double>& a, const Eigen::SparseMatrix<double>& b)
+    {
+        if(a.rows() != b.rows() || a.cols() != b.cols() || a.nonZeros() != b.nonZeros())
+            return false;
+
+        return (a - b).norm() == 0;
+    }
+}
+
+bool SolverAutotuner::configure(yarp::os::ResourceFinder& rf)
+{
+    m_backend = rf.check("backend", yarp::os::Value("osqp")).asString();
+    if(m_backend != "osqp" && m_backend != "qpOASES")
+    {
+        yError() << "[configure] The backend has to be osqp or qpOASES.";
+        return false;
+    }
+
+    if(!rf.check("problems_file"))
+    {
+        yError() << "[configure] Unable to find the problems_file.";
+        return false;
+    }
+    m_problemsFile = rf.find("problems_file").asString();
+
+    m_outputFile = rf.check("output_file", yarp::os::Value("solverSettings.ini")).asString();
+
+    m_numberOfThreads = rf.check("threads",
+                                 yarp::os::Value(static_cast<int>(std::thread::hardware_concurrency()))).asInt();
+    m_numberOfThreads = std::max(m_numberOfThreads, 1);
+
+    // by default the sequence is split in a shard for each thread
+    m_numberOfShards = rf.check("shards", yarp::os::Value(m_numberOfThreads)).asInt();
+    m_numberOfShards = std::max(m_numberOfShards, 1);
+
+    m_maxSolutionError = rf.check("max_solution_error", yarp::os::Value(1e-3)).asDouble();
+    m_maxConstraintViolation = rf.check("max_constraint_violation", yarp::os::Value(1e-3)).asDouble();
+
+    if(!buildGrid(rf))
+    {
+        yError() << "[configure] Unable to build the grid of the settings.";
+        return false;
+    }
+
+    if(!loadProblems())
+    {
+        yError() << "[configure] Unable to load the problems.";
+        return false;
+    }
+
+    return true;
+}
+
+bool SolverAutotuner::buildGrid(yarp::os::ResourceFinder& rf)
+{
+    m_candidates.clear();
+
+    if(m_backend == "osqp")
+    {
+        yarp::os::Bottle& grid = rf.findGroup("OSQP_GRID");
+        OsqpSettings defaults;
+        std::vector<double> rho, sigma, alpha, adaptiveRho, polish, epsAbs, epsRel, maxIter;
+        if(!getCandidates(grid, "rho", defaults.rho, rho)
+           || !getCandidates(grid, "sigma", defaults.sigma, sigma)
+           || !getCandidates(grid, "alpha", defaults.alpha, alpha)
+           || !getCandidates(grid, "adaptive_rho", static_cast<double>(defaults.adaptiveRho), adaptiveRho)
+           || !getCandidates(grid, "polish", static_cast<double>(defaults.polish), polish)
+           || !getCandidates(grid, "eps_abs", defaults.absoluteTolerance, epsAbs)
+           || !getCandidates(grid, "eps_rel", defaults.relativeTolerance, epsRel)
+           || !getCandidates(grid, "max_iter", static_cast<double>(defaults.maxIterations), maxIter))
+            return false;
+
+        for(double r : rho)
+            for(double s : sigma)
+                for(double a : alpha)
+                    for(double ar : adaptiveRho)
+                        for(double p : polish)
+                            for(double ea : epsAbs)
+                                for(double er : epsRel)
+                                    for(double mi : maxIter)
+                                    {
+                                        SolverBenchmark candidate;
+                                        candidate.osqpSettings.rho = r;
+                                        candidate.osqpSettings.sigma = s;
+                                        candidate.osqpSettings.alpha = a;
+                                        candidate.osqpSettings.adaptiveRho = ar != 0;
+                                        candidate.osqpSettings.polish = p != 0;
+                                        candidate.osqpSettings.absoluteTolerance = ea;
+                                        candidate.osqpSettings.relativeTolerance = er;
+                                        candidate.osqpSettings.maxIterations = mi;
+                                        m_candidates.push_back(candidate);
+                                    }
+    }
+    else
+    {
+        yarp::os::Bottle& grid = rf.findGroup("QPOASES_GRID");
+        std::vector<std::string> presets;
+        yarp::os::Value presetValue = grid.check("preset", yarp::os::Value("default"));
+        if(presetValue.isList())
+        {
+            for(int i = 0; i < presetValue.asList()->size(); i++)
+                presets.push_back(presetValue.asList()->get(i).asString());
+        }
+        else
+            presets.push_back(presetValue.asString());
+
+        std::vector<double> nWSR;
+        if(!getCandidates(grid, "nWSR", 100.0, nWSR))
+            return false;
+
+        for(const auto& preset : presets)
+            for(double n : nWSR)
+            {
+                SolverBenchmark candidate;
+                candidate.qpOASESSettings.preset = preset;
+                candidate.qpOASESSettings.maxWorkingSetRecalculations = n;
+                m_candidates.push_back(candidate);
+            }
+    }
+
+    yInfo() << "[buildGrid] Number of candidate settings: " << m_candidates.size();
+    return !m_candidates.empty();
+}
+
+bool SolverAutotuner::loadProblems()
+{
+    QPProblemReader reader;
+    if(!reader.open(m_problemsFile))
+        return false;
+
+    // only the current and the previous problem are kept in memory. The matrices that did not
+    // change are not updated during the replay (as in the controller)
+    m_numberOfProblems = 0;
+    m_isHessianChanged.clear();
+    m_isConstraintsMatrixChanged.clear();
+    std::vector<QPStartPoint> startPoints;
+    QPProblem problem, previousProblem;
+    QPStartPoint point;
+    point.offset = reader.tell();
+    while(reader.read(problem))
+    {
+        bool isNewSolver = m_numberOfProblems == 0 || problem.isStructureChanged;
+        m_isHessianChanged.push_back(isNewSolver || !isEqual(problem.hessian, previousProblem.hessian));
+        m_isConstraintsMatrixChanged.push_back(isNewSolver ||
+            !isEqual(problem.constraintsMatrix, previousProblem.constraintsMatrix));
+
+        if(isNewSolver || problem.hasCheckpoint)
+        {
+            point.index = m_numberOfProblems;
+            startPoints.push_back(point);
+        }
+
+        std::swap(problem, previousProblem);
+        m_numberOfProblems++;
+        point.offset = reader.tell();
+    }
+
+    if(m_numberOfProblems == 0)
+    {
+        yError() << "[loadProblems] No problem found in " << m_problemsFile;
+        return false;
+    }
+
+    yInfo() << "[loadProblems] Number of problems: " << m_numberOfProblems;
+
+    buildShards(startPoints);
+    return true;
+}
+
+void SolverAutotuner::buildShards(const std::vector<QPStartPoint>& startPoints)
+{
+    m_shards.clear();
+
+    // the first problem is always a start point
+    int targetLength = (m_numberOfProblems + m_numberOfShards - 1) / m_numberOfShards;
+    QPShard shard;
+    shard.offset = startPoints.front().offset;
+    for(const auto& point : startPoints)
+    {
+        if(point.index - shard.begin >= targetLength)
+        {
+            shard.end = point.index;
+            m_shards.push_back(shard);
+            shard.begin = point.index;
+            shard.offset = point.offset;
+        }
+    }
+    shard.end = m_numberOfProblems;
+    m_shards.push_back(shard);
+
+    yInfo() << "[buildShards] Number of shards: " << m_shards.size();
+}
+
+void SolverAutotuner::replayOsqp(const SolverBenchmark& benchmark, const QPShard& shard,
+                                 ShardResult& result, std::vector<Eigen::VectorXd>* solutions)
+{
+    result = ShardResult();
+    result.solveTimes.reserve(shard.end - shard.begin);
+
+    QPProblemReader reader;
+    if(!reader.open(m_problemsFile) || !reader.seek(shard.offset))
+    {
+        result.failures = shard.end - shard.begin;
+        return;
+    }
+
+    std::unique_ptr<OsqpEigen::Solver> solver;
+    QPProblem problem;
+    Eigen::VectorXd gradient, lowerBound, upperBound;
+
+    for(int i = shard.begin; i < shard.end; i++)
+    {
+        if(!reader.read(problem))
+        {
+            yError() << "[replayOsqp] Unable to read the problem " << i;
+            result.failures += shard.end - i;
+            return;
+        }
+        if(problem.hasVariableBounds)
+            foldVariableBounds(problem);
+
+        gradient = problem.gradient;
+        lowerBound = problem.lowerBound;
+        upperBound = problem.upperBound;
+        bool isNewSolver = solver == nullptr || problem.isStructureChanged;
+
+        // the checkpoint restores the warm start of the solver used in the controller
+        bool useCheckpoint = isNewSolver && !problem.isStructureChanged && problem.hasCheckpoint
+            && problem.checkpointPrimal.size() == problem.hessian.rows()
+            && problem.checkpointDual.size() == problem.constraintsMatrix.rows();
+
+        // the solver created by the replay (at the beginning of the shard or after a failure)
+        // is not created by the controller, so its setup is not timed
+        bool isReplaySetup = isNewSolver && !problem.isStructureChanged;
+
+        auto initTime = std::chrono::steady_clock::now();
+        bool isSolved = true;
+        if(isNewSolver)
+        {
+            solver = std::make_unique<OsqpEigen::Solver>();
+            solver->settings()->setVerbosity(false);
+            SolverSettings::applyOsqpSettings(benchmark.osqpSettings, *solver);
+            solver->data()->setNumberOfVariables(problem.hessian.rows());
+            solver->data()->setNumberOfConstraints(problem.constraintsMatrix.rows());
+            Eigen::SparseMatrix<double> hessian = problem.hessian;
+            Eigen::SparseMatrix<double> constraintsMatrix = problem.constraintsMatrix;
+            isSolved = solver->data()->setHessianMatrix(hessian)
+                && solver->data()->setGradient(gradient)
+                && solver->data()->setLinearConstraintsMatrix(constraintsMatrix)
+                && solver->data()->setLowerBound(lowerBound)
+                && solver->data()->setUpperBound(upperBound)
+                && solver->initSolver();
+            if(useCheckpoint)
+                isSolved = isSolved && solver->setWarmStart(problem.checkpointPrimal, problem.checkpointDual);
+            if(isReplaySetup)
+                initTime = std::chrono::steady_clock::now();
+        }
+        else
+        {
+            if(m_isHessianChanged[i])
+                isSolved = isSolved && solver->updateHessianMatrix(problem.hessian);
+            if(m_isConstraintsMatrixChanged[i])
+                isSolved = isSolved && solver->updateLinearConstraintsMatrix(problem.constraintsMatrix);
+            isSolved = isSolved && solver->updateGradient(gradient)
+                && solver->updateBounds(lowerBound, upperBound);
+        }
+        isSolved = isSolved && solver->solve();
+        auto endTime = std::chrono::steady_clock::now();
+
+        isSolved = isSolved && solver->workspace()->info->status_val == OSQP_SOLVED;
+        if(!isSolved)
+        {
+            result.failures++;
+            solver.reset();
+            continue;
+        }
+
+        result.solveTimes.push_back(std::chrono::duration<double>(endTime - initTime).count());
+        evaluateSolution(i, problem, solver->getSolution(), result);
+        if(solutions != nullptr)
+            (*solutions)[i] = solver->getSolution();
+    }
+}
+
+void SolverAutotuner::replayQpOASES(const SolverBenchmark& benchmark, const QPShard& shard,
+                                    ShardResult& result, std::vector<Eigen::VectorXd>* solutions)
+{
+    result = ShardResult();
+    result.solveTimes.reserve(shard.end - shard.begin);
+
+    QPProblemReader reader;
+    if(!reader.open(m_problemsFile) || !reader.seek(shard.offset))
+    {
+        result.failures = shard.end - shard.begin;
+        return;
+    }
+
+    std::unique_ptr<qpOASES::SQProblem> solver;
+    QPProblem problem;
+    MatrixXdRowMajor hessian, constraintsMatrix;
+    Eigen::VectorXd checkpointDual;
+
+    for(int i = shard.begin; i < shard.end; i++)
+    {
+        if(!reader.read(problem))
+        {
+            yError() << "[replayQpOASES] Unable to read the problem " << i;
+            result.failures += shard.end - i;
+            return;
+        }
+
+        int numberOfVariables = problem.hessian.rows();
+        int numberOfConstraints = problem.constraintsMatrix.rows();
+
+        // qpOASES requires dense row major matrices
+        hessian = MatrixXdRowMajor(problem.hessian);
+        constraintsMatrix = MatrixXdRowMajor(problem.constraintsMatrix);
+        bool isNewSolver = solver == nullptr || problem.isStructureChanged;
+
+        // the checkpoint is used as initial guess. If the problem has no bounds the
+        // multipliers of the bounds (stored before the ones of the constraints) are zero
+        int numberOfBoundMultipliers = problem.hasVariableBounds ? numberOfVariables : 0;
+        bool useCheckpoint = isNewSolver && !problem.isStructureChanged && problem.hasCheckpoint
+            && problem.checkpointPrimal.size() == numberOfVariables
+            && problem.checkpointDual.size() == numberOfBoundMultipliers + numberOfConstraints;
+        if(useCheckpoint)
+        {
+            checkpointDual.resize(numberOfVariables + numberOfConstraints);
+            if(problem.hasVariableBounds)
+                checkpointDual = problem.checkpointDual;
+            else
+                checkpointDual << Eigen::VectorXd::Zero(numberOfVariables), problem.checkpointDual;
+        }
+
+        // the joint limits of the QP-IK are the bounds of the variables, as in the controller
+        const double* lowerVariableBound = problem.hasVariableBounds ? problem.lowerVariableBound.data() : nullptr;
+        const double* upperVariableBound = problem.hasVariableBounds ? problem.upperVariableBound.data() : nullptr;
+
+        // init() sets up and solves the problem together, so the time of a solver created by
+        // the replay (at the beginning of the shard or after a failure) is not sampled
+        bool isReplaySetup = isNewSolver && !problem.isStructureChanged;
+
+        int nWSR = benchmark.qpOASESSettings.maxWorkingSetRecalculations;
+        qpOASES::returnValue status;
+
+        auto initTime = std::chrono::steady_clock::now();
+        if(isNewSolver)
+        {
+            solver = std::make_unique<qpOASES::SQProblem>(numberOfVariables, numberOfConstraints);
+            solver->setPrintLevel(qpOASES::PL_NONE);
+            SolverSettings::applyQpOASESSettings(benchmark.qpOASESSettings, *solver);
+            status = solver->init(hessian.data(), problem.gradient.data(), constraintsMatrix.data(),
+                                  lowerVariableBound, upperVariableBound,
+                                  problem.lowerBound.data(), problem.upperBound.data(), nWSR, 0,
+                                  useCheckpoint ? problem.checkpointPrimal.data() : nullptr,
+                                  useCheckpoint ? checkpointDual.data() : nullptr);
+        }
+        else
+            status = solver->hotstart(hessian.data(), problem.gradient.data(), constraintsMatrix.data(),
+                                      lowerVariableBound, upperVariableBound,
+                                      problem.lowerBound.data(), problem.upperBound.data(), nWSR, 0);
+        auto endTime = std::chrono::steady_clock::now();
+
+        if(status != qpOASES::SUCCESSFUL_RETURN)
+        {
+            result.failures++;
+            solver.reset();
+            continue;
+        }
+
+        Eigen::VectorXd solution(numberOfVariables);
+        solver->getPrimalSolution(solution.data());
+
+        if(!isReplaySetup)
+            result.solveTimes.push_back(std::chrono::duration<double>(endTime - initTime).count());
+        evaluateSolution(i, problem, solution, result);
+        if(solutions != nullptr)
+            (*solutions)[i] = solution;
+    }
+}
+
+void SolverAutotuner::evaluateSolution(const int& index, const QPProblem& problem,
+                                       const Eigen::VectorXd& solution, ShardResult& result)
+{
+    if(m_referenceSolutions.empty())
+        return;
+
+    result.maxSolutionError = std::max(result.maxSolutionError,
+                                       (solution - m_referenceSolutions[index]).lpNorm<Eigen::Infinity>());
+    result.maxConstraintViolation = std::max(result.maxConstraintViolation,
+                                             constraintViolation(problem, solution));
+}
+
+void SolverAutotuner::evaluateBenchmark(const std::vector<ShardResult>& results,
+                                        SolverBenchmark& benchmark)
+{
+    std::vector<double> solveTimes;
+    benchmark.failures = 0;
+    benchmark.maxSolutionError = 0;
+    benchmark.maxConstraintViolation = 0;
+    for(const auto& result : results)
+    {
+        solveTimes.insert(solveTimes.end(), result.solveTimes.begin(), result.solveTimes.end());
+        benchmark.failures += result.failures;
+        benchmark.maxSolutionError = std::max(benchmark.maxSolutionError, result.maxSolutionError);
+        benchmark.maxConstraintViolation = std::max(benchmark.maxConstraintViolation,
+                                                    result.maxConstraintViolation);
+    }
+
+    if(!solveTimes.empty())
+    {
+        std::sort(solveTimes.begin(), solveTimes.end());
+        benchmark.medianTime = solveTimes[solveTimes.size() / 2];
+        benchmark.p99Time = solveTimes[std::min(solveTimes.size() - 1,
+                                                static_cast<size_t>(0.99 * solveTimes.size()))];
+        benchmark.maxTime = solveTimes.back();
+    }
+
+    benchmark.isAccurate = benchmark.failures == 0
+        && benchmark.maxSolutionError <= m_maxSolutionError
+        && benchmark.maxConstraintViolation <= m_maxConstraintViolation;
+}
+
+void SolverAutotuner::runTasks(const int& numberOfTasks, const std::function<void(int)>& task)
+{
+    std::atomic<int> nextTask(0);
+    auto worker = [&nextTask, &numberOfTasks, &task]()
+        {
+            int index;
+            while((index = nextTask++) < numberOfTasks)
+                task(index);
+        };
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < std::min(m_numberOfThreads, numberOfTasks); i++)
+        threads.emplace_back(worker);
+
+    for(auto& thread : threads)
+        thread.join();
+}
+
+bool SolverAutotuner::run()
+{
+    // the reference solutions are evaluated with tight tolerances
+    SolverBenchmark reference;
+    reference.osqpSettings.absoluteTolerance = 1e-8;
+    reference.osqpSettings.relativeTolerance = 1e-8;
+    reference.osqpSettings.maxIterations = 100000;
+    reference.osqpSettings.polish = true;
+    reference.qpOASESSettings.preset = "reliable";
+    reference.qpOASESSettings.maxWorkingSetRecalculations = 10000;
+
+    int numberOfShards = m_shards.size();
+    auto replay = [this](const SolverBenchmark& benchmark, const QPShard& shard, ShardResult& result,
+                         std::vector<Eigen::VectorXd>* solutions)
+        {
+            if(m_backend == "osqp")
+                replayOsqp(benchmark, shard, result, solutions);
+            else
+                replayQpOASES(benchmark, shard, result, solutions);
+        };
+
+    // the shards of the reference replay are evaluated in parallel
+    auto initTime = std::chrono::steady_clock::now();
+    std::vector<Eigen::VectorXd> referenceSolutions(m_numberOfProblems);
+    std::vector<ShardResult> referenceResults(numberOfShards);
+    runTasks(numberOfShards, [&](int shard)
+             {
+                 replay(reference, m_shards[shard], referenceResults[shard], &referenceSolutions);
+             });
+    evaluateBenchmark(referenceResults, reference);
+
+    if(reference.failures != 0)
+    {
+        yError() << "[run] Unable to evaluate the reference solution of "
+                 << reference.failures << " problems.";
+        return false;
+    }
+    m_referenceSolutions = std::move(referenceSolutions);
+
+    // each task replays a shard with a candidate, the results are merged per candidate
+    std::vector<std::vector<ShardResult>> results(m_candidates.size(),
+                                                  std::vector<ShardResult>(numberOfShards));
+    runTasks(m_candidates.size() * numberOfShards, [&](int task)
+             {
+                 int candidate = task / numberOfShards;
+                 int shard = task % numberOfShards;
+                 replay(m_candidates[candidate], m_shards[shard], results[candidate][shard], nullptr);
+             });
+
+    for(int i = 0; i < m_candidates.size(); i++)
+        evaluateBenchmark(results[i], m_candidates[i]);
+
+    yInfo() << "[run]" << m_candidates.size() << "candidates replayed in" << numberOfShards
+            << "shards on" << m_numberOfThreads << "threads in"
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - initTime).count() << "s.";
+
+    // the accurate settings are ranked by the 99th percentile of the solve time
+    std::sort(m_candidates.begin(), m_candidates.end(),
+              [](const SolverBenchmark& a, const SolverBenchmark& b)
+              {
+                  if(a.isAccurate != b.isAccurate)
+                      return a.isAccurate;
+                  return a.p99Time < b.p99Time;
+              });
+
+    for(int i = 0; i < std::min(static_cast<int>(m_candidates.size()), 10); i++)
+    {
+        const SolverBenchmark& candidate = m_candidates[i];
+        yInfo() << "[run]" << i << "accurate:" << candidate.isAccurate
+                << "p50 [ms]:" << candidate.medianTime * 1e3
+                << "p99 [ms]:" << candidate.p99Time * 1e3
+                << "max [ms]:" << candidate.maxTime * 1e3
+                << "error:" << candidate.maxSolutionError
+                << "violation:" << candidate.maxConstraintViolation
+                << "failures:" << candidate.failures;
+    }
+
+    if(!m_candidates.front().isAccurate)
+    {
+        yError() << "[run] None of the candidate settings satisfies the accuracy constraints.";
+        return false;
+    }
+
+    return writeSettings(m_candidates.front());
+}
+
+bool SolverAutotuner::writeSettings(const SolverBenchmark& benchmark)
+{
+    std::ofstream stream(m_outputFile);
+    if(!stream.is_open())
+    {
+        yError() << "[writeSettings] Unable to open the file " << m_outputFile;
+        return false;
+    }
+
+    stream << "# solver settings selected by the solver autotuner from " << m_problemsFile << std::endl
+           << "# p99 solve time " << benchmark.p99Time * 1e3 << " ms, max solution error "
+           << benchmark.maxSolutionError << ", max constraint violation "
+           << benchmark.maxConstraintViolation << std::endl
+           << "# append these lines to controllerParams.ini (MPC) or to qpInverseKinematics.ini (QP-IK)"
+           << std::endl;
+
+    stream << std::setprecision(10);
+    if(m_backend == "osqp")
+    {
+        const OsqpSettings& settings = benchmark.osqpSettings;
+        stream << "osqp_rho                " << settings.rho << std::endl
+               << "osqp_sigma              " << settings.sigma << std::endl
+               << "osqp_alpha              " << settings.alpha << std::endl
+               << "osqp_adaptive_rho       " << settings.adaptiveRho << std::endl
+               << "osqp_polish             " << settings.polish << std::endl
+               << "osqp_eps_abs            " << settings.absoluteTolerance << std::endl
+               << "osqp_eps_rel            " << settings.relativeTolerance << std::endl
+               << "osqp_max_iter           " << settings.maxIterations << std::endl;
+    }
+    else
+    {
+        const QpOASESSettings& settings = benchmark.qpOASESSettings;
+        stream << "qpoases_preset          " << settings.preset << std::endl
+               << "qpoases_nWSR            " << settings.maxWorkingSetRecalculations << std::endl;
+    }
+
+    yInfo() << "[writeSettings] The settings are saved in " << m_outputFile;
+    return true;
+}
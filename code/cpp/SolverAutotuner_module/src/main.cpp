@@ -0,0 +1,39 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include "SolverAutotuner.hpp"
+
+int main(int argc, char * argv[])
+{
+    // the autotuner works offline, the YARP network is not required
+    yarp::os::ResourceFinder &rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+
+    rf.setDefaultConfigFile("solverAutotuner.ini");
+    rf.setDefaultContext("dcmWalkingSolverAutotuner");
+
+    rf.configure(argc, argv);
+
+    SolverAutotuner autotuner;
+    if(!autotuner.configure(rf))
+    {
+        yError() << "[main] Unable to configure the solver autotuner.";
+        return EXIT_FAILURE;
+    }
+
+    if(!autotuner.run())
+    {
+        yError() << "[main] Unable to tune the solver settings.";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file TransportBenchmark.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef TRANSPORT_BENCHMARK_HPP
+#define TRANSPORT_BENCHMARK_HPP
+
+// std
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/sig/Vector.h>
+
+/**
+ * Result of the benchmark of a carrier with a given payload.
+ */
+struct TransportResult
+{
+    std::string carrier; /**< Name of the carrier. */
+    int payloadSize{0}; /**< Number of doubles of the payload. */
+    bool isAvailable{false}; /**< False if the ports cannot be connected with the carrier. */
+
+    double oneWayMedian{0.0}; /**< Median one-way latency [s]. */
+    double oneWayP99{0.0}; /**< 99th percentile of the one-way latency [s]. */
+    double roundTripMedian{0.0}; /**< Median round-trip latency [s]. */
+    double roundTripP99{0.0}; /**< 99th percentile of the round-trip latency [s]. */
+    double roundTripMax{0.0}; /**< Maximum round-trip latency [s]. */
+    int lost{0}; /**< Number of messages without an answer within the timeout. */
+
+    double throughput{0.0}; /**< Number of messages received per second. */
+    double bandwidth{0.0}; /**< Payload received per second [MB/s]. */
+    int burstReceived{0}; /**< Number of messages of the burst that were received. */
+};
+
+/**
+ * Port that records the one-way latency of the received messages and (optionally) sends them back.
+ * Each message contains the sequence number and the send time followed by the payload.
+ */
+class EchoPort : public yarp::os::BufferedPort<yarp::sig::Vector>
+{
+    std::mutex m_mutex; /**< Mutex. */
+    std::vector<double> m_oneWayLatencies; /**< One-way latency of the received messages. */
+    std::atomic<int> m_received{0}; /**< Number of received messages. */
+    std::atomic<bool> m_isEchoEnabled{true}; /**< True if the messages are sent back. */
+    yarp::os::BufferedPort<yarp::sig::Vector>* m_pongPort{nullptr}; /**< Port used to send back the messages. */
+
+public:
+
+    using yarp::os::BufferedPort<yarp::sig::Vector>::onRead;
+
+    /**
+     * Callback of the port.
+     * @param message received message.
+     */
+    void onRead(yarp::sig::Vector& message) override;
+
+    /**
+     * Reset the counters.
+     * @param isEchoEnabled true if the messages have to be sent back;
+     * @param pongPort port used to send back the messages.
+     */
+    void reset(const bool& isEchoEnabled, yarp::os::BufferedPort<yarp::sig::Vector>* pongPort);
+
+    /**
+     * Get the number of received messages.
+     * @return number of received messages.
+     */
+    int getReceived() const;
+
+    /**
+     * Get the one-way latencies.
+     * @return the one-way latencies.
+     */
+    std::vector<double> getOneWayLatencies();
+};
+
+/**
+ * TransportBenchmark class measures latency and throughput of the YARP carriers with the
+ * payloads exchanged by the walking modules (e.g. 6-D wrenches and telemetry vectors).
+ * The ports are opened in the same process, so the one-way latency is measured with a single
+ * clock. The round trip uses two links with the same carrier (ping and pong).
+ */
+class TransportBenchmark
+{
+    std::vector<std::string> m_carriers; /**< Carriers under test. */
+    std::vector<int> m_payloadSizes; /**< Payload sizes under test (number of doubles). */
+    int m_numberOfSamples; /**< Number of round trips of the latency test. */
+    int m_burstSize; /**< Number of messages of the throughput test. */
+    double m_timeout; /**< Timeout of a round trip [s]. */
+    double m_period; /**< Delay between two round trips [s]. */
+    std::string m_outputFile; /**< File where the results are saved. */
+
+    yarp::os::BufferedPort<yarp::sig::Vector> m_pingPort; /**< Ping output port. */
+    EchoPort m_echoPort; /**< Ping input port (it sends the pong). */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_pongOutputPort; /**< Pong output port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_pongPort; /**< Pong input port. */
+
+    std::vector<TransportResult> m_results; /**< Results. */
+
+    /**
+     * Connect the ports with a carrier.
+     * @param carrier name of the carrier.
+     * @return true/false in case of success/failure.
+     */
+    bool connect(const std::string& carrier);
+
+    /**
+     * Disconnect the ports.
+     */
+    void disconnect();
+
+    /**
+     * Measure the one-way and round-trip latencies.
+     * @param result result of the benchmark.
+     */
+    void measureLatency(TransportResult& result);
+
+    /**
+     * Measure the throughput.
+     * @param result result of the benchmark.
+     */
+    void measureThroughput(TransportResult& result);
+
+    /**
+     * Save the results.
+     * @return true/false in case of success/failure.
+     */
+    bool writeResults();
+
+public:
+
+    /**
+     * Configure the benchmark and open the ports.
+     * @param rf is the reference to a resource finder object.
+     * @return true/false in case of success/failure.
+     */
+    bool configure(yarp::os::ResourceFinder& rf);
+
+    /**
+     * Evaluate all the carriers with all the payloads.
+     * @return true/false in case of success/failure.
+     */
+    bool run();
+
+    /**
+     * Close the ports.
+     */
+    void close();
+};
+
+#endif
@@ -0,0 +1,311 @@
+/**
+ * @file TransportBenchmark.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+
+#include "TransportBenchmark.hpp"
+
+namespace
+{
+    const std::string pingOutputPortName = "/transportBenchmark/ping:o";
+    const std::string pingInputPortName = "/transportBenchmark/ping:i";
+    const std::string pongOutputPortName = "/transportBenchmark/pong:o";
+    const std::string pongInputPortName = "/transportBenchmark/pong:i";
+
+    /**
+     * Median and 99th percentile of a set of samples.
+     */
+    void percentiles(std::vector<double>& samples, double& median, double& p99)
+    {
+        if(samples.empty())
+            return;
+
+        std::sort(samples.begin(), samples.end());
+        median = samples[samples.size() / 2];
+        p99 = samples[std::min(samples.size() - 1, static_cast<size_t>(0.99 * samples.size()))];
+    }
+}
+
+void EchoPort::onRead(yarp::sig::Vector& message)
+{
+    double now = yarp::os::Time::now();
+    if(message.size() < 2)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_oneWayLatencies.push_back(now - message[1]);
+    }
+    m_received++;
+
+    if(m_isEchoEnabled && m_pongPort != nullptr)
+    {
+        yarp::sig::Vector& pong = m_pongPort->prepare();
+        pong = message;
+        m_pongPort->write();
+    }
+}
+
+void EchoPort::reset(const bool& isEchoEnabled, yarp::os::BufferedPort<yarp::sig::Vector>* pongPort)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_oneWayLatencies.clear();
+    m_received = 0;
+    m_isEchoEnabled = isEchoEnabled;
+    m_pongPort = pongPort;
+}
+
+int EchoPort::getReceived() const
+{
+    return m_received;
+}
+
+std::vector<double> EchoPort::getOneWayLatencies()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_oneWayLatencies;
+}
+
+bool TransportBenchmark::configure(yarp::os::ResourceFinder& rf)
+{
+    yarp::os::Value carriers = rf.check("carriers", yarp::os::Value("tcp"));
+    if(carriers.isList())
+    {
+        for(int i = 0; i < carriers.asList()->size(); i++)
+            m_carriers.push_back(carriers.asList()->get(i).asString());
+    }
+    else
+        m_carriers.push_back(carriers.asString());
+
+    yarp::os::Value payloadSizes = rf.check("payload_sizes", yarp::os::Value(6));
+    if(payloadSizes.isList())
+    {
+        for(int i = 0; i < payloadSizes.asList()->size(); i++)
+            m_payloadSizes.push_back(payloadSizes.asList()->get(i).asInt());
+    }
+    else
+        m_payloadSizes.push_back(payloadSizes.asInt());
+
+    if(m_carriers.empty() || m_payloadSizes.empty())
+    {
+        yError() << "[configure] The lists of the carriers and of the payload sizes cannot be empty.";
+        return false;
+    }
+
+    m_numberOfSamples = rf.check("samples", yarp::os::Value(1000)).asInt();
+    m_burstSize = rf.check("burst_size", yarp::os::Value(10000)).asInt();
+    m_timeout = rf.check("timeout", yarp::os::Value(0.1)).asDouble();
+    m_period = rf.check("period", yarp::os::Value(0.001)).asDouble();
+    m_outputFile = rf.check("output_file", yarp::os::Value("transportBenchmark.txt")).asString();
+
+    if(m_numberOfSamples <= 0 || m_burstSize <= 0 || m_timeout <= 0)
+    {
+        yError() << "[configure] samples, burst_size and timeout have to be positive.";
+        return false;
+    }
+
+    // the pong port keeps all the messages, the ping port stores them in the callback
+    m_pongPort.setStrict();
+    m_echoPort.setStrict();
+    m_echoPort.useCallback();
+
+    if(!m_pingPort.open(pingOutputPortName) || !m_echoPort.open(pingInputPortName)
+       || !m_pongOutputPort.open(pongOutputPortName) || !m_pongPort.open(pongInputPortName))
+    {
+        yError() << "[configure] Unable to open the ports.";
+        return false;
+    }
+
+    return true;
+}
+
+bool TransportBenchmark::connect(const std::string& carrier)
+{
+    if(!yarp::os::Network::connect(pingOutputPortName, pingInputPortName, carrier))
+        return false;
+
+    if(!yarp::os::Network::connect(pongOutputPortName, pongInputPortName, carrier))
+    {
+        disconnect();
+        return false;
+    }
+
+    return true;
+}
+
+void TransportBenchmark::disconnect()
+{
+    yarp::os::Network::disconnect(pingOutputPortName, pingInputPortName);
+    yarp::os::Network::disconnect(pongOutputPortName, pongInputPortName);
+}
+
+void TransportBenchmark::measureLatency(TransportResult& result)
+{
+    m_echoPort.reset(true, &m_pongOutputPort);
+
+    std::vector<double> roundTrips;
+    roundTrips.reserve(m_numberOfSamples);
+    for(int i = 0; i < m_numberOfSamples; i++)
+    {
+        double sendTime = yarp::os::Time::now();
+        yarp::sig::Vector& ping = m_pingPort.prepare();
+        ping.resize(result.payloadSize + 2, 0.0);
+        ping[0] = i;
+        ping[1] = sendTime;
+        m_pingPort.write();
+
+        // wait for the answer (the messages of the previous round trips are discarded)
+        bool isReceived = false;
+        while(!isReceived && yarp::os::Time::now() - sendTime < m_timeout)
+        {
+            yarp::sig::Vector* pong = m_pongPort.read(false);
+            if(pong == nullptr)
+                std::this_thread::yield();
+            else if(static_cast<int>((*pong)[0]) == i)
+                isReceived = true;
+        }
+
+        if(isReceived)
+            roundTrips.push_back(yarp::os::Time::now() - sendTime);
+        else
+            result.lost++;
+
+        yarp::os::Time::delay(m_period);
+    }
+
+    std::vector<double> oneWay = m_echoPort.getOneWayLatencies();
+    percentiles(oneWay, result.oneWayMedian, result.oneWayP99);
+    percentiles(roundTrips, result.roundTripMedian, result.roundTripP99);
+    if(!roundTrips.empty())
+        result.roundTripMax = roundTrips.back();
+}
+
+void TransportBenchmark::measureThroughput(TransportResult& result)
+{
+    m_echoPort.reset(false, nullptr);
+
+    double initTime = yarp::os::Time::now();
+    for(int i = 0; i < m_burstSize; i++)
+    {
+        yarp::sig::Vector& message = m_pingPort.prepare();
+        message.resize(result.payloadSize + 2, 0.0);
+        message[0] = i;
+        message[1] = yarp::os::Time::now();
+
+        // the writer waits for the previous message, nothing is dropped by the sender
+        m_pingPort.writeStrict();
+    }
+
+    // wait for the last messages (a lossy carrier may never deliver the whole burst)
+    double lastReceiveTime = yarp::os::Time::now();
+    int received = m_echoPort.getReceived();
+    while(received < m_burstSize && yarp::os::Time::now() - lastReceiveTime < m_timeout)
+    {
+        yarp::os::Time::delay(0.001);
+        int newReceived = m_echoPort.getReceived();
+        if(newReceived != received)
+        {
+            received = newReceived;
+            lastReceiveTime = yarp::os::Time::now();
+        }
+    }
+
+    double duration = lastReceiveTime - initTime;
+    result.burstReceived = received;
+    if(duration > 0)
+    {
+        result.throughput = received / duration;
+        result.bandwidth = result.throughput * (result.payloadSize + 2) * sizeof(double) * 1e-6;
+    }
+}
+
+bool TransportBenchmark::run()
+{
+    for(const auto& carrier : m_carriers)
+    {
+        for(const auto& payloadSize : m_payloadSizes)
+        {
+            TransportResult result;
+            result.carrier = carrier;
+            result.payloadSize = payloadSize;
+
+            if(!connect(carrier))
+            {
+                yWarning() << "[run] Unable to connect the ports with the carrier" << carrier;
+                m_results.push_back(result);
+                continue;
+            }
+            result.isAvailable = true;
+
+            measureLatency(result);
+            measureThroughput(result);
+            disconnect();
+
+            yInfo() << "[run]" << carrier << "payload:" << payloadSize
+                    << "one-way p50 [ms]:" << result.oneWayMedian * 1e3
+                    << "p99 [ms]:" << result.oneWayP99 * 1e3
+                    << "round-trip p50 [ms]:" << result.roundTripMedian * 1e3
+                    << "p99 [ms]:" << result.roundTripP99 * 1e3
+                    << "max [ms]:" << result.roundTripMax * 1e3
+                    << "lost:" << result.lost
+                    << "throughput [msg/s]:" << result.throughput
+                    << "[MB/s]:" << result.bandwidth
+                    << "received:" << result.burstReceived << "/" << m_burstSize;
+
+            m_results.push_back(result);
+        }
+    }
+
+    return writeResults();
+}
+
+bool TransportBenchmark::writeResults()
+{
+    std::ofstream stream(m_outputFile);
+    if(!stream.is_open())
+    {
+        yError() << "[writeResults] Unable to open the file " << m_outputFile;
+        return false;
+    }
+
+    stream << "carrier payload available one_way_p50_ms one_way_p99_ms round_trip_p50_ms "
+           << "round_trip_p99_ms round_trip_max_ms lost throughput_msg_s bandwidth_MB_s burst_received"
+           << std::endl;
+
+    for(const auto& result : m_results)
+    {
+        stream << result.carrier << " " << result.payloadSize << " " << result.isAvailable << " "
+               << result.oneWayMedian * 1e3 << " " << result.oneWayP99 * 1e3 << " "
+               << result.roundTripMedian * 1e3 << " " << result.roundTripP99 * 1e3 << " "
+               << result.roundTripMax * 1e3 << " " << result.lost << " "
+               << result.throughput << " " << result.bandwidth << " " << result.burstReceived
+               << std::endl;
+    }
+
+    yInfo() << "[writeResults] The results are saved in " << m_outputFile;
+    return true;
+}
+
+void TransportBenchmark::close()
+{
+    disconnect();
+    m_pingPort.close();
+    m_echoPort.close();
+    m_pongOutputPort.close();
+    m_pongPort.close();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file main.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include "TransportBenchmark.hpp"
+
+int main(int argc, char * argv[])
+{
+    // initialise yarp network
+    yarp::os::Network yarp;
+    if (!yarp.checkNetwork())
+    {
+        yError()<<"Unable to find YARP network";
+        return EXIT_FAILURE;
+    }
+
+    // prepare and configure the resource finder
+    yarp::os::ResourceFinder &rf = yarp::os::ResourceFinder::getResourceFinderSingleton();
+
+    rf.setDefaultConfigFile("transportBenchmark.ini");
+    rf.setDefaultContext("dcmWalkingTransportBenchmark");
+
+    rf.configure(argc, argv);
+
+    TransportBenchmark benchmark;
+    if(!benchmark.configure(rf))
+    {
+        yError() << "[main] Unable to configure the transport benchmark.";
+        benchmark.close();
+        return EXIT_FAILURE;
+    }
+
+    bool ok = benchmark.run();
+    benchmark.close();
+    if(!ok)
+    {
+        yError() << "[main] Unable to run the transport benchmark.";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
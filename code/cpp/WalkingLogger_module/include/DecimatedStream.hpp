@@ -0,0 +1,79 @@
+/**
+ * @file DecimatedStream.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef DECIMATED_STREAM_HPP
+#define DECIMATED_STREAM_HPP
+
+// std
+#include <string>
+
+// YARP
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
+
+/**
+ * DecimatedStream class publishes a decimated version of the logged data for live plotting.
+ * The samples are aggregated in windows of fixed duration, at the end of each window a frame
+ * containing the minimum, the maximum and the last value of every channel is sent, so the
+ * spikes remain visible even if the rate is much lower than the one of the controller.
+ * The content of the bottle is:
+ * (time number_of_samples) (min_0 ... min_n) (max_0 ... max_n) (last_0 ... last_n).
+ * The port is not strict, a slow viewer does not slow down the logger.
+ */
+class DecimatedStream
+{
+    yarp::os::BufferedPort<yarp::os::Bottle> m_port; /**< Visualization port. */
+    double m_period{0.05}; /**< Duration of a window [s]. */
+    double m_windowInitTime{0.0}; /**< Time of the beginning of the current window [s]. */
+
+    yarp::sig::Vector m_min; /**< Minimum of each channel in the window. */
+    yarp::sig::Vector m_max; /**< Maximum of each channel in the window. */
+    yarp::sig::Vector m_last; /**< Last value of each channel. */
+    double m_lastTime{0.0}; /**< Time of the last sample. */
+    int m_numberOfSamples{0}; /**< Number of samples in the window. */
+
+public:
+
+    /**
+     * Open the port.
+     * @param config configuration of the stream;
+     * @param portPrefix prefix of the port name (e.g. /logger).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config, const std::string& portPrefix);
+
+    /**
+     * Start a new stream.
+     * @param numberOfChannels number of channels;
+     * @param time current time [s].
+     */
+    void reset(const int& numberOfChannels, const double& time);
+
+    /**
+     * Add a sample to the current window.
+     * @param time time of the sample [s];
+     * @param data vector containing the sample;
+     * @param offset index of the first channel in the vector.
+     */
+    void addSample(const double& time, const yarp::sig::Vector& data, const int& offset);
+
+    /**
+     * Send the frame if the window is elapsed.
+     * @param time current time [s].
+     */
+    void publish(const double& time);
+
+    /**
+     * Close the port.
+     */
+    void close();
+};
+
+#endif
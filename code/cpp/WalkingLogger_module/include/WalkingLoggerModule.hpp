@@ -10,30 +10,80 @@
 #define WALKING_LOGGER_MODULE_HPP
 
 // std
+#include <deque>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 // YARP
 #include <yarp/os/RFModule.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
 #include <yarp/os/RpcServer.h>
+#include <yarp/os/TypedReaderCallback.h>
 #include <yarp/sig/Vector.h>
 
+#include "DecimatedStream.hpp"
+
 /**
  * RFModule useful to collect data during an experiment.
+ * The samples are moved from the data port to a bounded queue by the port callback, so
+ * the intake of the port does not grow when the file is written. When the queue is full the
+ * new samples are discarded and counted.
  */
-class WalkingLoggerModule : public yarp::os::RFModule
+class WalkingLoggerModule : public yarp::os::RFModule,
+                            public yarp::os::TypedReaderCallback<yarp::sig::Vector>
 {
     double m_dT; /**< RFModule period. */
     std::ofstream m_stream; /**< std stream. */
 
     int m_numberOfValues; /**< Number of columns of the dataset. */
-    double m_time0; /**< Initial time of a stream. */
+    std::vector<std::string> m_channels; /**< Names of the columns of the dataset. */
+    double m_time0; /**< Initial time of a stream (logger clock). */
+    double m_sourceTime0; /**< Tick time of the first sample of a stream (controller clock). */
+    bool m_isFirstSample; /**< True if no sample has been stored in the stream. */
+
+    unsigned long m_expectedSequenceNumber; /**< Sequence number of the next sample. */
+    int m_receivedSamples; /**< Number of stored samples. */
+    int m_droppedSamples; /**< Number of samples never received. */
+    int m_lateSamples; /**< Number of samples queued for more than one period. */
+    int m_outOfOrderSamples; /**< Number of samples received after a more recent one. */
 
-    yarp::os::BufferedPort<yarp::sig::Vector> m_dataPort; /**< Data port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_dataPort; /**< Data port (strict, read by the callback). */
+    std::deque<yarp::sig::Vector> m_intake; /**< Samples received and not stored yet. */
+    std::deque<yarp::sig::Vector> m_pendingSamples; /**< Samples taken from the intake and being stored. */
+    std::size_t m_maxQueuedSamples; /**< Maximum number of samples in the intake. */
+    int m_discardedSamples; /**< Number of samples discarded because the intake was full. */
+    std::mutex m_intakeMutex; /**< Mutex of the intake (shared with the port callback). */
     yarp::os::RpcServer m_rpcPort; /**< RPC port. */
 
+    std::unique_ptr<DecimatedStream> m_decimatedStream; /**< Decimated stream for live plotting. */
+
+    std::mutex m_mutex; /**< Mutex shared by the RPC and the module threads. */
+
+    /**
+     * Read and store all the samples queued in the intake.
+     * @return true in case of success and false otherwise.
+     */
+    bool drainDataPort();
+
+    /**
+     * Store a sample in the file and update the counters.
+     * @param data sample (sequence number, tick time and acquisition time followed by the values).
+     * @return true in case of success and false otherwise.
+     */
+    bool storeSample(const yarp::sig::Vector& data);
+
 public:
 
+    /**
+     * Callback of the data port. The sample is added to the intake.
+     * @param data the received sample.
+     */
+    void onRead(yarp::sig::Vector& data) override;
+
     /**
      * Get the period of the RFModule.
      * @return the period of the module.
@@ -58,9 +108,12 @@ public:
      * @param command is the received message.
      * The following message has to be a bottle with the following structure:
      * 1. ("record", <list of the names of the saved variables>);
-     * 2. ("quit").
+     * 2. ("quit");
+     * 3. ("channels").
      * @param reply is the response of the server.
-     * 1. 1 in case of success;
+     * 1. 1 in case of success (after "quit" it is followed by the number of
+     * received, dropped, late, out of order and discarded samples, after "channels" by the names of
+     * the channels of the visualization stream);
      * 2. 0 in case of failure.
      * @return true in case of success and false otherwise.
      */
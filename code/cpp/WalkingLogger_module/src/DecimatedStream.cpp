@@ -0,0 +1,104 @@
+/**
+ * @file DecimatedStream.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "DecimatedStream.hpp"
+
+bool DecimatedStream::initialize(const yarp::os::Searchable& config, const std::string& portPrefix)
+{
+    m_period = config.check("period", yarp::os::Value(0.05)).asDouble();
+    if(m_period <= 0)
+    {
+        yError() << "[initialize] The period of the visualization stream has to be positive.";
+        return false;
+    }
+
+    std::string portName = config.check("port_name", yarp::os::Value("/visualization:o")).asString();
+    if(!m_port.open(portPrefix + portName))
+    {
+        yError() << "[initialize] Unable to open the port " << portPrefix + portName;
+        return false;
+    }
+    return true;
+}
+
+void DecimatedStream::reset(const int& numberOfChannels, const double& time)
+{
+    m_min.resize(numberOfChannels);
+    m_max.resize(numberOfChannels);
+    m_last.resize(numberOfChannels);
+    m_last.zero();
+
+    m_windowInitTime = time;
+    m_numberOfSamples = 0;
+}
+
+void DecimatedStream::addSample(const double& time, const yarp::sig::Vector& data, const int& offset)
+{
+    for(size_t i = 0; i < m_last.size(); i++)
+    {
+        double value = data[i + offset];
+        if(m_numberOfSamples == 0)
+        {
+            m_min[i] = value;
+            m_max[i] = value;
+        }
+        else
+        {
+            m_min[i] = std::min(m_min[i], value);
+            m_max[i] = std::max(m_max[i], value);
+        }
+        m_last[i] = value;
+    }
+
+    m_lastTime = time;
+    m_numberOfSamples++;
+}
+
+void DecimatedStream::publish(const double& time)
+{
+    if(time - m_windowInitTime < m_period)
+        return;
+
+    m_windowInitTime = time;
+
+    // an empty window is not sent
+    if(m_numberOfSamples == 0)
+        return;
+
+    yarp::os::Bottle& bottle = m_port.prepare();
+    bottle.clear();
+
+    yarp::os::Bottle& status = bottle.addList();
+    status.addDouble(m_lastTime);
+    status.addInt(m_numberOfSamples);
+
+    yarp::os::Bottle& min = bottle.addList();
+    yarp::os::Bottle& max = bottle.addList();
+    yarp::os::Bottle& last = bottle.addList();
+    for(size_t i = 0; i < m_last.size(); i++)
+    {
+        min.addDouble(m_min[i]);
+        max.addDouble(m_max[i]);
+        last.addDouble(m_last[i]);
+    }
+
+    m_port.write();
+    m_numberOfSamples = 0;
+}
+
+void DecimatedStream::close()
+{
+    m_port.close();
+}
@@ -15,6 +15,15 @@
 
 #include "WalkingLoggerModule.hpp"
 
+namespace
+{
+    /**
+     * Number of elements that precede the values in a sample
+     * (sequence number, tick time and acquisition time).
+     */
+    const int s_headerSize = 3;
+}
+
 double WalkingLoggerModule::getPeriod()
 {
     return m_dT;
@@ -22,17 +31,25 @@ double WalkingLoggerModule::getPeriod()
 
 bool WalkingLoggerModule::close()
 {
+    // close the ports (the callback is not called anymore)
+    m_dataPort.close();
+
     // close the stream (if it is open)
     if(m_stream.is_open())
         m_stream.close();
 
-    // close the ports
-    m_dataPort.close();
     m_rpcPort.close();
+
+    if(m_decimatedStream)
+        m_decimatedStream->close();
+
+    return true;
 }
 
 bool WalkingLoggerModule::respond(const yarp::os::Bottle& command, yarp::os::Bottle& reply)
 {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
     if (command.get(0).asString() == "quit")
     {
         if(!m_stream.is_open())
@@ -41,10 +58,23 @@ bool WalkingLoggerModule::respond(const yarp::os::Bottle& command, yarp::os::Bot
             reply.addInt(0);
             return true;
         }
+
+        // store the samples sent before the quit command
+        if(!drainDataPort())
+            yError() << "[RPC Server] Unable to store the last samples.";
+
         m_stream.close();
         reply.addInt(1);
+        reply.addInt(m_receivedSamples);
+        reply.addInt(m_droppedSamples);
+        reply.addInt(m_lateSamples);
+        reply.addInt(m_outOfOrderSamples);
+        reply.addInt(m_discardedSamples);
 
-        yInfo() << "[RPC Server] The stream is closed.";
+        yInfo() << "[RPC Server] The stream is closed. Received samples:" << m_receivedSamples
+                << "dropped:" << m_droppedSamples << "late:" << m_lateSamples
+                << "out of order:" << m_outOfOrderSamples
+                << "discarded:" << m_discardedSamples;
         return true;
     }
     else if (command.get(0).asString() == "record")
@@ -57,16 +87,37 @@ bool WalkingLoggerModule::respond(const yarp::os::Bottle& command, yarp::os::Bot
         }
 
         m_numberOfValues = command.size() - 1;
-
-        std::string head{"time "};
+        m_channels.clear();
         for(int i = 0; i < m_numberOfValues; i++)
-            head += command.get(i + 1).asString() + " ";
+            m_channels.push_back(command.get(i + 1).asString());
+
+        // the controller tick time is the time axis, the receive time is stored only to
+        // evaluate the latency of the logger
+        std::string head{"time acquisition_time receive_time sequence_number "};
+        for(const auto& channel : m_channels)
+            head += channel + " ";
 
         yInfo() << "[RPC Server] The following data will be stored: "
                 << head;
 
         // get the current time
         m_time0 = yarp::os::Time::now();
+        m_isFirstSample = true;
+
+        // reset the counters
+        m_expectedSequenceNumber = 0;
+        m_receivedSamples = 0;
+        m_droppedSamples = 0;
+        m_lateSamples = 0;
+        m_outOfOrderSamples = 0;
+        {
+            std::lock_guard<std::mutex> intakeGuard(m_intakeMutex);
+            m_intake.clear();
+            m_discardedSamples = 0;
+        }
+
+        if(m_decimatedStream)
+            m_decimatedStream->reset(m_numberOfValues, m_time0);
 
         // set the file name
         std::time_t t = std::time(nullptr);
@@ -84,6 +135,13 @@ bool WalkingLoggerModule::respond(const yarp::os::Bottle& command, yarp::os::Bot
         reply.addInt(1);
         return true;
     }
+    else if (command.get(0).asString() == "channels")
+    {
+        reply.addInt(1);
+        for(const auto& channel : m_channels)
+            reply.addString(channel);
+        return true;
+    }
     else
     {
         yError() << "[RPC Server] Unknown command.";
@@ -131,6 +189,18 @@ bool WalkingLoggerModule::configure(yarp::os::ResourceFinder &rf)
         yError() << "[configure] The value is not a string.";
         return false;
     }
+    // the samples are moved to the intake by the callback. The port is strict, so it never
+    // drops the old samples, and its queue is bounded by the intake
+    int maxQueuedSamples = rf.check("max_queued_samples", yarp::os::Value(1000)).asInt();
+    if(maxQueuedSamples <= 0)
+    {
+        yError() << "[configure] The max_queued_samples has to be positive.";
+        return false;
+    }
+    m_maxQueuedSamples = maxQueuedSamples;
+    m_discardedSamples = 0;
+    m_dataPort.setStrict();
+    m_dataPort.useCallback(*this);
     m_dataPort.open("/" + getName() + value->asString());
 
     // set rpc port name
@@ -150,38 +220,116 @@ bool WalkingLoggerModule::configure(yarp::os::ResourceFinder &rf)
     // set the RFModule period
     m_dT = rf.check("sampling_time", yarp::os::Value(0.005)).asDouble();
 
+    // open the decimated stream used for live plotting
+    if(rf.check("publish_visualization", yarp::os::Value(false)).asBool())
+    {
+        m_decimatedStream = std::make_unique<DecimatedStream>();
+        yarp::os::Bottle& visualizationOptions = rf.findGroup("VISUALIZATION");
+        if(!m_decimatedStream->initialize(visualizationOptions, "/" + getName()))
+        {
+            yError() << "[configure] Unable to initialize the visualization stream.";
+            return false;
+        }
+    }
+
     return true;
 }
 
 bool WalkingLoggerModule::updateModule()
 {
-    yarp::sig::Vector *data = NULL;
+    std::lock_guard<std::mutex> guard(m_mutex);
 
-    // try to read data from port
-    data = m_dataPort.read(false);
+    if(!drainDataPort())
+        return false;
+
+    if(m_decimatedStream && m_stream.is_open())
+        m_decimatedStream->publish(yarp::os::Time::now());
 
-    if (data != NULL)
+    return true;
+}
+
+void WalkingLoggerModule::onRead(yarp::sig::Vector& data)
+{
+    std::lock_guard<std::mutex> guard(m_intakeMutex);
+    if(m_intake.size() >= m_maxQueuedSamples)
     {
-        if(!m_stream.is_open())
-        {
-            yError() << "[updateModule] No stream is open. I cannot store your data.";
-            return false;
-        }
+        m_discardedSamples++;
+        return;
+    }
+    m_intake.push_back(data);
+}
 
-        if(data->size() != m_numberOfValues)
+bool WalkingLoggerModule::drainDataPort()
+{
+    // the samples are taken at once, so the callback is not blocked while the file is written
+    {
+        std::lock_guard<std::mutex> guard(m_intakeMutex);
+        m_pendingSamples.swap(m_intake);
+    }
+
+    // the samples that were queued behind another one are late
+    if(m_pendingSamples.size() > 1)
+        m_lateSamples += static_cast<int>(m_pendingSamples.size()) - 1;
+
+    bool ok = true;
+    for(const auto& data : m_pendingSamples)
+    {
+        if(!storeSample(data))
         {
-            yError() << "[updateModule] The size of the vector is different from "
-                     << m_numberOfValues;
-            return false;
+            ok = false;
+            break;
         }
+    }
+    m_pendingSamples.clear();
+    return ok;
+}
 
-        // write into the file
-        double time = yarp::os::Time::now() - m_time0;
-        m_stream << time << " ";
-        for(int i = 0; i < m_numberOfValues; i++)
-            m_stream << (*data)[i] << " ";
+bool WalkingLoggerModule::storeSample(const yarp::sig::Vector& data)
+{
+    if(!m_stream.is_open())
+    {
+        yError() << "[storeSample] No stream is open. I cannot store your data.";
+        return false;
+    }
 
-        m_stream << std::endl;
+    if(data.size() != m_numberOfValues + s_headerSize)
+    {
+        yError() << "[storeSample] The size of the vector is different from "
+                 << m_numberOfValues + s_headerSize;
+        return false;
     }
+
+    // check the sequence number
+    unsigned long sequenceNumber = static_cast<unsigned long>(data[0]);
+    if(sequenceNumber < m_expectedSequenceNumber)
+        m_outOfOrderSamples++;
+    else
+    {
+        m_droppedSamples += sequenceNumber - m_expectedSequenceNumber;
+        m_expectedSequenceNumber = sequenceNumber + 1;
+    }
+    m_receivedSamples++;
+
+    // the times are relative to the first sample of the stream
+    if(m_isFirstSample)
+    {
+        m_sourceTime0 = data[1];
+        m_isFirstSample = false;
+    }
+    double tickTime = data[1] - m_sourceTime0;
+    double acquisitionTime = data[2] - m_sourceTime0;
+    double receiveTime = yarp::os::Time::now() - m_time0;
+
+    // write into the file
+    m_stream << tickTime << " " << acquisitionTime << " " << receiveTime << " "
+             << sequenceNumber << " ";
+    for(int i = 0; i < m_numberOfValues; i++)
+        m_stream << data[i + s_headerSize] << " ";
+
+    if(m_decimatedStream)
+        m_decimatedStream->addSample(tickTime, data, s_headerSize);
+
+    // the stream is flushed when it is closed, the backlog is written at once
+    m_stream << "\n";
     return true;
 }
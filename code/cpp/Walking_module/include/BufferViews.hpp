@@ -0,0 +1,92 @@
+/**
+ * @file BufferViews.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef BUFFER_VIEWS_HPP
+#define BUFFER_VIEWS_HPP
+
+// eigen
+#include <Eigen/Dense>
+
+/**
+ * Non-owning views of the contiguous buffers used by the controller
+ * (yarp::sig::Vector, iDynTree::VectorDynSize, iDynTree::VectorFixSize, std::vector<double>).
+ * Each signal is stored in a single owning buffer. The buffer is passed as raw memory to the
+ * YARP devices (data()) and it is read or written by iDynTree and Eigen through a view, so
+ * the conversion between the libraries does not allocate.
+ * @note the types that own their storage (e.g. the output of the iCub::ctrl filters and
+ * integrators, or iDynTree::SpatialForceVector whose toEigen() returns a copy) cannot be
+ * aliased: they are still copied into a preallocated buffer.
+ */
+namespace BufferViews
+{
+    typedef Eigen::Map<Eigen::VectorXd> VectorView;
+    typedef Eigen::Map<const Eigen::VectorXd> ConstVectorView;
+
+    /**
+     * Get a view of a buffer.
+     * @param buffer a buffer that exposes data() and size();
+     * @return a writable Eigen view of the buffer.
+     */
+    template <typename Buffer>
+    inline VectorView view(Buffer& buffer)
+    {
+        return VectorView(buffer.data(), static_cast<Eigen::Index>(buffer.size()));
+    }
+
+    /**
+     * Get a read-only view of a buffer.
+     * @param buffer a buffer that exposes data() and size();
+     * @return a read-only Eigen view of the buffer.
+     */
+    template <typename Buffer>
+    inline ConstVectorView view(const Buffer& buffer)
+    {
+        return ConstVectorView(buffer.data(), static_cast<Eigen::Index>(buffer.size()));
+    }
+
+    /**
+     * Copy a buffer into a view without allocating memory.
+     * @param source a buffer that exposes data() and size();
+     * @param destination the destination view (e.g. iDynTree::toEigen(position) or view(vector)).
+     * @return false if the sizes of the buffers are different, true otherwise.
+     */
+    template <typename Buffer, typename PlainObjectType, int MapOptions, typename StrideType>
+    inline bool copy(const Buffer& source, Eigen::Map<PlainObjectType, MapOptions, StrideType> destination)
+    {
+        if(static_cast<Eigen::Index>(source.size()) != destination.size())
+            return false;
+
+        destination = view(source);
+        return true;
+    }
+
+    /**
+     * Copy a buffer into an Eigen vector without allocating memory.
+     * @param source a buffer that exposes data() and size();
+     * @param destination the destination vector.
+     * @return false if the sizes of the buffers are different, true otherwise.
+     */
+    template <typename Buffer, typename Derived>
+    inline bool copy(const Buffer& source, Eigen::PlainObjectBase<Derived>& destination)
+    {
+        if(static_cast<Eigen::Index>(source.size()) != destination.size())
+            return false;
+
+        destination = view(source);
+        return true;
+    }
+
+    /**
+     * A temporary vector (e.g. the one returned by iDynTree::toEigen(wrench)) would be written
+     * and discarded, so it is not accepted as destination.
+     */
+    template <typename Buffer, typename Derived>
+    bool copy(const Buffer& source, Eigen::PlainObjectBase<Derived>&& destination) = delete;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file FlightRecorder.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+#include "WalkingThreadPool.hpp"
+
+/**
+ * Reasons of a dump, sorted by priority.
+ */
+enum class DumpReason
+{
+    Request = 0, /**< Dump requested by the user. */
+    Watchdog, /**< A tick was longer than the watchdog duration. */
+    Fault, /**< The controller failed. */
+    NumberOfReasons
+};
+
+/**
+ * FlightRecorder class keeps the last seconds of telemetry in memory and saves them on fault.
+ * The control thread appends a record per tick in one of two preallocated rings (no allocation
+ * and no disk I/O). When a dump is triggered the ring is frozen, a low priority task of the
+ * thread pool writes it in a binary file and the recording continues in the other ring.
+ * If a dump is triggered while the other ring is being written, the recording ring is frozen
+ * too (it contains the records that preceded the trigger) and it is written as soon as the first
+ * dump ends. Until then the records are discarded and the following triggers are suppressed,
+ * a suppressed trigger only raises the reason of the pending dump if it has a higher priority.
+ * The file contains: the magic number "WFRD" (uint32), the number of channels (int32), the name
+ * of each channel (int32 length followed by the characters), the reason of the dump (same
+ * format), the number of records (int32) and the records (doubles, oldest first).
+ */
+class FlightRecorder
+{
+    /**
+     * Ring of records.
+     */
+    struct Ring
+    {
+        std::vector<double> records; /**< Records. */
+        size_t head{0}; /**< Index of the next record. */
+        size_t numberOfRecords{0}; /**< Number of records in the ring. */
+        DumpReason reason{DumpReason::Request}; /**< Reason of the dump of the ring. */
+    };
+
+    std::vector<std::string> m_channels; /**< Names of the channels (schema of a record). */
+    Ring m_rings[2]; /**< Rings of records. */
+    size_t m_capacity{0}; /**< Maximum number of records of a ring. */
+    bool m_isSizeWrong{false}; /**< True if a record with a wrong size was received. */
+    bool m_isWatchdogTriggered{false}; /**< Last state of the watchdog condition. */
+
+    int m_recordingRing{0}; /**< Ring used by the control thread (changed only while it is pending). */
+    std::atomic<bool> m_isRecordingPending{false}; /**< True if the recording ring waits to be dumped. */
+    bool m_isDumping{false}; /**< True if a ring is being dumped. */
+    std::atomic<bool> m_isDumpRequested{false}; /**< True if a dump was requested by another thread. */
+    std::string m_filePrefix; /**< Prefix of the dump files. */
+
+    int m_numberOfDumps{0}; /**< Number of saved dumps. */
+    int m_numberOfDelayedDumps{0}; /**< Number of dumps triggered while another one was written. */
+    int m_numberOfSuppressedTriggers{0}; /**< Number of triggers merged in a pending dump or dropped. */
+
+    WalkingThreadPool* m_threadPool{nullptr}; /**< Pool that runs the dumps (it has to outlive the recorder). */
+    std::mutex m_mutex; /**< Mutex. */
+    std::condition_variable m_conditionVariable; /**< Used to wait for the end of a dump. */
+
+    /**
+     * Dump a frozen ring, then the pending one if any (thread pool task).
+     * @param ring index of the ring.
+     */
+    void dumpTask(int ring);
+
+    /**
+     * Write a frozen ring in a file.
+     * @param ring the ring.
+     * @return true/false in case of success/failure.
+     */
+    bool dump(const Ring& ring);
+
+    /**
+     * Freeze the recording ring and submit its dump to the thread pool (control thread).
+     * @param reason reason of the dump.
+     */
+    void freeze(const DumpReason& reason);
+
+    /**
+     * Number of elements of a set of scalars and vectors.
+     */
+    size_t size(const int& value);
+
+    size_t size(const double& value);
+
+    template <typename T>
+    size_t size(const T& t);
+
+    template <typename T, typename... Args>
+    size_t size(const T& t, const Args&... args);
+
+    /**
+     * Copy a set of scalars and vectors in a record.
+     */
+    void copy(double*& record, const int& value);
+
+    void copy(double*& record, const double& value);
+
+    template <typename T>
+    void copy(double*& record, const T& t);
+
+    template <typename T, typename... Args>
+    void copy(double*& record, const T& t, const Args&... args);
+
+public:
+
+    /**
+     * Destructor. A pending dump is completed.
+     */
+    ~FlightRecorder();
+
+    /**
+     * Allocate the ring.
+     * @param config configuration of the recorder;
+     * @param samplingTime period of the records [s];
+     * @param filePrefix prefix of the dump files;
+     * @param channels names of the channels;
+     * @param threadPool pool used to write the dumps (it has to outlive the recorder).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config, const double& samplingTime,
+                    const std::string& filePrefix, const std::vector<std::string>& channels,
+                    WalkingThreadPool& threadPool);
+
+    /**
+     * Append a record (control thread). The arguments are int, double or vectors
+     * (size() and operator()), the total size has to be equal to the number of channels.
+     * The record is discarded if the ring is being dumped.
+     * @param args content of the record.
+     */
+    template <typename... Args>
+    void record(const Args&... args);
+
+    /**
+     * Dump the ring (control thread).
+     * @param reason reason of the dump.
+     */
+    void trigger(const DumpReason& reason);
+
+    /**
+     * Update the watchdog (control thread). The ring is dumped when the condition becomes true.
+     * @param isTriggered state of the watchdog condition.
+     */
+    void watchdog(const bool& isTriggered);
+
+    /**
+     * Request a dump (any thread). The ring is frozen after the next record.
+     */
+    void requestDump();
+
+    /**
+     * Wait for the end of the pending dumps.
+     */
+    void close();
+
+    /**
+     * Add the counters of the dumps to a bottle.
+     * The bottle contains a (flight_recorder ((dumps d) (delayed_dumps l) (suppressed_triggers s))) entry.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+
+    /**
+     * Reset the counters of the dumps.
+     */
+    void resetStatistics();
+};
+
+#include "FlightRecorder.tpp"
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file FlightRecorder.tpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+template <typename T>
+size_t FlightRecorder::size(const T& t)
+{
+    return t.size();
+}
+
+template <typename T, typename... Args>
+size_t FlightRecorder::size(const T& t, const Args&... args)
+{
+    return size(t) + size(args...);
+}
+
+template <typename T>
+void FlightRecorder::copy(double*& record, const T& t)
+{
+    for(int i = 0; i < t.size(); i++)
+        *record++ = t(i);
+}
+
+template <typename T, typename... Args>
+void FlightRecorder::copy(double*& record, const T& t, const Args&... args)
+{
+    copy(record, t);
+    copy(record, args...);
+}
+
+template <typename... Args>
+void FlightRecorder::record(const Args&... args)
+{
+    // the recording ring is waiting to be dumped
+    if(m_isRecordingPending.load(std::memory_order_acquire))
+        return;
+
+    if(size(args...) != m_channels.size())
+    {
+        if(!m_isSizeWrong)
+            yError() << "[record] The size of the record is different from " << m_channels.size();
+        m_isSizeWrong = true;
+        return;
+    }
+
+    Ring& ring = m_rings[m_recordingRing];
+    double* record = ring.records.data() + ring.head * m_channels.size();
+    copy(record, args...);
+
+    ring.head = (ring.head + 1) % m_capacity;
+    if(ring.numberOfRecords < m_capacity)
+        ring.numberOfRecords++;
+
+    if(m_isDumpRequested.exchange(false))
+        freeze(DumpReason::Request);
+}
@@ -20,6 +20,10 @@
 #include <OsqpEigen/OsqpEigen.h>
 
 #include "Utils.hpp"
+#include "SolverAccuracySchedule.hpp"
+#include "SolverSettings.hpp"
+#include "QPProblemRecorder.hpp"
+#include "MemoryAccounting.hpp"
 
 /**
  * MPCSolver class
@@ -30,6 +34,7 @@ class MPCSolver
      * Pointer to the optimization solver
      */
     std::unique_ptr<OsqpEigen::Solver> m_optimizerSolver;
+    ExternalMemory m_solverMemory; /**< Memory of the OSQP workspace (allocated with malloc). */
     iDynTree::Triplets const* m_equalConstraintsMatrix; /**< Equal part of the constraints matrix. */
     iDynSparseMatrix const* m_gradientSubmatrix; /**< Matrix used to evaluate the gradient vector */
     iDynSparseMatrix const* m_stateWeightMatrix; /**< State weight stacked matrix */
@@ -37,6 +42,9 @@ class MPCSolver
     Eigen::VectorXd m_lowerBound; /**< Lower bound vector. */
     Eigen::VectorXd m_upperBound; /**< Upper bound vector. */
     Eigen::VectorXd m_gradient; /**< Gradient vector. */
+    Eigen::SparseMatrix<double> m_hessian; /**< Hessian matrix (stored to record the problem). */
+    Eigen::SparseMatrix<double> m_constraintsMatrix; /**< Constraints matrix (stored to record the problem). */
+    bool m_isStructureChanged{true}; /**< True if the problem has not been recorded yet. */
 
     int m_stateSize; /**< Size of the state vector (2). */
     int m_inputSize; /**< Size of the controlled input vector (2). */
@@ -125,12 +133,47 @@ public:
      */
     bool initialize();
 
+    /**
+     * Set the settings of the solver. Please call this function before initializing the solver.
+     * @param settings osqp settings.
+     * @return true/false in case of success/failure.
+     */
+    bool setSolverSettings(const OsqpSettings& settings);
+
+    /**
+     * Set the termination criteria of the solver.
+     * If the solver is already initialized the settings are updated.
+     * @param accuracy tolerances and maximum number of iterations.
+     * @return true/false in case of success/failure.
+     */
+    bool setAccuracy(const SolverAccuracy& accuracy);
+
     /**
      * Solve the optimization problem.
      * @return true/false in case of success/failure.
      */
     bool solve();
 
+    /**
+     * Get the statistics of the last solution.
+     * @return number of iterations and residuals.
+     */
+    SolverStatistics getStatistics();
+
+    /**
+     * Get the current optimization problem (useful to replay it offline).
+     * @param problem QP problem.
+     */
+    void getProblem(QPProblem& problem);
+
+    /**
+     * Get the solution of the last problem in the format of the recorded problems (checkpoint
+     * used to replay the sequence from the next problem).
+     * @param primal primal solution;
+     * @param dual multipliers of the rows of the constraints matrix.
+     */
+    void getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual);
+
     /**
      * Get the solver solution
      * @return the entire solution of the solver
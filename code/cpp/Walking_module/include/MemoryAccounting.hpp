@@ -0,0 +1,189 @@
+/**
+ * @file MemoryAccounting.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef MEMORY_ACCOUNTING_HPP
+#define MEMORY_ACCOUNTING_HPP
+
+// std
+#include <cstddef>
+
+// YARP
+#include <yarp/os/Bottle.h>
+
+/**
+ * Subsystems of the walking module whose memory is accounted.
+ */
+enum class MemorySubsystem
+{
+    Other = 0, /**< Allocations outside the tagged scopes. */
+    Trajectories, /**< Trajectory deques of the module. */
+    Planner, /**< Trajectory planner (and its task of the thread pool). */
+    MPC, /**< DCM MPC controller (one OSQP problem per contact configuration). */
+    FK, /**< Forward kinematics (KinDynComputations of WalkingFK). */
+    IK, /**< Inverse kinematics (WalkingIK and QP-IK solvers). */
+    NumberOfSubsystems
+};
+
+/**
+ * MemoryScope class tags the allocations of the calling thread with a subsystem
+ * while the object is alive. The scopes can be nested.
+ */
+class MemoryScope
+{
+    MemorySubsystem m_previousSubsystem; /**< Tag restored when the scope ends. */
+
+public:
+
+    /**
+     * Constructor.
+     * @param subsystem subsystem of the allocations of the scope.
+     */
+    explicit MemoryScope(const MemorySubsystem& subsystem);
+
+    /**
+     * Destructor.
+     */
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+
+/**
+ * ExternalMemory class accounts the memory that a library allocates with malloc (e.g. the
+ * OSQP workspaces), which is not seen by the operator new of the module. While the object is
+ * sampling, the malloc calls of the calling thread are recorded by the allocator of the module
+ * (MemoryAllocator.cpp) and the blocks that are still allocated at the end of the sampling are
+ * accounted to the subsystem of the thread until the object is released. The allocations of
+ * the other threads are not recorded. If malloc is not interposed the memory is not accounted.
+ */
+class ExternalMemory
+{
+    /**
+     * Block allocated while sampling.
+     */
+    struct Block
+    {
+        void* pointer; /**< Address of the block. */
+        std::size_t size; /**< Usable size of the block [B]. */
+    };
+
+    static const int maxNumberOfBlocks = 256; /**< Maximum number of blocks recorded by a sampling. */
+
+    MemorySubsystem m_subsystem{MemorySubsystem::Other}; /**< Subsystem of the memory. */
+    long m_bytes{0}; /**< Accounted memory [B]. */
+    Block m_blocks[maxNumberOfBlocks]; /**< Blocks allocated by the current sampling. */
+    int m_numberOfBlocks{0}; /**< Number of recorded blocks. */
+    long m_untrackedBytes{0}; /**< Memory of the blocks that did not fit in m_blocks [B]. */
+    ExternalMemory* m_previousSampling{nullptr}; /**< Sampling restored when this one ends. */
+
+public:
+
+    ExternalMemory() = default;
+
+    /**
+     * Destructor. The memory is released.
+     */
+    ~ExternalMemory();
+
+    ExternalMemory(const ExternalMemory&) = delete;
+    ExternalMemory& operator=(const ExternalMemory&) = delete;
+
+    /**
+     * Call it before the call that allocates the memory.
+     */
+    void beginSampling();
+
+    /**
+     * Call it after the call that allocates the memory. The memory accounted before is replaced.
+     */
+    void endSampling();
+
+    /**
+     * Release the accounted memory (call it when the library frees the memory).
+     */
+    void release();
+
+    /**
+     * Record a block allocated by the sampling thread (called by the allocator, it never allocates).
+     * @param pointer address of the block;
+     * @param size usable size of the block [B].
+     */
+    void blockAllocated(void* pointer, const std::size_t& size);
+
+    /**
+     * Remove a block freed by the sampling thread (called by the allocator).
+     * @param pointer address of the block.
+     */
+    void blockFreed(void* pointer);
+};
+
+/**
+ * The counters are updated by the global operator new/delete of the walking module
+ * (MemoryAllocator.cpp). If the operators are not replaced (e.g. in the benchmarks) the
+ * scopes have no effect and the counters stay at zero. Each thread updates its own counters,
+ * which are merged when the statistics are read. The peaks are updated on the allocation path:
+ * each thread adds its net allocations to a shared counter of the subsystem in batches of
+ * peakBatchBytes, so the peaks are high-water marks with an error below peakBatchBytes for
+ * each thread, while an allocation rarely writes a shared cache line.
+ */
+namespace MemoryAccounting
+{
+    /**
+     * Net memory that a thread accumulates before updating the shared counters of the peaks [B].
+     */
+    const long peakBatchBytes = 16 * 1024;
+
+    /**
+     * Get the subsystem of the allocations of the calling thread.
+     * @return the current subsystem.
+     */
+    MemorySubsystem currentSubsystem();
+
+    /**
+     * Account an allocation.
+     * @param subsystem subsystem of the allocation;
+     * @param size size of the allocation [B].
+     */
+    void allocated(const MemorySubsystem& subsystem, const std::size_t& size);
+
+    /**
+     * Account a deallocation.
+     * @param subsystem subsystem of the allocation;
+     * @param size size of the allocation [B].
+     */
+    void deallocated(const MemorySubsystem& subsystem, const std::size_t& size);
+
+    /**
+     * Record a block allocated with malloc. It is recorded only if an ExternalMemory object is
+     * sampling in the calling thread. The function never allocates.
+     * @param pointer address of the block;
+     * @param size usable size of the block [B].
+     */
+    void externalAllocated(void* pointer, const std::size_t& size);
+
+    /**
+     * Record a block freed with free (if an ExternalMemory object is sampling in the calling thread).
+     * @param pointer address of the block.
+     */
+    void externalFreed(void* pointer);
+
+    /**
+     * Reset the peaks (to the current values) and the allocation rates.
+     */
+    void reset();
+
+    /**
+     * Add the counters to a bottle. The bottle contains a (memory (...)) entry with the current
+     * and the peak memory and the allocation rates (since the last reset) of each subsystem.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file QPIKTaskSet.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef QPIK_TASK_SET_HPP
+#define QPIK_TASK_SET_HPP
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+/**
+ * QPIKTaskSet class contains the tasks of the cost function of the QP-IK problem.
+ * The feet (and the CoM when it is used as a constraint) are constraints of the problem,
+ * so they are always considered. The other tasks are listed in the "tasks" key of the
+ * configuration, e.g. tasks ("neck" "joint_regularization"). A task that is not listed is
+ * removed from the problem: its Jacobian is not required and it does not contribute
+ * to the hessian matrix and to the gradient vector.
+ */
+class QPIKTaskSet
+{
+    bool m_isNeckEnabled{true}; /**< True if the neck orientation task is in the cost function. */
+    bool m_isJointRegularizationEnabled{true}; /**< True if the joint regularization is in the cost function. */
+
+public:
+
+    /**
+     * Initialize the task set. If the "tasks" key is missing all the tasks are enabled.
+     * @param config config of the QP-IK solver.
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config);
+
+    /**
+     * Return true if the neck orientation task is enabled.
+     */
+    bool isNeckEnabled() const;
+
+    /**
+     * Return true if the joint regularization task is enabled.
+     */
+    bool isJointRegularizationEnabled() const;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @file QPProblemRecorder.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef QP_PROBLEM_RECORDER_HPP
+#define QP_PROBLEM_RECORDER_HPP
+
+// std
+#include <fstream>
+#include <string>
+
+// eigen
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+/**
+ * Quadratic problem in the form
+ * \f$ \min 1/2 x^T H x + g^T x \f$ s.t. \f$ l \le A x \le u \f$ (and \f$ l_x \le x \le u_x \f$
+ * if the solver has bounds on the variables).
+ */
+struct QPProblem
+{
+    Eigen::SparseMatrix<double> hessian; /**< Hessian matrix (H). */
+    Eigen::VectorXd gradient; /**< Gradient vector (g). */
+    Eigen::SparseMatrix<double> constraintsMatrix; /**< Linear constraints matrix (A). */
+    Eigen::VectorXd lowerBound; /**< Lower bound vector (l). */
+    Eigen::VectorXd upperBound; /**< Upper bound vector (u). */
+    bool hasVariableBounds{false}; /**< True if the variables are bounded (as in qpOASES). */
+    Eigen::VectorXd lowerVariableBound; /**< Lower bound of the variables (l_x, valid if hasVariableBounds). */
+    Eigen::VectorXd upperVariableBound; /**< Upper bound of the variables (u_x, valid if hasVariableBounds). */
+    bool isStructureChanged{true}; /**< False if the problem is solved by the same solver instance
+                                      of the previous problem of the sequence (warm start). */
+
+    bool hasCheckpoint{false}; /**< True if the state of the solver before this problem is known
+                                  (the replay of the sequence can start from this problem). */
+    Eigen::VectorXd checkpointPrimal; /**< Primal solution of the previous problem (valid if hasCheckpoint). */
+    Eigen::VectorXd checkpointDual; /**< Multipliers of the previous problem (valid if hasCheckpoint):
+                                       the ones of the variable bounds (if hasVariableBounds)
+                                       followed by the ones of the rows of the constraints matrix. */
+};
+
+/**
+ * QPProblemRecorder class stores a sequence of QP problems in a binary file.
+ * A checkpoint (the warm start of the solver) can be stored every checkpointPeriod problems,
+ * so that the sequence can be split in shards replayed independently.
+ */
+class QPProblemRecorder
+{
+    std::ofstream m_stream; /**< Binary stream. */
+    int m_checkpointPeriod{0}; /**< Number of problems between two checkpoints (0 to disable them). */
+    long m_numberOfProblems{0}; /**< Number of recorded problems. */
+
+public:
+
+    /**
+     * Open the file.
+     * @param fileName name of the file;
+     * @param checkpointPeriod number of problems between two checkpoints (0 to disable them).
+     * @return true/false in case of success/failure.
+     */
+    bool open(const std::string& fileName, const int& checkpointPeriod = 0);
+
+    /**
+     * Append a problem to the file.
+     * @param problem QP problem.
+     * @return true/false in case of success/failure.
+     */
+    bool record(const QPProblem& problem);
+
+    /**
+     * Return true if a checkpoint has to be stored after the last recorded problem.
+     * @return true if a checkpoint is required.
+     */
+    bool isCheckpointRequired() const;
+
+    /**
+     * Append the solution of the last recorded problem. The reader attaches it to the next problem.
+     * @param primal primal solution;
+     * @param dual multipliers of the variable bounds (if any) and of the rows of the constraints matrix.
+     * @return true/false in case of success/failure.
+     */
+    bool recordCheckpoint(const Eigen::VectorXd& primal, const Eigen::VectorXd& dual);
+
+    /**
+     * Close the file.
+     */
+    void close();
+
+    /**
+     * Return true if the file is open.
+     * @return true if the file is open.
+     */
+    bool isOpen() const;
+};
+
+/**
+ * QPProblemReader class reads a sequence of QP problems stored by QPProblemRecorder.
+ */
+class QPProblemReader
+{
+    std::ifstream m_stream; /**< Binary stream. */
+
+public:
+
+    /**
+     * Open the file.
+     * @param fileName name of the file.
+     * @return true/false in case of success/failure.
+     */
+    bool open(const std::string& fileName);
+
+    /**
+     * Read the next problem. If a checkpoint precedes the problem it is stored in the problem.
+     * @param problem QP problem.
+     * @return true if a problem is read, false at the end of the file or in case of failure.
+     */
+    bool read(QPProblem& problem);
+
+    /**
+     * Get the position of the next record. It can be used to resume the reading with seek().
+     * @return the offset of the next record in the file.
+     */
+    std::streamoff tell();
+
+    /**
+     * Move to a record.
+     * @param offset offset of the record (returned by tell()).
+     * @return true/false in case of success/failure.
+     */
+    bool seek(const std::streamoff& offset);
+};
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * @file RealTimeSettings.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef REAL_TIME_SETTINGS_HPP
+#define REAL_TIME_SETTINGS_HPP
+
+// std
+#include <vector>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+/**
+ * RealTimeSettings class sets the scheduling of the control thread: the SCHED_FIFO priority,
+ * the CPUs where the thread can run and the locking of the memory of the process.
+ * The settings are applied to the calling thread, the threads created later inherit them.
+ */
+class RealTimeSettings
+{
+    int m_priority{0}; /**< SCHED_FIFO priority (0 to keep the default scheduler). */
+    std::vector<int> m_cpus; /**< CPUs of the thread (empty to use all the CPUs). */
+    bool m_lockMemory{false}; /**< True if the memory of the process is locked. */
+
+public:
+
+    /**
+     * Read the settings.
+     * @param config configuration (realtime_priority, cpu_affinity and lock_memory).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config);
+
+    /**
+     * Check if at least one setting is enabled.
+     * @return true if the default settings are changed.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Apply the settings to the calling thread.
+     * @note the real-time priority and the memory locking require the corresponding
+     * privileges (e.g. CAP_SYS_NICE and CAP_IPC_LOCK or the rtprio and memlock limits).
+     * @return true/false in case of success/failure.
+     */
+    bool apply() const;
+};
+
+#endif
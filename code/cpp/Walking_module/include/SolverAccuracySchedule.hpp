@@ -0,0 +1,109 @@
+/**
+ * @file SolverAccuracySchedule.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef SOLVER_ACCURACY_SCHEDULE_HPP
+#define SOLVER_ACCURACY_SCHEDULE_HPP
+
+// std
+#include <deque>
+#include <unordered_map>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+/**
+ * Contact phases used to schedule the accuracy of the solvers.
+ */
+enum class SolverAccuracyPhase {Standing, DoubleSupport, SingleSupport, ContactSwitch};
+
+/**
+ * Termination criteria of the QP solvers.
+ */
+struct SolverAccuracy
+{
+    double absoluteTolerance{1e-3}; /**< Absolute tolerance (osqp eps_abs). */
+    double relativeTolerance{1e-3}; /**< Relative tolerance (osqp eps_rel). */
+    int maxIterations{4000}; /**< Maximum number of iterations (osqp max_iter). */
+    int maxWorkingSetRecalculations{100}; /**< Maximum number of working set recalculations (qpOASES nWSR). */
+};
+
+/**
+ * Statistics of the last solution of a QP solver.
+ */
+struct SolverStatistics
+{
+    int iterations{0}; /**< Number of iterations (or working set recalculations). */
+    double primalResidual{0.0}; /**< Primal residual (constraints violation, NaN if not evaluated). */
+    double dualResidual{0.0}; /**< Dual residual (stationarity violation, NaN if not evaluated). */
+};
+
+/**
+ * SolverAccuracySchedule class selects the termination criteria of the QP solvers
+ * depending on the current contact phase.
+ */
+class SolverAccuracySchedule
+{
+    bool m_isEnabled{false}; /**< True if the schedule is used. */
+    int m_switchWindow{0}; /**< Number of samples looked ahead to detect a contact switch. */
+
+    std::unordered_map<int, SolverAccuracy> m_accuracies; /**< Accuracy associated to each phase. */
+
+    SolverAccuracyPhase m_currentPhase{SolverAccuracyPhase::Standing}; /**< Current phase. */
+    bool m_isPhaseInitialized{false}; /**< False until the first phase is evaluated. */
+
+    /**
+     * Parse the accuracy of a phase.
+     * @param config yarp searchable configuration variable;
+     * @param key name of the phase in the configuration file;
+     * @param phase phase.
+     * @return true/false in case of success/failure.
+     */
+    bool parseAccuracy(const yarp::os::Searchable& config, const std::string& key,
+                       const SolverAccuracyPhase& phase);
+
+public:
+
+    /**
+     * Initialize the schedule.
+     * @param config yarp searchable configuration variable;
+     * @param samplingTime sampling time of the contact sequence.
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config, const double& samplingTime);
+
+    /**
+     * Evaluate the current phase.
+     * @param leftInContact deque containing the contact status of the left foot;
+     * @param rightInContact deque containing the contact status of the right foot;
+     * @param isStanding true if the robot is standing still.
+     * @return true if the phase is changed since the last call, false otherwise.
+     */
+    bool updatePhase(const std::deque<bool>& leftInContact,
+                     const std::deque<bool>& rightInContact,
+                     const bool& isStanding);
+
+    /**
+     * Get the current phase.
+     * @return the current phase.
+     */
+    const SolverAccuracyPhase& getPhase() const;
+
+    /**
+     * Get the accuracy associated to the current phase.
+     * @return the accuracy of the solvers.
+     */
+    const SolverAccuracy& getAccuracy() const;
+
+    /**
+     * Return true if the schedule is used.
+     * @return true if the schedule is used.
+     */
+    bool isEnabled() const;
+};
+
+#endif
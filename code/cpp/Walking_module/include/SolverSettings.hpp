@@ -0,0 +1,81 @@
+/**
+ * @file SolverSettings.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef SOLVER_SETTINGS_HPP
+#define SOLVER_SETTINGS_HPP
+
+// std
+#include <string>
+
+// YARP
+#include <yarp/os/Searchable.h>
+
+// solvers
+#include <OsqpEigen/OsqpEigen.h>
+#include <qpOASES.hpp>
+
+/**
+ * Settings of the osqp solver. The default values are the ones of osqp.
+ */
+struct OsqpSettings
+{
+    double rho{0.1}; /**< ADMM step size. */
+    double sigma{1e-6}; /**< ADMM regularization parameter. */
+    double alpha{1.6}; /**< ADMM relaxation parameter. */
+    bool adaptiveRho{true}; /**< True if the step size is adapted during the iterations. */
+    bool polish{false}; /**< True if the solution is polished. */
+    double absoluteTolerance{1e-3}; /**< Absolute tolerance. */
+    double relativeTolerance{1e-3}; /**< Relative tolerance. */
+    int maxIterations{4000}; /**< Maximum number of iterations. */
+};
+
+/**
+ * Settings of the qpOASES solver.
+ */
+struct QpOASESSettings
+{
+    std::string preset{"default"}; /**< Options preset (default, reliable, mpc or fast). */
+    int maxWorkingSetRecalculations{100}; /**< Maximum number of working set recalculations (nWSR). */
+};
+
+namespace SolverSettings
+{
+    /**
+     * Parse the osqp settings. The keys that are not found keep their default value.
+     * @param config yarp searchable configuration variable (keys osqp_*);
+     * @param settings osqp settings.
+     * @return true/false in case of success/failure.
+     */
+    bool parseOsqpSettings(const yarp::os::Searchable& config, OsqpSettings& settings);
+
+    /**
+     * Apply the osqp settings. The solver must not be initialized.
+     * @param settings osqp settings;
+     * @param solver osqp solver.
+     * @return true/false in case of success/failure.
+     */
+    bool applyOsqpSettings(const OsqpSettings& settings, OsqpEigen::Solver& solver);
+
+    /**
+     * Parse the qpOASES settings. The keys that are not found keep their default value.
+     * @param config yarp searchable configuration variable (keys qpoases_*);
+     * @param settings qpOASES settings.
+     * @return true/false in case of success/failure.
+     */
+    bool parseQpOASESSettings(const yarp::os::Searchable& config, QpOASESSettings& settings);
+
+    /**
+     * Apply the qpOASES options preset.
+     * @param settings qpOASES settings;
+     * @param solver qpOASES solver.
+     * @return true/false in case of success/failure.
+     */
+    bool applyQpOASESSettings(const QpOASESSettings& settings, qpOASES::SQProblem& solver);
+}
+
+#endif
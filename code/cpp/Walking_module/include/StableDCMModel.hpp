@@ -33,7 +33,7 @@ class StableDCMModel
 
     iDynTree::Vector2 m_dcmPosition; /**< Position of the DCM. */
     iDynTree::Vector2 m_comPosition; /**< Position of the CoM. */
-    iDynTree::Vector2 m_comVelocity; /**< Velocity of the CoM. */
+    yarp::sig::Vector m_comVelocity; /**< Velocity of the CoM (it is also the input of the integrator). */
 
     bool m_isModelPropagated{false}; /**< True if the model is propagated. */
 
@@ -77,6 +77,13 @@ public:
      * @return true/false in case of success/failure
      */
     bool reset(const iDynTree::Vector2& initialValue);
+
+    /**
+     * Set the sampling time of the model integrator.
+     * @param samplingTime new sampling time (in seconds)
+     * @return true/false in case of success/failure
+     */
+    bool setSamplingTime(const double& samplingTime);
 };
 
 #endif
@@ -0,0 +1,131 @@
+/**
+ * @file ThreadTelemetry.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef THREAD_TELEMETRY_HPP
+#define THREAD_TELEMETRY_HPP
+
+// std
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+#include "WalkingThreadPool.hpp"
+
+/**
+ * Scheduler counters of a thread.
+ */
+struct SchedulingCounters
+{
+    double runTime{0.0}; /**< Time spent on a CPU [s]. */
+    double waitTime{0.0}; /**< Time spent waiting on a run queue [s]. */
+    long voluntarySwitches{0}; /**< Voluntary context switches. */
+    long involuntarySwitches{0}; /**< Involuntary context switches (preemptions). */
+    long migrations{0}; /**< Number of samples where the thread ran on a different CPU. */
+    int windows{0}; /**< Number of sampling windows. */
+};
+
+/**
+ * Scheduler statistics of a thread of the walking module.
+ */
+struct ThreadSchedulingStatistics
+{
+    int tid{-1}; /**< Thread id. */
+    int cpu{-1}; /**< CPU of the last run. */
+    SchedulingCounters previous; /**< Counters read in the previous sample (cumulative). */
+    SchedulingCounters normal; /**< Counters accumulated in the windows without overruns. */
+    SchedulingCounters overrun; /**< Counters accumulated in the windows with at least one overrun. */
+};
+
+/**
+ * ThreadTelemetry class samples the scheduler statistics of the threads of the walking module
+ * (/proc/self/task/<tid>/schedstat, status and stat) every few ticks of the control thread.
+ * The control thread only records the overruns and the end of each window, the files are read
+ * by a low priority task of the thread pool. The task may run late, so the lag between the end
+ * of the window and the sample is measured: a window whose first or last sample is later than
+ * thread_telemetry_max_lag is discarded, since its counters contain the ticks of another window.
+ * The counters of each sampling window are accumulated separately for the windows that
+ * contain an overrun, so the interference of the OS (preemptions, run queue delays and
+ * migrations) can be told apart from the cost of the controller.
+ * The threads are identified by their name (see setCurrentThreadName()), the control thread
+ * is the main thread of the process.
+ */
+class ThreadTelemetry
+{
+    int m_period{0}; /**< Number of ticks between two samples (0 if the telemetry is disabled). */
+    int m_ticks{0}; /**< Number of ticks since the last sample. */
+    bool m_isOverrun{false}; /**< True if the current window contains an overrun. */
+    WalkingThreadPool* m_threadPool{nullptr}; /**< Pool that reads the counters (it has to outlive the telemetry). */
+    std::atomic<bool> m_isSamplePending{false}; /**< True if a sample task is queued or running. */
+    std::atomic<bool> m_isSampleOverrun{false}; /**< True if the window of the pending sample contains an overrun. */
+    std::atomic<std::chrono::steady_clock::rep> m_windowEndTime{0}; /**< End of the window of the pending sample. */
+    double m_maxLag{0.0}; /**< Maximum delay between the end of a window and its sample [s]. */
+
+    std::mutex m_mutex; /**< Mutex. */
+    std::map<std::string, ThreadSchedulingStatistics> m_threads; /**< Statistics of each thread. */
+    bool m_isPreviousSampleLate{true}; /**< True if the sample that opened the current window was late (or missing). */
+    int m_numberOfSamples{0}; /**< Number of samples. */
+    int m_numberOfRejectedWindows{0}; /**< Number of windows discarded because of a late sample. */
+    double m_meanLag{0.0}; /**< Mean delay between the end of a window and its sample [s]. */
+    double m_maxObservedLag{0.0}; /**< Maximum delay between the end of a window and its sample [s]. */
+
+    /**
+     * Read the counters of all the threads of the module and update the statistics
+     * (task of the thread pool).
+     */
+    void sample();
+
+public:
+
+    /**
+     * Set the name of the calling thread. The threads of the module are named walk-<name>
+     * (at most 15 characters).
+     * @param name name of the thread.
+     */
+    static void setCurrentThreadName(const std::string& name);
+
+    /**
+     * Read the configuration.
+     * @param config configuration (thread_telemetry_period and thread_telemetry_max_lag);
+     * @param threadPool pool used to read the counters (it has to outlive the telemetry).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config, WalkingThreadPool& threadPool);
+
+    /**
+     * Check if the telemetry is enabled.
+     * @return true if the threads are sampled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Update the telemetry. The function has to be called by the control thread once per tick,
+     * it never reads the counters (a sample task is submitted at the end of each window).
+     * @param isOverrun true if the tick was longer than the period.
+     */
+    void update(const bool& isOverrun);
+
+    /**
+     * Reset all the statistics.
+     */
+    void reset();
+
+    /**
+     * Add the statistics to a bottle. The bottle contains a (threads (...)) entry with the
+     * counters of each thread and a (thread_sampling (...)) entry with the lag of the samples.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+};
+
+#endif
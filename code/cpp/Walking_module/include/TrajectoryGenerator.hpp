@@ -10,8 +10,8 @@
 #define TRAJECTORY_GENERATOR_HPP
 
 // std
-#include <thread>
 #include <condition_variable>
+#include <mutex>
 
 // YARP
 #include <yarp/os/Searchable.h>
@@ -21,10 +21,12 @@
 
 #include "UnicycleTrajectoryGenerator.h"
 
+#include "WalkingThreadPool.hpp"
+
 /**
  * Enumerator useful to track the state of the trajectory generator
  */
-enum class GeneratorState {NotConfigured, Configured, FirstStep, Called, Returned, Closing};
+enum class GeneratorState {NotConfigured, Configured, FirstStep, Called, Returned};
 
 /**
  * TrajectoryGenerator class is used to handle the UnicycleTrajectoryGenerator library.
@@ -40,13 +42,14 @@ class TrajectoryGenerator
 
     double m_nominalWidth; /**< Nominal width between two feet. */
     double m_initTime; /**< Init time of the current trajectory. */
+    double m_planningDuration{0.0}; /**< Time spent to evaluate the last trajectory [s]. */
 
     iDynTree::Vector2 m_referencePointDistance; /**< Vector between the center of the unicycle and the point that has to be reach the goal. */
 
     GeneratorState m_generatorState{GeneratorState::NotConfigured}; /**< Useful to track the generator state. */
 
-    std::thread m_generatorThread; /**< Main trajectory thread. */
-    std::condition_variable m_conditionVariable; /**< Synchronizer. */
+    WalkingThreadPool* m_threadPool{nullptr}; /**< Pool that evaluates the trajectories (it has to outlive the generator). */
+    std::condition_variable m_conditionVariable; /**< Used to wait for the trajectory under evaluation. */
 
     bool m_correctLeft; /**< The left foot has to be corrected. */
     iDynTree::Transform m_measuredTransformLeft; /**< Measured transformation between the left foot and the world frame. (w_H_lf) */
@@ -60,23 +63,24 @@ class TrajectoryGenerator
     std::mutex m_mutex; /**< Mutex. */
 
     /**
-     * Main thread method.
+     * Evaluate the trajectory asked by updateTrajectories() (thread pool task).
      */
-    void computeThread();
+    void computeTrajectory();
 
 public:
 
     /**
-     * Deconstructor.
+     * Deconstructor. It waits for the trajectory under evaluation.
      */
     ~TrajectoryGenerator();
 
     /**
      * Initialize the trajectory generator
-     * @param config yarp searchable object.
+     * @param config yarp searchable object;
+     * @param threadPool pool used to evaluate the trajectories (it has to outlive the generator).
      * @return true/false in case of success/failure.
      */
-    bool initialize(const yarp::os::Searchable& config);
+    bool initialize(const yarp::os::Searchable& config, WalkingThreadPool& threadPool);
 
     /**
      * Configure the planner.
@@ -205,6 +209,13 @@ public:
      * @return true/false in case of success/failure.
      */
     bool getMergePoints(std::vector<size_t>& mergePoints);
+
+    /**
+     * Get the time spent to evaluate the last trajectory.
+     * @param planningDuration duration of the planner [s].
+     * @return true/false in case of success/failure.
+     */
+    bool getPlanningDuration(double& planningDuration);
 };
 
 #endif
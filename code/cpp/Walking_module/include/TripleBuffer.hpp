@@ -0,0 +1,69 @@
+/**
+ * @file TripleBuffer.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+// std
+#include <array>
+#include <atomic>
+
+/**
+ * TripleBuffer class shares the last value produced by a writer thread with a reader thread.
+ * Both the writer and the reader are wait-free: they never block and never wait for each other.
+ * The writer fills its own buffer and publishes it by swapping it with the middle one, the reader
+ * takes the middle buffer only if a new value has been published. Intermediate values may be lost.
+ * Only one writer and one reader are allowed.
+ */
+template <typename T>
+class TripleBuffer
+{
+    static constexpr unsigned s_indexMask = 0x3; /**< Bits containing the index of the middle buffer. */
+    static constexpr unsigned s_newDataFlag = 0x4; /**< Set if the middle buffer has not been read yet. */
+
+    std::array<T, 3> m_buffers; /**< Buffers. */
+    std::atomic<unsigned> m_middle{1}; /**< Index of the middle buffer and new data flag. */
+    unsigned m_writeIndex{0}; /**< Index of the buffer owned by the writer. */
+    unsigned m_readIndex{2}; /**< Index of the buffer owned by the reader. */
+
+public:
+
+    /**
+     * Set all the buffers to the same value (e.g. to preallocate them) and discard the
+     * published value. It is not thread safe: call it before the writer and the reader start.
+     * @param value initial value of the buffers.
+     */
+    void reset(const T& value);
+
+    /**
+     * Get the buffer owned by the writer.
+     * @return reference to the buffer that will be published.
+     */
+    T& getWriteBuffer();
+
+    /**
+     * Publish the buffer owned by the writer (writer side).
+     */
+    void publish();
+
+    /**
+     * Take the last published buffer (reader side).
+     * @return true if a new value has been published since the last call, false otherwise.
+     */
+    bool update();
+
+    /**
+     * Get the buffer owned by the reader.
+     * @return reference to the last value taken by update().
+     */
+    const T& getReadBuffer() const;
+};
+
+#include "TripleBuffer.tpp"
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file TripleBuffer.tpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+template <typename T>
+void TripleBuffer<T>::reset(const T& value)
+{
+    m_buffers.fill(value);
+    m_writeIndex = 0;
+    m_middle.store(1, std::memory_order_relaxed);
+    m_readIndex = 2;
+}
+
+template <typename T>
+T& TripleBuffer<T>::getWriteBuffer()
+{
+    return m_buffers[m_writeIndex];
+}
+
+template <typename T>
+void TripleBuffer<T>::publish()
+{
+    // the release order makes the content of the buffer visible to the reader
+    unsigned previousMiddle = m_middle.exchange(m_writeIndex | s_newDataFlag,
+                                                std::memory_order_acq_rel);
+    m_writeIndex = previousMiddle & s_indexMask;
+}
+
+template <typename T>
+bool TripleBuffer<T>::update()
+{
+    if(!(m_middle.load(std::memory_order_relaxed) & s_newDataFlag))
+        return false;
+
+    unsigned previousMiddle = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+    m_readIndex = previousMiddle & s_indexMask;
+    return true;
+}
+
+template <typename T>
+const T& TripleBuffer<T>::getReadBuffer() const
+{
+    return m_buffers[m_readIndex];
+}
@@ -22,6 +22,7 @@
 
 #include <unordered_map>
 #include <deque>
+#include <vector>
 
 // solver
 #include "MPCSolver.hpp"
@@ -59,12 +60,33 @@ class WalkingController
 
     int m_stateSize; /**< Size of the state vector. It is equal to 2. */
     int m_inputSize;  /**< Size of the input vector. It is equal to 2. */
-    int m_controllerHorizon; /**< Length of the controller horizon. */
+    int m_controllerHorizon; /**< Length of the controller horizon (number of preview intervals). */
+
+    /**
+     * Length of each preview interval expressed as a multiple of the reference sampling time.
+     * The first intervals are as long as the controller period while the remaining ones are
+     * coarseSamplingFactor times longer.
+     */
+    std::vector<int> m_previewSteps;
+    std::vector<std::size_t> m_previewNodes; /**< Index of the reference sample associated to each node
+                                        of the preview grid (m_controllerHorizon + 1 elements). */
+    bool m_isPreviewGridUniform; /**< True if all the preview intervals have the same length. */
+    std::deque<iDynTree::Vector2> m_referenceWindow; /**< Reference signal sampled on the preview grid. */
 
     double m_convexHullTolerance; /**< This is the maximum acceptable distance between the solution and the convex hull. */
 
+    double m_dT; /**< Sampling time of the reference signal. */
+    double m_controllerHorizonSeconds; /**< Length of the controller horizon (in seconds). */
+    double m_fineHorizonSeconds; /**< Length of the part of the horizon sampled with the controller period. */
+    int m_coarseSamplingFactor; /**< Ratio between the coarse intervals and the controller period. */
+    double m_omega; /**< Inverted time constant of the 3D-LIPM. */
+    iDynTree::Triplets m_stateWeightTriplets; /**< State weight matrix (Q). */
+    iDynTree::Triplets m_inputWeightTriplets; /**< Input weight matrix (R). */
+
     std::pair<bool, bool> m_feetStatus; /**< Current status of the feet. Left and Right. True is used
                                            if the foot is in contact. */
+    bool m_isSolverRebuilt{false}; /**< True if the last call of setConvexHullConstraint() instantiated
+                                      a new solver (i.e. the contact configuration changed). */
 
     iDynTree::ConvexHullProjectionConstraint m_convexHullComputer; /**<iDynTree convex hull helper. */
     std::vector<iDynTree::Polygon> m_feetPolygons; /**<Vector containing the polygon of each foot (left and right). */
@@ -79,6 +101,10 @@ class WalkingController
 
     iDynTree::Vector2 m_output; /**< Vector containing the output of the controller. */
 
+    OsqpSettings m_solverSettings; /**< Settings of the solver. */
+    SolverAccuracy m_accuracy; /**< Termination criteria of the solver. */
+    bool m_useCustomAccuracy{false}; /**< True if the default termination criteria are overwritten. */
+
     /**
      * Initialize the quantities useful in the inequality constraints evaluation.
      * @param config yarp searchable configuration variable.
@@ -93,9 +119,25 @@ class WalkingController
      */
     bool initializeMatrices(const yarp::os::Searchable& config);
 
+    /**
+     * Evaluate the constant matrices of the optimization problem for a given controller period.
+     * @param samplesPerStep ratio between the controller period and the reference sampling time.
+     * @return true/false in case of success/failure.
+     */
+    bool evaluateMatrices(const int& samplesPerStep);
+
+    /**
+     * Evaluate the preview grid, i.e. the length of each interval of the controller horizon.
+     * @param samplesPerStep ratio between the controller period and the reference sampling time.
+     * @return true/false in case of success/failure.
+     */
+    bool evaluatePreviewGrid(const int& samplesPerStep);
+
     /**
      * Evaluate theta matrix. For further information please refers to the
      * [literature](https://github.com/loc2/element_capture-point-walking/issues/9)
+     * When the preview grid is not uniform each input variation is divided by the length of its
+     * interval, so that the rate of change of the input is penalized.
      * @return theta.
      */
     iDynSparseMatrix evaluateThetaMatrix();
@@ -147,26 +189,28 @@ class WalkingController
 
     /**
      * Evaluate the equal constraint matrix.
-     * @param stateDynamicsTriplets are the triplets related to the linear state dynamics matrix;
-     * @param inputDynamicsTriplets are the triplets related to the linear input dynamics matrix;
+     * @param stateDynamicsTriplets are the triplets related to the linear state dynamics matrix
+     * (one for each interval of the preview grid);
+     * @param inputDynamicsTriplets are the triplets related to the linear input dynamics matrix
+     * (one for each interval of the preview grid);
      * @return The equal constraints matrix.
      */
-    iDynTree::Triplets evaluateEqualConstraintsMatrix(const iDynTree::Triplets& stateDynamicsTriplets,
-                                                      const iDynTree::Triplets& inputDynamicsTriplets);
+    iDynTree::Triplets evaluateEqualConstraintsMatrix(const std::vector<iDynTree::Triplets>& stateDynamicsTriplets,
+                                                      const std::vector<iDynTree::Triplets>& inputDynamicsTriplets);
 
     /**
      * Evaluate the equal constraint state submatrix.
-     * @param stateDynamicsMatrix is the linear state dynamics matrix.
+     * @param stateDynamicsMatrix is the linear state dynamics matrix of each interval.
      * @return the equal constraint state submatrix.
      */
-    iDynTree::Triplets evaluateEqualConstraintsStateSubmatrix(const iDynTree::Triplets& stateDynamicsMatrix);
+    iDynTree::Triplets evaluateEqualConstraintsStateSubmatrix(const std::vector<iDynTree::Triplets>& stateDynamicsMatrix);
 
     /**
      * Evaluate the equal constraint input submatrix.
-     * @param inputDynamicsMatrix is the linear input dynamics matrix.
+     * @param inputDynamicsMatrix is the linear input dynamics matrix of each interval.
      * @return the equal constraint input submatrix.
      */
-    iDynTree::Triplets evaluateEqualConstraintsInputSubmatrix(const iDynTree::Triplets& inputDynamicsMatrix);
+    iDynTree::Triplets evaluateEqualConstraintsInputSubmatrix(const std::vector<iDynTree::Triplets>& inputDynamicsMatrix);
 
     /**
      * Build the convex hull for double support phase.
@@ -211,6 +255,14 @@ public:
                                  const std::deque<bool>& leftInContact,
                                  const std::deque<bool>& rightInContact);
 
+    /**
+     * Set the controller period. The matrices of the problem are evaluated again and a new
+     * MPCSolver will be initialized at the next call of setConvexHullConstraint().
+     * @param samplingTime controller period. It has to be a multiple of the reference sampling time.
+     * @return true/false in case of success/failure.
+     */
+    bool setSamplingTime(const double& samplingTime);
+
     /**
      * Set the feedback.
      * @param currentState current value of the state.
@@ -220,7 +272,8 @@ public:
 
     /**
      * Set the reference signal
-     * @param reference signal deque containing the reference signal.
+     * If the preview grid is not uniform the signal is sampled on the nodes of the grid.
+     * @param reference signal deque containing the reference signal (one sample every sampling time).
      * @param resetTrajectory set equal to true if you do clear the old trajectory.
      * @return true/false in case of success/failure.
      */
@@ -233,6 +286,41 @@ public:
      */
     bool solve();
 
+    /**
+     * Set the termination criteria of the solver. The criteria are applied to the current
+     * MPCSolver and to the ones that will be initialized at the next phases.
+     * @param accuracy tolerances and maximum number of iterations.
+     * @return true/false in case of success/failure.
+     */
+    bool setAccuracy(const SolverAccuracy& accuracy);
+
+    /**
+     * Get the statistics of the last solution.
+     * @return number of iterations and residuals.
+     */
+    SolverStatistics getStatistics();
+
+    /**
+     * Check if the last call of setConvexHullConstraint() instantiated a new solver.
+     * @return true if the contact configuration changed in the last call.
+     */
+    bool isSolverRebuilt() const;
+
+    /**
+     * Get the current optimization problem (useful to replay it offline).
+     * @param problem QP problem.
+     * @return true/false in case of success/failure.
+     */
+    bool getProblem(QPProblem& problem);
+
+    /**
+     * Get the solution of the current optimization problem (checkpoint of the recorded problems).
+     * @param primal primal solution;
+     * @param dual multipliers of the rows of the constraints matrix.
+     * @return true/false in case of success/failure.
+     */
+    bool getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual);
+
     /**
      * Get the output of the controller.
      * @param controllerOutput is the vector containing the output the controller.
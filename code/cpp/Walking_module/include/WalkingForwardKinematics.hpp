@@ -49,6 +49,7 @@ class WalkingFK
     std::unique_ptr<iCub::ctrl::FirstOrderLowPassFilter> m_comVelocityFilter; /**< CoM velocity low pass filter. */
     yarp::sig::Vector m_comPositionFiltered; /**< Filtered position of the CoM. */
     yarp::sig::Vector m_comVelocityFiltered; /**< Filtered velocity of the CoM. */
+    yarp::sig::Vector m_comFilterInput; /**< Preallocated input of the CoM filters. */
     bool m_useFilters; /**< If it is true the filters will be used. */
 
     bool m_firstStep; /**< True only during the first step. */
@@ -217,6 +218,13 @@ public:
      * @return true/false in case of success/failure.
      */
     bool getCoMJacobian(iDynTree::MatrixDynSize &jacobian);
+
+    /**
+     * Set the sampling time of the CoM filters.
+     * @param samplingTime new sampling time (in seconds)
+     * @return true/false in case of success/failure.
+     */
+    bool setSamplingTime(const double& samplingTime);
 };
 
 #endif
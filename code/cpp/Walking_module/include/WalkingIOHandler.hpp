@@ -0,0 +1,211 @@
+/**
+ * @file WalkingIOHandler.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_IO_HANDLER_HPP
+#define WALKING_IO_HANDLER_HPP
+
+// std
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+// POSIX
+#include <semaphore.h>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/dev/IEncodersTimed.h>
+#include <yarp/dev/IPositionDirect.h>
+
+#include "RealTimeSettings.hpp"
+#include "TripleBuffer.hpp"
+
+/**
+ * Feedback acquired by the I/O thread.
+ */
+struct WalkingFeedbackSnapshot
+{
+    yarp::sig::Vector positionInDegrees; /**< Joint positions [deg]. */
+    yarp::sig::Vector velocityInDegrees; /**< Joint velocities [deg/s]. */
+    yarp::sig::Vector leftWrench; /**< Left foot wrench. */
+    yarp::sig::Vector rightWrench; /**< Right foot wrench. */
+    double time{0.0}; /**< Time at the end of the acquisition. */
+};
+
+/**
+ * Timing statistics of the I/O thread.
+ */
+struct WalkingIOStatistics
+{
+    double maxReadDuration{0.0}; /**< Maximum duration of the feedback acquisition [s]. */
+    double meanReadDuration{0.0}; /**< Mean duration of the feedback acquisition [s]. */
+    double maxWriteDuration{0.0}; /**< Maximum duration of the command write [s]. */
+    double meanWriteDuration{0.0}; /**< Mean duration of the command write [s]. */
+    int numberOfReads{0}; /**< Number of acquisitions. */
+    int numberOfWrites{0}; /**< Number of writes. */
+    int numberOfStalls{0}; /**< Number of reads or writes longer than the stall threshold. */
+    int numberOfLateFeedbacks{0}; /**< Number of ticks that waited for the feedback. */
+    int numberOfStaleWrenches{0}; /**< Number of acquisitions failed because a wrench was too old. */
+};
+
+/**
+ * WalkingIOHandler class moves the device I/O out of the control thread.
+ * The feedback is acquired by a dedicated thread just before the next tick is released
+ * and the joint references published by the tick are written as soon as they are available.
+ * The feedback and the references are exchanged through triple buffers, so the control thread
+ * never waits for the I/O thread unless the feedback of the current tick is missing.
+ */
+class WalkingIOHandler
+{
+    yarp::dev::IEncodersTimed* m_encodersInterface{nullptr}; /**< Encorders interface. */
+    yarp::dev::IPositionDirect* m_positionDirectInterface{nullptr}; /**< Direct position control interface. */
+    yarp::os::BufferedPort<yarp::sig::Vector>* m_leftWrenchPort{nullptr}; /**< Left foot wrench port. */
+    yarp::os::BufferedPort<yarp::sig::Vector>* m_rightWrenchPort{nullptr}; /**< Right foot wrench port. */
+    int m_actuatedDOFs{0}; /**< Number of the actuated DoFs. */
+    RealTimeSettings m_realTimeSettings; /**< Real-time settings of the I/O thread. */
+
+    std::thread m_thread; /**< I/O thread. */
+    std::atomic<bool> m_isRunning{false}; /**< True if the I/O thread is running. */
+    sem_t m_wakeUp; /**< Posted by the control thread to wake up the I/O thread. */
+    sem_t m_feedbackReady; /**< Posted by the I/O thread when a requested feedback is acquired. */
+
+    TripleBuffer<WalkingFeedbackSnapshot> m_feedback; /**< Feedback (written by the I/O thread). */
+    std::atomic<bool> m_isFeedbackRequested{false}; /**< True if the control thread is waiting for a feedback. */
+    std::atomic<bool> m_isFeedbackFailed{false}; /**< True if the last acquisition failed. */
+    yarp::sig::Vector m_lastLeftWrench; /**< Last left foot wrench received (used only by the I/O thread). */
+    yarp::sig::Vector m_lastRightWrench; /**< Last right foot wrench received (used only by the I/O thread). */
+    double m_leftWrenchTime{0.0}; /**< Time of the last left foot wrench (or of the start of the thread). */
+    double m_rightWrenchTime{0.0}; /**< Time of the last right foot wrench (or of the start of the thread). */
+    double m_maxWrenchAge; /**< The acquisition fails if a wrench is older than this age [s]. */
+
+    TripleBuffer<yarp::sig::Vector> m_command; /**< Joint references [deg] (written by the control thread). */
+    std::atomic<bool> m_isCommandFailed{false}; /**< True if the last write failed. */
+
+    double m_prefetchLead; /**< The feedback is acquired m_prefetchLead seconds before the next tick. */
+    std::atomic<double> m_prefetchTime{0.0}; /**< Time of the next acquisition. */
+    std::atomic<bool> m_isPrefetchScheduled{false}; /**< True if the feedback for the next tick has to be acquired. */
+    double m_stallThreshold; /**< Reads and writes longer than this threshold are considered stalls. */
+
+    WalkingIOStatistics m_statistics; /**< Timing statistics (updated by the I/O thread). */
+    std::atomic<int> m_numberOfLateFeedbacks{0}; /**< Number of ticks that waited for the feedback. */
+    mutable std::mutex m_statisticsMutex; /**< Mutex of the statistics (shared with the rpc thread). */
+
+    /**
+     * Outcome of an acquisition.
+     */
+    enum class FeedbackStatus
+    {
+        Ready, /**< The feedback is acquired. */
+        Waiting, /**< A wrench has not been received yet, but it is not too old. */
+        Failed /**< The interfaces failed or a wrench is too old. */
+    };
+
+    /**
+     * Acquire the feedback. The wrench ports are never read in blocking mode.
+     * @param snapshot snapshot that will contain the feedback.
+     * @return the outcome of the acquisition.
+     */
+    FeedbackStatus readFeedback(WalkingFeedbackSnapshot& snapshot);
+
+    /**
+     * Main loop of the I/O thread.
+     * @param isStarted set when the real-time settings are applied to the I/O thread.
+     */
+    void ioThread(std::promise<bool> isStarted);
+
+public:
+
+    /**
+     * Constructor
+     * @param prefetchLead the feedback is acquired prefetchLead seconds before the next tick;
+     * @param stallThreshold reads and writes longer than this threshold are considered stalls;
+     * @param maxWrenchAge the acquisition fails if no new wrench is received for maxWrenchAge seconds.
+     */
+    WalkingIOHandler(const double& prefetchLead, const double& stallThreshold,
+                     const double& maxWrenchAge);
+
+    /**
+     * Destructor. The I/O thread is stopped.
+     */
+    ~WalkingIOHandler();
+
+    /**
+     * Start the I/O thread.
+     * @param encodersInterface encoders interface;
+     * @param positionDirectInterface direct position control interface;
+     * @param leftWrenchPort left foot wrench port;
+     * @param rightWrenchPort right foot wrench port;
+     * @param actuatedDOFs number of the actuated DoFs;
+     * @param realTimeSettings real-time settings applied by the I/O thread (the thread may be
+     * started by a thread with the default scheduling, so the settings are not inherited).
+     * @return true/false in case of success/failure.
+     */
+    bool start(yarp::dev::IEncodersTimed* encodersInterface,
+               yarp::dev::IPositionDirect* positionDirectInterface,
+               yarp::os::BufferedPort<yarp::sig::Vector>* leftWrenchPort,
+               yarp::os::BufferedPort<yarp::sig::Vector>* rightWrenchPort,
+               const int& actuatedDOFs,
+               const RealTimeSettings& realTimeSettings);
+
+    /**
+     * Stop the I/O thread.
+     */
+    void stop();
+
+    /**
+     * Return true if the I/O thread is running.
+     * @return true if the I/O thread is running.
+     */
+    bool isRunning() const;
+
+    /**
+     * Take the feedback acquired for the current tick and schedule the acquisition for the next one.
+     * If the feedback is not ready the control thread waits for a new acquisition.
+     * @param tickReleaseTime time at which the current tick has been released;
+     * @param period period of the control thread (used to schedule the next acquisition);
+     * @param timeout maximum waiting time.
+     * @return true/false in case of success/failure.
+     */
+    bool getFeedback(const double& tickReleaseTime, const double& period, const double& timeout);
+
+    /**
+     * Get the feedback taken by the last call of getFeedback() (control thread only).
+     * @return the feedback snapshot.
+     */
+    const WalkingFeedbackSnapshot& getFeedbackSnapshot() const;
+
+    /**
+     * Publish the joint references. They are written by the I/O thread.
+     * @param positionsInDegrees desired joint positions [deg] (one for each actuated DoF).
+     * @return false if the previous command was not written, true otherwise.
+     */
+    bool setDirectPositionReferences(const double* positionsInDegrees);
+
+    /**
+     * Get the timing statistics.
+     * @return the statistics.
+     */
+    WalkingIOStatistics getStatistics() const;
+
+    /**
+     * Reset the timing statistics.
+     */
+    void resetStatistics();
+
+    /**
+     * Add the timing statistics to a bottle.
+     * The bottle contains a (io ((reads r) (mean_read_ms m) ...)) entry.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle) const;
+};
+
+#endif
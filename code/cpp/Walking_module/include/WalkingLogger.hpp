@@ -9,22 +9,71 @@
 #ifndef WALKING_LOGGER_HPP
 #define WALKING_LOGGER_HPP
 
+// std
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// POSIX
+#include <semaphore.h>
+
 // YARP
+#include <yarp/os/Bottle.h>
 #include <yarp/os/Searchable.h>
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/RpcClient.h>
 #include <yarp/sig/Vector.h>
 
+/**
+ * WalkingLogger class sends the data of the controller to the logger module.
+ * The control thread copies each sample in a bounded queue and a sender thread writes the
+ * samples on the port, so the control thread never waits for the logger. When the queue is
+ * full the sample is dropped and counted.
+ */
 class WalkingLogger
 {
-    yarp::os::BufferedPort<yarp::sig::Vector> m_dataPort; /**< Data logger port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_dataPort; /**< Data logger port (used by the sender thread). */
     yarp::os::RpcClient m_rpcPort; /**< RPC data logger port. */
 
+    std::vector<yarp::sig::Vector> m_queue; /**< Ring of the samples waiting to be sent. */
+    std::atomic<unsigned long> m_queueHead{0}; /**< Number of samples taken by the sender thread. */
+    std::atomic<unsigned long> m_queueTail{0}; /**< Number of samples added by the control thread. */
+    std::atomic<unsigned long> m_droppedSamples{0}; /**< Number of samples dropped because the queue was full. */
+    std::atomic<unsigned long> m_maxQueuedSamples{0}; /**< Maximum number of queued samples. */
+    sem_t m_samplesReady; /**< Posted by the control thread for each queued sample. */
+    std::thread m_senderThread; /**< Thread that writes the samples on the port. */
+    std::atomic<bool> m_isRunning{false}; /**< True if the sender thread is running. */
+
+    unsigned long m_sequenceNumber{0}; /**< Sequence number of the next sample. */
+    double m_tickTime{0.0}; /**< Time of the controller tick of the next sample [s]. */
+    double m_acquisitionTime{0.0}; /**< Time of the sensor acquisition of the next sample [s]. */
+
+    /**
+     * Main loop of the sender thread.
+     */
+    void senderThread();
+
+    /**
+     * Send the queued samples and stop the sender thread.
+     */
+    void stopSender();
+
 public:
 
+    /**
+     * Constructor.
+     */
+    WalkingLogger();
+
+    /**
+     * Destructor. The sender thread is stopped.
+     */
+    ~WalkingLogger();
+
     /**
      * Configure
-     * @param config yarp searchable configuration variable;
+     * @param config yarp searchable configuration variable (queue_size is the number of samples
+     * that can wait to be sent, 100 by default);
      * @param name is the name of the module.
      * @return true/false in case of success/failure.
      */
@@ -38,12 +87,41 @@ public:
     bool startRecord(const std::initializer_list<std::string>& strings);
 
     /**
-     * Quit the logger.
+     * Quit the logger. The queued samples are sent before closing the stream.
      */
     void quit();
 
     /**
-     * Send data to the logger.
+     * Add the counters of the sender to a bottle.
+     * The bottle contains a (logger ((sent s) (dropped d) (queued q) (max_queued m))) entry.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle) const;
+
+    /**
+     * Reset the counters of the sender.
+     */
+    void resetStatistics();
+
+    /**
+     * Set the timestamps of the next sample.
+     * @param tickTime time of the beginning of the controller tick [s];
+     * @param acquisitionTime time of the sensor acquisition [s].
+     */
+    void setTimestamps(const double& tickTime, const double& acquisitionTime);
+
+    /**
+     * Set the timestamps of the next sample. The acquisition time is equal to the tick time.
+     * @param tickTime time of the beginning of the controller tick [s].
+     */
+    void setTimestamps(const double& tickTime);
+
+    /**
+     * Send data to the logger. Each sample starts with the sequence number, the tick time and
+     * the acquisition time, so the logger can detect lost and reordered samples and the dataset
+     * is not affected by the port latency. The call never blocks: the sample is copied in the
+     * queue of the sender thread or, if the queue is full, it is dropped (its sequence number is
+     * skipped, so the logger counts it as dropped too).
      * @param args all the vector containing the data that will be sent.
      */
     template <typename... Args>
@@ -11,5 +11,26 @@
 template <typename... Args>
 void WalkingLogger::sendData(const Args&... args)
 {
-    YarpHelper::sendVariadicVector(m_dataPort, args...);
+    unsigned long tail = m_queueTail.load(std::memory_order_relaxed);
+    unsigned long queuedSamples = tail - m_queueHead.load(std::memory_order_acquire);
+    if(queuedSamples >= m_queue.size())
+    {
+        m_sequenceNumber++;
+        m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // the slot keeps its capacity, so after the first samples the copy does not allocate
+    yarp::sig::Vector& vector = m_queue[tail % m_queue.size()];
+    vector.clear();
+
+    vector.push_back(static_cast<double>(m_sequenceNumber++));
+    vector.push_back(m_tickTime);
+    vector.push_back(m_acquisitionTime);
+    YarpHelper::mergeSigVector(vector, args...);
+
+    m_queueTail.store(tail + 1, std::memory_order_release);
+    if(queuedSamples + 1 > m_maxQueuedSamples.load(std::memory_order_relaxed))
+        m_maxQueuedSamples.store(queuedSamples + 1, std::memory_order_relaxed);
+    sem_post(&m_samplesReady);
 }
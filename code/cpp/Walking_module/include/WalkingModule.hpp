@@ -10,6 +10,7 @@
 #define WALKING_MODULE_HPP
 
 // std
+#include <atomic>
 #include <memory>
 #include <deque>
 
@@ -40,6 +41,17 @@
 #include "WalkingPIDHandler.hpp"
 #include "WalkingLogger.hpp"
 #include "TimeProfiler.hpp"
+#include "SolverAccuracySchedule.hpp"
+#include "QPProblemRecorder.hpp"
+#include "WalkingIOHandler.hpp"
+#include "WalkingStatePublisher.hpp"
+#include "WalkingStatistics.hpp"
+#include "ThreadTelemetry.hpp"
+#include "MemoryAccounting.hpp"
+#include "FlightRecorder.hpp"
+#include "RealTimeSettings.hpp"
+#include "WalkingStageGraph.hpp"
+#include "WalkingThreadPool.hpp"
 
 // iCub-ctrl
 #include <iCub/ctrl/filters.h>
@@ -49,6 +61,40 @@
 
 enum class WalkingFSM {Idle, Configured, Prepared, Walking, OnTheFly, Stance};
 
+/**
+ * Quantities exchanged by the stages of a control tick. Each field is written by a single stage
+ * and read only by the stages that depend on it. The structure is cleared at the beginning of
+ * every tick.
+ */
+struct WalkingTickData
+{
+    double initTime{0.0}; /**< Time at the beginning of the tick [s]. */
+    bool resetTrajectory{false}; /**< True if a new trajectory is merged in this tick (trajectory). */
+
+    iDynTree::Vector2 measuredDCM; /**< Measured DCM (estimation). */
+    iDynTree::Vector2 measuredZMP; /**< Measured ZMP (estimation). */
+    iDynTree::Position measuredCoM; /**< Measured CoM position (estimation). */
+    iDynTree::Vector3 measuredCoMVelocity; /**< Measured CoM velocity (estimation). */
+
+    iDynTree::Vector2 desiredCoMPositionXY; /**< Desired CoM position of the 3D-LIPM (reference). */
+    iDynTree::Vector2 desiredCoMVelocityXY; /**< Desired CoM velocity of the 3D-LIPM (reference). */
+
+    bool isSteadyState{false}; /**< True if the solvers are skipped (solvers). */
+
+    iDynTree::Vector2 desiredZMP; /**< Output of the DCM controller (dcm_control). */
+
+    iDynTree::Vector2 outputZMPCoMControllerPosition; /**< CoM position given by the ZMP controller (zmp_control). */
+    iDynTree::Vector2 outputZMPCoMControllerVelocity; /**< CoM velocity given by the ZMP controller (zmp_control). */
+
+    iDynTree::Position desiredCoMPosition; /**< Desired CoM position (inverse_kinematics). */
+    iDynTree::Vector3 desiredCoMVelocity; /**< Desired CoM velocity (inverse_kinematics). */
+
+    SolverStatistics mpcStatistics; /**< Statistics of the MPC (zero if it is skipped). */
+    SolverStatistics ikStatistics; /**< Statistics of the QP-IK (zero if it is skipped). */
+
+    WalkingTickStatistics statistics; /**< Statistics of the tick. */
+};
+
 /**
  * RFModule of the 2D-DCM dynamics model.
  */
@@ -56,7 +102,9 @@ class WalkingModule:
     public yarp::os::RFModule,
     public WalkingCommands
 {
-    double m_dT; /**< RFModule period. */
+    double m_dT; /**< Sampling time of the reference signals (RFModule period while walking). */
+    int m_stanceRateMultiplier; /**< Ratio between the RFModule period in stance and m_dT. */
+    int m_rateMultiplier; /**< Ratio between the current RFModule period and m_dT. */
     double m_time; /**< Current time. */
     std::string m_robot; /**< Robot name. */
 
@@ -67,7 +115,21 @@ class WalkingModule:
     bool m_useQPIK; /**< True if the QP-IK is used. */
     bool m_useOSQP; /**< True if osqp is used to QP-IK problem. */
     bool m_dumpData; /**< True if data are saved. */
-
+    bool m_recordQPProblems; /**< True if the QP problems are saved (they can be replayed by the solver autotuner). */
+
+    // related to the steady state fast path
+    bool m_useSteadyStateFastPath; /**< True if the MPC and the IK are not solved while the robot is standing still. */
+    double m_steadyStateDCMTolerance; /**< Max distance between the measured DCM and the one of the last full solve. */
+    double m_steadyStateZMPTolerance; /**< Max distance between the measured ZMP and the one of the last full solve. */
+    int m_steadyStateMaxSkippedTicks; /**< Max number of consecutive ticks in which the solvers are not called. */
+    int m_steadyStateSkippedTicks; /**< Number of ticks since the last full solve. */
+    bool m_isSteadyStateSnapshotValid; /**< True if the quantities of the last full solve can be reused. */
+    iDynTree::Vector2 m_steadyStateMeasuredDCM; /**< Measured DCM at the last full solve. */
+    iDynTree::Vector2 m_steadyStateMeasuredZMP; /**< Measured ZMP at the last full solve. */
+    iDynTree::Vector2 m_steadyStateDesiredDCM; /**< Desired DCM at the last full solve. */
+    iDynTree::Vector2 m_steadyStateDesiredZMP; /**< Output of the DCM controller at the last full solve. */
+
+    std::unique_ptr<WalkingThreadPool> m_threadPool; /**< Pool of the background work (it is destroyed after its users). */
     std::unique_ptr<TrajectoryGenerator> m_trajectoryGenerator; /**< Pointer to the trajectory generator object. */
     std::unique_ptr<WalkingController> m_walkingController; /**< Pointer to the walking DCM MPC object. */
     std::unique_ptr<WalkingDCMReactiveController> m_walkingDCMReactiveController; /**< Pointer to the walking DCM reactive controller object. */
@@ -80,6 +142,29 @@ class WalkingModule:
     std::unique_ptr<WalkingPIDHandler> m_PIDHandler; /**< Pointer to the PID handler object. */
     std::unique_ptr<WalkingLogger> m_walkingLogger; /**< Pointer to the Walking Logger object. */
     std::unique_ptr<TimeProfiler> m_profiler; /**< Time profiler. */
+    bool m_useIOThread; /**< True if the device I/O is performed by a dedicated thread. */
+    std::unique_ptr<WalkingIOHandler> m_IOHandler; /**< Device I/O thread. */
+    RealTimeSettings m_realTimeSettings; /**< Real-time settings of the control thread and of the I/O thread. */
+    double m_tickReleaseTime{0.0}; /**< Time at which the current tick has been released. */
+    double m_feedbackTime; /**< Time at the end of the last feedback acquisition [s]. */
+    std::unique_ptr<WalkingStatePublisher> m_statePublisher; /**< Publisher of the controller state. */
+    std::unique_ptr<WalkingStatistics> m_statistics; /**< Statistics of the controller. */
+    std::unique_ptr<ThreadTelemetry> m_threadTelemetry; /**< Scheduler statistics of the threads. */
+    bool m_publishMetrics; /**< True if the statistics are streamed on the metrics port. */
+    double m_metricsPeriod; /**< Period of the metrics port [s]. */
+    double m_metricsPublishTime{0.0}; /**< Time of the last metrics message. */
+    std::atomic<bool> m_isMetricsPending{false}; /**< True while a metrics message is sent by the thread pool. */
+    yarp::os::BufferedPort<yarp::os::Bottle> m_metricsPort; /**< Metrics port. */
+    std::unique_ptr<FlightRecorder> m_flightRecorder; /**< In-memory recorder of the last seconds of telemetry. */
+    double m_watchdogTickDuration; /**< The flight recorder is dumped if a tick is longer than this value [s]. */
+    std::unique_ptr<QPProblemRecorder> m_MPCProblemRecorder; /**< Recorder of the MPC problems. */
+    std::unique_ptr<QPProblemRecorder> m_IKProblemRecorder; /**< Recorder of the QP-IK problems. */
+    QPProblem m_recordedProblem; /**< Buffer used to record the QP problems. */
+    Eigen::VectorXd m_recordedPrimal; /**< Buffer used to record the checkpoints (primal solution). */
+    Eigen::VectorXd m_recordedDual; /**< Buffer used to record the checkpoints (dual solution). */
+    std::unique_ptr<SolverAccuracySchedule> m_accuracySchedule; /**< Phase dependent accuracy of the QP solvers. */
+    std::unique_ptr<WalkingStageGraph> m_stageGraph; /**< Stages of the control tick. */
+    WalkingTickData m_tickData; /**< Quantities exchanged by the stages. */
 
     // related to the onTheFly feature
     std::unique_ptr<iCub::ctrl::minJerkTrajGen> m_jointsSmoother; /**< Minimum jerk trajectory for the joint during the
@@ -111,6 +196,9 @@ class WalkingModule:
     std::deque<double> m_comHeightTrajectory; /**< Deque containing the CoM height trajectory. */
     std::deque<double> m_comHeightVelocity; /**< Deque containing the CoM height velocity. */
     std::deque<size_t> m_mergePoints; /**< Deque containing the time position of the merge points. */
+    size_t m_nonStationarySamples{0}; /**< Number of samples at the beginning of the reference deques
+                                         that differ from the last sample (0 if the references are
+                                         constant for the whole trajectory). */
 
     std::deque<bool> m_isLeftFixedFrame; /**< Deque containing when the main frame of the left foot is the fixed frame
                                             In general a main frame of a foot is the fix frame only during the
@@ -141,6 +229,7 @@ class WalkingModule:
     iDynTree::VectorDynSize m_positionFeedbackInRadians; /**< Vector containing the current joint position [rad]. */
     iDynTree::VectorDynSize m_velocityFeedbackInRadians; /**< Vector containing the current joint velocity [rad/s]. */
     iDynTree::VectorDynSize m_toDegBuffer; /**< Vector containing the desired joint positions that will be sent to the robot [deg]. */
+    yarp::sig::Vector m_dqDesiredYarp; /**< Desired joint velocity used as input of the integrator [rad/s]. */
     iDynTree::VectorDynSize m_minJointsLimit; /**< Vector containing the max negative limits [rad/s]. */
     iDynTree::VectorDynSize m_maxJointsLimit; /**< Vector containing the max positive limits [rad/s]. */
 
@@ -165,6 +254,11 @@ class WalkingModule:
     bool m_useWrenchFilter; /**< True if the wrench filter is used. */
 
     yarp::os::Port m_rpcPort; /**< Remote Procedure Call port. */
+    yarp::os::BufferedPort<yarp::sig::Vector> m_goalPort; /**< Streamed goal port (sequence number, timestamp, x, y). */
+    unsigned long m_goalSequenceNumber; /**< Sequence number of the last streamed goal. */
+    yarp::sig::Vector m_pendingGoal; /**< Last streamed goal (sequence number, timestamp, x, y). */
+    bool m_isGoalPending; /**< True if the last streamed goal has not been applied yet. */
+    double m_goalTimeout; /**< The streamed goals older than this value are discarded [s]. */
 
     bool m_newTrajectoryRequired; /**< if true a new trajectory will be merged soon. (after m_newTrajectoryMergeCounter - 2 cycles). */
     size_t m_newTrajectoryMergeCounter; /**< The new trajectory will be merged after m_newTrajectoryMergeCounter - 2 cycles. */
@@ -217,12 +311,93 @@ class WalkingModule:
      */
     bool propagateReferenceSignals();
 
+    /**
+     * Update the termination criteria of the QP solvers if the contact phase is changed.
+     * @return true/false in case of success/failure.
+     */
+    bool updateSolversAccuracy();
+
+    /**
+     * Check if the robot is standing, i.e. the robot is in stance, no new trajectory is required
+     * and the reference signals are constant.
+     * @return true if the robot is standing and false otherwise.
+     */
+    bool isStanding();
+
+    /**
+     * Evaluate the number of samples at the beginning of the reference deques that differ from
+     * the last one. The whole trajectory is checked, so it has to be called only when the
+     * deques are updated; the number is then decreased when the references are propagated.
+     */
+    void evaluateNonStationarySamples();
+
+    /**
+     * Set the period of the RFModule. All the integrators, the filters and the MPC matrices
+     * are discretized again.
+     * @param rateMultiplier ratio between the new period and m_dT.
+     * @return true in case of success and false otherwise.
+     */
+    bool setControlPeriod(const int& rateMultiplier);
+
+    /**
+     * Reduce the period of the RFModule while the robot is standing and restore it as soon
+     * as a new trajectory is required.
+     * @return true in case of success and false otherwise.
+     */
+    bool updateControlPeriod();
+
+    /**
+     * Check if the robot is standing still, i.e. the robot is standing and the measured DCM
+     * and ZMP are close to the ones of the last full solve.
+     * In this case the previous solutions of the MPC and of the IK can be reused.
+     * @param measuredDCM measured position of the DCM;
+     * @param measuredZMP measured position of the ZMP;
+     * @param resetTrajectory true if a new trajectory has been merged in this tick.
+     * @return true if the solvers can be skipped and false otherwise.
+     */
+    bool isInSteadyState(const iDynTree::Vector2& measuredDCM, const iDynTree::Vector2& measuredZMP,
+                         const bool& resetTrajectory);
+
+    /**
+     * Store the quantities used to detect the steady state.
+     * @param measuredDCM measured position of the DCM;
+     * @param measuredZMP measured position of the ZMP;
+     * @param desiredZMP output of the DCM controller;
+     * @param isSteadyState true if the solvers were skipped in this tick.
+     */
+    void updateSteadyStateSnapshot(const iDynTree::Vector2& measuredDCM, const iDynTree::Vector2& measuredZMP,
+                                   const iDynTree::Vector2& desiredZMP, const bool& isSteadyState);
+
     /**
      * Get all the feedback signal from the interfaces
+     * If the I/O thread is running the feedback prefetched by the thread is used.
      * @return true in case of success and false otherwise.
      */
     bool getFeedbacks(unsigned int maxAttempts = 1);
 
+    /**
+     * Filter and convert the raw feedback signals.
+     * @return true in case of success and false otherwise.
+     */
+    bool evaluateFeedbacks();
+
+    /**
+     * Start the I/O thread (if it is required by the configuration).
+     * @return true in case of success and false otherwise.
+     */
+    bool startIOThread();
+
+    /**
+     * Send the statistics on the metrics port (thread pool task).
+     */
+    void publishMetrics();
+
+    /**
+     * Add the statistics of the controller to a bottle.
+     * @param statistics bottle containing the statistics.
+     */
+    void getStatistics(yarp::os::Bottle& statistics);
+
     /**
      * Get the higher position error among all joints.
      * @param desiredJointPositionsRad desired joint position in radiants;
@@ -343,6 +518,113 @@ class WalkingModule:
      */
     bool updateTrajectories(const size_t& mergePoint);
 
+    /**
+     * Set the desired final position of the CoM. The module mutex has to be locked.
+     * @param x desired x position of the CoM;
+     * @param y desired y position of the CoM.
+     * @return true in case of success and false otherwise.
+     */
+    bool applyGoal(const double& x, const double& y);
+
+    /**
+     * Read the last goal streamed on the goal port and apply it. A goal rejected by applyGoal()
+     * is kept and applied again at the next tick until it expires or a new goal is received.
+     */
+    void readGoal();
+
+    /**
+     * Build the stage graph of the control tick.
+     * @param config configuration of the graph (STAGE_GRAPH group).
+     * @return true in case of success and false otherwise.
+     */
+    bool configureStageGraph(const yarp::os::Searchable& config);
+
+    /**
+     * Stage of the tick: update the control period, ask and merge the trajectories and
+     * update the PID gains.
+     * @return true in case of success and false otherwise.
+     */
+    bool runTrajectoryStage();
+
+    /**
+     * Stage of the tick: get the feedback from the robot.
+     * @return true in case of success and false otherwise.
+     */
+    bool runFeedbackStage();
+
+    /**
+     * Stage of the tick: update the forward kinematics.
+     * @return true in case of success and false otherwise.
+     */
+    bool runForwardKinematicsStage();
+
+    /**
+     * Stage of the tick: evaluate the measured CoM, DCM and ZMP.
+     * @return true in case of success and false otherwise.
+     */
+    bool runEstimationStage();
+
+    /**
+     * Stage of the tick: propagate the 3D-LIPM reference model.
+     * @return true in case of success and false otherwise.
+     */
+    bool runReferenceStage();
+
+    /**
+     * Stage of the tick: check the steady state and update the accuracy of the solvers.
+     * @return true in case of success and false otherwise.
+     */
+    bool runSolversStage();
+
+    /**
+     * Stage of the tick: DCM controller (MPC).
+     * @return true in case of success and false otherwise.
+     */
+    bool runMPCStage();
+
+    /**
+     * Stage of the tick: DCM controller (reactive).
+     * @return true in case of success and false otherwise.
+     */
+    bool runDCMReactiveStage();
+
+    /**
+     * Stage of the tick: ZMP-CoM controller.
+     * @return true in case of success and false otherwise.
+     */
+    bool runZMPControlStage();
+
+    /**
+     * Stage of the tick: inverse kinematics.
+     * @return true in case of success and false otherwise.
+     */
+    bool runInverseKinematicsStage();
+
+    /**
+     * Stage of the tick: send the joint references to the robot.
+     * @return true in case of success and false otherwise.
+     */
+    bool runCommandStage();
+
+    /**
+     * Stage of the tick: logger, statistics, metrics, flight recorder and state publisher.
+     * @return true in case of success and false otherwise.
+     */
+    bool runTelemetryStage();
+
+    /**
+     * Stage of the tick: propagate the time and the reference signals and end the onTheFly
+     * procedure.
+     * @return true in case of success and false otherwise.
+     */
+    bool runPropagationStage();
+
+    /**
+     * Run a tick of the controller.
+     * @return true in case of success and false otherwise.
+     */
+    bool updateController();
+
 public:
 
     /**
@@ -395,5 +677,23 @@ public:
      * @return true in case of success and false otherwise.
      */
     virtual bool setGoal(double x, double y);
+
+    /**
+     * Get the statistics of the controller.
+     * @return the statistics.
+     */
+    virtual yarp::os::Bottle getStats();
+
+    /**
+     * Reset the statistics of the controller.
+     * @return true in case of success and false otherwise.
+     */
+    virtual bool resetStats();
+
+    /**
+     * Save the content of the flight recorder.
+     * @return true in case of success and false otherwise.
+     */
+    virtual bool dumpFlightRecorder();
 };
 #endif
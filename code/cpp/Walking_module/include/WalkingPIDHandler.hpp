@@ -22,8 +22,8 @@
 #include <yarp/dev/ControlBoardPid.h>
 #include <yarp/os/Bottle.h>
 #include <mutex>
-#include <thread>
 #include <condition_variable>
+#include "WalkingThreadPool.hpp"
 
 namespace yarp{
     namespace os{
@@ -96,13 +96,18 @@ class WalkingPIDHandler {
     PIDPhase m_previousPhase;
     int m_currentPIDIndex;
     int m_desiredPIDIndex;
+    bool m_isActivationRequested;
     double m_firmwareDelay;
     double m_smoothingTime;
+    int m_numberOfSwitches;
+    double m_meanSwitchDuration;
+    double m_maxSwitchDuration;
     yarp::os::Bottle m_remoteControlBoards; //to be removed when the gain scheduling has a proper interface to set the smoothing times.
 
     std::mutex m_mutex;
     std::condition_variable m_conditionVariable;
-    std::thread m_handlerThread;
+    WalkingThreadPool *m_threadPool; //the pool has to outlive the handler.
+    bool m_isSwitchPending; //true while a switch task is queued or running.
 
     bool getAxisMap();
 
@@ -128,7 +133,7 @@ class WalkingPIDHandler {
 
     bool guessPhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed);
 
-    void setPIDThread();
+    void setPIDTask();
 
     //bool getSmoothingTimes(yarp::os::Bottle &defaultSmoothingTime); //to be restored when the gain scheduling has a proper interface to set the smoothing times.
 
@@ -141,7 +146,7 @@ public:
 
     ~WalkingPIDHandler();
 
-    bool initialize(const yarp::os::Bottle& PIDSettings, yarp::dev::PolyDriver& robotDriver, yarp::os::Bottle& remoteControlBords);
+    bool initialize(const yarp::os::Bottle& PIDSettings, yarp::dev::PolyDriver& robotDriver, yarp::os::Bottle& remoteControlBords, WalkingThreadPool& threadPool);
 
     bool restorePIDs();
 
@@ -149,8 +154,14 @@ public:
 
     bool updatePhases(const std::deque<bool> &leftIsFixed, const std::deque<bool> &rightIsFixed, double time);
 
+    bool isActivationRequested(); //true if the last updatePhases() asked for a new PID group.
+
     bool reset();
 
+    void getSwitchStatistics(int &numberOfSwitches, double &meanDuration, double &maxDuration);
+
+    void resetSwitchStatistics();
+
 };
 
 #endif // ICUB_WALKINGPIDHANDLER_H
@@ -17,6 +17,11 @@
 
 #include <OsqpEigen/OsqpEigen.h>
 #include "Utils.hpp"
+#include "SolverAccuracySchedule.hpp"
+#include "SolverSettings.hpp"
+#include "QPProblemRecorder.hpp"
+#include "QPIKTaskSet.hpp"
+#include "MemoryAccounting.hpp"
 
 class WalkingQPIK_osqp
 {
@@ -45,6 +50,7 @@ class WalkingQPIK_osqp
     int m_numberOfVariables; /**<Number of variables in the QP problem (# of joints + 6) */
     int m_numberOfConstraints; /**<Number of constraints in the QP problem (# of joints + 12) */
     std::unique_ptr<OsqpEigen::Solver> m_optimizerSolver; /**< Optimization solver. */
+    ExternalMemory m_solverMemory; /**< Memory of the OSQP workspace (allocated with malloc). */
 
     iDynSparseMatrix m_jointRegulatizationGains;  /**< Gain related to the joint regularization. */
     double m_kPosFoot; /**< Gain related to the desired foot position. */
@@ -72,6 +78,13 @@ class WalkingQPIK_osqp
 
     bool m_useCoMAsConstraint; /**< True if the CoM is added as a constraint. */
 
+    QPIKTaskSet m_tasks; /**< Tasks of the cost function. */
+
+    bool m_isHessianConstant; /**< True if the hessian matrix does not depend on the Jacobians
+                                 (i.e. it contains only the joint regularization). */
+
+    bool m_isStructureChanged; /**< True if the problem has not been recorded since the initialization. */
+
     /**
      * Initialize all the constant matrix from the configuration file.
      * @return true/false in case of success/failure.
@@ -173,6 +186,7 @@ public:
 
     /**
      * Set the Jacobian of the neck
+     * @note it is required only if the neck task is enabled.
      * @param leftFootJacobian jacobian of the neck foot (mixed representation)
      * @return true/false in case of success/failure.
      */
@@ -220,6 +234,34 @@ public:
      */
     void setDesiredCoMPosition(const iDynTree::Position& desiredComPosition);
 
+    /**
+     * Set the termination criteria of the solver.
+     * If the solver is already initialized the settings are updated.
+     * @param accuracy tolerances and maximum number of iterations.
+     * @return true/false in case of success/failure.
+     */
+    bool setAccuracy(const SolverAccuracy& accuracy);
+
+    /**
+     * Get the current optimization problem (useful to replay it offline).
+     * @param problem QP problem.
+     */
+    void getProblem(QPProblem& problem);
+
+    /**
+     * Get the solution of the last problem in the format of the recorded problems (checkpoint
+     * used to replay the sequence from the next problem).
+     * @param primal primal solution;
+     * @param dual multipliers of the rows of the constraints matrix.
+     */
+    void getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual);
+
+    /**
+     * Get the statistics of the last solution.
+     * @return number of iterations and residuals.
+     */
+    SolverStatistics getStatistics();
+
     /**
      * Solve the optimization problem.
      * @return true/false in case of success/failure.
@@ -249,6 +291,12 @@ public:
      */
     bool getRightFootError(iDynTree::VectorDynSize& output);
 
+    /**
+     * Get the tasks of the cost function.
+     * @return the task set.
+     */
+    const QPIKTaskSet& getTaskSet() const;
+
     const Eigen::MatrixXd& getHessianMatrix() const;
 
     const Eigen::MatrixXd& getConstraintMatrix() const;
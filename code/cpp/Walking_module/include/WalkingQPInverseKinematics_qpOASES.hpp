@@ -20,6 +20,10 @@
 #include <qpOASES.hpp>
 
 #include "Utils.hpp"
+#include "SolverAccuracySchedule.hpp"
+#include "SolverSettings.hpp"
+#include "QPProblemRecorder.hpp"
+#include "QPIKTaskSet.hpp"
 
 class WalkingQPIK_qpOASES
 {
@@ -38,6 +42,14 @@ class WalkingQPIK_qpOASES
 
     bool m_isFirstTime;
 
+    int m_maxWorkingSetRecalculations; /**< Maximum number of working set recalculations (nWSR). */
+    SolverStatistics m_statistics; /**< Statistics of the last solution. */
+    bool m_isResidualRequired{false}; /**< True if the residuals of the solution are evaluated. */
+    std::vector<double> m_primalSolution; /**< Primal solution (used to evaluate the residuals). */
+    std::vector<double> m_dualSolution; /**< Dual solution (used to evaluate the residuals). */
+
+    bool m_isStructureChanged; /**< True if the problem has not been recorded since the initialization. */
+
     iDynTree::MatrixDynSize m_comJacobian; /**< CoM jacobian (mixed representation). */
     iDynTree::MatrixDynSize m_neckJacobian; /**< Neck jacobian (mixed representation). */
     iDynTree::MatrixDynSize m_leftFootJacobian; /**< Left foot Jacobian (mixed representation). */
@@ -83,6 +95,11 @@ class WalkingQPIK_qpOASES
 
     bool m_useCoMAsConstraint; /**< True if the CoM is added as a constraint. */
 
+    QPIKTaskSet m_tasks; /**< Tasks of the cost function. */
+
+    bool m_isHessianConstant; /**< True if the hessian matrix does not depend on the Jacobians
+                                 (i.e. it contains only the joint regularization). */
+
     /**
      * Initialize all the constant matrix from the configuration file.
      * @return true/false in case of success/failure.
@@ -164,6 +181,7 @@ public:
 
     /**
      * Set the Jacobian of the neck
+     * @note it is required only if the neck task is enabled.
      * @param neckJacobian jacobian of the neck (mixed representation)
      * @return true/false in case of success/failure.
      */
@@ -224,6 +242,50 @@ public:
      */
     void setDesiredCoMVelocity(const iDynTree::Vector3& comVelocity);
 
+    /**
+     * Set the termination criteria of the solver.
+     * Only the maximum number of working set recalculations is used, the termination
+     * tolerance of qpOASES is not changed.
+     * @param accuracy tolerances and maximum number of iterations.
+     * @return true/false in case of success/failure.
+     */
+    bool setAccuracy(const SolverAccuracy& accuracy);
+
+    /**
+     * Get the current optimization problem (useful to replay it offline). The joint limits
+     * are stored as bounds of the variables.
+     * @param problem QP problem.
+     */
+    void getProblem(QPProblem& problem);
+
+    /**
+     * Get the solution of the last problem in the format of the recorded problems (checkpoint
+     * used to replay the sequence from the next problem).
+     * @param primal primal solution;
+     * @param dual multipliers of the joint limits and of the rows of the constraints matrix.
+     */
+    void getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual);
+
+    /**
+     * Get the statistics of the last solution.
+     * @return number of iterations and residuals.
+     */
+    SolverStatistics getStatistics();
+
+    /**
+     * Enable the evaluation of the residuals (KKT violation) of the solution. It is
+     * expensive, so enable it only if the statistics are logged or recorded. If it is
+     * disabled the residuals returned by getStatistics() are NaN.
+     * @param isResidualRequired true if the residuals are evaluated.
+     */
+    void setResidualRequired(const bool& isResidualRequired);
+
+    /**
+     * Get the tasks of the cost function.
+     * @return the task set.
+     */
+    const QPIKTaskSet& getTaskSet() const;
+
     /**
      * Solve the optimization problem.
      * @return true/false in case of success/failure.
@@ -0,0 +1,156 @@
+/**
+ * @file WalkingStageGraph.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_STAGE_GRAPH_HPP
+#define WALKING_STAGE_GRAPH_HPP
+
+// std
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+
+#include "WalkingStatistics.hpp"
+
+/**
+ * WalkingStageGraph class runs the stages of a control tick.
+ * Each stage depends on the stages that produce its inputs. The stages are grouped in levels
+ * (a stage belongs to the level following the ones of its dependencies) and the levels are
+ * run in order. The stages of the same level are independent: if some workers are available
+ * they are run concurrently by the workers and by the calling thread, otherwise they are run
+ * in the calling thread in the order in which they were added.
+ * Each stage declares the data that it reads and writes: the initialization fails if a stage
+ * writes data accessed by another stage of the same level, since they may run concurrently.
+ * The duration of each stage is measured at every run.
+ */
+class WalkingStageGraph
+{
+    /**
+     * Node of the graph.
+     */
+    struct Stage
+    {
+        std::string name; /**< Name of the stage. */
+        std::vector<int> dependencies; /**< Indices of the stages that have to be run before. */
+        std::function<bool()> function; /**< Function of the stage. */
+        std::vector<std::string> reads; /**< Data read by the stage. */
+        std::vector<std::string> writes; /**< Data written by the stage. */
+        int level{0}; /**< Level of the stage. */
+        bool isOk{true}; /**< Result of the last run. */
+        double duration{0.0}; /**< Duration of the last run [s]. */
+        LatencyHistogram histogram; /**< Durations of the stage. */
+    };
+
+    std::vector<Stage> m_stages; /**< Stages in the order in which they were added. */
+    std::vector<std::vector<int>> m_levels; /**< Indices of the stages of each level. */
+
+    std::vector<std::thread> m_workers; /**< Worker threads. */
+    std::mutex m_mutex; /**< Mutex shared by the calling thread and the workers. */
+    std::condition_variable m_levelStarted; /**< Used to wake up the workers. */
+    std::condition_variable m_levelCompleted; /**< Used to wake up the calling thread. */
+    const std::vector<int>* m_currentLevel{nullptr}; /**< Level that is running (nullptr if none). */
+    size_t m_nextStage{0}; /**< Position of the next stage of the level to be run. */
+    size_t m_pendingStages{0}; /**< Number of stages of the level that are not completed. */
+    unsigned long m_generation{0}; /**< Number of levels run by the workers. */
+    bool m_isRunning{false}; /**< True if the workers are running. */
+
+    std::mutex m_statisticsMutex; /**< Mutex of the histograms. */
+
+    /**
+     * Check that two stages of the same level do not access the same data while one of them
+     * writes it.
+     * @param first first stage;
+     * @param second second stage.
+     * @return true if the stages can run concurrently.
+     */
+    bool checkDataRace(const Stage& first, const Stage& second) const;
+
+    /**
+     * Run a stage and measure its duration.
+     * @param index index of the stage.
+     */
+    void runStage(const int& index);
+
+    /**
+     * Run the stages of the current level until all of them are taken.
+     */
+    void runLevelStages();
+
+    /**
+     * Main loop of a worker.
+     * @param worker index of the worker.
+     */
+    void workerThread(const int worker);
+
+public:
+
+    /**
+     * Destructor. The workers are stopped.
+     */
+    ~WalkingStageGraph();
+
+    /**
+     * Add a stage. The stages have to be added before calling initialize().
+     * @param name name of the stage;
+     * @param dependencies names of the stages that have to be run before (they have to be
+     * already added);
+     * @param function function of the stage. It returns false in case of failure;
+     * @param reads names of the data read by the stage;
+     * @param writes names of the data written by the stage.
+     * @return true/false in case of success/failure.
+     */
+    bool addStage(const std::string& name, const std::vector<std::string>& dependencies,
+                  const std::function<bool()>& function,
+                  const std::vector<std::string>& reads = {},
+                  const std::vector<std::string>& writes = {});
+
+    /**
+     * Group the stages in levels, check that the stages of the same level do not race on
+     * their data and start the workers.
+     * @param workers number of worker threads (if 0 all the stages are run by the calling thread).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const int& workers);
+
+    /**
+     * Run all the stages. The execution stops at the first level containing a failed stage.
+     * @return true/false in case of success/failure.
+     */
+    bool run();
+
+    /**
+     * Get the duration of the last run of a stage.
+     * @param name name of the stage.
+     * @return the duration [s] (0 if the stage does not exist).
+     */
+    double getDuration(const std::string& name) const;
+
+    /**
+     * Stop the workers.
+     */
+    void close();
+
+    /**
+     * Reset the histograms of the stages.
+     */
+    void resetStatistics();
+
+    /**
+     * Add the histograms of the stages to a bottle.
+     * The bottle contains a (stages ((name (level l) (histogram)) ...)) entry.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file WalkingStatePublisher.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_STATE_PUBLISHER_HPP
+#define WALKING_STATE_PUBLISHER_HPP
+
+// std
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// YARP
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+// iDynTree
+#include <iDynTree/Core/VectorFixSize.h>
+#include <iDynTree/Core/Position.h>
+#include <iDynTree/Core/Transform.h>
+
+#include "SolverAccuracySchedule.hpp"
+#include "TripleBuffer.hpp"
+
+/**
+ * Compact state of the controller. It is filled by the control thread at every tick.
+ */
+struct WalkingStateSnapshot
+{
+    unsigned long tick{0}; /**< Number of the tick. */
+    double time{0.0}; /**< Time at the end of the tick [s]. */
+    int robotState{0}; /**< State of the walking FSM. */
+    bool isSteadyState{false}; /**< True if the solvers were skipped. */
+
+    iDynTree::Vector2 measuredDCM; /**< Measured DCM. */
+    iDynTree::Vector2 desiredDCM; /**< Desired DCM. */
+    iDynTree::Vector2 measuredZMP; /**< Measured ZMP. */
+    iDynTree::Vector2 desiredZMP; /**< Desired ZMP. */
+    iDynTree::Position measuredCoM; /**< Measured CoM. */
+    iDynTree::Vector2 desiredCoM; /**< Desired CoM (XY projection). */
+
+    iDynTree::Transform leftFoot; /**< Measured left foot pose. */
+    iDynTree::Transform rightFoot; /**< Measured right foot pose. */
+    iDynTree::Transform desiredLeftFoot; /**< Desired left foot pose. */
+    iDynTree::Transform desiredRightFoot; /**< Desired right foot pose. */
+
+    int solverPhase{0}; /**< Phase of the solver accuracy schedule. */
+    SolverStatistics mpcStatistics; /**< Statistics of the MPC solver. */
+    SolverStatistics ikStatistics; /**< Statistics of the QP-IK solver. */
+
+    double tickDuration{0.0}; /**< Duration of the tick [s]. */
+};
+
+/**
+ * WalkingStatePublisher class streams the state of the controller on a YARP port.
+ * The control thread writes the snapshot in a triple buffer (it never blocks), while a
+ * separate thread reads the last snapshot and sends it at the publisher period.
+ * The content of the bottle is:
+ * (tick time robot_state is_steady_state)
+ * (dcm_x dcm_y dcm_des_x dcm_des_y) (zmp_x zmp_y zmp_des_x zmp_des_y)
+ * (com_x com_y com_z com_des_x com_des_y)
+ * (lf_x lf_y lf_z lf_roll lf_pitch lf_yaw) (rf_x rf_y rf_z rf_roll rf_pitch rf_yaw)
+ * (lf_des_x lf_des_y lf_des_z lf_des_roll lf_des_pitch lf_des_yaw)
+ * (rf_des_x rf_des_y rf_des_z rf_des_roll rf_des_pitch rf_des_yaw)
+ * (solver_phase mpc_iter mpc_pri_res mpc_dua_res ik_iter ik_pri_res ik_dua_res)
+ * (tick_duration).
+ * The residuals of the qpOASES QP-IK are NaN if they are not evaluated (they are evaluated
+ * only if dump_data or use_flight_recorder is set).
+ */
+class WalkingStatePublisher
+{
+    TripleBuffer<WalkingStateSnapshot> m_buffer; /**< Snapshots shared with the control thread. */
+    unsigned long m_tick{0}; /**< Number of published snapshots (used by the control thread). */
+
+    yarp::os::BufferedPort<yarp::os::Bottle> m_port; /**< State port. */
+    double m_period{0.05}; /**< Period of the publisher [s]. */
+
+    std::thread m_thread; /**< Publisher thread. */
+    std::mutex m_mutex; /**< Mutex used only to stop the publisher thread. */
+    std::condition_variable m_conditionVariable; /**< Condition variable used to stop the thread. */
+    bool m_isRunning{false}; /**< True if the publisher thread is running. */
+
+    /**
+     * Main loop of the publisher thread.
+     */
+    void publisherThread();
+
+public:
+
+    /**
+     * Destructor. The publisher is closed.
+     */
+    ~WalkingStatePublisher();
+
+    /**
+     * Open the port and start the publisher thread.
+     * @param config configuration of the publisher;
+     * @param portPrefix prefix of the port name (e.g. /walking-coordinator).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config, const std::string& portPrefix);
+
+    /**
+     * Get the snapshot that will be published (control thread).
+     * @return reference to the snapshot.
+     */
+    WalkingStateSnapshot& getSnapshot();
+
+    /**
+     * Publish the snapshot (control thread). The function never blocks.
+     */
+    void publish();
+
+    /**
+     * Stop the publisher thread and close the port.
+     */
+    void close();
+};
+
+#endif
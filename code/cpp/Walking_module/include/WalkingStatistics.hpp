@@ -0,0 +1,177 @@
+/**
+ * @file WalkingStatistics.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_STATISTICS_HPP
+#define WALKING_STATISTICS_HPP
+
+// std
+#include <array>
+#include <mutex>
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+
+#include "SolverAccuracySchedule.hpp"
+
+/**
+ * Histogram of the durations of a stage.
+ */
+class LatencyHistogram
+{
+    static const std::array<double, 11> s_bounds; /**< Upper bounds of the bins [s] (the last bin is unbounded). */
+    std::array<int, 12> m_bins; /**< Number of samples in each bin (the histogram is copied without allocating). */
+    int m_count{0}; /**< Number of samples. */
+    double m_sum{0.0}; /**< Sum of the durations [s]. */
+    double m_max{0.0}; /**< Maximum duration [s]. */
+
+public:
+
+    /**
+     * Constructor. The bins range from 0.5 ms to 50 ms.
+     */
+    LatencyHistogram();
+
+    /**
+     * Add a sample.
+     * @param duration duration [s].
+     */
+    void add(const double& duration);
+
+    /**
+     * Remove all the samples.
+     */
+    void reset();
+
+    /**
+     * Get the number of samples.
+     * @return the number of samples.
+     */
+    int getCount() const;
+
+    /**
+     * Add the histogram to a bottle.
+     * The bottle contains (count n) (mean_ms m) (max_ms m) (bounds_ms (...)) (bins (...)).
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle) const;
+};
+
+/**
+ * Statistics of a QP solver.
+ */
+struct SolverCounters
+{
+    int solves{0}; /**< Number of solved problems. */
+    int skipped{0}; /**< Number of ticks where the previous solution was reused. */
+    long iterations{0}; /**< Total number of iterations. */
+    int maxIterations{0}; /**< Maximum number of iterations. */
+};
+
+/**
+ * Events that can happen in a tick. Each tick is tagged with the bitwise or of its events.
+ */
+namespace WalkingEvent
+{
+    enum : unsigned int
+    {
+        Merge = 1 << 0, /**< A new trajectory is merged (updateTrajectories). */
+        ContactSwitch = 1 << 1, /**< The contacts changed and a new MPC solver is instantiated. */
+        PIDActivation = 1 << 2, /**< A new PID group is requested by the gain scheduling. */
+        PlannerRequest = 1 << 3, /**< A new trajectory is asked to the planner. */
+        FirstTick = 1 << 4 /**< First tick after the start of the controller. */
+    };
+
+    /**
+     * Number of the combinations of the events (the masks range from 0 to NumberOfCombinations - 1).
+     */
+    const unsigned int NumberOfCombinations = FirstTick << 1;
+}
+
+/**
+ * Latency of the ticks tagged with the same events.
+ */
+struct EventLatency
+{
+    LatencyHistogram total; /**< Duration of the ticks. */
+    LatencyHistogram mpc; /**< Duration of the DCM controller. */
+    LatencyHistogram ik; /**< Duration of the IK. */
+};
+
+/**
+ * Quantities measured by the control thread in a single tick.
+ */
+struct WalkingTickStatistics
+{
+    double period{0.0}; /**< Period of the tick [s]. */
+    double totalDuration{0.0}; /**< Duration of the tick [s]. */
+    double feedbackDuration{0.0}; /**< Duration of the feedback acquisition and of the FK [s]. */
+    double mpcDuration{0.0}; /**< Duration of the DCM controller [s]. */
+    double ikDuration{0.0}; /**< Duration of the IK [s]. */
+    bool isSteadyState{false}; /**< True if the solvers were skipped. */
+    bool isMPCSolved{false}; /**< True if the MPC problem was solved. */
+    bool isIKSolved{false}; /**< True if the QP-IK problem was solved. */
+    SolverStatistics mpcStatistics; /**< Statistics of the MPC solver. */
+    SolverStatistics ikStatistics; /**< Statistics of the QP-IK solver. */
+    bool isMerged{false}; /**< True if a new trajectory was merged. */
+    double plannerDuration{0.0}; /**< Duration of the planner (valid if isMerged is true) [s]. */
+    unsigned int events{0}; /**< Events of the tick (bitwise or of WalkingEvent). */
+};
+
+/**
+ * WalkingStatistics class collects the statistics of the controller.
+ * The control thread calls update() once per tick, the statistics can be read by any thread.
+ * The mutex protects only the counters, it is never held while the controller is running.
+ * The readers copy the counters (no allocation) and format them after releasing the mutex.
+ */
+class WalkingStatistics
+{
+    /**
+     * Counters of the controller.
+     */
+    struct Counters
+    {
+        int ticks{0}; /**< Number of ticks. */
+        int overruns{0}; /**< Number of ticks longer than the period. */
+        LatencyHistogram total; /**< Duration of the ticks. */
+        LatencyHistogram feedback; /**< Duration of the feedback acquisition. */
+        LatencyHistogram mpc; /**< Duration of the DCM controller. */
+        LatencyHistogram ik; /**< Duration of the IK. */
+        LatencyHistogram planner; /**< Duration of the planner. */
+        SolverCounters mpcCounters; /**< Counters of the MPC solver. */
+        SolverCounters ikCounters; /**< Counters of the QP-IK solver. */
+        int merges{0}; /**< Number of merged trajectories. */
+        std::array<EventLatency, WalkingEvent::NumberOfCombinations> events; /**< Latency of each combination
+                                                                                of events (indexed by
+                                                                                the mask). */
+    };
+
+    std::mutex m_mutex; /**< Mutex. */
+    Counters m_counters; /**< Counters (protected by the mutex). */
+
+public:
+
+    /**
+     * Add the quantities measured in a tick.
+     * @param tick statistics of the tick.
+     */
+    void update(const WalkingTickStatistics& tick);
+
+    /**
+     * Reset all the statistics.
+     */
+    void reset();
+
+    /**
+     * Add the statistics to a bottle. Each entry is a (key value) list.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+};
+
+#endif
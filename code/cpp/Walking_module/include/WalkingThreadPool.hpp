@@ -0,0 +1,153 @@
+/**
+ * @file WalkingThreadPool.hpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+#ifndef WALKING_THREAD_POOL_HPP
+#define WALKING_THREAD_POOL_HPP
+
+// std
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Searchable.h>
+
+#include "RealTimeSettings.hpp"
+
+/**
+ * Priority classes of the tasks. The high priority tasks of all the workers are run
+ * before any low priority task.
+ */
+enum class TaskPriority
+{
+    High = 0, /**< Tasks required by the controller (e.g. the planner and the PID switches). */
+    Low, /**< Telemetry and diagnostics (e.g. metrics and flight recorder dumps). */
+    NumberOfPriorities
+};
+
+/**
+ * WalkingThreadPool class runs the background work of the walking module.
+ * Each worker has a queue for each priority class. A task submitted by a worker is added to
+ * its own queue, the other tasks are distributed among the workers. A worker runs the oldest
+ * task of its queues and, when they are empty, steals the newest task of the other workers.
+ * The number of queued tasks is bounded, the tasks submitted when the bound is reached are
+ * rejected. The workers can be bound to a set of CPUs, so the background work is kept off
+ * the control core.
+ */
+class WalkingThreadPool
+{
+    /**
+     * Task submitted to the pool.
+     */
+    struct Task
+    {
+        std::function<void()> function; /**< Function of the task. */
+        std::chrono::steady_clock::time_point submissionTime; /**< Time of the submission. */
+    };
+
+    /**
+     * Queues of a worker.
+     */
+    struct Worker
+    {
+        std::mutex mutex; /**< Mutex of the queues. */
+        std::deque<Task> queues[static_cast<int>(TaskPriority::NumberOfPriorities)]; /**< Queues. */
+        std::thread thread; /**< Worker thread. */
+    };
+
+    /**
+     * Counters of a priority class.
+     */
+    struct TaskCounters
+    {
+        int submitted{0}; /**< Number of submitted tasks. */
+        int rejected{0}; /**< Number of rejected tasks. */
+        int executed{0}; /**< Number of executed tasks. */
+        int stolen{0}; /**< Number of tasks run by a worker different from the one of the queue. */
+        double waitSum{0.0}; /**< Sum of the times spent in the queue [s]. */
+        double waitMax{0.0}; /**< Maximum time spent in the queue [s]. */
+        double runSum{0.0}; /**< Sum of the durations of the tasks [s]. */
+        double runMax{0.0}; /**< Maximum duration of a task [s]. */
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers; /**< Workers. */
+    RealTimeSettings m_workerSettings; /**< Scheduling settings of the workers. */
+    int m_maxQueuedTasks{64}; /**< Maximum number of queued tasks. */
+
+    std::mutex m_mutex; /**< Mutex used to put the workers to sleep. */
+    std::condition_variable m_conditionVariable; /**< Condition variable used to wake up the workers. */
+    int m_queuedTasks{0}; /**< Number of queued tasks. */
+    unsigned int m_nextWorker{0}; /**< Worker that receives the next external task. */
+    bool m_isRunning{false}; /**< True if the pool accepts new tasks. */
+
+    std::mutex m_statisticsMutex; /**< Mutex of the counters. */
+    TaskCounters m_counters[static_cast<int>(TaskPriority::NumberOfPriorities)]; /**< Counters. */
+
+    /**
+     * Take a task, the own queues are checked before the other workers.
+     * @param worker index of the worker;
+     * @param task the task;
+     * @param priority priority of the task;
+     * @param isStolen true if the task was taken from another worker.
+     * @return true if a task was found.
+     */
+    bool takeTask(const int& worker, Task& task, TaskPriority& priority, bool& isStolen);
+
+    /**
+     * Main loop of a worker.
+     * @param worker index of the worker.
+     */
+    void workerThread(const int worker);
+
+public:
+
+    /**
+     * Destructor. The queued tasks are run before stopping the workers.
+     */
+    ~WalkingThreadPool();
+
+    /**
+     * Start the workers.
+     * @param config configuration of the pool (workers, max_queued_tasks and cpu_affinity).
+     * @return true/false in case of success/failure.
+     */
+    bool initialize(const yarp::os::Searchable& config);
+
+    /**
+     * Submit a task. The function never blocks.
+     * @param priority priority of the task;
+     * @param task function of the task.
+     * @return false if the pool is not running or too many tasks are queued.
+     */
+    bool submit(const TaskPriority& priority, const std::function<void()>& task);
+
+    /**
+     * Run the queued tasks and stop the workers. The tasks submitted later are rejected.
+     */
+    void close();
+
+    /**
+     * Reset the counters of the tasks.
+     */
+    void resetStatistics();
+
+    /**
+     * Add the counters of the tasks to a bottle.
+     * The bottle contains a (thread_pool ((priority (submitted s) ...) ...)) entry.
+     * @param bottle bottle.
+     */
+    void toBottle(yarp::os::Bottle& bottle);
+};
+
+#endif
@@ -14,6 +14,7 @@
 
 // YARP
 #include <yarp/os/Searchable.h>
+#include <yarp/sig/Vector.h>
 
 // iCub-ctrl
 #include <iCub/ctrl/pids.h>
@@ -41,7 +42,7 @@ class WalkingZMPController
     iDynTree::Vector2 m_comVelocityDesired; /**< Desired CoM velocity. */
 
     iDynTree::Vector2 m_controllerOutput; /**< Controller output. */
-    iDynTree::Vector2 m_desiredCoMVelocity; /**< Controller output. */
+    yarp::sig::Vector m_desiredCoMVelocity; /**< Controller output (it is also the input of the integrator). */
 
     /**
      * Pointer containing an integrator object.
@@ -97,6 +98,13 @@ public:
      * @return true/false in case of success/failure
      */
     bool reset(const iDynTree::Vector2& initialValue);
+
+    /**
+     * Set the sampling time of the controller integrator.
+     * @param samplingTime new sampling time (in seconds)
+     * @return true/false in case of success/failure
+     */
+    bool setSamplingTime(const double& samplingTime);
 };
 
 #endif
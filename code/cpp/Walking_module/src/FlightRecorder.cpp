@@ -0,0 +1,272 @@
+/**
+ * @file FlightRecorder.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "FlightRecorder.hpp"
+
+namespace
+{
+    const uint32_t magicNumber = 0x57465244; /**< Identifier of a flight recorder file ("WFRD"). */
+
+    template <typename T>
+    void writeValue(std::ofstream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(std::ofstream& stream, const std::string& string)
+    {
+        writeValue(stream, static_cast<int32_t>(string.size()));
+        stream.write(string.data(), string.size());
+    }
+
+    const char* reasonNames[static_cast<int>(DumpReason::NumberOfReasons)] = {"request", "watchdog", "fault"};
+
+    const char* reasonName(const DumpReason& reason)
+    {
+        return reasonNames[static_cast<int>(reason)];
+    }
+
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const int& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addInt(value);
+    }
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    close();
+}
+
+bool FlightRecorder::initialize(const yarp::os::Searchable& config, const double& samplingTime,
+                                const std::string& filePrefix, const std::vector<std::string>& channels,
+                                WalkingThreadPool& threadPool)
+{
+    double duration = config.check("duration", yarp::os::Value(5.0)).asDouble();
+    if(duration <= 0 || samplingTime <= 0)
+    {
+        yError() << "[initialize] The duration of the flight recorder and the sampling time have to be positive.";
+        return false;
+    }
+
+    if(channels.empty())
+    {
+        yError() << "[initialize] The flight recorder requires at least one channel.";
+        return false;
+    }
+
+    m_channels = channels;
+    m_capacity = static_cast<size_t>(std::ceil(duration / samplingTime));
+    for(auto& ring : m_rings)
+    {
+        ring.records.resize(m_capacity * m_channels.size());
+        ring.head = 0;
+        ring.numberOfRecords = 0;
+    }
+    m_recordingRing = 0;
+    m_filePrefix = filePrefix;
+    m_threadPool = &threadPool;
+    return true;
+}
+
+size_t FlightRecorder::size(const int&)
+{
+    return 1;
+}
+
+size_t FlightRecorder::size(const double&)
+{
+    return 1;
+}
+
+void FlightRecorder::copy(double*& record, const int& value)
+{
+    *record++ = value;
+}
+
+void FlightRecorder::copy(double*& record, const double& value)
+{
+    *record++ = value;
+}
+
+void FlightRecorder::freeze(const DumpReason& reason)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    Ring& ring = m_rings[m_recordingRing];
+
+    // the recording ring already waits to be dumped, it keeps the reason with the highest priority
+    if(m_isRecordingPending.load(std::memory_order_relaxed))
+    {
+        if(reason > ring.reason)
+            ring.reason = reason;
+        m_numberOfSuppressedTriggers++;
+        return;
+    }
+
+    ring.reason = reason;
+
+    // the other ring is being written. The recording ring is frozen, so the records that
+    // preceded the trigger are kept, and it is dumped when the current dump ends
+    if(m_isDumping)
+    {
+        m_isRecordingPending.store(true, std::memory_order_release);
+        m_numberOfDelayedDumps++;
+        return;
+    }
+
+    // the recording continues if the dump cannot be queued
+    int frozenRing = m_recordingRing;
+    if(!m_threadPool->submit(TaskPriority::Low, [this, frozenRing]{dumpTask(frozenRing);}))
+    {
+        yError() << "[freeze] Unable to submit the dump of the flight recorder.";
+        m_numberOfSuppressedTriggers++;
+        return;
+    }
+
+    // the recording continues in the other ring
+    m_isDumping = true;
+    m_recordingRing = 1 - frozenRing;
+    m_rings[m_recordingRing].head = 0;
+    m_rings[m_recordingRing].numberOfRecords = 0;
+}
+
+void FlightRecorder::trigger(const DumpReason& reason)
+{
+    yWarning() << "[trigger] The flight recorder is dumped (" << reasonName(reason) << ").";
+    freeze(reason);
+}
+
+void FlightRecorder::watchdog(const bool& isTriggered)
+{
+    if(isTriggered && !m_isWatchdogTriggered)
+        trigger(DumpReason::Watchdog);
+
+    m_isWatchdogTriggered = isTriggered;
+}
+
+void FlightRecorder::requestDump()
+{
+    m_isDumpRequested = true;
+}
+
+void FlightRecorder::dumpTask(int ring)
+{
+    while(true)
+    {
+        bool ok = dump(m_rings[ring]);
+        if(!ok)
+            yError() << "[dumpTask] Unable to save the flight recorder.";
+
+        // the condition variable is notified while the mutex is locked, so the recorder cannot
+        // be destroyed before the end of the task
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if(ok)
+            m_numberOfDumps++;
+
+        if(!m_isRecordingPending.load(std::memory_order_relaxed))
+        {
+            m_isDumping = false;
+            m_conditionVariable.notify_all();
+            return;
+        }
+
+        // the recording ring was frozen while this ring was written. The recording restarts
+        // in the ring just written and the pending ring is dumped (the control thread does
+        // not use the rings until the pending flag is cleared)
+        int pendingRing = m_recordingRing;
+        m_rings[ring].head = 0;
+        m_rings[ring].numberOfRecords = 0;
+        m_recordingRing = ring;
+        m_isRecordingPending.store(false, std::memory_order_release);
+        ring = pendingRing;
+    }
+}
+
+bool FlightRecorder::dump(const Ring& ring)
+{
+    std::time_t t = std::time(nullptr);
+    std::tm tm = *std::localtime(&t);
+
+    std::stringstream fileName;
+    fileName << m_filePrefix << "_" << std::put_time(&tm, "%Y_%m_%d_%H_%M_%S")
+             << "_" << reasonName(ring.reason) << ".wfr";
+
+    std::ofstream stream(fileName.str(), std::ios::binary);
+    if(!stream.is_open())
+    {
+        yError() << "[dump] Unable to open the file " << fileName.str();
+        return false;
+    }
+
+    writeValue(stream, magicNumber);
+    writeValue(stream, static_cast<int32_t>(m_channels.size()));
+    for(const auto& channel : m_channels)
+        writeString(stream, channel);
+    writeString(stream, reasonName(ring.reason));
+    writeValue(stream, static_cast<int32_t>(ring.numberOfRecords));
+
+    // the oldest record follows the newest one
+    size_t recordSize = m_channels.size();
+    size_t first = (ring.head + m_capacity - ring.numberOfRecords) % m_capacity;
+    for(size_t i = 0; i < ring.numberOfRecords; i++)
+    {
+        size_t index = (first + i) % m_capacity;
+        stream.write(reinterpret_cast<const char*>(ring.records.data() + index * recordSize),
+                     sizeof(double) * recordSize);
+    }
+
+    if(!stream)
+        return false;
+
+    yInfo() << "[dump] The flight recorder is saved in " << fileName.str();
+    return true;
+}
+
+void FlightRecorder::close()
+{
+    // the pending dumps are completed
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_conditionVariable.wait(lock, [this]{return !m_isDumping;});
+}
+
+void FlightRecorder::toBottle(yarp::os::Bottle& bottle)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // (flight_recorder ((dumps d) (delayed_dumps l) (suppressed_triggers s)))
+    yarp::os::Bottle& recorder = bottle.addList();
+    recorder.addString("flight_recorder");
+    yarp::os::Bottle& list = recorder.addList();
+    addEntry("dumps", m_numberOfDumps, list);
+    addEntry("delayed_dumps", m_numberOfDelayedDumps, list);
+    addEntry("suppressed_triggers", m_numberOfSuppressedTriggers, list);
+}
+
+void FlightRecorder::resetStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_numberOfDumps = 0;
+    m_numberOfDelayedDumps = 0;
+    m_numberOfSuppressedTriggers = 0;
+}
@@ -54,6 +54,7 @@ MPCSolver::MPCSolver(const int& stateSize, const int& inputSize,
 bool MPCSolver::setHessianMatrix(const iDynSparseMatrix& hessian)
 {
     Eigen::SparseMatrix<double> hessianEigen = iDynTree::toEigen(hessian);
+    m_hessian = hessianEigen;
     if(m_optimizerSolver->isInitialized())
     {
         std::cerr << "[setHessianMatrix] Something goes wrong. "
@@ -99,6 +100,7 @@ bool MPCSolver::setConstraintsMatrix(const iDynTree::MatrixDynSize& inequalityCo
     // it is required by the osqp library
     Eigen::SparseMatrix<double> constraintsMatrixEigen =
         iDynTree::toEigen(constraintsMatrix);
+    m_constraintsMatrix = constraintsMatrixEigen;
 
     if(m_optimizerSolver->isInitialized())
     {
@@ -294,7 +296,45 @@ bool MPCSolver::isInitialized()
 
 bool MPCSolver::initialize()
 {
-    return m_optimizerSolver->initSolver();
+    m_solverMemory.beginSampling();
+    bool ok = m_optimizerSolver->initSolver();
+    m_solverMemory.endSampling();
+    return ok;
+}
+
+bool MPCSolver::setSolverSettings(const OsqpSettings& settings)
+{
+    if(!SolverSettings::applyOsqpSettings(settings, *m_optimizerSolver))
+    {
+        std::cerr << "[setSolverSettings] Unable to set the solver settings."
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MPCSolver::setAccuracy(const SolverAccuracy& accuracy)
+{
+    if(m_optimizerSolver->isInitialized())
+    {
+        OSQPWorkspace* workspace = m_optimizerSolver->workspace().get();
+        if(osqp_update_eps_abs(workspace, accuracy.absoluteTolerance) != 0
+           || osqp_update_eps_rel(workspace, accuracy.relativeTolerance) != 0
+           || osqp_update_max_iter(workspace, accuracy.maxIterations) != 0)
+        {
+            std::cerr << "[setAccuracy] Unable to update the solver settings."
+                      << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        OSQPSettings* settings = m_optimizerSolver->settings()->getSettings();
+        settings->eps_abs = accuracy.absoluteTolerance;
+        settings->eps_rel = accuracy.relativeTolerance;
+        settings->max_iter = accuracy.maxIterations;
+    }
+    return true;
 }
 
 bool MPCSolver::solve()
@@ -309,6 +349,40 @@ bool MPCSolver::solve()
     return m_optimizerSolver->solve();
 }
 
+SolverStatistics MPCSolver::getStatistics()
+{
+    SolverStatistics statistics;
+    if(!m_optimizerSolver->isInitialized())
+        return statistics;
+
+    const OSQPInfo* info = m_optimizerSolver->workspace()->info;
+    statistics.iterations = info->iter;
+    statistics.primalResidual = info->pri_res;
+    statistics.dualResidual = info->dua_res;
+    return statistics;
+}
+
+void MPCSolver::getProblem(QPProblem& problem)
+{
+    problem.hessian = m_hessian;
+    problem.gradient = m_gradient;
+    problem.constraintsMatrix = m_constraintsMatrix;
+    problem.lowerBound = m_lowerBound;
+    problem.upperBound = m_upperBound;
+    problem.hasVariableBounds = false;
+
+    // the structure of the problem changes only when a new solver is instantiated
+    problem.isStructureChanged = m_isStructureChanged;
+    m_isStructureChanged = false;
+}
+
+void MPCSolver::getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual)
+{
+    primal = m_optimizerSolver->getSolution();
+    const OSQPSolution* solution = m_optimizerSolver->workspace()->solution;
+    dual = Eigen::Map<const Eigen::VectorXd>(solution->y, m_constraintsMatrix.rows());
+}
+
 iDynTree::VectorDynSize MPCSolver::getSolution()
 {
     Eigen::VectorXd solutionEigen = m_optimizerSolver->getSolution();
@@ -0,0 +1,327 @@
+/**
+ * @file MemoryAccounting.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "MemoryAccounting.hpp"
+
+namespace
+{
+    const int numberOfSubsystems = static_cast<int>(MemorySubsystem::NumberOfSubsystems);
+
+    /**
+     * Counters of a subsystem in a thread. They are monotonic (the current memory is the
+     * difference between the allocated and the freed bytes), so they can be merged without
+     * stopping the threads.
+     */
+    struct SubsystemCounters
+    {
+        std::atomic<long> allocatedBytes{0}; /**< Memory allocated by the thread [B]. */
+        std::atomic<long> freedBytes{0}; /**< Memory freed by the thread [B]. */
+        std::atomic<long> allocations{0}; /**< Number of allocations of the thread. */
+    };
+
+    /**
+     * Counters of a thread. They are written only by the owning thread with relaxed loads
+     * and stores, so an allocation never executes a locked instruction and never writes a
+     * cache line shared with another thread. They are merged when the statistics are read.
+     */
+    struct alignas(64) ThreadCounters
+    {
+        SubsystemCounters subsystems[numberOfSubsystems]; /**< Counters of the subsystems. */
+    };
+
+    const int maxNumberOfThreads = 64;
+
+    ThreadCounters threadCounters[maxNumberOfThreads];
+
+    std::atomic<int> numberOfThreads{0};
+
+    // the threads created after the first maxNumberOfThreads ones share these counters
+    ThreadCounters sharedCounters;
+
+    thread_local ThreadCounters* localCounters = nullptr;
+
+    thread_local MemorySubsystem threadSubsystem = MemorySubsystem::Other;
+
+    // net memory of the calling thread not yet added to the shared counters of the peaks
+    thread_local long pendingBytes[numberOfSubsystems] = {0};
+
+    // object that records the malloc calls of the calling thread
+    thread_local ExternalMemory* samplingMemory = nullptr;
+
+    /**
+     * Shared counters used to update the peak of a subsystem on the allocation path.
+     */
+    struct alignas(64) PeakCounters
+    {
+        std::atomic<long> current{0}; /**< Memory allocated, up to the pending bytes of the threads [B]. */
+        std::atomic<long> peak{0}; /**< Peak of the memory [B]. */
+    };
+
+    PeakCounters peakCounters[numberOfSubsystems];
+
+    const char* subsystemNames[numberOfSubsystems] = {"other", "trajectories", "planner", "mpc", "fk", "ik"};
+
+    /**
+     * Merged counters of a subsystem.
+     */
+    struct SubsystemSummary
+    {
+        long current{0}; /**< Memory currently allocated [B]. */
+        long allocations{0}; /**< Number of allocations. */
+        long allocatedBytes{0}; /**< Memory allocated [B]. */
+    };
+
+    // the readers (getStats, resetStats and the metrics task) are serialized by this mutex
+    std::mutex summaryMutex;
+    SubsystemSummary resetSummary[numberOfSubsystems]; /**< Counters at the last reset. */
+    std::chrono::steady_clock::time_point resetTime = std::chrono::steady_clock::now();
+
+    /**
+     * Get the counters of the calling thread.
+     */
+    ThreadCounters& getLocalCounters()
+    {
+        if(localCounters == nullptr)
+        {
+            int index = numberOfThreads.fetch_add(1, std::memory_order_relaxed);
+            localCounters = index < maxNumberOfThreads ? &threadCounters[index] : &sharedCounters;
+        }
+        return *localCounters;
+    }
+
+    /**
+     * Increase a counter of the calling thread.
+     */
+    void increase(std::atomic<long>& counter, const long& value, const bool& isShared)
+    {
+        if(isShared)
+            counter.fetch_add(value, std::memory_order_relaxed);
+        else
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Raise the peak of a subsystem.
+     */
+    void updatePeak(const int& subsystem, const long& current)
+    {
+        std::atomic<long>& peak = peakCounters[subsystem].peak;
+        long value = peak.load(std::memory_order_relaxed);
+        while(current > value && !peak.compare_exchange_weak(value, current, std::memory_order_relaxed));
+    }
+
+    /**
+     * Add the net memory of the calling thread to the shared counters when it exceeds the batch.
+     */
+    void accumulate(const int& subsystem, const long& bytes)
+    {
+        long& pending = pendingBytes[subsystem];
+        pending += bytes;
+        if(pending < MemoryAccounting::peakBatchBytes && pending > -MemoryAccounting::peakBatchBytes)
+            return;
+
+        long current = peakCounters[subsystem].current.fetch_add(pending, std::memory_order_relaxed) + pending;
+        pending = 0;
+        updatePeak(subsystem, current);
+    }
+
+    /**
+     * Merge the counters of all the threads.
+     */
+    void merge(SubsystemSummary (&summary)[numberOfSubsystems])
+    {
+        int threads = std::min(numberOfThreads.load(std::memory_order_relaxed), maxNumberOfThreads);
+        for(int i = 0; i < numberOfSubsystems; i++)
+        {
+            summary[i] = SubsystemSummary();
+            for(int j = 0; j <= threads; j++)
+            {
+                const SubsystemCounters& counters = j < threads ? threadCounters[j].subsystems[i]
+                    : sharedCounters.subsystems[i];
+                long allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+                summary[i].current += allocatedBytes - counters.freedBytes.load(std::memory_order_relaxed);
+                summary[i].allocatedBytes += allocatedBytes;
+                summary[i].allocations += counters.allocations.load(std::memory_order_relaxed);
+            }
+            // the merged value is exact, so it is used to refine the peak
+            updatePeak(i, summary[i].current);
+        }
+    }
+
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const double& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addDouble(value);
+    }
+}
+
+MemoryScope::MemoryScope(const MemorySubsystem& subsystem)
+    : m_previousSubsystem(threadSubsystem)
+{
+    threadSubsystem = subsystem;
+}
+
+MemoryScope::~MemoryScope()
+{
+    threadSubsystem = m_previousSubsystem;
+}
+
+ExternalMemory::~ExternalMemory()
+{
+    release();
+}
+
+void ExternalMemory::beginSampling()
+{
+    m_numberOfBlocks = 0;
+    m_untrackedBytes = 0;
+    m_previousSampling = samplingMemory;
+    samplingMemory = this;
+}
+
+void ExternalMemory::endSampling()
+{
+    samplingMemory = m_previousSampling;
+    m_previousSampling = nullptr;
+
+    // the blocks freed before the end of the sampling are removed, the other ones are
+    // retained by the library
+    long bytes = m_untrackedBytes;
+    for(int i = 0; i < m_numberOfBlocks; i++)
+        bytes += static_cast<long>(m_blocks[i].size);
+    m_numberOfBlocks = 0;
+    m_untrackedBytes = 0;
+
+    release();
+    if(bytes <= 0)
+        return;
+
+    m_subsystem = MemoryAccounting::currentSubsystem();
+    m_bytes = bytes;
+    MemoryAccounting::allocated(m_subsystem, m_bytes);
+}
+
+void ExternalMemory::blockAllocated(void* pointer, const std::size_t& size)
+{
+    if(m_numberOfBlocks < maxNumberOfBlocks)
+        m_blocks[m_numberOfBlocks++] = Block{pointer, size};
+    else
+        m_untrackedBytes += static_cast<long>(size);
+}
+
+void ExternalMemory::blockFreed(void* pointer)
+{
+    for(int i = 0; i < m_numberOfBlocks; i++)
+    {
+        if(m_blocks[i].pointer == pointer)
+        {
+            m_blocks[i] = m_blocks[--m_numberOfBlocks];
+            return;
+        }
+    }
+}
+
+void ExternalMemory::release()
+{
+    if(m_bytes == 0)
+        return;
+
+    MemoryAccounting::deallocated(m_subsystem, m_bytes);
+    m_bytes = 0;
+}
+
+MemorySubsystem MemoryAccounting::currentSubsystem()
+{
+    return threadSubsystem;
+}
+
+void MemoryAccounting::allocated(const MemorySubsystem& subsystem, const std::size_t& size)
+{
+    ThreadCounters& counters = getLocalCounters();
+    bool isShared = &counters == &sharedCounters;
+    SubsystemCounters& subsystemCounters = counters.subsystems[static_cast<int>(subsystem)];
+    increase(subsystemCounters.allocatedBytes, size, isShared);
+    increase(subsystemCounters.allocations, 1, isShared);
+    accumulate(static_cast<int>(subsystem), static_cast<long>(size));
+}
+
+void MemoryAccounting::deallocated(const MemorySubsystem& subsystem, const std::size_t& size)
+{
+    // the block may be freed by a thread different from the one that allocated it, the
+    // counters are consistent once they are merged
+    ThreadCounters& counters = getLocalCounters();
+    increase(counters.subsystems[static_cast<int>(subsystem)].freedBytes, size,
+             &counters == &sharedCounters);
+    accumulate(static_cast<int>(subsystem), -static_cast<long>(size));
+}
+
+void MemoryAccounting::externalAllocated(void* pointer, const std::size_t& size)
+{
+    if(samplingMemory != nullptr && pointer != nullptr)
+        samplingMemory->blockAllocated(pointer, size);
+}
+
+void MemoryAccounting::externalFreed(void* pointer)
+{
+    if(samplingMemory != nullptr && pointer != nullptr)
+        samplingMemory->blockFreed(pointer);
+}
+
+void MemoryAccounting::reset()
+{
+    std::lock_guard<std::mutex> guard(summaryMutex);
+    merge(resetSummary);
+    for(int i = 0; i < numberOfSubsystems; i++)
+        peakCounters[i].peak.store(resetSummary[i].current, std::memory_order_relaxed);
+    resetTime = std::chrono::steady_clock::now();
+}
+
+void MemoryAccounting::toBottle(yarp::os::Bottle& bottle)
+{
+    SubsystemSummary summary[numberOfSubsystems];
+    long peakBytes[numberOfSubsystems];
+    double elapsedTime;
+    {
+        std::lock_guard<std::mutex> guard(summaryMutex);
+        merge(summary);
+        for(int i = 0; i < numberOfSubsystems; i++)
+        {
+            peakBytes[i] = peakCounters[i].peak.load(std::memory_order_relaxed);
+            summary[i].allocations -= resetSummary[i].allocations;
+            summary[i].allocatedBytes -= resetSummary[i].allocatedBytes;
+        }
+        elapsedTime = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                             - resetTime).count(), 1e-3);
+    }
+
+    // (memory ((name (current_kb c) (peak_kb p) (allocations_per_s a) (allocated_kb_per_s b)) ...))
+    yarp::os::Bottle& memory = bottle.addList();
+    memory.addString("memory");
+    yarp::os::Bottle& memoryList = memory.addList();
+    for(int i = 0; i < numberOfSubsystems; i++)
+    {
+        yarp::os::Bottle& entry = memoryList.addList();
+        entry.addString(subsystemNames[i]);
+        yarp::os::Bottle& list = entry.addList();
+        addEntry("current_kb", summary[i].current / 1024.0, list);
+        addEntry("peak_kb", peakBytes[i] / 1024.0, list);
+        addEntry("allocations_per_s", summary[i].allocations / elapsedTime, list);
+        addEntry("allocated_kb_per_s", summary[i].allocatedBytes / 1024.0 / elapsedTime, list);
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ * @file MemoryAllocator.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// Replacement of the global operator new/delete of the walking module. Each block is
+// preceded by a header with its size and the subsystem of the scope where it was allocated,
+// so the deallocation is accounted to the right subsystem even if it happens in another scope.
+// With glibc (WALKING_INTERPOSE_MALLOC) malloc, calloc, realloc and free are interposed too:
+// they forward to the glibc allocator and, while an ExternalMemory object is sampling in the
+// calling thread (e.g. around the initialization of the OSQP workspaces), they record the
+// blocks of the thread. The operator new uses the glibc allocator directly, so its blocks are
+// not recorded twice. Without the interposition the malloc calls are not accounted.
+
+// std
+#include <cstdlib>
+#include <new>
+
+#ifdef WALKING_INTERPOSE_MALLOC
+// POSIX
+#include <malloc.h>
+
+// entry points of the glibc allocator
+extern "C"
+{
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t number, std::size_t size);
+    void* __libc_realloc(void* pointer, std::size_t size);
+    void __libc_free(void* pointer);
+}
+#endif
+
+#include "MemoryAccounting.hpp"
+
+namespace
+{
+    void* rawAllocate(std::size_t size)
+    {
+#ifdef WALKING_INTERPOSE_MALLOC
+        return __libc_malloc(size);
+#else
+        return std::malloc(size);
+#endif
+    }
+
+    void rawFree(void* pointer)
+    {
+#ifdef WALKING_INTERPOSE_MALLOC
+        __libc_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+
+    /**
+     * Header of an allocated block. The size keeps the alignment of malloc.
+     */
+    struct alignas(alignof(std::max_align_t)) BlockHeader
+    {
+        std::size_t size;
+        MemorySubsystem subsystem;
+    };
+
+    void* allocate(std::size_t size)
+    {
+        BlockHeader* header = static_cast<BlockHeader*>(rawAllocate(sizeof(BlockHeader) + size));
+        if(header == nullptr)
+            return nullptr;
+
+        header->size = size;
+        header->subsystem = MemoryAccounting::currentSubsystem();
+        MemoryAccounting::allocated(header->subsystem, size);
+        return header + 1;
+    }
+
+    void* allocateOrThrow(std::size_t size)
+    {
+        void* pointer;
+        while((pointer = allocate(size)) == nullptr)
+        {
+            std::new_handler handler = std::get_new_handler();
+            if(handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+        return pointer;
+    }
+
+    void deallocate(void* pointer) noexcept
+    {
+        if(pointer == nullptr)
+            return;
+
+        BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+        MemoryAccounting::deallocated(header->subsystem, header->size);
+        rawFree(header);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return allocateOrThrow(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocateOrThrow(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+#ifdef WALKING_INTERPOSE_MALLOC
+extern "C"
+{
+    void* malloc(std::size_t size)
+    {
+        void* pointer = __libc_malloc(size);
+        if(pointer != nullptr)
+            MemoryAccounting::externalAllocated(pointer, malloc_usable_size(pointer));
+        return pointer;
+    }
+
+    void* calloc(std::size_t number, std::size_t size)
+    {
+        void* pointer = __libc_calloc(number, size);
+        if(pointer != nullptr)
+            MemoryAccounting::externalAllocated(pointer, malloc_usable_size(pointer));
+        return pointer;
+    }
+
+    void* realloc(void* pointer, std::size_t size)
+    {
+        void* newPointer = __libc_realloc(pointer, size);
+
+        // the old block is released if the call succeeds (or if the new size is zero)
+        if(newPointer != nullptr || size == 0)
+            MemoryAccounting::externalFreed(pointer);
+        if(newPointer != nullptr)
+            MemoryAccounting::externalAllocated(newPointer, malloc_usable_size(newPointer));
+        return newPointer;
+    }
+
+    void free(void* pointer)
+    {
+        MemoryAccounting::externalFreed(pointer);
+        __libc_free(pointer);
+    }
+}
+#endif
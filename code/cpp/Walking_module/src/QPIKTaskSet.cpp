@@ -0,0 +1,62 @@
+/**
+ * @file QPIKTaskSet.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <string>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "QPIKTaskSet.hpp"
+
+bool QPIKTaskSet::initialize(const yarp::os::Searchable& config)
+{
+    m_isNeckEnabled = true;
+    m_isJointRegularizationEnabled = true;
+
+    if(!config.check("tasks"))
+        return true;
+
+    yarp::os::Bottle* tasks = config.find("tasks").asList();
+    if(tasks == nullptr)
+    {
+        yError() << "[initialize] The tasks of the QP-IK problem have to be a list.";
+        return false;
+    }
+
+    m_isNeckEnabled = false;
+    m_isJointRegularizationEnabled = false;
+    for(int i = 0; i < tasks->size(); i++)
+    {
+        std::string task = tasks->get(i).asString();
+        if(task == "neck")
+            m_isNeckEnabled = true;
+        else if(task == "joint_regularization")
+            m_isJointRegularizationEnabled = true;
+        else
+        {
+            yError() << "[initialize] Unknown QP-IK task" << task
+                     << "(the available tasks are neck and joint_regularization).";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool QPIKTaskSet::isNeckEnabled() const
+{
+    return m_isNeckEnabled;
+}
+
+bool QPIKTaskSet::isJointRegularizationEnabled() const
+{
+    return m_isJointRegularizationEnabled;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file QPProblemRecorder.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cstdint>
+#include <vector>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include "QPProblemRecorder.hpp"
+
+namespace
+{
+    const uint32_t magicNumber = 0x51505052; /**< Identifier of a problem record ("QPPR"). */
+    const uint32_t boundedMagicNumber = 0x51505042; /**< Identifier of a problem record with
+                                                       bounds on the variables ("QPPB"). */
+    const uint32_t checkpointMagicNumber = 0x51504350; /**< Identifier of a checkpoint record ("QPCP"). */
+
+    template <typename T>
+    void writeValue(std::ofstream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& stream, T& value)
+    {
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<bool>(stream);
+    }
+
+    void writeVector(std::ofstream& stream, const Eigen::VectorXd& vector)
+    {
+        writeValue(stream, static_cast<int32_t>(vector.size()));
+        stream.write(reinterpret_cast<const char*>(vector.data()), sizeof(double) * vector.size());
+    }
+
+    bool readVector(std::ifstream& stream, Eigen::VectorXd& vector)
+    {
+        int32_t size;
+        if(!readValue(stream, size) || size < 0)
+            return false;
+
+        vector.resize(size);
+        stream.read(reinterpret_cast<char*>(vector.data()), sizeof(double) * size);
+        return static_cast<bool>(stream);
+    }
+
+    void writeMatrix(std::ofstream& stream, const Eigen::SparseMatrix<double>& matrix)
+    {
+        writeValue(stream, static_cast<int32_t>(matrix.rows()));
+        writeValue(stream, static_cast<int32_t>(matrix.cols()));
+        writeValue(stream, static_cast<int32_t>(matrix.nonZeros()));
+        for(int k = 0; k < matrix.outerSize(); k++)
+            for(Eigen::SparseMatrix<double>::InnerIterator it(matrix, k); it; ++it)
+            {
+                writeValue(stream, static_cast<int32_t>(it.row()));
+                writeValue(stream, static_cast<int32_t>(it.col()));
+                writeValue(stream, it.value());
+            }
+    }
+
+    bool readMatrix(std::ifstream& stream, Eigen::SparseMatrix<double>& matrix)
+    {
+        int32_t rows, cols, nonZeros;
+        if(!readValue(stream, rows) || !readValue(stream, cols) || !readValue(stream, nonZeros))
+            return false;
+
+        if(rows < 0 || cols < 0 || nonZeros < 0)
+            return false;
+
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(nonZeros);
+        for(int i = 0; i < nonZeros; i++)
+        {
+            int32_t row, col;
+            double value;
+            if(!readValue(stream, row) || !readValue(stream, col) || !readValue(stream, value))
+                return false;
+            triplets.emplace_back(row, col, value);
+        }
+
+        matrix.resize(rows, cols);
+        matrix.setFromTriplets(triplets.begin(), triplets.end());
+        return true;
+    }
+}
+
+bool QPProblemRecorder::open(const std::string& fileName, const int& checkpointPeriod)
+{
+    m_checkpointPeriod = checkpointPeriod;
+    m_numberOfProblems = 0;
+
+    m_stream.open(fileName, std::ios::out | std::ios::binary);
+    if(!m_stream.is_open())
+    {
+        yError() << "[open] Unable to open the file " << fileName;
+        return false;
+    }
+    return true;
+}
+
+bool QPProblemRecorder::record(const QPProblem& problem)
+{
+    if(!m_stream.is_open())
+    {
+        yError() << "[record] The file is not open.";
+        return false;
+    }
+
+    writeValue(m_stream, problem.hasVariableBounds ? boundedMagicNumber : magicNumber);
+    writeValue(m_stream, static_cast<uint8_t>(problem.isStructureChanged));
+    writeMatrix(m_stream, problem.hessian);
+    writeVector(m_stream, problem.gradient);
+    writeMatrix(m_stream, problem.constraintsMatrix);
+    writeVector(m_stream, problem.lowerBound);
+    writeVector(m_stream, problem.upperBound);
+    if(problem.hasVariableBounds)
+    {
+        writeVector(m_stream, problem.lowerVariableBound);
+        writeVector(m_stream, problem.upperVariableBound);
+    }
+
+    if(!m_stream)
+    {
+        yError() << "[record] Unable to write the problem.";
+        return false;
+    }
+
+    m_numberOfProblems++;
+    return true;
+}
+
+bool QPProblemRecorder::isCheckpointRequired() const
+{
+    return m_checkpointPeriod > 0 && m_numberOfProblems % m_checkpointPeriod == 0;
+}
+
+bool QPProblemRecorder::recordCheckpoint(const Eigen::VectorXd& primal, const Eigen::VectorXd& dual)
+{
+    if(!m_stream.is_open())
+    {
+        yError() << "[recordCheckpoint] The file is not open.";
+        return false;
+    }
+
+    writeValue(m_stream, checkpointMagicNumber);
+    writeVector(m_stream, primal);
+    writeVector(m_stream, dual);
+
+    if(!m_stream)
+    {
+        yError() << "[recordCheckpoint] Unable to write the checkpoint.";
+        return false;
+    }
+    return true;
+}
+
+void QPProblemRecorder::close()
+{
+    if(m_stream.is_open())
+        m_stream.close();
+}
+
+bool QPProblemRecorder::isOpen() const
+{
+    return m_stream.is_open();
+}
+
+bool QPProblemReader::open(const std::string& fileName)
+{
+    m_stream.open(fileName, std::ios::in | std::ios::binary);
+    if(!m_stream.is_open())
+    {
+        yError() << "[open] Unable to open the file " << fileName;
+        return false;
+    }
+    return true;
+}
+
+bool QPProblemReader::read(QPProblem& problem)
+{
+    uint32_t magic;
+    if(!readValue(m_stream, magic))
+        return false;
+
+    // a checkpoint contains the state of the solver before the next problem
+    problem.hasCheckpoint = false;
+    if(magic == checkpointMagicNumber)
+    {
+        if(!readVector(m_stream, problem.checkpointPrimal)
+           || !readVector(m_stream, problem.checkpointDual)
+           || !readValue(m_stream, magic))
+            return false;
+        problem.hasCheckpoint = true;
+    }
+
+    if(magic != magicNumber && magic != boundedMagicNumber)
+    {
+        yError() << "[read] The file is corrupted.";
+        return false;
+    }
+
+    uint8_t isStructureChanged;
+    if(!readValue(m_stream, isStructureChanged)
+       || !readMatrix(m_stream, problem.hessian)
+       || !readVector(m_stream, problem.gradient)
+       || !readMatrix(m_stream, problem.constraintsMatrix)
+       || !readVector(m_stream, problem.lowerBound)
+       || !readVector(m_stream, problem.upperBound))
+    {
+        yError() << "[read] The last problem is truncated.";
+        return false;
+    }
+
+    problem.hasVariableBounds = magic == boundedMagicNumber;
+    if(problem.hasVariableBounds
+       && (!readVector(m_stream, problem.lowerVariableBound)
+           || !readVector(m_stream, problem.upperVariableBound)))
+    {
+        yError() << "[read] The last problem is truncated.";
+        return false;
+    }
+    problem.isStructureChanged = isStructureChanged;
+    return true;
+}
+
+std::streamoff QPProblemReader::tell()
+{
+    return m_stream.tellg();
+}
+
+bool QPProblemReader::seek(const std::streamoff& offset)
+{
+    // the end of file flag is set if the previous read reached the end of the file
+    m_stream.clear();
+    m_stream.seekg(offset);
+    if(!m_stream)
+    {
+        yError() << "[seek] Unable to move to the offset " << offset;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file RealTimeSettings.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// YARP
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "RealTimeSettings.hpp"
+
+bool RealTimeSettings::initialize(const yarp::os::Searchable& config)
+{
+    m_priority = config.check("realtime_priority", yarp::os::Value(0)).asInt();
+    if(m_priority != 0 && (m_priority < sched_get_priority_min(SCHED_FIFO)
+                           || m_priority > sched_get_priority_max(SCHED_FIFO)))
+    {
+        yError() << "[initialize] The real-time priority has to be between "
+                 << sched_get_priority_min(SCHED_FIFO) << " and " << sched_get_priority_max(SCHED_FIFO)
+                 << " (0 to use the default scheduler).";
+        return false;
+    }
+
+    m_cpus.clear();
+    yarp::os::Value cpus = config.find("cpu_affinity");
+    if(cpus.isList())
+    {
+        for(int i = 0; i < cpus.asList()->size(); i++)
+            m_cpus.push_back(cpus.asList()->get(i).asInt());
+    }
+    else if(cpus.isInt())
+        m_cpus.push_back(cpus.asInt());
+
+    for(const auto& cpu : m_cpus)
+    {
+        if(cpu < 0 || cpu >= CPU_SETSIZE)
+        {
+            yError() << "[initialize] Invalid CPU " << cpu;
+            return false;
+        }
+    }
+
+    m_lockMemory = config.check("lock_memory", yarp::os::Value(false)).asBool();
+    return true;
+}
+
+bool RealTimeSettings::isEnabled() const
+{
+    return m_priority != 0 || !m_cpus.empty() || m_lockMemory;
+}
+
+bool RealTimeSettings::apply() const
+{
+    if(!m_cpus.empty())
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for(const auto& cpu : m_cpus)
+            CPU_SET(cpu, &cpuSet);
+
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+        if(error != 0)
+        {
+            yError() << "[apply] Unable to set the CPU affinity: " << std::strerror(error);
+            return false;
+        }
+    }
+
+    if(m_priority != 0)
+    {
+        sched_param parameters;
+        parameters.sched_priority = m_priority;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+        if(error != 0)
+        {
+            yError() << "[apply] Unable to set the real-time priority: " << std::strerror(error);
+            return false;
+        }
+    }
+
+    // the pages already mapped and the ones mapped later are never swapped out
+    if(m_lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        yError() << "[apply] Unable to lock the memory: " << std::strerror(errno);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file SolverAccuracySchedule.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <cmath>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/Bottle.h>
+
+#include "SolverAccuracySchedule.hpp"
+
+bool SolverAccuracySchedule::parseAccuracy(const yarp::os::Searchable& config, const std::string& key,
+                                           const SolverAccuracyPhase& phase)
+{
+    SolverAccuracy accuracy;
+    if(!config.check(key))
+    {
+        m_accuracies[static_cast<int>(phase)] = accuracy;
+        return true;
+    }
+
+    yarp::os::Value value = config.find(key);
+    yarp::os::Bottle* list = value.asList();
+    if(list == nullptr || list->size() != 4)
+    {
+        yError() << "[parseAccuracy] The field " << key
+                 << " has to be a list of four elements (eps_abs eps_rel max_iter nWSR).";
+        return false;
+    }
+
+    accuracy.absoluteTolerance = list->get(0).asDouble();
+    accuracy.relativeTolerance = list->get(1).asDouble();
+    accuracy.maxIterations = list->get(2).asInt();
+    accuracy.maxWorkingSetRecalculations = list->get(3).asInt();
+
+    if(accuracy.absoluteTolerance < 0 || accuracy.relativeTolerance < 0
+       || accuracy.maxIterations <= 0 || accuracy.maxWorkingSetRecalculations <= 0)
+    {
+        yError() << "[parseAccuracy] The tolerances of " << key
+                 << " have to be non negative and the iterations have to be positive.";
+        return false;
+    }
+
+    m_accuracies[static_cast<int>(phase)] = accuracy;
+    return true;
+}
+
+bool SolverAccuracySchedule::initialize(const yarp::os::Searchable& config, const double& samplingTime)
+{
+    m_isPhaseInitialized = false;
+    m_isEnabled = config.check("use_accuracy_schedule", yarp::os::Value(false)).asBool();
+
+    double switchWindow = config.check("switch_window", yarp::os::Value(0.1)).asDouble();
+    if(switchWindow < 0 || samplingTime <= 0)
+    {
+        yError() << "[initialize] The switch window and the sampling time have to be positive.";
+        return false;
+    }
+    m_switchWindow = std::round(switchWindow / samplingTime);
+
+    if(!parseAccuracy(config, "standing", SolverAccuracyPhase::Standing))
+        return false;
+
+    if(!parseAccuracy(config, "double_support", SolverAccuracyPhase::DoubleSupport))
+        return false;
+
+    if(!parseAccuracy(config, "single_support", SolverAccuracyPhase::SingleSupport))
+        return false;
+
+    if(!parseAccuracy(config, "contact_switch", SolverAccuracyPhase::ContactSwitch))
+        return false;
+
+    return true;
+}
+
+bool SolverAccuracySchedule::updatePhase(const std::deque<bool>& leftInContact,
+                                         const std::deque<bool>& rightInContact,
+                                         const bool& isStanding)
+{
+    SolverAccuracyPhase phase;
+
+    // a contact switch is detected if the contact status changes inside the window
+    bool isSwitching = false;
+    int window = std::min(std::min(leftInContact.size(), rightInContact.size()),
+                          static_cast<size_t>(m_switchWindow + 1));
+    for(int i = 1; i < window; i++)
+    {
+        if(leftInContact[i] != leftInContact.front() || rightInContact[i] != rightInContact.front())
+        {
+            isSwitching = true;
+            break;
+        }
+    }
+
+    if(isSwitching)
+        phase = SolverAccuracyPhase::ContactSwitch;
+    else if(isStanding)
+        phase = SolverAccuracyPhase::Standing;
+    else if(!leftInContact.empty() && !rightInContact.empty()
+            && leftInContact.front() && rightInContact.front())
+        phase = SolverAccuracyPhase::DoubleSupport;
+    else
+        phase = SolverAccuracyPhase::SingleSupport;
+
+    bool isChanged = !m_isPhaseInitialized || phase != m_currentPhase;
+    m_currentPhase = phase;
+    m_isPhaseInitialized = true;
+    return isChanged;
+}
+
+const SolverAccuracyPhase& SolverAccuracySchedule::getPhase() const
+{
+    return m_currentPhase;
+}
+
+const SolverAccuracy& SolverAccuracySchedule::getAccuracy() const
+{
+    return m_accuracies.at(static_cast<int>(m_currentPhase));
+}
+
+bool SolverAccuracySchedule::isEnabled() const
+{
+    return m_isEnabled;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file SolverSettings.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "SolverSettings.hpp"
+
+bool SolverSettings::parseOsqpSettings(const yarp::os::Searchable& config, OsqpSettings& settings)
+{
+    settings.rho = config.check("osqp_rho", yarp::os::Value(settings.rho)).asDouble();
+    settings.sigma = config.check("osqp_sigma", yarp::os::Value(settings.sigma)).asDouble();
+    settings.alpha = config.check("osqp_alpha", yarp::os::Value(settings.alpha)).asDouble();
+    settings.adaptiveRho = config.check("osqp_adaptive_rho",
+                                        yarp::os::Value(settings.adaptiveRho)).asBool();
+    settings.polish = config.check("osqp_polish", yarp::os::Value(settings.polish)).asBool();
+    settings.absoluteTolerance = config.check("osqp_eps_abs",
+                                              yarp::os::Value(settings.absoluteTolerance)).asDouble();
+    settings.relativeTolerance = config.check("osqp_eps_rel",
+                                              yarp::os::Value(settings.relativeTolerance)).asDouble();
+    settings.maxIterations = config.check("osqp_max_iter",
+                                          yarp::os::Value(settings.maxIterations)).asInt();
+
+    if(settings.rho <= 0 || settings.sigma <= 0)
+    {
+        yError() << "[parseOsqpSettings] rho and sigma have to be positive.";
+        return false;
+    }
+
+    if(settings.alpha <= 0 || settings.alpha >= 2)
+    {
+        yError() << "[parseOsqpSettings] alpha has to be in the interval (0, 2).";
+        return false;
+    }
+
+    if(settings.absoluteTolerance < 0 || settings.relativeTolerance < 0 || settings.maxIterations <= 0)
+    {
+        yError() << "[parseOsqpSettings] The tolerances have to be non negative and "
+                 << "the maximum number of iterations has to be positive.";
+        return false;
+    }
+    return true;
+}
+
+bool SolverSettings::applyOsqpSettings(const OsqpSettings& settings, OsqpEigen::Solver& solver)
+{
+    if(solver.isInitialized())
+    {
+        yError() << "[applyOsqpSettings] The settings can be applied only before initializing the solver.";
+        return false;
+    }
+
+    OSQPSettings* osqpSettings = solver.settings()->getSettings();
+    osqpSettings->rho = settings.rho;
+    osqpSettings->sigma = settings.sigma;
+    osqpSettings->alpha = settings.alpha;
+    osqpSettings->adaptive_rho = settings.adaptiveRho;
+    osqpSettings->polish = settings.polish;
+    osqpSettings->eps_abs = settings.absoluteTolerance;
+    osqpSettings->eps_rel = settings.relativeTolerance;
+    osqpSettings->max_iter = settings.maxIterations;
+    return true;
+}
+
+bool SolverSettings::parseQpOASESSettings(const yarp::os::Searchable& config, QpOASESSettings& settings)
+{
+    settings.preset = config.check("qpoases_preset", yarp::os::Value(settings.preset)).asString();
+    settings.maxWorkingSetRecalculations = config.check("qpoases_nWSR",
+                                                        yarp::os::Value(settings.maxWorkingSetRecalculations)).asInt();
+
+    if(settings.preset != "default" && settings.preset != "reliable"
+       && settings.preset != "mpc" && settings.preset != "fast")
+    {
+        yError() << "[parseQpOASESSettings] Unknown preset " << settings.preset
+                 << ". Available presets: default, reliable, mpc and fast.";
+        return false;
+    }
+
+    if(settings.maxWorkingSetRecalculations <= 0)
+    {
+        yError() << "[parseQpOASESSettings] nWSR has to be positive.";
+        return false;
+    }
+    return true;
+}
+
+bool SolverSettings::applyQpOASESSettings(const QpOASESSettings& settings, qpOASES::SQProblem& solver)
+{
+    qpOASES::Options options;
+    if(settings.preset == "reliable")
+        options.setToReliable();
+    else if(settings.preset == "mpc")
+        options.setToMPC();
+    else if(settings.preset == "fast")
+        options.setToFast();
+    else
+        options.setToDefault();
+
+    // keep the print level chosen by the user of the solver
+    options.printLevel = solver.getOptions().printLevel;
+
+    if(solver.setOptions(options) != qpOASES::SUCCESSFUL_RETURN)
+    {
+        yError() << "[applyQpOASESSettings] Unable to set the options of the solver.";
+        return false;
+    }
+    return true;
+}
@@ -19,6 +19,7 @@
 
 #include "StableDCMModel.hpp"
 #include "Utils.hpp"
+#include "BufferViews.hpp"
 
 bool StableDCMModel::initialize(const yarp::os::Searchable& config)
 {
@@ -48,6 +49,7 @@ bool StableDCMModel::initialize(const yarp::os::Searchable& config)
 
     yarp::sig::Vector buffer;
     buffer.resize(2, 0.0);
+    m_comVelocity.resize(2, 0.0);
 
     // instantiate Integrator object
     m_comIntegrator = std::make_unique<iCub::ctrl::Integrator>(samplingTime, buffer);
@@ -72,17 +74,11 @@ bool StableDCMModel::integrateModel()
     }
 
     // evaluate the velocity of the CoM
-    yarp::sig::Vector comVelocityYarp(2);
-    iDynTree::toEigen(comVelocityYarp) = -m_omega * (iDynTree::toEigen(m_comPosition) -
-                                                     iDynTree::toEigen(m_dcmPosition));
+    BufferViews::view(m_comVelocity) = -m_omega * (iDynTree::toEigen(m_comPosition) -
+                                                   iDynTree::toEigen(m_dcmPosition));
 
     // integrate velocities
-    yarp::sig::Vector comPositionYarp(2);
-    comPositionYarp = m_comIntegrator->integrate(comVelocityYarp);
-
-    // convert YARP vector into iDynTree vector
-    iDynTree::toiDynTree(comVelocityYarp, m_comVelocity);
-    iDynTree::toiDynTree(comPositionYarp, m_comPosition);
+    iDynTree::toEigen(m_comPosition) = BufferViews::view(m_comIntegrator->integrate(m_comVelocity));
 
     m_isModelPropagated = true;
 
@@ -109,7 +105,7 @@ bool StableDCMModel::getCoMVelocity(iDynTree::Vector2& comVelocity)
                  << "Please call 'propagateModel()' method.";
         return false;
     }
-    comVelocity = m_comVelocity;
+    iDynTree::toEigen(comVelocity) = BufferViews::view(m_comVelocity);
     return true;
 }
 
@@ -128,3 +124,22 @@ bool StableDCMModel::reset(const iDynTree::Vector2& initialValue)
     m_comIntegrator->reset(buffer);
     return true;
 }
+
+bool StableDCMModel::setSamplingTime(const double& samplingTime)
+{
+    if(m_comIntegrator == nullptr)
+    {
+        yError() << "[setSamplingTime] The dcm integrator object is not ready. "
+                 << "Please call initialize method.";
+        return false;
+    }
+
+    if(samplingTime <= 0)
+    {
+        yError() << "[setSamplingTime] The sampling time has to be a positive number.";
+        return false;
+    }
+
+    m_comIntegrator->setTs(samplingTime);
+    return true;
+}
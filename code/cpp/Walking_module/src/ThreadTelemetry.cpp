@@ -0,0 +1,298 @@
+/**
+ * @file ThreadTelemetry.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "ThreadTelemetry.hpp"
+
+namespace
+{
+    /**
+     * Prefix of the names of the threads of the module.
+     */
+    const std::string threadPrefix = "walk-";
+
+    /**
+     * Counters of a thread read in a sample.
+     */
+    struct ThreadSample
+    {
+        int tid;
+        std::string name;
+        int cpu{-1};
+        SchedulingCounters counters;
+    };
+
+    /**
+     * Read the scheduler counters of a thread of the process.
+     * @return false if the thread does not exist anymore.
+     */
+    bool readThreadSample(ThreadSample& sample)
+    {
+        std::string path = "/proc/self/task/" + std::to_string(sample.tid) + "/";
+
+        // time on the CPU and time on the run queue [ns]
+        std::ifstream schedstat(path + "schedstat");
+        long runTime, waitTime;
+        if(!(schedstat >> runTime >> waitTime))
+            return false;
+        sample.counters.runTime = runTime * 1e-9;
+        sample.counters.waitTime = waitTime * 1e-9;
+
+        std::ifstream status(path + "status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.compare(0, 24, "voluntary_ctxt_switches:") == 0)
+                sample.counters.voluntarySwitches = std::atol(line.c_str() + 24);
+            else if(line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0)
+                sample.counters.involuntarySwitches = std::atol(line.c_str() + 27);
+        }
+
+        // the CPU of the last run is the field 39, the name (field 2) may contain spaces
+        std::ifstream stat(path + "stat");
+        if(!std::getline(stat, line) || line.rfind(')') == std::string::npos)
+            return false;
+        std::istringstream fields(line.substr(line.rfind(')') + 1));
+        std::string field;
+        for(int i = 3; i < 39; i++)
+            fields >> field;
+        fields >> sample.cpu;
+
+        return true;
+    }
+
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const int& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addInt(value);
+    }
+
+    void addEntry(const std::string& key, const double& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addDouble(value);
+    }
+
+    void addEntry(const std::string& key, const std::string& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addString(value);
+    }
+
+    /**
+     * Add a (key (counters)) list to a bottle.
+     */
+    void addCounters(const std::string& key, const SchedulingCounters& counters, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        yarp::os::Bottle& list = entry.addList();
+        addEntry("windows", counters.windows, list);
+        addEntry("run_ms", counters.runTime * 1e3, list);
+        addEntry("wait_ms", counters.waitTime * 1e3, list);
+        addEntry("voluntary_switches", static_cast<int>(counters.voluntarySwitches), list);
+        addEntry("involuntary_switches", static_cast<int>(counters.involuntarySwitches), list);
+        addEntry("migrations", static_cast<int>(counters.migrations), list);
+    }
+}
+
+void ThreadTelemetry::setCurrentThreadName(const std::string& name)
+{
+    // the kernel truncates the names to 15 characters
+    pthread_setname_np(pthread_self(), (threadPrefix + name).substr(0, 15).c_str());
+}
+
+bool ThreadTelemetry::initialize(const yarp::os::Searchable& config, WalkingThreadPool& threadPool)
+{
+    m_threadPool = &threadPool;
+    m_period = config.check("thread_telemetry_period", yarp::os::Value(0)).asInt();
+    if(m_period < 0)
+    {
+        yError() << "[initialize] The thread_telemetry_period cannot be negative.";
+        return false;
+    }
+    m_maxLag = config.check("thread_telemetry_max_lag", yarp::os::Value(0.002)).asDouble();
+    return true;
+}
+
+bool ThreadTelemetry::isEnabled() const
+{
+    return m_period > 0;
+}
+
+void ThreadTelemetry::update(const bool& isOverrun)
+{
+    if(m_period <= 0)
+        return;
+
+    m_isOverrun = m_isOverrun || isOverrun;
+    if(++m_ticks < m_period)
+        return;
+
+    // the window is extended until the previous sample is completed
+    if(m_isSamplePending.load(std::memory_order_acquire))
+        return;
+
+    m_isSampleOverrun.store(m_isOverrun, std::memory_order_relaxed);
+    m_windowEndTime.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+    m_isSamplePending.store(true, std::memory_order_release);
+    if(!m_threadPool->submit(TaskPriority::Low, [this]{sample();}))
+    {
+        // the window is extended if the task cannot be queued
+        m_isSamplePending.store(false, std::memory_order_release);
+        return;
+    }
+
+    m_ticks = 0;
+    m_isOverrun = false;
+}
+
+void ThreadTelemetry::sample()
+{
+    // delay of the task with respect to the end of the window
+    std::chrono::steady_clock::time_point windowEndTime{
+        std::chrono::steady_clock::duration(m_windowEndTime.load(std::memory_order_relaxed))};
+    double lag = std::chrono::duration<double>(std::chrono::steady_clock::now() - windowEndTime).count();
+
+    DIR* directory = opendir("/proc/self/task");
+    if(directory == nullptr)
+    {
+        m_isSamplePending.store(false, std::memory_order_release);
+        return;
+    }
+
+    // the files are read without holding the mutex
+    std::vector<ThreadSample> samples;
+    int pid = getpid();
+    while(dirent* entry = readdir(directory))
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+
+        ThreadSample sample;
+        sample.tid = std::atoi(entry->d_name);
+        if(sample.tid == pid)
+            sample.name = "control";
+        else
+        {
+            std::ifstream comm("/proc/self/task/" + std::string(entry->d_name) + "/comm");
+            std::string name;
+            if(!std::getline(comm, name) || name.compare(0, threadPrefix.size(), threadPrefix) != 0)
+                continue;
+            sample.name = name.substr(threadPrefix.size());
+        }
+
+        if(readThreadSample(sample))
+            samples.push_back(sample);
+    }
+    closedir(directory);
+
+    bool isOverrun = m_isSampleOverrun.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // a window is valid only if it is opened and closed by samples taken on time, otherwise
+    // its counters contain the ticks of the following window. The late sample is kept as the
+    // reference of the next window
+    bool isLate = lag > m_maxLag;
+    bool isWindowValid = !isLate && !m_isPreviousSampleLate;
+    if(!isWindowValid && m_numberOfSamples > 0)
+        m_numberOfRejectedWindows++;
+    m_isPreviousSampleLate = isLate;
+    m_numberOfSamples++;
+    m_meanLag += (lag - m_meanLag) / m_numberOfSamples;
+    m_maxObservedLag = std::max(m_maxObservedLag, lag);
+
+    for(const auto& sample : samples)
+    {
+        ThreadSchedulingStatistics& thread = m_threads[sample.name];
+
+        // the first sample of a thread (or of a restarted thread) is only a reference
+        if(thread.tid == sample.tid && isWindowValid)
+        {
+            SchedulingCounters& counters = isOverrun ? thread.overrun : thread.normal;
+            counters.runTime += sample.counters.runTime - thread.previous.runTime;
+            counters.waitTime += sample.counters.waitTime - thread.previous.waitTime;
+            counters.voluntarySwitches += sample.counters.voluntarySwitches
+                - thread.previous.voluntarySwitches;
+            counters.involuntarySwitches += sample.counters.involuntarySwitches
+                - thread.previous.involuntarySwitches;
+            if(thread.cpu != sample.cpu)
+                counters.migrations++;
+            counters.windows++;
+        }
+
+        thread.tid = sample.tid;
+        thread.cpu = sample.cpu;
+        thread.previous = sample.counters;
+    }
+    m_isSamplePending.store(false, std::memory_order_release);
+}
+
+void ThreadTelemetry::reset()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // the previous samples are kept, so the next window is still valid
+    for(auto& thread : m_threads)
+    {
+        thread.second.normal = SchedulingCounters();
+        thread.second.overrun = SchedulingCounters();
+    }
+    m_numberOfSamples = 0;
+    m_numberOfRejectedWindows = 0;
+    m_meanLag = 0.0;
+    m_maxObservedLag = 0.0;
+}
+
+void ThreadTelemetry::toBottle(yarp::os::Bottle& bottle)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // (threads (((name n) (tid t) (cpu c) (normal (...)) (overrun (...))) ...))
+    yarp::os::Bottle& threads = bottle.addList();
+    threads.addString("threads");
+    yarp::os::Bottle& threadsList = threads.addList();
+    for(const auto& thread : m_threads)
+    {
+        yarp::os::Bottle& entry = threadsList.addList();
+        addEntry("name", thread.first, entry);
+        addEntry("tid", thread.second.tid, entry);
+        addEntry("cpu", thread.second.cpu, entry);
+        addCounters("normal", thread.second.normal, entry);
+        addCounters("overrun", thread.second.overrun, entry);
+    }
+
+    // (thread_sampling ((samples s) (rejected_windows r) (mean_lag_ms m) (max_lag_ms x)))
+    yarp::os::Bottle& sampling = bottle.addList();
+    sampling.addString("thread_sampling");
+    yarp::os::Bottle& samplingList = sampling.addList();
+    addEntry("samples", m_numberOfSamples, samplingList);
+    addEntry("rejected_windows", m_numberOfRejectedWindows, samplingList);
+    addEntry("mean_lag_ms", m_meanLag * 1e3, samplingList);
+    addEntry("max_lag_ms", m_maxObservedLag * 1e3, samplingList);
+}
@@ -9,30 +9,26 @@
 // YARP
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Value.h>
+#include <yarp/os/Time.h>
 
 // iDynTree
 #include <iDynTree/Core/EigenHelpers.h>
 
+#include "MemoryAccounting.hpp"
 #include "TrajectoryGenerator.hpp"
 #include "Utils.hpp"
 
 TrajectoryGenerator::~TrajectoryGenerator()
 {
-    {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        m_generatorState = GeneratorState::Closing;
-        m_conditionVariable.notify_one();
-    }
-
-    if(m_generatorThread.joinable())
-    {
-        m_generatorThread.join();
-        m_generatorThread = std::thread();
-    }
+    // the task of the pool uses the generator
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_conditionVariable.wait(lock, [this]{return m_generatorState != GeneratorState::Called;});
 }
 
-bool TrajectoryGenerator::initialize(const yarp::os::Searchable& config)
+bool TrajectoryGenerator::initialize(const yarp::os::Searchable& config, WalkingThreadPool& threadPool)
 {
+    m_threadPool = &threadPool;
+
     if(!configurePlanner(config))
     {
         yError() << "[initialize] Failed to configure the unicycle trajectory generator.";
@@ -154,9 +150,6 @@ bool TrajectoryGenerator::configurePlanner(const yarp::os::Searchable& config)
 
         // change the state of the generator
         m_generatorState = GeneratorState::FirstStep;
-
-        // start the thread
-        m_generatorThread = std::thread(&TrajectoryGenerator::computeThread, this);
     }
 
     return ok;
@@ -167,91 +160,91 @@ void TrajectoryGenerator::addTerminalStep(bool terminalStep)
     m_trajectoryGenerator.addTerminalStep(terminalStep);
 }
 
-void TrajectoryGenerator::computeThread()
+void TrajectoryGenerator::computeTrajectory()
 {
-    while (true)
-    {
-        double initTime;
-        double endTime;
-        double dT;
+    // the condition variable is notified while the mutex is locked, so the generator cannot
+    // be destroyed before the end of the task
+    MemoryScope memoryScope(MemorySubsystem::Planner);
 
-        bool correctLeft;
+    double initTime;
+    double endTime;
+    double dT;
 
-        iDynTree::Vector2 desiredPoint;
-        iDynTree::Vector2 measuredPositionLeft, measuredPositionRight;
-        double measuredAngleLeft, measuredAngleRight;
+    bool correctLeft;
 
-        iDynTree::Vector2 DCMBoundaryConditionAtMergePointPosition;
-        iDynTree::Vector2 DCMBoundaryConditionAtMergePointVelocity;
+    iDynTree::Vector2 desiredPoint;
+    iDynTree::Vector2 measuredPositionLeft, measuredPositionRight;
+    double measuredAngleLeft, measuredAngleRight;
 
-        // wait until a new trajectory has to be evaluated.
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_conditionVariable.wait(lock, [&]{return ((m_generatorState == GeneratorState::Called)
-                                                       || (m_generatorState == GeneratorState::Closing));});
+    iDynTree::Vector2 DCMBoundaryConditionAtMergePointPosition;
+    iDynTree::Vector2 DCMBoundaryConditionAtMergePointVelocity;
 
-            if(m_generatorState == GeneratorState::Closing)
-                break;
+    // get the inputs of the new trajectory
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
 
-            // set timings
-            dT = m_dT ;
-            initTime = m_initTime;
-            endTime = initTime + m_plannerHorizon;
+        // set timings
+        dT = m_dT ;
+        initTime = m_initTime;
+        endTime = initTime + m_plannerHorizon;
 
-            // set desired point
-            desiredPoint = m_desiredPoint;
+        // set desired point
+        desiredPoint = m_desiredPoint;
 
-            // dcm boundary conditions
-            DCMBoundaryConditionAtMergePointPosition = m_DCMBoundaryConditionAtMergePointPosition;
-            DCMBoundaryConditionAtMergePointVelocity = m_DCMBoundaryConditionAtMergePointVelocity;
+        // dcm boundary conditions
+        DCMBoundaryConditionAtMergePointPosition = m_DCMBoundaryConditionAtMergePointPosition;
+        DCMBoundaryConditionAtMergePointVelocity = m_DCMBoundaryConditionAtMergePointVelocity;
 
-            // left foot
-            measuredPositionLeft(0) = m_measuredTransformLeft.getPosition()(0);
-            measuredPositionLeft(1) = m_measuredTransformLeft.getPosition()(1);
-            measuredAngleLeft = m_measuredTransformLeft.getRotation().asRPY()(2);
+        // left foot
+        measuredPositionLeft(0) = m_measuredTransformLeft.getPosition()(0);
+        measuredPositionLeft(1) = m_measuredTransformLeft.getPosition()(1);
+        measuredAngleLeft = m_measuredTransformLeft.getRotation().asRPY()(2);
 
-            // right foot
-            measuredPositionRight(0) = m_measuredTransformRight.getPosition()(0);
-            measuredPositionRight(1) = m_measuredTransformRight.getPosition()(1);
-            measuredAngleRight = m_measuredTransformRight.getRotation().asRPY()(2);
+        // right foot
+        measuredPositionRight(0) = m_measuredTransformRight.getPosition()(0);
+        measuredPositionRight(1) = m_measuredTransformRight.getPosition()(1);
+        measuredAngleRight = m_measuredTransformRight.getRotation().asRPY()(2);
 
-            correctLeft = m_correctLeft;
-        }
+        correctLeft = m_correctLeft;
+    }
 
-        // clear the old trajectory
-        m_trajectoryGenerator.clearDesiredTrajectory();
+    double planningInitTime = yarp::os::Time::now();
 
-        // add new point
-        if(!m_trajectoryGenerator.addDesiredTrajectoryPoint(endTime, desiredPoint))
-        {
-            // something goes wrong
-            std::lock_guard<std::mutex> guard(m_mutex);
-            m_generatorState = GeneratorState::Configured;
-            yError() << "[TrajectoryGenerator_Thread] Error while setting the new reference.";
-            break;
-        }
+    // clear the old trajectory
+    m_trajectoryGenerator.clearDesiredTrajectory();
 
-        iDynTree::Vector2 measuredPosition;
-        double measuredAngle;
-        measuredPosition = correctLeft ? measuredPositionLeft : measuredPositionRight;
-        measuredAngle = correctLeft ? measuredAngleLeft : measuredAngleRight;
+    // add new point
+    if(!m_trajectoryGenerator.addDesiredTrajectoryPoint(endTime, desiredPoint))
+    {
+        // something goes wrong
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_generatorState = GeneratorState::Configured;
+        yError() << "[computeTrajectory] Error while setting the new reference.";
+        m_conditionVariable.notify_all();
+        return;
+    }
 
-        if(m_trajectoryGenerator.reGenerateDCM(initTime, dT, endTime,
-                                               DCMBoundaryConditionAtMergePointPosition,
-                                               DCMBoundaryConditionAtMergePointVelocity,
-                                               correctLeft, measuredPosition, measuredAngle))
-        {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            m_generatorState = GeneratorState::Returned;
-            continue;
-        }
-        else
-        {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            m_generatorState = GeneratorState::Configured;
-            yError() << "[TrajectoryGenerator_Thread] Failed in computing new trajectory.";
-            continue;
-        }
+    iDynTree::Vector2 measuredPosition;
+    double measuredAngle;
+    measuredPosition = correctLeft ? measuredPositionLeft : measuredPositionRight;
+    measuredAngle = correctLeft ? measuredAngleLeft : measuredAngleRight;
+
+    if(m_trajectoryGenerator.reGenerateDCM(initTime, dT, endTime,
+                                           DCMBoundaryConditionAtMergePointPosition,
+                                           DCMBoundaryConditionAtMergePointVelocity,
+                                           correctLeft, measuredPosition, measuredAngle))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_generatorState = GeneratorState::Returned;
+        m_planningDuration = yarp::os::Time::now() - planningInitTime;
+        m_conditionVariable.notify_all();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_generatorState = GeneratorState::Configured;
+        yError() << "[computeTrajectory] Failed in computing new trajectory.";
+        m_conditionVariable.notify_all();
     }
 }
 
@@ -432,6 +425,7 @@ bool TrajectoryGenerator::updateTrajectories(double initTime, const iDynTree::Ve
     double c_theta = std::cos(theta);
 
     // save the data
+    GeneratorState previousState;
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
@@ -454,10 +448,20 @@ bool TrajectoryGenerator::updateTrajectories(double initTime, const iDynTree::Ve
         else
             m_measuredTransformRight = measured;
 
+        previousState = m_generatorState;
         m_generatorState = GeneratorState::Called;
     }
 
-    m_conditionVariable.notify_one();
+    // the trajectory is evaluated by the thread pool. If the task is rejected the state
+    // held before the call is restored (no new trajectory has been computed)
+    if(!m_threadPool->submit(TaskPriority::High, [this]{computeTrajectory();}))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_generatorState = previousState;
+        m_conditionVariable.notify_all();
+        yError() << "[updateTrajectories] Unable to submit the evaluation of the trajectory.";
+        return false;
+    }
 
     return true;
 }
@@ -585,3 +589,16 @@ bool TrajectoryGenerator::getMergePoints(std::vector<size_t>& mergePoints)
     m_trajectoryGenerator.getMergePoints(mergePoints);
     return true;
 }
+
+bool TrajectoryGenerator::getPlanningDuration(double& planningDuration)
+{
+    if(!isTrajectoryComputed())
+    {
+        yError() << "[getPlanningDuration] No trajectories are available";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    planningDuration = m_planningDuration;
+    return true;
+}
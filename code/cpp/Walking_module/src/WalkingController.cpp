@@ -6,6 +6,10 @@
  * @date 2018
  */
 
+// std
+#include <algorithm>
+#include <cmath>
+
 // yarp
 #include <yarp/os/LogStream.h>
 
@@ -16,14 +20,72 @@
 #include "WalkingController.hpp"
 #include "Utils.hpp"
 
+bool WalkingController::evaluatePreviewGrid(const int& samplesPerStep)
+{
+    if(samplesPerStep < 1)
+    {
+        yError() << "[evaluatePreviewGrid] The number of samples per step has to be a positive integer.";
+        return false;
+    }
+
+    double stepLength = m_dT * samplesPerStep;
+    int horizonSteps = round(m_controllerHorizonSeconds / stepLength);
+    int fineSteps = std::min((int)round(m_fineHorizonSeconds / stepLength), horizonSteps);
+    if(horizonSteps < 1 || fineSteps < 0)
+    {
+        yError() << "[evaluatePreviewGrid] The controller horizon has to be greater than the sampling time.";
+        return false;
+    }
+
+    // the first part of the horizon is sampled with the controller period while the remaining
+    // part uses intervals that are m_coarseSamplingFactor times longer.
+    // The length of each interval is expressed in number of reference samples
+    m_previewSteps.assign(fineSteps, samplesPerStep);
+    int coarseSteps = std::ceil((double)(horizonSteps - fineSteps) / m_coarseSamplingFactor);
+    m_previewSteps.insert(m_previewSteps.end(), coarseSteps, samplesPerStep * m_coarseSamplingFactor);
+
+    m_controllerHorizon = m_previewSteps.size();
+    int firstStep = m_previewSteps.front();
+    m_isPreviewGridUniform = std::all_of(m_previewSteps.begin(), m_previewSteps.end(),
+                                         [firstStep](int step){return step == firstStep;});
+
+    // evaluate the index of the reference sample associated to each node
+    // (the intervals are positive since samplesPerStep and m_coarseSamplingFactor are)
+    m_previewNodes.resize(m_controllerHorizon + 1);
+    m_previewNodes[0] = 0;
+    for(int i = 0; i < m_controllerHorizon; i++)
+        m_previewNodes[i + 1] = m_previewNodes[i] + static_cast<std::size_t>(m_previewSteps[i]);
+
+    m_referenceWindow.resize(m_controllerHorizon + 1);
+
+    return true;
+}
+
 iDynSparseMatrix WalkingController::evaluateThetaMatrix()
 {
     // set the submatrix dimension
     int submatrixDimension = m_inputSize * m_controllerHorizon;
 
     iDynTree::Triplets thetaTriplets;
-    thetaTriplets.addDiagonalMatrix(0, 0, 1, m_inputSize * m_controllerHorizon);
-    thetaTriplets.addDiagonalMatrix(m_inputSize, 0, -1, m_inputSize * (m_controllerHorizon -1));
+    if(m_isPreviewGridUniform)
+    {
+        // (u_i - u_{i-1}) / dT (normalized with respect to the reference sampling time)
+        double weight = 1.0 / m_previewSteps.front();
+        thetaTriplets.addDiagonalMatrix(0, 0, weight, m_inputSize * m_controllerHorizon);
+        thetaTriplets.addDiagonalMatrix(m_inputSize, 0, -weight, m_inputSize * (m_controllerHorizon -1));
+    }
+    else
+    {
+        // (u_i - u_{i-1}) / dT_i (normalized with respect to the reference sampling time)
+        for(int i = 0; i < m_controllerHorizon; i++)
+        {
+            double weight = 1.0 / m_previewSteps[i];
+            thetaTriplets.addDiagonalMatrix(i * m_inputSize, i * m_inputSize, weight, m_inputSize);
+            if(i > 0)
+                thetaTriplets.addDiagonalMatrix(i * m_inputSize, (i - 1) * m_inputSize,
+                                                -weight, m_inputSize);
+        }
+    }
 
     iDynSparseMatrix thetaMatrix(submatrixDimension, submatrixDimension);
     thetaMatrix.setFromConstTriplets(thetaTriplets);
@@ -72,8 +134,8 @@ iDynSparseMatrix WalkingController::evaluateHessianInputSubmatrix(const iDynTree
 
 }
 
-iDynTree::Triplets WalkingController::evaluateEqualConstraintsMatrix(const iDynTree::Triplets& stateDynamicsTriplets,
-                                                                     const iDynTree::Triplets& inputDynamicsTriplets)
+iDynTree::Triplets WalkingController::evaluateEqualConstraintsMatrix(const std::vector<iDynTree::Triplets>& stateDynamicsTriplets,
+                                                                     const std::vector<iDynTree::Triplets>& inputDynamicsTriplets)
 {
     // evaluate submatrices
     iDynTree::Triplets equalConstraintsStateSubmatrixTriplets = evaluateEqualConstraintsStateSubmatrix(stateDynamicsTriplets);
@@ -90,7 +152,7 @@ iDynTree::Triplets WalkingController::evaluateEqualConstraintsMatrix(const iDynT
     return equalConstraintsTriplets;
 }
 
-iDynTree::Triplets WalkingController::evaluateEqualConstraintsStateSubmatrix(const iDynTree::Triplets& stateDynamicsMatrix)
+iDynTree::Triplets WalkingController::evaluateEqualConstraintsStateSubmatrix(const std::vector<iDynTree::Triplets>& stateDynamicsMatrix)
 {
     // evaluate equal constraint state triplets
     // [See here](https://github.com/loc2/element_capture-point-walking/issues/9).
@@ -101,20 +163,20 @@ iDynTree::Triplets WalkingController::evaluateEqualConstraintsStateSubmatrix(con
     for(int i = 0; i < m_controllerHorizon; i++)
         iDynTreeHelper::Triplets::pushTripletsAsSubMatrix(i * m_stateSize + m_stateSize,
                                                           i * m_stateSize,
-                                                          stateDynamicsMatrix,
+                                                          stateDynamicsMatrix[i],
                                                           equalConstraintsStateSubmatrix);
 
     return equalConstraintsStateSubmatrix;
 }
 
-iDynTree::Triplets WalkingController::evaluateEqualConstraintsInputSubmatrix(const iDynTree::Triplets& inputDynamicsMatrix)
+iDynTree::Triplets WalkingController::evaluateEqualConstraintsInputSubmatrix(const std::vector<iDynTree::Triplets>& inputDynamicsMatrix)
 {
     // evaluate equal constraints input triplets
     iDynTree::Triplets equalConstraintsInputSubmatrix;
     for(int i = 0; i < m_controllerHorizon; i++)
         iDynTreeHelper::Triplets::pushTripletsAsSubMatrix(i * m_stateSize + m_stateSize,
                                                           i * m_stateSize,
-                                                          inputDynamicsMatrix,
+                                                          inputDynamicsMatrix[i],
                                                           equalConstraintsInputSubmatrix);
     return equalConstraintsInputSubmatrix;
 }
@@ -175,38 +237,74 @@ bool WalkingController::initializeMatrices(const yarp::os::Searchable& config)
     }
 
     // get sampling time
-    double dT = config.check("sampling_time", yarp::os::Value(0.016)).asDouble();
+    m_dT = config.check("sampling_time", yarp::os::Value(0.016)).asDouble();
 
     // evaluate the controller horizon
-    double controllerHorizonSeconds = config.check("controllerHorizon",
-                                                   yarp::os::Value(2.0)).asDouble();
-    m_controllerHorizon = round(controllerHorizonSeconds / dT);
+    m_controllerHorizonSeconds = config.check("controllerHorizon",
+                                              yarp::os::Value(2.0)).asDouble();
+
+    // get the preview grid parameters. By default the whole horizon is sampled with dT
+    m_fineHorizonSeconds = config.check("controllerFineHorizon",
+                                        yarp::os::Value(m_controllerHorizonSeconds)).asDouble();
+    m_coarseSamplingFactor = config.check("controllerCoarseSamplingFactor",
+                                          yarp::os::Value(1)).asInt();
+    if(m_coarseSamplingFactor < 1)
+    {
+        yError() << "[initialize] The coarse sampling factor has to be a positive integer.";
+        return false;
+    }
+
+    // get the solver settings (osqp_* keys, e.g. generated by the solver autotuner)
+    if(!SolverSettings::parseOsqpSettings(config, m_solverSettings))
+    {
+        yError() << "[initialize] Unable to get the solver settings.";
+        return false;
+    }
 
     // get the state weight matrix
     tempValue = config.find("stateWeightTriplets");
-    iDynTree::Triplets stateWeightMatrix;
-    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, m_stateSize, stateWeightMatrix))
+    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, m_stateSize, m_stateWeightTriplets))
     {
         yError() << "Initialization failed while reading stateWeightTriplets vector.";
         return false;
     }
     // the sparse matrix
     m_stateWeightMatrix.resize(m_stateSize, m_stateSize);
-    m_stateWeightMatrix.setFromConstTriplets(stateWeightMatrix);
+    m_stateWeightMatrix.setFromConstTriplets(m_stateWeightTriplets);
 
     // get the input weight matrix
     tempValue = config.find("inputWeightTriplets");
-    iDynTree::Triplets inputWeightMatrix;
-    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, m_inputSize, inputWeightMatrix))
+    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, m_inputSize, m_inputWeightTriplets))
     {
         yError() << "Initialization failed while reading inputWeightTriplets vector.";
         return false;
     }
 
+    // get model parameters
+    double comHeight;
+    if(!YarpHelper::getDoubleFromSearchable(config, "com_height", comHeight))
+    {
+        yError() << "[initialize] Unable to get the double from searchable.";
+        return false;
+    }
+    double gravityAcceleration = config.check("gravity_acceleration", yarp::os::Value(9.81)).asDouble();
+    m_omega = sqrt(gravityAcceleration / comHeight);
+
+    return evaluateMatrices(1);
+}
+
+bool WalkingController::evaluateMatrices(const int& samplesPerStep)
+{
+    if(!evaluatePreviewGrid(samplesPerStep))
+    {
+        yError() << "[evaluateMatrices] Unable to evaluate the preview grid.";
+        return false;
+    }
+
     // evaluate submatrices
     iDynSparseMatrix thetaMatrix = evaluateThetaMatrix();
-    iDynTree::Triplets inputWeightStackedMatrix = evaluateInputWeightStackedMatrix(inputWeightMatrix);
-    iDynTree::Triplets stateWeightStackedMatrix = evaluateStateWeightStackedMatrix(stateWeightMatrix);
+    iDynTree::Triplets inputWeightStackedMatrix = evaluateInputWeightStackedMatrix(m_inputWeightTriplets);
+    iDynTree::Triplets stateWeightStackedMatrix = evaluateStateWeightStackedMatrix(m_stateWeightTriplets);
     iDynSparseMatrix hessianInputSubmatrix = evaluateHessianInputSubmatrix(inputWeightStackedMatrix,
                                                                            thetaMatrix);
 
@@ -216,21 +314,15 @@ bool WalkingController::initializeMatrices(const yarp::os::Searchable& config)
     // evaluate gradient submatrix
     m_gradientSubmatrix = evaluateGradientSubmatrix(inputWeightStackedMatrix, thetaMatrix);
 
-    // get model parameters
-    double comHeight;
-    if(!YarpHelper::getDoubleFromSearchable(config, "com_height", comHeight))
+    // evaluate dynamics matrix (one for each interval of the preview grid)
+    std::vector<iDynTree::Triplets> stateDynamicsTriplets(m_controllerHorizon);
+    std::vector<iDynTree::Triplets> inputDynamicsTriplets(m_controllerHorizon);
+    for(int i = 0; i < m_controllerHorizon; i++)
     {
-        yError() << "[initialize] Unable to get the double from searchable.";
-        return false;
+        double intervalLength = m_previewSteps[i] * m_dT;
+        stateDynamicsTriplets[i].addDiagonalMatrix(0, 0, exp(m_omega * intervalLength), m_stateSize);
+        inputDynamicsTriplets[i].addDiagonalMatrix(0, 0, 1 - exp(m_omega * intervalLength), m_inputSize);
     }
-    double gravityAcceleration = config.check("gravity_acceleration", yarp::os::Value(9.81)).asDouble();
-    double omega = sqrt(gravityAcceleration / comHeight);
-
-    // evaluate dynamics matrix
-    iDynTree::Triplets stateDynamicsTriplets;
-    iDynTree::Triplets inputDynamicsTriplets;
-    stateDynamicsTriplets.addDiagonalMatrix(0, 0, exp(omega * dT), m_stateSize);
-    inputDynamicsTriplets.addDiagonalMatrix(0, 0, 1 - exp(omega * dT), m_inputSize);
 
     // evaluate equal constraints matrix
     m_equalConstraintsMatrixTriplets = evaluateEqualConstraintsMatrix(stateDynamicsTriplets,
@@ -366,6 +458,7 @@ bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Trans
 
     // the status of the feet is the same of the previous iteration
     // the convexHull is already evaluated: do nothing
+    m_isSolverRebuilt = false;
     if(m_feetStatus == feetStatus)
         return true;
 
@@ -408,6 +501,7 @@ bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Trans
     int numberOfConstraints = m_convexHullComputer.A.rows();
 
     // is it possible to reuse the old solver??
+    m_isSolverRebuilt = true;
     m_currentController = std::make_shared<MPCSolver>(m_stateSize, m_inputSize,
                                                       m_controllerHorizon,
                                                       numberOfConstraints,
@@ -421,6 +515,18 @@ bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Trans
         return false;
     }
 
+    if(!m_currentController->setSolverSettings(m_solverSettings))
+    {
+        yError() << "[setConvexHullConstraint] Unable to set the settings of the solver.";
+        return false;
+    }
+
+    if(m_useCustomAccuracy && !m_currentController->setAccuracy(m_accuracy))
+    {
+        yError() << "[setConvexHullConstraint] Unable to set the accuracy of the solver.";
+        return false;
+    }
+
     if(!m_currentController->setConstraintsMatrix(m_convexHullComputer.A))
     {
         yError() << "[setConvexHullConstraint] Unable to add set constraints Matrix.";
@@ -430,6 +536,30 @@ bool WalkingController::setConvexHullConstraint(const std::deque<iDynTree::Trans
     return true;
 }
 
+bool WalkingController::setSamplingTime(const double& samplingTime)
+{
+    int samplesPerStep = round(samplingTime / m_dT);
+    if(samplesPerStep < 1 || std::abs(samplesPerStep * m_dT - samplingTime) > 1e-6)
+    {
+        yError() << "[setSamplingTime] The sampling time has to be a multiple of "
+                 << m_dT << "seconds.";
+        return false;
+    }
+
+    if(!evaluateMatrices(samplesPerStep))
+    {
+        yError() << "[setSamplingTime] Unable to evaluate the matrices.";
+        return false;
+    }
+
+    // the current solver refers to the old matrices. A new one will be instantiated
+    // by setConvexHullConstraint()
+    m_currentController.reset();
+    m_feetStatus = std::make_pair<bool, bool>(false, false);
+
+    return true;
+}
+
 bool WalkingController::setFeedback(const iDynTree::Vector2& currentState)
 {
     return m_currentController->setBounds(currentState, m_convexHullComputer.b);
@@ -438,7 +568,19 @@ bool WalkingController::setFeedback(const iDynTree::Vector2& currentState)
 bool WalkingController::setReferenceSignal(const std::deque<iDynTree::Vector2>& referenceSignal,
                                            const bool& resetTrajectory)
 {
-    return m_currentController->setGradient(referenceSignal, m_output, resetTrajectory);
+    // the reference signal is used as it is only if the grid has the same sampling time
+    if(m_isPreviewGridUniform && m_previewSteps.front() == 1)
+        return m_currentController->setGradient(referenceSignal, m_output, resetTrajectory);
+
+    // sample the reference signal on the nodes of the preview grid.
+    // If the signal is shorter than the horizon it is assumed to be constant
+    for(int i = 0; i < (m_controllerHorizon + 1); i++)
+        m_referenceWindow[i] = m_previewNodes[i] < referenceSignal.size() ?
+            referenceSignal[m_previewNodes[i]] : referenceSignal.back();
+
+    // the reference moves by one sample per tick while the nodes are more than one sample
+    // apart, so the previous gradient cannot be shifted
+    return m_currentController->setGradient(m_referenceWindow, m_output, true);
 }
 
 bool WalkingController::buildConvexHull(const iDynTree::Transform& leftFootTransform,
@@ -516,6 +658,55 @@ bool WalkingController::solve()
     return true;
 }
 
+bool WalkingController::setAccuracy(const SolverAccuracy& accuracy)
+{
+    m_accuracy = accuracy;
+    m_useCustomAccuracy = true;
+
+    // the accuracy is stored and applied also to the solvers initialized later
+    if(m_currentController == nullptr)
+        return true;
+
+    return m_currentController->setAccuracy(m_accuracy);
+}
+
+SolverStatistics WalkingController::getStatistics()
+{
+    if(m_currentController == nullptr)
+        return SolverStatistics();
+
+    return m_currentController->getStatistics();
+}
+
+bool WalkingController::isSolverRebuilt() const
+{
+    return m_isSolverRebuilt;
+}
+
+bool WalkingController::getProblem(QPProblem& problem)
+{
+    if(m_currentController == nullptr)
+    {
+        yError() << "[getProblem] The solver is not initialized.";
+        return false;
+    }
+
+    m_currentController->getProblem(problem);
+    return true;
+}
+
+bool WalkingController::getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual)
+{
+    if(m_currentController == nullptr)
+    {
+        yError() << "[getCheckpoint] The solver is not initialized.";
+        return false;
+    }
+
+    m_currentController->getCheckpoint(primal, dual);
+    return true;
+}
+
 bool WalkingController::getControllerOutput(iDynTree::Vector2& controllerOutput)
 {
     if(!m_isSolutionEvaluated)
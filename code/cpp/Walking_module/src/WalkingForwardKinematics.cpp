@@ -21,6 +21,7 @@
 
 #include "WalkingForwardKinematics.hpp"
 #include "Utils.hpp"
+#include "BufferViews.hpp"
 
 bool WalkingFK::setRobotModel(const iDynTree::Model& model)
 {
@@ -153,6 +154,7 @@ bool WalkingFK::initialize(const yarp::os::Searchable& config,
     m_comPositionFiltered.resize(3,0);
     m_comPositionFiltered(2) = comHeight;
     m_comVelocityFiltered.resize(3,0);
+    m_comFilterInput.resize(3,0);
 
     m_comPositionFilter = std::make_unique<iCub::ctrl::FirstOrderLowPassFilter>(cutFrequency, samplingTime);
     m_comVelocityFilter = std::make_unique<iCub::ctrl::FirstOrderLowPassFilter>(cutFrequency, samplingTime);
@@ -287,22 +289,12 @@ bool WalkingFK::evaluateCoM()
     m_comPosition = m_kinDyn.getCenterOfMassPosition();
     m_comVelocity = m_kinDyn.getCenterOfMassVelocity();
 
-    yarp::sig::Vector temp;
-    temp.resize(3);
+    // the input of the filters is preallocated
+    BufferViews::view(m_comFilterInput) = iDynTree::toEigen(m_comPosition);
+    m_comPositionFiltered = m_comPositionFilter->filt(m_comFilterInput);
 
-    if(!iDynTree::toYarp(m_comPosition, temp))
-    {
-        yError() << "[evaluateCoM] Unable to convert an iDynTree::Position to a yarp vector";
-        return false;
-    }
-    m_comPositionFiltered = m_comPositionFilter->filt(temp);
-
-    if(!iDynTree::toYarp(m_comVelocity, temp))
-    {
-        yError() << "[evaluateCoM] Unable to convert an iDynTree::Vector to a yarp vector";
-        return false;
-    }
-    m_comVelocityFiltered = m_comVelocityFilter->filt(temp);
+    BufferViews::view(m_comFilterInput) = iDynTree::toEigen(m_comVelocity);
+    m_comVelocityFiltered = m_comVelocityFilter->filt(m_comFilterInput);
 
     m_comEvaluated = true;
 
@@ -361,7 +353,7 @@ bool WalkingFK::getCoMPosition(iDynTree::Position& comPosition)
 
     if(m_useFilters)
     {
-        if(!iDynTree::toiDynTree(m_comPositionFiltered, comPosition))
+        if(!BufferViews::copy(m_comPositionFiltered, iDynTree::toEigen(comPosition)))
         {
             yError() << "[getCoMPosition] Unable to convert a yarp vector to an iDynTree position";
             return false;
@@ -383,7 +375,7 @@ bool WalkingFK::getCoMVelocity(iDynTree::Vector3& comVelocity)
 
     if(m_useFilters)
     {
-        if(!iDynTree::toiDynTree(m_comVelocityFiltered, comVelocity))
+        if(!BufferViews::copy(m_comVelocityFiltered, iDynTree::toEigen(comVelocity)))
         {
             yError() << "[getCoMVelocity] Unable to convert a yarp vector to an iDynTree vector";
             return false;
@@ -452,3 +444,20 @@ bool WalkingFK::getCoMJacobian(iDynTree::MatrixDynSize &jacobian)
 {
     return m_kinDyn.getCenterOfMassJacobian(jacobian);
 }
+
+bool WalkingFK::setSamplingTime(const double& samplingTime)
+{
+    if(m_comPositionFilter == nullptr || m_comVelocityFilter == nullptr)
+    {
+        yError() << "[setSamplingTime] The filters are not initialized.";
+        return false;
+    }
+
+    if(!m_comPositionFilter->setSampleTime(samplingTime)
+       || !m_comVelocityFilter->setSampleTime(samplingTime))
+    {
+        yError() << "[setSamplingTime] Unable to set the sampling time of the CoM filters.";
+        return false;
+    }
+    return true;
+}
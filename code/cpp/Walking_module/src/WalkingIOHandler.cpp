@@ -0,0 +1,398 @@
+/**
+ * @file WalkingIOHandler.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include "ThreadTelemetry.hpp"
+#include "WalkingIOHandler.hpp"
+
+namespace
+{
+    /**
+     * Update mean and maximum of a duration.
+     */
+    void updateDuration(const double& duration, int& counter, double& mean, double& max)
+    {
+        counter++;
+        mean += (duration - mean) / counter;
+        max = std::max(max, duration);
+    }
+
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const int& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addInt(value);
+    }
+
+    void addEntry(const std::string& key, const double& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addDouble(value);
+    }
+
+    /**
+     * Wait until the semaphore is posted or the timeout expires.
+     * @param semaphore the semaphore;
+     * @param timeout maximum waiting time [s].
+     * @return true if the semaphore has been posted, false if the timeout is expired.
+     */
+    bool waitFor(sem_t& semaphore, const double& timeout)
+    {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        double seconds = std::floor(std::max(timeout, 0.0));
+        deadline.tv_sec += static_cast<time_t>(seconds);
+        deadline.tv_nsec += static_cast<long>((std::max(timeout, 0.0) - seconds) * 1e9);
+        if(deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while(sem_timedwait(&semaphore, &deadline) != 0)
+        {
+            if(errno != EINTR)
+                return false;
+        }
+        return true;
+    }
+}
+
+WalkingIOHandler::WalkingIOHandler(const double& prefetchLead, const double& stallThreshold,
+                                   const double& maxWrenchAge)
+    : m_maxWrenchAge(maxWrenchAge),
+      m_prefetchLead(prefetchLead),
+      m_stallThreshold(stallThreshold)
+{
+    sem_init(&m_wakeUp, 0, 0);
+    sem_init(&m_feedbackReady, 0, 0);
+}
+
+WalkingIOHandler::~WalkingIOHandler()
+{
+    stop();
+    sem_destroy(&m_wakeUp);
+    sem_destroy(&m_feedbackReady);
+}
+
+bool WalkingIOHandler::start(yarp::dev::IEncodersTimed* encodersInterface,
+                             yarp::dev::IPositionDirect* positionDirectInterface,
+                             yarp::os::BufferedPort<yarp::sig::Vector>* leftWrenchPort,
+                             yarp::os::BufferedPort<yarp::sig::Vector>* rightWrenchPort,
+                             const int& actuatedDOFs,
+                             const RealTimeSettings& realTimeSettings)
+{
+    if(encodersInterface == nullptr || positionDirectInterface == nullptr
+       || leftWrenchPort == nullptr || rightWrenchPort == nullptr)
+    {
+        yError() << "[start] The interfaces are not ready.";
+        return false;
+    }
+
+    if(isRunning())
+    {
+        yError() << "[start] The I/O thread is already running.";
+        return false;
+    }
+
+    m_encodersInterface = encodersInterface;
+    m_positionDirectInterface = positionDirectInterface;
+    m_leftWrenchPort = leftWrenchPort;
+    m_rightWrenchPort = rightWrenchPort;
+    m_actuatedDOFs = actuatedDOFs;
+    m_realTimeSettings = realTimeSettings;
+
+    // all the buffers are allocated here, the threads only copy the data
+    WalkingFeedbackSnapshot snapshot;
+    snapshot.positionInDegrees.resize(actuatedDOFs, 0.0);
+    snapshot.velocityInDegrees.resize(actuatedDOFs, 0.0);
+    m_feedback.reset(snapshot);
+    m_command.reset(yarp::sig::Vector(actuatedDOFs, 0.0));
+    m_lastLeftWrench.clear();
+    m_lastRightWrench.clear();
+
+    // the age of a missing wrench is measured from the start of the thread
+    m_leftWrenchTime = yarp::os::Time::now();
+    m_rightWrenchTime = m_leftWrenchTime;
+
+    // discard the posts left by a previous run
+    while(sem_trywait(&m_wakeUp) == 0);
+    while(sem_trywait(&m_feedbackReady) == 0);
+
+    m_isFeedbackRequested = false;
+    m_isFeedbackFailed = false;
+    m_isCommandFailed = false;
+    m_isPrefetchScheduled = false;
+    resetStatistics();
+
+    // the I/O thread is started only if the real-time settings are applied
+    std::promise<bool> isStarted;
+    std::future<bool> started = isStarted.get_future();
+    m_isRunning = true;
+    m_thread = std::thread(&WalkingIOHandler::ioThread, this, std::move(isStarted));
+    if(!started.get())
+    {
+        yError() << "[start] Unable to apply the real-time settings to the I/O thread.";
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void WalkingIOHandler::stop()
+{
+    m_isRunning = false;
+    sem_post(&m_wakeUp);
+
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+        m_thread = std::thread();
+    }
+}
+
+bool WalkingIOHandler::isRunning() const
+{
+    return m_isRunning;
+}
+
+WalkingIOHandler::FeedbackStatus WalkingIOHandler::readFeedback(WalkingFeedbackSnapshot& snapshot)
+{
+    if(!m_encodersInterface->getEncoders(snapshot.positionInDegrees.data()))
+        return FeedbackStatus::Failed;
+
+    if(!m_encodersInterface->getEncoderSpeeds(snapshot.velocityInDegrees.data()))
+        return FeedbackStatus::Failed;
+
+    // the wrenches are streamed and the ports are never read in blocking mode, so the thread
+    // can always be stopped. If a new message is not arrived the last one is used until it
+    // becomes older than m_maxWrenchAge
+    double now = yarp::os::Time::now();
+    yarp::sig::Vector* leftWrenchRaw = m_leftWrenchPort->read(false);
+    if(leftWrenchRaw != nullptr)
+    {
+        m_lastLeftWrench = *leftWrenchRaw;
+        m_leftWrenchTime = now;
+    }
+
+    yarp::sig::Vector* rightWrenchRaw = m_rightWrenchPort->read(false);
+    if(rightWrenchRaw != nullptr)
+    {
+        m_lastRightWrench = *rightWrenchRaw;
+        m_rightWrenchTime = now;
+    }
+
+    if(now - m_leftWrenchTime > m_maxWrenchAge || now - m_rightWrenchTime > m_maxWrenchAge)
+    {
+        yError() << "[readFeedback] No wrench received in the last" << m_maxWrenchAge << "seconds.";
+        std::lock_guard<std::mutex> guard(m_statisticsMutex);
+        m_statistics.numberOfStaleWrenches++;
+        return FeedbackStatus::Failed;
+    }
+
+    if(m_lastLeftWrench.size() == 0 || m_lastRightWrench.size() == 0)
+        return FeedbackStatus::Waiting;
+
+    snapshot.leftWrench = m_lastLeftWrench;
+    snapshot.rightWrench = m_lastRightWrench;
+    snapshot.time = now;
+    return FeedbackStatus::Ready;
+}
+
+void WalkingIOHandler::ioThread(std::promise<bool> isStarted)
+{
+    ThreadTelemetry::setCurrentThreadName("io");
+
+    if(m_realTimeSettings.isEnabled() && !m_realTimeSettings.apply())
+    {
+        isStarted.set_value(false);
+        return;
+    }
+    isStarted.set_value(true);
+
+    while(m_isRunning)
+    {
+        // the command is written as soon as it is published
+        if(m_command.update())
+        {
+            double initTime = yarp::os::Time::now();
+            bool ok = m_positionDirectInterface->setPositions(m_command.getReadBuffer().data());
+            double duration = yarp::os::Time::now() - initTime;
+
+            if(!ok)
+                m_isCommandFailed = true;
+
+            std::lock_guard<std::mutex> guard(m_statisticsMutex);
+            updateDuration(duration, m_statistics.numberOfWrites,
+                           m_statistics.meanWriteDuration, m_statistics.maxWriteDuration);
+            if(duration > m_stallThreshold)
+                m_statistics.numberOfStalls++;
+            continue;
+        }
+
+        // the feedback is acquired just before the next tick (or immediately if it is required)
+        double now = yarp::os::Time::now();
+        bool isRequested = m_isFeedbackRequested;
+        bool isPrefetchScheduled = m_isPrefetchScheduled;
+        if(isRequested || (isPrefetchScheduled && now >= m_prefetchTime))
+        {
+            m_isPrefetchScheduled = false;
+
+            FeedbackStatus status = readFeedback(m_feedback.getWriteBuffer());
+            if(status == FeedbackStatus::Ready)
+                m_feedback.publish();
+            else if(status == FeedbackStatus::Failed)
+                m_isFeedbackFailed = true;
+            double duration = yarp::os::Time::now() - now;
+
+            {
+                std::lock_guard<std::mutex> guard(m_statisticsMutex);
+                updateDuration(duration, m_statistics.numberOfReads,
+                               m_statistics.meanReadDuration, m_statistics.maxReadDuration);
+                if(duration > m_stallThreshold)
+                    m_statistics.numberOfStalls++;
+            }
+
+            // the first wrenches are not arrived yet. A requested feedback is acquired again
+            // after a short delay (as the control thread did before the I/O thread), the
+            // request is kept until the feedback is ready or the wrenches are too old
+            if(status == FeedbackStatus::Waiting)
+            {
+                if(m_isFeedbackRequested)
+                    waitFor(m_wakeUp, 0.001);
+                continue;
+            }
+
+            // the request may arrive while the feedback is acquired, in this case it is satisfied too
+            if(m_isFeedbackRequested.exchange(false))
+                sem_post(&m_feedbackReady);
+            continue;
+        }
+
+        // the I/O thread sleeps until the prefetch time or until the control thread posts
+        // a command or a request
+        if(isPrefetchScheduled)
+            waitFor(m_wakeUp, m_prefetchTime - now);
+        else
+            sem_wait(&m_wakeUp);
+    }
+}
+
+bool WalkingIOHandler::getFeedback(const double& tickReleaseTime, const double& period,
+                                   const double& timeout)
+{
+    if(!m_isRunning)
+    {
+        yError() << "[getFeedback] The I/O thread is not running.";
+        return false;
+    }
+
+    // the feedback was not prefetched (or the prefetch failed). A new acquisition is required
+    if(!m_feedback.update())
+    {
+        m_numberOfLateFeedbacks++;
+        m_isFeedbackFailed = false;
+        m_isFeedbackRequested = true;
+        sem_post(&m_wakeUp);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+        while(!m_feedback.update())
+        {
+            double remainingTime = std::chrono::duration<double>(deadline
+                                                                 - std::chrono::steady_clock::now()).count();
+            if(m_isFeedbackFailed || !waitFor(m_feedbackReady, remainingTime))
+            {
+                // the feedback may be published just before the timeout
+                if(m_feedback.update())
+                    break;
+
+                m_isFeedbackRequested = false;
+                yError() << "[getFeedback] Unable to get the feedback.";
+                return false;
+            }
+        }
+    }
+
+    // schedule the acquisition for the next tick. The schedule follows the release time
+    // of the tick, so it does not drift with the time spent by the tick before this call
+    m_prefetchTime = tickReleaseTime + period - m_prefetchLead;
+    m_isPrefetchScheduled = true;
+    sem_post(&m_wakeUp);
+    return true;
+}
+
+const WalkingFeedbackSnapshot& WalkingIOHandler::getFeedbackSnapshot() const
+{
+    return m_feedback.getReadBuffer();
+}
+
+bool WalkingIOHandler::setDirectPositionReferences(const double* positionsInDegrees)
+{
+    if(m_isCommandFailed.exchange(false))
+    {
+        yError() << "[setDirectPositionReferences] Error while setting the desired position.";
+        return false;
+    }
+
+    yarp::sig::Vector& command = m_command.getWriteBuffer();
+    std::copy(positionsInDegrees, positionsInDegrees + m_actuatedDOFs, command.data());
+    m_command.publish();
+    sem_post(&m_wakeUp);
+    return true;
+}
+
+WalkingIOStatistics WalkingIOHandler::getStatistics() const
+{
+    std::unique_lock<std::mutex> guard(m_statisticsMutex);
+    WalkingIOStatistics statistics = m_statistics;
+    guard.unlock();
+
+    statistics.numberOfLateFeedbacks = m_numberOfLateFeedbacks;
+    return statistics;
+}
+
+void WalkingIOHandler::resetStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+    m_statistics = WalkingIOStatistics();
+    m_numberOfLateFeedbacks = 0;
+}
+
+void WalkingIOHandler::toBottle(yarp::os::Bottle& bottle) const
+{
+    // the statistics are copied, so the bottle is filled without holding the mutex
+    WalkingIOStatistics statistics = getStatistics();
+
+    // (io ((reads r) (mean_read_ms m) ... (stale_wrenches w)))
+    yarp::os::Bottle& io = bottle.addList();
+    io.addString("io");
+    yarp::os::Bottle& list = io.addList();
+    addEntry("reads", statistics.numberOfReads, list);
+    addEntry("mean_read_ms", statistics.meanReadDuration * 1e3, list);
+    addEntry("max_read_ms", statistics.maxReadDuration * 1e3, list);
+    addEntry("writes", statistics.numberOfWrites, list);
+    addEntry("mean_write_ms", statistics.meanWriteDuration * 1e3, list);
+    addEntry("max_write_ms", statistics.maxWriteDuration * 1e3, list);
+    addEntry("stalls", statistics.numberOfStalls, list);
+    addEntry("late_feedbacks", statistics.numberOfLateFeedbacks, list);
+    addEntry("stale_wrenches", statistics.numberOfStaleWrenches, list);
+}
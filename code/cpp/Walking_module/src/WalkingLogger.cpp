@@ -9,9 +9,21 @@
 // YARP
 #include <yarp/os/LogStream.h>
 
+#include "ThreadTelemetry.hpp"
 #include "WalkingLogger.hpp"
 #include "Utils.hpp"
 
+WalkingLogger::WalkingLogger()
+{
+    sem_init(&m_samplesReady, 0, 0);
+}
+
+WalkingLogger::~WalkingLogger()
+{
+    stopSender();
+    sem_destroy(&m_samplesReady);
+}
+
 bool WalkingLogger::configure(const yarp::os::Searchable& config, const std::string& name)
 {
     std::string portInput, portOutput;
@@ -34,8 +46,10 @@ bool WalkingLogger::configure(const yarp::os::Searchable& config, const std::str
         yError() << "[configureLogger] Unable to get the string from searchable.";
         return false;
     }
+    // the carrier can be chosen for same-host links (e.g. shmem), the default one is tcp
+    std::string carrier = config.check("dataLogger_carrier", yarp::os::Value("")).asString();
     m_dataPort.open("/" + name + portOutput);
-    if(!yarp::os::Network::connect("/" + name + portOutput,  portInput))
+    if(!yarp::os::Network::connect("/" + name + portOutput,  portInput, carrier))
     {
         yError() << "Unable to connect to port " << "/" + name + portOutput;
         return false;
@@ -52,15 +66,101 @@ bool WalkingLogger::configure(const yarp::os::Searchable& config, const std::str
         yError() << "[configureLogger] Unable to get the string from searchable.";
         return false;
     }
+    carrier = config.check("dataLoggerRpc_carrier", yarp::os::Value("")).asString();
     m_rpcPort.open("/" + name + portOutput);
-    if(!yarp::os::Network::connect("/" + name + portOutput,  portInput))
+    if(!yarp::os::Network::connect("/" + name + portOutput,  portInput, carrier))
     {
         yError() << "Unable to connect to port " << "/" + name + portOutput;
         return false;
     }
+
+    // the queue is allocated here. The sender thread is created by the configuration thread
+    // before the real-time settings are applied, so it keeps the default scheduling
+    int queueSize = config.check("queue_size", yarp::os::Value(100)).asInt();
+    if(queueSize <= 0)
+    {
+        yError() << "[configureLogger] The size of the queue has to be positive.";
+        return false;
+    }
+    m_queue.assign(queueSize, yarp::sig::Vector());
+    m_queueHead = 0;
+    m_queueTail = 0;
+    resetStatistics();
+
+    m_isRunning = true;
+    m_senderThread = std::thread(&WalkingLogger::senderThread, this);
     return true;
 }
 
+void WalkingLogger::senderThread()
+{
+    ThreadTelemetry::setCurrentThreadName("logger");
+
+    while(true)
+    {
+        sem_wait(&m_samplesReady);
+
+        unsigned long head = m_queueHead.load(std::memory_order_relaxed);
+        if(head == m_queueTail.load(std::memory_order_acquire))
+        {
+            // all the samples are sent
+            if(!m_isRunning)
+                break;
+            continue;
+        }
+
+        yarp::sig::Vector& sample = m_dataPort.prepare();
+        sample = m_queue[head % m_queue.size()];
+        m_queueHead.store(head + 1, std::memory_order_release);
+
+        // the write is strict, so the sender waits for the previous sample instead of
+        // replacing it. If the logger is slow the queue is filled and the samples are dropped
+        // by sendData()
+        m_dataPort.write(true);
+    }
+}
+
+void WalkingLogger::stopSender()
+{
+    if(!m_senderThread.joinable())
+        return;
+
+    // the samples are posted before the stop request, so they are sent before the thread exits
+    m_isRunning = false;
+    sem_post(&m_samplesReady);
+    m_senderThread.join();
+    m_senderThread = std::thread();
+}
+
+void WalkingLogger::toBottle(yarp::os::Bottle& bottle) const
+{
+    unsigned long head = m_queueHead.load(std::memory_order_acquire);
+    unsigned long tail = m_queueTail.load(std::memory_order_acquire);
+
+    // (logger ((sent s) (dropped d) (queued q) (max_queued m)))
+    yarp::os::Bottle& logger = bottle.addList();
+    logger.addString("logger");
+    yarp::os::Bottle& list = logger.addList();
+    yarp::os::Bottle& sent = list.addList();
+    sent.addString("sent");
+    sent.addInt(static_cast<int>(head));
+    yarp::os::Bottle& dropped = list.addList();
+    dropped.addString("dropped");
+    dropped.addInt(static_cast<int>(m_droppedSamples.load(std::memory_order_relaxed)));
+    yarp::os::Bottle& queued = list.addList();
+    queued.addString("queued");
+    queued.addInt(static_cast<int>(tail - head));
+    yarp::os::Bottle& maxQueued = list.addList();
+    maxQueued.addString("max_queued");
+    maxQueued.addInt(static_cast<int>(m_maxQueuedSamples.load(std::memory_order_relaxed)));
+}
+
+void WalkingLogger::resetStatistics()
+{
+    m_droppedSamples = 0;
+    m_maxQueuedSamples = 0;
+}
+
 bool WalkingLogger::startRecord(const std::initializer_list<std::string>& strings)
 {
     yarp::os::Bottle cmd, outcome;
@@ -73,17 +173,42 @@ bool WalkingLogger::startRecord(const std::initializer_list<std::string>& string
         yError() << "[startWalking] Unable to store data";
         return false;
     }
+
+    // a new dataset starts from the first sample
+    m_sequenceNumber = 0;
     return true;
 }
 
+void WalkingLogger::setTimestamps(const double& tickTime, const double& acquisitionTime)
+{
+    m_tickTime = tickTime;
+    m_acquisitionTime = acquisitionTime;
+}
+
+void WalkingLogger::setTimestamps(const double& tickTime)
+{
+    setTimestamps(tickTime, tickTime);
+}
+
 void WalkingLogger::quit()
 {
+    // the queued samples are sent before the stream is closed
+    stopSender();
+
     // stop recording
     yarp::os::Bottle cmd, outcome;
     cmd.addString("quit");
     m_rpcPort.write(cmd, outcome);
     if(outcome.get(0).asInt() != 1)
         yInfo() << "[close] Unable to close the stream.";
+    else if(outcome.size() == 6)
+        yInfo() << "[close] Samples produced:" << m_sequenceNumber
+                << "dropped by the sender:" << m_droppedSamples.load()
+                << "received:" << outcome.get(1).asInt()
+                << "dropped:" << outcome.get(2).asInt()
+                << "late:" << outcome.get(3).asInt()
+                << "out of order:" << outcome.get(4).asInt()
+                << "discarded by the logger:" << outcome.get(5).asInt();
 
     // close ports
     m_dataPort.close();
@@ -9,12 +9,19 @@
 // std
 #include <iostream>
 #include <memory>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <limits>
+#include <map>
+#include <functional>
 
 // YARP
 #include <yarp/os/RFModule.h>
 #include <yarp/os/BufferedPort.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
 
 // iDynTree
 #include <iDynTree/Core/VectorFixSize.h>
@@ -25,6 +32,7 @@
 
 #include "WalkingModule.hpp"
 #include "Utils.hpp"
+#include "BufferViews.hpp"
 
 void WalkingModule::propagateTime()
 {
@@ -34,6 +42,9 @@ void WalkingModule::propagateTime()
 
 bool WalkingModule::propagateReferenceSignals()
 {
+    // the memory of the trajectory deques is accounted separately
+    MemoryScope memoryScope(MemorySubsystem::Trajectories);
+
     // check if vector is not initialized
     if(m_leftTrajectory.empty()
        || m_rightTrajectory.empty()
@@ -80,6 +91,10 @@ bool WalkingModule::propagateReferenceSignals()
     m_comHeightVelocity.pop_front();
     m_comHeightVelocity.push_back(m_comHeightVelocity.back());
 
+    // the last sample is repeated, so the stationary part of the trajectory grows
+    if(m_nonStationarySamples > 0)
+        m_nonStationarySamples--;
+
     // at each sampling time the merge points are decreased by one.
     // If the first merge point is equal to 0 it will be dropped.
     // A new trajectory will be merged at the first merge point or if the deque is empty
@@ -95,10 +110,195 @@ bool WalkingModule::propagateReferenceSignals()
     return true;
 }
 
+bool WalkingModule::updateSolversAccuracy()
+{
+    if(!m_accuracySchedule->updatePhase(m_leftInContact, m_rightInContact, isStanding()))
+        return true;
+
+    if(!m_accuracySchedule->isEnabled())
+        return true;
+
+    const SolverAccuracy& accuracy = m_accuracySchedule->getAccuracy();
+    if(m_useMPC)
+    {
+        if(!m_walkingController->setAccuracy(accuracy))
+        {
+            yError() << "[updateSolversAccuracy] Unable to set the accuracy of the MPC solver.";
+            return false;
+        }
+    }
+
+    if(m_useQPIK)
+    {
+        if(!m_QPIKSolver_osqp->setAccuracy(accuracy))
+        {
+            yError() << "[updateSolversAccuracy] Unable to set the accuracy of the QP-IK solver (osqp).";
+            return false;
+        }
+
+        if(!m_QPIKSolver_qpOASES->setAccuracy(accuracy))
+        {
+            yError() << "[updateSolversAccuracy] Unable to set the accuracy of the QP-IK solver (qpOASES).";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WalkingModule::isStanding()
+{
+    // the robot is not going to walk
+    if(m_robotState != WalkingFSM::Stance || m_newTrajectoryRequired)
+        return false;
+
+    // the reference signals have to be constant for the whole trajectory and both the feet
+    // have to be in contact
+    if(m_nonStationarySamples > 0)
+        return false;
+
+    return m_leftInContact.back() && m_rightInContact.back();
+}
+
+void WalkingModule::evaluateNonStationarySamples()
+{
+    // the deques are visited from the end, the first sample that differs from the last
+    // one gives the number of non stationary samples
+    m_nonStationarySamples = 0;
+    for(size_t i = m_DCMPositionDesired.size(); i-- > 0;)
+    {
+        if(m_leftInContact[i] != m_leftInContact.back()
+           || m_rightInContact[i] != m_rightInContact.back()
+           || iDynTree::toEigen(m_DCMPositionDesired[i]) != iDynTree::toEigen(m_DCMPositionDesired.back())
+           || iDynTree::toEigen(m_leftTrajectory[i].getPosition())
+           != iDynTree::toEigen(m_leftTrajectory.back().getPosition())
+           || iDynTree::toEigen(m_rightTrajectory[i].getPosition())
+           != iDynTree::toEigen(m_rightTrajectory.back().getPosition()))
+        {
+            m_nonStationarySamples = i + 1;
+            return;
+        }
+    }
+}
+
+bool WalkingModule::setControlPeriod(const int& rateMultiplier)
+{
+    double period = m_dT * rateMultiplier;
+
+    if(m_useMPC)
+    {
+        if(!m_walkingController->setSamplingTime(period))
+        {
+            yError() << "[setControlPeriod] Unable to set the sampling time of the MPC controller.";
+            return false;
+        }
+    }
+
+    if(!m_walkingZMPController->setSamplingTime(period))
+    {
+        yError() << "[setControlPeriod] Unable to set the sampling time of the ZMP controller.";
+        return false;
+    }
+
+    if(!m_stableDCMModel->setSamplingTime(period))
+    {
+        yError() << "[setControlPeriod] Unable to set the sampling time of the 3D-LIPM.";
+        return false;
+    }
+
+    if(!m_FKSolver->setSamplingTime(period))
+    {
+        yError() << "[setControlPeriod] Unable to set the sampling time of the FK solver.";
+        return false;
+    }
+
+    if(m_useVelocityFilter)
+        m_velocityFilter->setSampleTime(period);
+
+    if(m_useWrenchFilter)
+    {
+        m_leftWrenchFilter->setSampleTime(period);
+        m_rightWrenchFilter->setSampleTime(period);
+    }
+
+    if(m_velocityIntegral != nullptr)
+        m_velocityIntegral->setTs(period);
+
+    m_rateMultiplier = rateMultiplier;
+    return true;
+}
+
+bool WalkingModule::updateControlPeriod()
+{
+    int rateMultiplier = isStanding() ? m_stanceRateMultiplier : 1;
+    if(rateMultiplier == m_rateMultiplier)
+        return true;
+
+    if(!setControlPeriod(rateMultiplier))
+    {
+        yError() << "[updateControlPeriod] Unable to set the control period.";
+        return false;
+    }
+
+    yInfo() << "[updateControlPeriod] The control period is now" << m_dT * m_rateMultiplier
+            << "seconds.";
+    return true;
+}
+
+bool WalkingModule::isInSteadyState(const iDynTree::Vector2& measuredDCM,
+                                    const iDynTree::Vector2& measuredZMP,
+                                    const bool& resetTrajectory)
+{
+    if(!m_useSteadyStateFastPath || !m_isSteadyStateSnapshotValid)
+        return false;
+
+    // the fast path is used only when the robot is not going to walk
+    if(resetTrajectory || !isStanding())
+        return false;
+
+    // a full solve is performed at least every m_steadyStateMaxSkippedTicks ticks
+    if(m_steadyStateSkippedTicks >= m_steadyStateMaxSkippedTicks)
+        return false;
+
+    if(iDynTree::toEigen(m_DCMPositionDesired.front()) != iDynTree::toEigen(m_steadyStateDesiredDCM))
+        return false;
+
+    // the measured quantities have to be close to the ones of the last full solve
+    if((iDynTree::toEigen(measuredDCM) - iDynTree::toEigen(m_steadyStateMeasuredDCM)).norm()
+       > m_steadyStateDCMTolerance)
+        return false;
+
+    if((iDynTree::toEigen(measuredZMP) - iDynTree::toEigen(m_steadyStateMeasuredZMP)).norm()
+       > m_steadyStateZMPTolerance)
+        return false;
+
+    return true;
+}
+
+void WalkingModule::updateSteadyStateSnapshot(const iDynTree::Vector2& measuredDCM,
+                                              const iDynTree::Vector2& measuredZMP,
+                                              const iDynTree::Vector2& desiredZMP,
+                                              const bool& isSteadyState)
+{
+    // the skipped ticks are counted in m_dT units so that the refresh period
+    // does not depend on the current control period
+    if(isSteadyState)
+    {
+        m_steadyStateSkippedTicks += m_rateMultiplier;
+        return;
+    }
+
+    m_steadyStateMeasuredDCM = measuredDCM;
+    m_steadyStateMeasuredZMP = measuredZMP;
+    m_steadyStateDesiredDCM = m_DCMPositionDesired.front();
+    m_steadyStateDesiredZMP = desiredZMP;
+    m_steadyStateSkippedTicks = 0;
+    m_isSteadyStateSnapshotValid = true;
+}
+
 double WalkingModule::getPeriod()
 {
     //  period of the module (seconds)
-    return m_dT;
+    return m_dT * m_rateMultiplier;
 }
 
 bool WalkingModule::setControlledJoints(const yarp::os::Searchable& rf)
@@ -241,6 +441,7 @@ bool WalkingModule::configureRobot(const yarp::os::Searchable& rf)
     m_dqDesired_osqp.resize(m_actuatedDOFs);
     m_dqDesired_qpOASES.resize(m_actuatedDOFs);
     m_toDegBuffer.resize(m_actuatedDOFs);
+    m_dqDesiredYarp.resize(m_actuatedDOFs, 0.0);
     m_minJointsLimit.resize(m_actuatedDOFs);
     m_maxJointsLimit.resize(m_actuatedDOFs);
 
@@ -326,7 +527,7 @@ bool WalkingModule::configureRobot(const yarp::os::Searchable& rf)
 
 bool WalkingModule::configureForceTorqueSensors(const yarp::os::Searchable& config)
 {
-    std::string portInput, portOutput;
+    std::string portInput, portOutput, carrier;
 
     // check if the config file is empty
     if(config.isNull())
@@ -348,8 +549,9 @@ bool WalkingModule::configureForceTorqueSensors(const yarp::os::Searchable& conf
     }
     // open port
     m_leftWrenchPort.open("/" + getName() + portInput);
-    // connect port
-    if(!yarp::os::Network::connect(portOutput, "/" + getName() + portInput))
+    // connect port (the carrier can be chosen for same-host links, the default one is tcp)
+    carrier = config.check("leftFootWrench_carrier", yarp::os::Value("")).asString();
+    if(!yarp::os::Network::connect(portOutput, "/" + getName() + portInput, carrier))
     {
         yError() << "Unable to connect to port " << "/" + getName() + portInput;
         return false;
@@ -368,8 +570,9 @@ bool WalkingModule::configureForceTorqueSensors(const yarp::os::Searchable& conf
     }
     // open port
     m_rightWrenchPort.open("/" + getName() + portInput);
-    // connect port
-    if(!yarp::os::Network::connect(portOutput, "/" + getName() + portInput))
+    // connect port (the carrier can be chosen for same-host links, the default one is tcp)
+    carrier = config.check("rightFootWrench_carrier", yarp::os::Value("")).asString();
+    if(!yarp::os::Network::connect(portOutput, "/" + getName() + portInput, carrier))
     {
         yError() << "Unable to connect to port " << "/" + getName() + portInput;
         return false;
@@ -393,6 +596,21 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     m_useQPIK = rf.check("use_QP-IK", yarp::os::Value(false)).asBool();
     m_useOSQP = rf.check("use_osqp", yarp::os::Value(false)).asBool();
     m_dumpData = rf.check("dump_data", yarp::os::Value(false)).asBool();
+    m_recordQPProblems = rf.check("record_qp_problems", yarp::os::Value(false)).asBool();
+    m_useIOThread = rf.check("use_io_thread", yarp::os::Value(false)).asBool();
+
+    // the DCM controller can be chosen also in the stage graph group
+    yarp::os::Bottle& stageGraphOptions = rf.findGroup("STAGE_GRAPH");
+    if(stageGraphOptions.check("dcm_control"))
+    {
+        std::string dcmControl = stageGraphOptions.find("dcm_control").asString();
+        if(dcmControl != "mpc" && dcmControl != "reactive")
+        {
+            yError() << "[configure] The dcm_control stage has to be mpc or reactive.";
+            return false;
+        }
+        m_useMPC = dcmControl == "mpc";
+    }
 
     if(!setControlledJoints(rf))
     {
@@ -415,6 +633,23 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     yarp::os::Bottle& generalOptions = rf.findGroup("GENERAL");
     m_dT = generalOptions.check("sampling_time", yarp::os::Value(0.016)).asDouble();
 
+    // the period of the module can be increased while the robot is standing
+    double stanceSamplingTime = generalOptions.check("stance_sampling_time", yarp::os::Value(m_dT)).asDouble();
+    m_stanceRateMultiplier = round(stanceSamplingTime / m_dT);
+    if(m_stanceRateMultiplier < 1)
+    {
+        yError() << "[configure] The stance sampling time has to be greater than the sampling time.";
+        return false;
+    }
+    m_rateMultiplier = 1;
+
+    // steady state fast path
+    m_useSteadyStateFastPath = rf.check("use_steady_state_fast_path", yarp::os::Value(false)).asBool();
+    m_steadyStateDCMTolerance = rf.check("steady_state_dcm_tolerance", yarp::os::Value(0.002)).asDouble();
+    m_steadyStateZMPTolerance = rf.check("steady_state_zmp_tolerance", yarp::os::Value(0.005)).asDouble();
+    double steadyStateRefreshPeriod = rf.check("steady_state_refresh_period", yarp::os::Value(0.1)).asDouble();
+    m_steadyStateMaxSkippedTicks = round(steadyStateRefreshPeriod / m_dT);
+
     yarp::os::Bottle& forceTorqueSensorsOptions = rf.findGroup("FT_SENSORS");
     if(!configureForceTorqueSensors(forceTorqueSensorsOptions))
     {
@@ -422,6 +657,9 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
+    // the statistics are available through the rpc port
+    m_statistics = std::make_unique<WalkingStatistics>();
+
     // open RPC port for external command
     std::string rpcPortName = "/" + getName() + "/rpc";
     this->yarp().attachAsServer(this->m_rpcPort);
@@ -431,19 +669,53 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
         return false;
     }
 
-    // initialize the trajectory planner
-    m_trajectoryGenerator = std::make_unique<TrajectoryGenerator>();
-    yarp::os::Bottle& trajectoryPlannerOptions = rf.findGroup("TRAJECTORY_PLANNER");
-    trajectoryPlannerOptions.append(generalOptions);
-    if(!m_trajectoryGenerator->initialize(trajectoryPlannerOptions))
+    // open the port used to stream the goal (e.g. by the joypad)
+    m_goalTimeout = rf.check("goal_timeout", yarp::os::Value(0.0)).asDouble();
+    m_goalSequenceNumber = std::numeric_limits<unsigned long>::max();
+    m_pendingGoal.resize(4);
+    m_isGoalPending = false;
+    if(!m_goalPort.open("/" + getName() + "/goal:i"))
+    {
+        yError() << "[configure] Unable to open the goal port.";
+        return false;
+    }
+
+    // the background work of the module (planner, PID switches, metrics and flight recorder
+    // dumps) is run by the thread pool. The workers are started before the real-time
+    // settings are applied, so they do not inherit the settings of the control thread
+    m_threadPool = std::make_unique<WalkingThreadPool>();
+    yarp::os::Bottle& threadPoolOptions = rf.findGroup("THREAD_POOL");
+    if(!m_threadPool->initialize(threadPoolOptions))
+    {
+        yError() << "[configure] Unable to initialize the thread pool.";
+        return false;
+    }
+
+    // the counters of the threads are read by a task of the pool
+    m_threadTelemetry = std::make_unique<ThreadTelemetry>();
+    if(!m_threadTelemetry->initialize(rf, *m_threadPool))
     {
-        yError() << "[configure] Unable to initialize the planner.";
+        yError() << "[configure] Unable to configure the thread telemetry.";
         return false;
     }
 
+    // initialize the trajectory planner
+    {
+        MemoryScope memoryScope(MemorySubsystem::Planner);
+        m_trajectoryGenerator = std::make_unique<TrajectoryGenerator>();
+        yarp::os::Bottle& trajectoryPlannerOptions = rf.findGroup("TRAJECTORY_PLANNER");
+        trajectoryPlannerOptions.append(generalOptions);
+        if(!m_trajectoryGenerator->initialize(trajectoryPlannerOptions, *m_threadPool))
+        {
+            yError() << "[configure] Unable to initialize the planner.";
+            return false;
+        }
+    }
+
     if(m_useMPC)
     {
         // initialize the MPC controller
+        MemoryScope memoryScope(MemorySubsystem::MPC);
         m_walkingController = std::make_unique<WalkingController>();
         yarp::os::Bottle& dcmControllerOptions = rf.findGroup("DCM_MPC_CONTROLLER");
         dcmControllerOptions.append(generalOptions);
@@ -477,16 +749,20 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     }
 
     // initialize the inverse kinematics solver
-    m_IKSolver = std::make_unique<WalkingIK>();
-    yarp::os::Bottle& inverseKinematicsSolverOptions = rf.findGroup("INVERSE_KINEMATICS_SOLVER");
-    if(!m_IKSolver->initialize(inverseKinematicsSolverOptions, m_loader.model(), m_axesList))
     {
-        yError() << "[configure] Failed to configure the ik solver";
-        return false;
+        MemoryScope memoryScope(MemorySubsystem::IK);
+        m_IKSolver = std::make_unique<WalkingIK>();
+        yarp::os::Bottle& inverseKinematicsSolverOptions = rf.findGroup("INVERSE_KINEMATICS_SOLVER");
+        if(!m_IKSolver->initialize(inverseKinematicsSolverOptions, m_loader.model(), m_axesList))
+        {
+            yError() << "[configure] Failed to configure the ik solver";
+            return false;
+        }
     }
 
     if(m_useQPIK)
     {
+        MemoryScope memoryScope(MemorySubsystem::IK);
         yarp::os::Bottle& inverseKinematicsQPSolverOptions = rf.findGroup("INVERSE_KINEMATICS_QP_SOLVER");
 
         m_QPIKSolver_osqp = std::make_unique<WalkingQPIK_osqp>();
@@ -508,16 +784,28 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
         }
     }
 
-    // initialize the forward kinematics solver
-    m_FKSolver = std::make_unique<WalkingFK>();
-    yarp::os::Bottle& forwardKinematicsSolverOptions = rf.findGroup("FORWARD_KINEMATICS_SOLVER");
-    forwardKinematicsSolverOptions.append(generalOptions);
-    if(!m_FKSolver->initialize(forwardKinematicsSolverOptions, m_loader.model()))
+    // initialize the accuracy schedule of the QP solvers
+    m_accuracySchedule = std::make_unique<SolverAccuracySchedule>();
+    yarp::os::Bottle& accuracyScheduleOptions = rf.findGroup("SOLVER_ACCURACY_SCHEDULE");
+    if(!m_accuracySchedule->initialize(accuracyScheduleOptions, m_dT))
     {
-        yError() << "[configure] Failed to configure the fk solver";
+        yError() << "[configure] Failed to configure the accuracy schedule of the solvers.";
         return false;
     }
 
+    // initialize the forward kinematics solver
+    {
+        MemoryScope memoryScope(MemorySubsystem::FK);
+        m_FKSolver = std::make_unique<WalkingFK>();
+        yarp::os::Bottle& forwardKinematicsSolverOptions = rf.findGroup("FORWARD_KINEMATICS_SOLVER");
+        forwardKinematicsSolverOptions.append(generalOptions);
+        if(!m_FKSolver->initialize(forwardKinematicsSolverOptions, m_loader.model()))
+        {
+            yError() << "[configure] Failed to configure the fk solver";
+            return false;
+        }
+    }
+
     // initialize the linear inverted pendulum model
     m_stableDCMModel = std::make_unique<StableDCMModel>();
     if(!m_stableDCMModel->initialize(generalOptions))
@@ -529,7 +817,7 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     // set PIDs gains
     m_PIDHandler = std::make_unique<WalkingPIDHandler>();
     yarp::os::Bottle& pidOptions = rf.findGroup("PID");
-    if (!m_PIDHandler->initialize(pidOptions, m_robotDevice, m_remoteControlBoards))
+    if (!m_PIDHandler->initialize(pidOptions, m_robotDevice, m_remoteControlBoards, *m_threadPool))
     {
         yError() << "[configure] Failed to configure the PIDs.";
         return false;
@@ -547,6 +835,113 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
         }
     }
 
+    // initialize the I/O thread. It is started when the robot starts walking
+    if(m_useIOThread)
+    {
+        double prefetchLead = rf.check("io_prefetch_lead", yarp::os::Value(0.002)).asDouble();
+        double stallThreshold = rf.check("io_stall_threshold", yarp::os::Value(0.005)).asDouble();
+
+        // the feedback fails (and the walk is stopped) if a foot wrench is not refreshed
+        // for io_max_wrench_age seconds, the control thread waited for 100 attempts of 1 ms
+        double maxWrenchAge = rf.check("io_max_wrench_age", yarp::os::Value(0.1)).asDouble();
+        m_IOHandler = std::make_unique<WalkingIOHandler>(prefetchLead, stallThreshold, maxWrenchAge);
+    }
+
+    // initialize the metrics port
+    m_publishMetrics = rf.check("publish_metrics", yarp::os::Value(false)).asBool();
+    if(m_publishMetrics)
+    {
+        m_metricsPeriod = rf.check("metrics_period", yarp::os::Value(1.0)).asDouble();
+        if(!m_metricsPort.open("/" + getName() + "/metrics:o"))
+        {
+            yError() << "[configure] Unable to open the metrics port.";
+            return false;
+        }
+    }
+
+    // initialize the state publisher
+    if(rf.check("publish_state", yarp::os::Value(false)).asBool())
+    {
+        m_statePublisher = std::make_unique<WalkingStatePublisher>();
+        yarp::os::Bottle& statePublisherOptions = rf.findGroup("STATE_PUBLISHER");
+        if(!m_statePublisher->initialize(statePublisherOptions, "/" + getName()))
+        {
+            yError() << "[configure] Unable to initialize the state publisher.";
+            return false;
+        }
+    }
+
+    // initialize the flight recorder
+    if(rf.check("use_flight_recorder", yarp::os::Value(false)).asBool())
+    {
+        yarp::os::Bottle& flightRecorderOptions = rf.findGroup("FLIGHT_RECORDER");
+        m_watchdogTickDuration = flightRecorderOptions.check("watchdog_tick_duration",
+                                                             yarp::os::Value(0.0)).asDouble();
+
+        std::vector<std::string> channels{"time", "feedback_time", "robot_state", "is_steady_state",
+                "dcm_x", "dcm_y", "dcm_des_x", "dcm_des_y",
+                "zmp_x", "zmp_y", "zmp_des_x", "zmp_des_y",
+                "com_x", "com_y", "com_z", "com_des_x", "com_des_y",
+                "lf_x", "lf_y", "lf_z", "lf_roll", "lf_pitch", "lf_yaw",
+                "rf_x", "rf_y", "rf_z", "rf_roll", "rf_pitch", "rf_yaw",
+                "lf_des_x", "lf_des_y", "lf_des_z", "lf_des_roll", "lf_des_pitch", "lf_des_yaw",
+                "rf_des_x", "rf_des_y", "rf_des_z", "rf_des_roll", "rf_des_pitch", "rf_des_yaw",
+                "solver_phase", "mpc_iter", "mpc_pri_res", "mpc_dua_res",
+                "ik_iter", "ik_pri_res", "ik_dua_res", "tick_duration"};
+        for(const auto& joint : m_axesList)
+            channels.push_back(joint);
+        for(const auto& joint : m_axesList)
+            channels.push_back(joint + "_des");
+
+        m_flightRecorder = std::make_unique<FlightRecorder>();
+        if(!m_flightRecorder->initialize(flightRecorderOptions, m_dT,
+                                         getName() + "_flight_recorder", channels, *m_threadPool))
+        {
+            yError() << "[configure] Unable to initialize the flight recorder.";
+            return false;
+        }
+    }
+
+    // the residuals of the qpOASES solution are expensive, they are evaluated only if they are
+    // logged or recorded
+    if(m_QPIKSolver_qpOASES)
+        m_QPIKSolver_qpOASES->setResidualRequired(m_dumpData || m_flightRecorder != nullptr);
+
+    // initialize the QP problems recorders
+    if(m_recordQPProblems)
+    {
+        // the checkpoints allow the autotuner to replay the sequence in parallel shards
+        int checkpointPeriod = rf.check("qp_checkpoint_period", yarp::os::Value(500)).asInt();
+
+        std::time_t t = std::time(nullptr);
+        std::tm tm = *std::localtime(&t);
+
+        std::stringstream suffix;
+        suffix << "_" << std::put_time(&tm, "%Y_%m_%d_%H_%M_%S") << ".qp";
+
+        if(m_useMPC)
+        {
+            m_MPCProblemRecorder = std::make_unique<QPProblemRecorder>();
+            if(!m_MPCProblemRecorder->open(getName() + "_mpc_problems" + suffix.str(), checkpointPeriod))
+            {
+                yError() << "[configure] Unable to open the MPC problems file.";
+                return false;
+            }
+        }
+
+        if(m_useQPIK)
+        {
+            std::string backend = m_useOSQP ? "_osqp" : "_qpOASES";
+            m_IKProblemRecorder = std::make_unique<QPProblemRecorder>();
+            if(!m_IKProblemRecorder->open(getName() + "_ik" + backend + "_problems" + suffix.str(),
+                                          checkpointPeriod))
+            {
+                yError() << "[configure] Unable to open the QP-IK problems file.";
+                return false;
+            }
+        }
+    }
+
     // time profiler
     m_profiler = std::make_unique<TimeProfiler>();
     m_profiler->setPeriod(round(0.1 / m_dT));
@@ -561,6 +956,90 @@ bool WalkingModule::configure(yarp::os::ResourceFinder& rf)
     m_newTrajectoryRequired = false;
     m_newTrajectoryMergeCounter = -1;
     m_robotState = WalkingFSM::Configured;
+    m_steadyStateSkippedTicks = 0;
+    m_isSteadyStateSnapshotValid = false;
+
+    // updateModule() runs in the thread that configures the module. The settings are applied
+    // at the end, so the pool workers created before keep the default scheduling. The I/O
+    // thread is started by the RPC thread, so it applies the settings explicitly
+    if(!m_realTimeSettings.initialize(rf))
+    {
+        yError() << "[configure] Unable to read the real-time settings.";
+        return false;
+    }
+
+    if(m_realTimeSettings.isEnabled() && !m_realTimeSettings.apply())
+    {
+        yError() << "[configure] Unable to apply the real-time settings.";
+        return false;
+    }
+
+    // the workers of the stage graph are part of the control tick and they are created after
+    // apply(): they inherit the priority and they are pinned to the CPUs of the control thread
+    if(!configureStageGraph(stageGraphOptions))
+    {
+        yError() << "[configure] Unable to configure the stage graph.";
+        return false;
+    }
+
+    return true;
+}
+
+bool WalkingModule::configureStageGraph(const yarp::os::Searchable& config)
+{
+    m_stageGraph = std::make_unique<WalkingStageGraph>();
+
+    // the DCM controller stage is chosen among the available implementations
+    std::map<std::string, std::function<bool()>> dcmControlStages;
+    dcmControlStages["mpc"] = [this]{return runMPCStage();};
+    dcmControlStages["reactive"] = [this]{return runDCMReactiveStage();};
+
+    // the stages are added after their dependencies. The reference model does not depend on
+    // the feedback, so the two stages can run concurrently. The data read and written by each
+    // stage are used to check that the concurrent stages do not race
+    if(!m_stageGraph->addStage("trajectory", {}, [this]{return runTrajectoryStage();},
+                               {}, {"trajectories", "tick_statistics"})
+       || !m_stageGraph->addStage("feedback", {"trajectory"}, [this]{return runFeedbackStage();},
+                                  {}, {"joint_feedback", "wrenches"})
+       || !m_stageGraph->addStage("reference", {"trajectory"}, [this]{return runReferenceStage();},
+                                  {"trajectories"}, {"lipm_model", "desired_com"})
+       || !m_stageGraph->addStage("forward_kinematics", {"feedback"},
+                                  [this]{return runForwardKinematicsStage();},
+                                  {"joint_feedback", "trajectories"}, {"kinematics"})
+       || !m_stageGraph->addStage("estimation", {"forward_kinematics"},
+                                  [this]{return runEstimationStage();},
+                                  {"kinematics", "wrenches"}, {"measured_state", "tick_statistics"})
+       || !m_stageGraph->addStage("solvers", {"estimation"}, [this]{return runSolversStage();},
+                                  {"measured_state", "trajectories"}, {"solver_settings"})
+       || !m_stageGraph->addStage("dcm_control", {"solvers"},
+                                  dcmControlStages[m_useMPC ? "mpc" : "reactive"],
+                                  {"measured_state", "trajectories", "solver_settings"},
+                                  {"desired_zmp", "tick_statistics"})
+       || !m_stageGraph->addStage("zmp_control", {"dcm_control", "reference"},
+                                  [this]{return runZMPControlStage();},
+                                  {"measured_state", "desired_zmp", "desired_com"}, {"com_control"})
+       || !m_stageGraph->addStage("inverse_kinematics", {"zmp_control"},
+                                  [this]{return runInverseKinematicsStage();},
+                                  {"com_control", "trajectories", "kinematics", "solver_settings"},
+                                  {"joint_reference", "tick_statistics"})
+       || !m_stageGraph->addStage("command", {"inverse_kinematics"}, [this]{return runCommandStage();},
+                                  {"joint_reference"}, {})
+       || !m_stageGraph->addStage("telemetry", {"command"}, [this]{return runTelemetryStage();},
+                                  {"measured_state", "desired_zmp", "joint_reference", "tick_statistics"}, {})
+       || !m_stageGraph->addStage("propagation", {"telemetry"}, [this]{return runPropagationStage();},
+                                  {}, {"trajectories"}))
+    {
+        yError() << "[configureStageGraph] Unable to add the stages.";
+        return false;
+    }
+
+    // by default all the stages are run by the control thread
+    int workers = config.check("workers", yarp::os::Value(0)).asInt();
+    if(!m_stageGraph->initialize(workers))
+    {
+        yError() << "[configureStageGraph] Unable to initialize the stage graph.";
+        return false;
+    }
 
     return true;
 }
@@ -577,6 +1056,42 @@ bool WalkingModule::close()
     if(m_dumpData)
         m_walkingLogger->quit();
 
+    if(m_IOHandler)
+    {
+        m_IOHandler->stop();
+        WalkingIOStatistics statistics = m_IOHandler->getStatistics();
+        yInfo() << "[close] I/O thread. Read [ms] mean:" << statistics.meanReadDuration * 1e3
+                << "max:" << statistics.maxReadDuration * 1e3
+                << "Write [ms] mean:" << statistics.meanWriteDuration * 1e3
+                << "max:" << statistics.maxWriteDuration * 1e3
+                << "stalls:" << statistics.numberOfStalls
+                << "late feedbacks:" << statistics.numberOfLateFeedbacks
+                << "stale wrenches:" << statistics.numberOfStaleWrenches;
+    }
+
+    // the queued background tasks (e.g. a pending dump or PID switch) are completed
+    if(m_threadPool)
+        m_threadPool->close();
+
+    if(m_statePublisher)
+        m_statePublisher->close();
+
+    // a pending dump is completed
+    if(m_flightRecorder)
+        m_flightRecorder->close();
+
+    if(m_publishMetrics)
+        m_metricsPort.close();
+
+    if(m_MPCProblemRecorder)
+        m_MPCProblemRecorder->close();
+
+    if(m_IKProblemRecorder)
+        m_IKProblemRecorder->close();
+
+    if(m_stageGraph)
+        m_stageGraph->close();
+
     // restore PID
     m_PIDHandler->restorePIDs();
 
@@ -601,6 +1116,7 @@ bool WalkingModule::close()
 
     // close the ports
     m_rpcPort.close();
+    m_goalPort.close();
     m_rightWrenchPort.close();
     m_leftWrenchPort.close();
 
@@ -613,6 +1129,8 @@ bool WalkingModule::solveQPIK(auto& solver, const iDynTree::Position& desiredCoM
                               const iDynTree::Rotation& desiredNeckOrientation,
                               iDynTree::VectorDynSize &output)
 {
+    MemoryScope memoryScope(MemorySubsystem::IK);
+
     if(!solver->setRobotState(m_positionFeedbackInRadians,
                               m_FKSolver->getLeftFootToWorldTransform(),
                               m_FKSolver->getRightFootToWorldTransform(),
@@ -646,8 +1164,12 @@ bool WalkingModule::solveQPIK(auto& solver, const iDynTree::Position& desiredCoM
     m_FKSolver->getRightFootJacobian(jacobian);
     solver->setRightFootJacobian(jacobian);
 
-    m_FKSolver->getNeckJacobian(jacobian);
-    solver->setNeckJacobian(jacobian);
+    // the neck Jacobian is evaluated only if the neck task is in the QP-IK problem
+    if(solver->getTaskSet().isNeckEnabled())
+    {
+        m_FKSolver->getNeckJacobian(jacobian);
+        solver->setNeckJacobian(jacobian);
+    }
 
     m_FKSolver->getCoMJacobian(comJacobian);
     solver->setCoMJacobian(comJacobian);
@@ -669,426 +1191,722 @@ bool WalkingModule::solveQPIK(auto& solver, const iDynTree::Position& desiredCoM
 
 bool WalkingModule::updateModule()
 {
+    // the release time is taken before waiting for the mutex (it is used to schedule the I/O)
+    m_tickReleaseTime = yarp::os::Time::now();
+
     std::lock_guard<std::mutex> guard(m_mutex);
 
-    if(m_robotState == WalkingFSM::Walking
-       || m_robotState == WalkingFSM::Stance
-       || m_robotState == WalkingFSM::OnTheFly)
+    // the streamed goals are applied at the beginning of the tick
+    readGoal();
+
+    if(!updateController())
+    {
+        // save the ticks that preceded the fault
+        if(m_flightRecorder)
+            m_flightRecorder->trigger(DumpReason::Fault);
+        return false;
+    }
+    return true;
+}
+
+void WalkingModule::readGoal()
+{
+    // the port is not strict, only the last goal is read. A new goal replaces the pending one
+    yarp::sig::Vector* goal = m_goalPort.read(false);
+    if(goal != nullptr)
     {
-        iDynTree::Vector2 measuredDCM, measuredZMP;
-        iDynTree::Position measuredCoM;
-        iDynTree::Vector3 measuredCoMVelocity;
+        if(goal->size() != 4)
+            yError() << "[readGoal] The goal has to contain sequence number, timestamp, x and y.";
+        else if(static_cast<unsigned long>((*goal)(0)) != m_goalSequenceNumber)
+        {
+            m_goalSequenceNumber = static_cast<unsigned long>((*goal)(0));
+            for(int i = 0; i < 4; i++)
+                m_pendingGoal(i) = (*goal)(i);
+            m_isGoalPending = true;
+        }
+    }
 
-        bool resetTrajectory = false;
+    if(!m_isGoalPending)
+        return;
 
-        m_profiler->setInitTime("Total");
+    if(m_goalTimeout > 0 && yarp::os::Time::now() - m_pendingGoal(1) > m_goalTimeout)
+    {
+        yWarning() << "[readGoal] The goal" << m_goalSequenceNumber << "is too old, it is discarded.";
+        m_isGoalPending = false;
+        return;
+    }
 
-        // if a new trajectory is required check if its the time to evaluate the new trajectory or
-        // the time to attach new one
-        if(m_newTrajectoryRequired)
-        {
-            // when we are near to the merge point the new trajectory is evaluated
-            if(m_newTrajectoryMergeCounter == 20)
-            {
+    // the goals are streamed also when the robot is not walking, they are discarded
+    // (the joypad sends the last goal again every keep_alive_period)
+    if(m_robotState != WalkingFSM::Walking && m_robotState != WalkingFSM::Stance)
+    {
+        m_isGoalPending = false;
+        return;
+    }
 
-                double initTimeTrajectory;
-                initTimeTrajectory = m_time + m_newTrajectoryMergeCounter * m_dT;
+    // a goal rejected by the controller (e.g. because the robot is not in double support
+    // at the end of the trajectory) is applied again at the next tick
+    if(applyGoal(m_pendingGoal(2), m_pendingGoal(3)))
+        m_isGoalPending = false;
+}
 
-                iDynTree::Transform measuredTransform = m_isLeftFixedFrame.front() ?
-                    m_rightTrajectory[m_newTrajectoryMergeCounter] :
-                    m_leftTrajectory[m_newTrajectoryMergeCounter];
+bool WalkingModule::runTrajectoryStage()
+{
+    // the full rate is restored before a new trajectory is merged
+    if(!updateControlPeriod())
+    {
+        yError() << "[runTrajectoryStage] Unable to update the control period.";
+        return false;
+    }
 
-                // ask for a new trajectory
-                if(!askNewTrajectories(initTimeTrajectory, !m_isLeftFixedFrame.front(),
-                                       measuredTransform, m_newTrajectoryMergeCounter,
-                                       m_desiredPosition))
-                {
-                    yError() << "[updateModule] Unable to ask for a new trajectory.";
-                    return false;
-                }
-            }
+    // if a new trajectory is required check if its the time to evaluate the new trajectory or
+    // the time to attach new one
+    if(m_newTrajectoryRequired)
+    {
+        // when we are near to the merge point the new trajectory is evaluated
+        if(m_newTrajectoryMergeCounter == 20)
+        {
+
+            double initTimeTrajectory;
+            initTimeTrajectory = m_time + m_newTrajectoryMergeCounter * m_dT;
 
-            if(m_newTrajectoryMergeCounter == 2)
+            iDynTree::Transform measuredTransform = m_isLeftFixedFrame.front() ?
+                m_rightTrajectory[m_newTrajectoryMergeCounter] :
+                m_leftTrajectory[m_newTrajectoryMergeCounter];
+
+            // ask for a new trajectory
+            if(!askNewTrajectories(initTimeTrajectory, !m_isLeftFixedFrame.front(),
+                                   measuredTransform, m_newTrajectoryMergeCounter,
+                                   m_desiredPosition))
             {
-                if(!updateTrajectories(m_newTrajectoryMergeCounter))
-                {
-                    yError() << "[updateModule] Error while updating trajectories. They were not computed yet.";
-                    return false;
-                }
-                m_newTrajectoryRequired = false;
-                resetTrajectory = true;
+                yError() << "[runTrajectoryStage] Unable to ask for a new trajectory.";
+                return false;
             }
-
-            m_newTrajectoryMergeCounter--;
+            m_tickData.statistics.events |= WalkingEvent::PlannerRequest;
         }
 
-        if (m_PIDHandler->usingGainScheduling())
+        if(m_newTrajectoryMergeCounter == 2)
         {
-            if (!m_PIDHandler->updatePhases(m_leftInContact, m_rightInContact, m_time))
+            m_tickData.statistics.isMerged = true;
+            m_tickData.statistics.events |= WalkingEvent::Merge;
+            m_trajectoryGenerator->getPlanningDuration(m_tickData.statistics.plannerDuration);
+
+            if(!updateTrajectories(m_newTrajectoryMergeCounter))
             {
-                yError() << "[updateModule] Unable to get the update PID.";
+                yError() << "[runTrajectoryStage] Error while updating trajectories. They were not computed yet.";
                 return false;
             }
+            m_newTrajectoryRequired = false;
+            m_tickData.resetTrajectory = true;
         }
 
-        // get feedbacks and evaluate useful quantities
-        if(!getFeedbacks(100))
-        {
-            yError() << "[updateModule] Unable to get the feedback.";
-            return false;
-        }
+        m_newTrajectoryMergeCounter--;
+    }
 
-        if(!updateFKSolver())
+    if (m_PIDHandler->usingGainScheduling())
+    {
+        if (!m_PIDHandler->updatePhases(m_leftInContact, m_rightInContact, m_time))
         {
-            yError() << "[updateModule] Unable to update the FK solver.";
+            yError() << "[runTrajectoryStage] Unable to get the update PID.";
             return false;
         }
 
-        if(!evaluateCoM(measuredCoM, measuredCoMVelocity))
-        {
-            yError() << "[updateModule] Unable to evaluate the CoM.";
-            return false;
-        }
+        if(m_PIDHandler->isActivationRequested())
+            m_tickData.statistics.events |= WalkingEvent::PIDActivation;
+    }
+
+    return true;
+}
+
+bool WalkingModule::runFeedbackStage()
+{
+    // get feedbacks and evaluate useful quantities
+    if(!getFeedbacks(100))
+    {
+        yError() << "[runFeedbackStage] Unable to get the feedback.";
+        return false;
+    }
+
+    return true;
+}
+
+bool WalkingModule::runForwardKinematicsStage()
+{
+    if(!updateFKSolver())
+    {
+        yError() << "[runForwardKinematicsStage] Unable to update the FK solver.";
+        return false;
+    }
+
+    return true;
+}
 
-        if(!evaluateDCM(measuredDCM))
+bool WalkingModule::runEstimationStage()
+{
+    if(!evaluateCoM(m_tickData.measuredCoM, m_tickData.measuredCoMVelocity))
+    {
+        yError() << "[runEstimationStage] Unable to evaluate the CoM.";
+        return false;
+    }
+
+    if(!evaluateDCM(m_tickData.measuredDCM))
+    {
+        yError() << "[runEstimationStage] Unable to evaluate the DCM.";
+        return false;
+    }
+
+    if(!evaluateZMP(m_tickData.measuredZMP))
+    {
+        yError() << "[runEstimationStage] Unable to evaluate the ZMP.";
+        return false;
+    }
+    m_tickData.statistics.feedbackDuration = yarp::os::Time::now() - m_tickData.initTime;
+
+    return true;
+}
+
+bool WalkingModule::runReferenceStage()
+{
+    // evaluate 3D-LIPM reference signal
+    m_stableDCMModel->setInput(m_DCMPositionDesired.front());
+    if(!m_stableDCMModel->integrateModel())
+    {
+        yError() << "[runReferenceStage] Unable to propagate the 3D-LIPM.";
+        return false;
+    }
+
+    if(!m_stableDCMModel->getCoMPosition(m_tickData.desiredCoMPositionXY))
+    {
+        yError() << "[runReferenceStage] Unable to get the desired CoM position.";
+        return false;
+    }
+
+    if(!m_stableDCMModel->getCoMVelocity(m_tickData.desiredCoMVelocityXY))
+    {
+        yError() << "[runReferenceStage] Unable to get the desired CoM velocity.";
+        return false;
+    }
+
+    return true;
+}
+
+bool WalkingModule::runSolversStage()
+{
+    // if the robot is standing still the previous solutions are reused
+    m_tickData.isSteadyState = isInSteadyState(m_tickData.measuredDCM, m_tickData.measuredZMP,
+                                               m_tickData.resetTrajectory);
+
+    // the accuracy of the solvers depends on the current contact phase
+    if(!updateSolversAccuracy())
+    {
+        yError() << "[runSolversStage] Unable to update the accuracy of the solvers.";
+        return false;
+    }
+
+    return true;
+}
+
+bool WalkingModule::runMPCStage()
+{
+    // Model predictive controller (a new OSQP problem is allocated at each contact switch)
+    MemoryScope memoryScope(MemorySubsystem::MPC);
+    m_profiler->setInitTime("MPC");
+    if(m_tickData.isSteadyState)
+        m_tickData.desiredZMP = m_steadyStateDesiredZMP;
+    else
+    {
+        if(!m_walkingController->setConvexHullConstraint(m_leftTrajectory, m_rightTrajectory,
+                                                         m_leftInContact, m_rightInContact))
         {
-            yError() << "[updateModule] Unable to evaluate the DCM.";
+            yError() << "[runMPCStage] unable to evaluate the convex hull.";
             return false;
         }
 
-        if(!evaluateZMP(measuredZMP))
+        if(m_walkingController->isSolverRebuilt())
+            m_tickData.statistics.events |= WalkingEvent::ContactSwitch;
+
+        if(!m_walkingController->setFeedback(m_tickData.measuredDCM))
         {
-            yError() << "[updateModule] Unable to evaluate the ZMP.";
+            yError() << "[runMPCStage] unable to set the feedback.";
             return false;
         }
 
-        // evaluate 3D-LIPM reference signal
-        m_stableDCMModel->setInput(m_DCMPositionDesired.front());
-        if(!m_stableDCMModel->integrateModel())
+        // the gradient cannot be shifted if some ticks were skipped
+        if(!m_walkingController->setReferenceSignal(m_DCMPositionDesired,
+                                                    m_tickData.resetTrajectory || m_steadyStateSkippedTicks > 0))
         {
-            yError() << "[updateModule] Unable to propagate the 3D-LIPM.";
+            yError() << "[runMPCStage] unable to set the reference Signal.";
             return false;
         }
 
-        iDynTree::Vector2 desiredCoMPositionXY;
-        if(!m_stableDCMModel->getCoMPosition(desiredCoMPositionXY))
+        if(!m_walkingController->solve())
         {
-            yError() << "[updateModule] Unable to get the desired CoM position.";
+            yError() << "[runMPCStage] Unable to solve the problem.";
             return false;
         }
 
-        iDynTree::Vector2 desiredCoMVelocityXY;
-        if(!m_stableDCMModel->getCoMVelocity(desiredCoMVelocityXY))
+        if(!m_walkingController->getControllerOutput(m_tickData.desiredZMP))
         {
-            yError() << "[updateModule] Unable to get the desired CoM velocity.";
+            yError() << "[runMPCStage] Unable to get the MPC output.";
             return false;
         }
 
-        // DCM controller
-        iDynTree::Vector2 desiredZMP;
-        if(m_useMPC)
-        {
-            // Model predictive controller
-            m_profiler->setInitTime("MPC");
-            if(!m_walkingController->setConvexHullConstraint(m_leftTrajectory, m_rightTrajectory,
-                                                             m_leftInContact, m_rightInContact))
-            {
-                yError() << "[updateModule] unable to evaluate the convex hull.";
-                return false;
-            }
+        m_tickData.mpcStatistics = m_walkingController->getStatistics();
+        m_tickData.statistics.isMPCSolved = true;
 
-            if(!m_walkingController->setFeedback(measuredDCM))
-            {
-                yError() << "[updateModule] unable to set the feedback.";
-                return false;
-            }
+        if(m_MPCProblemRecorder && m_walkingController->getProblem(m_recordedProblem))
+        {
+            m_MPCProblemRecorder->record(m_recordedProblem);
+            if(m_MPCProblemRecorder->isCheckpointRequired()
+               && m_walkingController->getCheckpoint(m_recordedPrimal, m_recordedDual))
+                m_MPCProblemRecorder->recordCheckpoint(m_recordedPrimal, m_recordedDual);
+        }
+    }
 
-            if(!m_walkingController->setReferenceSignal(m_DCMPositionDesired, resetTrajectory))
-            {
-                yError() << "[updateModule] unable to set the reference Signal.";
-                return false;
-            }
+    m_profiler->setEndTime("MPC");
 
-            if(!m_walkingController->solve())
-            {
-                yError() << "[updateModule] Unable to solve the problem.";
-                return false;
-            }
+    return true;
+}
 
-            if(!m_walkingController->getControllerOutput(desiredZMP))
-            {
-                yError() << "[updateModule] Unable to get the MPC output.";
-                return false;
-            }
+bool WalkingModule::runDCMReactiveStage()
+{
+    m_walkingDCMReactiveController->setFeedback(m_tickData.measuredDCM);
+    m_walkingDCMReactiveController->setReferenceSignal(m_DCMPositionDesired.front(), m_DCMVelocityDesired.front());
 
-            m_profiler->setEndTime("MPC");
-        }
-        else
-        {
-            m_walkingDCMReactiveController->setFeedback(measuredDCM);
-            m_walkingDCMReactiveController->setReferenceSignal(m_DCMPositionDesired.front(), m_DCMVelocityDesired.front());
+    if(!m_walkingDCMReactiveController->evaluateControl())
+    {
+        yError() << "[runDCMReactiveStage] Unable to evaluate the DCM control output.";
+        return false;
+    }
 
-            if(!m_walkingDCMReactiveController->evaluateControl())
-            {
-                yError() << "[updateModule] Unable to evaluate the DCM control output.";
-                return false;
-            }
+    if(!m_walkingDCMReactiveController->getControllerOutput(m_tickData.desiredZMP))
+    {
+        yError() << "[runDCMReactiveStage] Unable to get the DCM control output.";
+        return false;
+    }
 
-            if(!m_walkingDCMReactiveController->getControllerOutput(desiredZMP))
-            {
-                yError() << "[updateModule] Unable to get the DCM control output.";
-                return false;
-            }
-        }
+    return true;
+}
 
-        // inner COM-ZMP controller
-        m_walkingZMPController->setFeedback(measuredZMP, measuredCoM);
-        m_walkingZMPController->setReferenceSignal(desiredZMP, desiredCoMPositionXY, desiredCoMVelocityXY);
+bool WalkingModule::runZMPControlStage()
+{
+    // inner COM-ZMP controller
+    m_walkingZMPController->setFeedback(m_tickData.measuredZMP, m_tickData.measuredCoM);
+    m_walkingZMPController->setReferenceSignal(m_tickData.desiredZMP, m_tickData.desiredCoMPositionXY,
+                                               m_tickData.desiredCoMVelocityXY);
 
-        if(!m_walkingZMPController->evaluateControl())
-        {
-            yError() << "[updateModule] Unable to evaluate the ZMP control output.";
-            return false;
-        }
+    if(!m_walkingZMPController->evaluateControl())
+    {
+        yError() << "[runZMPControlStage] Unable to evaluate the ZMP control output.";
+        return false;
+    }
 
-        iDynTree::Vector2 outputZMPCoMControllerPosition, outputZMPCoMControllerVelocity;
-        if(!m_walkingZMPController->getControllerOutput(outputZMPCoMControllerPosition,
-                                                        outputZMPCoMControllerVelocity))
-        {
-            yError() << "[updateModule] Unable to get the ZMP controller output.";
-            return false;
-        }
+    if(!m_walkingZMPController->getControllerOutput(m_tickData.outputZMPCoMControllerPosition,
+                                                    m_tickData.outputZMPCoMControllerVelocity))
+    {
+        yError() << "[runZMPControlStage] Unable to get the ZMP controller output.";
+        return false;
+    }
 
-        // inverse kinematics
-        m_profiler->setInitTime("IK");
+    return true;
+}
 
-        iDynTree::Position desiredCoMPosition;
-        desiredCoMPosition(0) = outputZMPCoMControllerPosition(0);
-        desiredCoMPosition(1) = outputZMPCoMControllerPosition(1);
+bool WalkingModule::runInverseKinematicsStage()
+{
+    // inverse kinematics
+    m_profiler->setInitTime("IK");
 
-        if(m_robotState == WalkingFSM::OnTheFly)
-        {
-            m_heightSmoother->computeNextValues(yarp::sig::Vector(1,m_comHeightTrajectory.front()));
-            desiredCoMPosition(2) = m_heightSmoother->getPos()[0];
-        }
-        else
-            desiredCoMPosition(2) = m_comHeightTrajectory.front();
+    m_tickData.desiredCoMPosition(0) = m_tickData.outputZMPCoMControllerPosition(0);
+    m_tickData.desiredCoMPosition(1) = m_tickData.outputZMPCoMControllerPosition(1);
 
+    if(m_robotState == WalkingFSM::OnTheFly)
+    {
+        m_heightSmoother->computeNextValues(yarp::sig::Vector(1,m_comHeightTrajectory.front()));
+        m_tickData.desiredCoMPosition(2) = m_heightSmoother->getPos()[0];
+    }
+    else
+        m_tickData.desiredCoMPosition(2) = m_comHeightTrajectory.front();
 
-        iDynTree::Vector3 desiredCoMVelocity;
-        desiredCoMVelocity(0) = outputZMPCoMControllerVelocity(0);
-        desiredCoMVelocity(1) = outputZMPCoMControllerVelocity(1);
-        desiredCoMVelocity(2) = m_comHeightVelocity.front();
+    m_tickData.desiredCoMVelocity(0) = m_tickData.outputZMPCoMControllerVelocity(0);
+    m_tickData.desiredCoMVelocity(1) = m_tickData.outputZMPCoMControllerVelocity(1);
+    m_tickData.desiredCoMVelocity(2) = m_comHeightVelocity.front();
 
-        // evaluate desired neck transformation
-        double yawLeft = m_leftTrajectory.front().getRotation().asRPY()(2);
-        double yawRight = m_rightTrajectory.front().getRotation().asRPY()(2);
+    // evaluate desired neck transformation
+    double yawLeft = m_leftTrajectory.front().getRotation().asRPY()(2);
+    double yawRight = m_rightTrajectory.front().getRotation().asRPY()(2);
 
-        double meanYaw = std::atan2(std::sin(yawLeft) + std::sin(yawRight),
-                                    std::cos(yawLeft) + std::cos(yawRight));
-        iDynTree::Rotation yawRotation, modifiedInertial;
+    double meanYaw = std::atan2(std::sin(yawLeft) + std::sin(yawRight),
+                                std::cos(yawLeft) + std::cos(yawRight));
+    iDynTree::Rotation yawRotation, modifiedInertial;
 
-        yawRotation = iDynTree::Rotation::RotZ(meanYaw);
-        yawRotation = yawRotation.inverse();
-        modifiedInertial = yawRotation * m_inertial_R_worldFrame;
+    yawRotation = iDynTree::Rotation::RotZ(meanYaw);
+    yawRotation = yawRotation.inverse();
+    modifiedInertial = yawRotation * m_inertial_R_worldFrame;
 
-        if(m_useQPIK && m_robotState != WalkingFSM::OnTheFly)
+    if(m_tickData.isSteadyState)
+    {
+        // the robot is standing still: the previous joint reference is kept
+    }
+    else if(m_useQPIK && m_robotState != WalkingFSM::OnTheFly)
+    {
+        // integrate dq because velocity control mode seems not available
+        if(!m_FKSolver->setInternalRobotState(m_qDesired, m_dqDesired_osqp))
         {
-            // integrate dq because velocity control mode seems not available
-            yarp::sig::Vector bufferVelocity(m_actuatedDOFs);
-            yarp::sig::Vector bufferPosition(m_actuatedDOFs);
+            yError() << "[updateFKSolver] Unable to evaluate the CoM.";
+            return false;
+        }
 
-            if(!m_FKSolver->setInternalRobotState(m_qDesired, m_dqDesired_osqp))
+        if(m_useOSQP)
+        {
+            if(!solveQPIK(m_QPIKSolver_osqp, m_tickData.desiredCoMPosition,
+                          m_tickData.desiredCoMVelocity, m_tickData.measuredCoM,
+                          yawRotation, m_dqDesired_osqp))
             {
-                yError() << "[updateFKSolver] Unable to evaluate the CoM.";
+                yError() << "[runInverseKinematicsStage] Unable to solve the QP problem with osqp.";
                 return false;
             }
 
-            if(m_useOSQP)
-            {
-                if(!solveQPIK(m_QPIKSolver_osqp, desiredCoMPosition,
-                              desiredCoMVelocity, measuredCoM,
-                              yawRotation, m_dqDesired_osqp))
-                {
-                    yError() << "[updateModule] Unable to solve the QP problem with osqp.";
-                    return false;
-                }
+            BufferViews::view(m_dqDesiredYarp) = iDynTree::toEigen(m_dqDesired_osqp);
+            m_tickData.ikStatistics = m_QPIKSolver_osqp->getStatistics();
+            m_tickData.statistics.isIKSolved = true;
 
-                iDynTree::toYarp(m_dqDesired_osqp, bufferVelocity);
-            }
-            else
+            if(m_IKProblemRecorder)
             {
-                if(!solveQPIK(m_QPIKSolver_qpOASES, desiredCoMPosition,
-                              desiredCoMVelocity, measuredCoM,
-                              yawRotation, m_dqDesired_qpOASES))
+                m_QPIKSolver_osqp->getProblem(m_recordedProblem);
+                m_IKProblemRecorder->record(m_recordedProblem);
+                if(m_IKProblemRecorder->isCheckpointRequired())
                 {
-                    yError() << "[updateModule] Unable to solve the QP problem with osqp.";
-                    return false;
+                    m_QPIKSolver_osqp->getCheckpoint(m_recordedPrimal, m_recordedDual);
+                    m_IKProblemRecorder->recordCheckpoint(m_recordedPrimal, m_recordedDual);
                 }
-
-                iDynTree::toYarp(m_dqDesired_qpOASES, bufferVelocity);
             }
-
-
-            bufferPosition = m_velocityIntegral->integrate(bufferVelocity);
-            iDynTree::toiDynTree(bufferPosition, m_qDesired);
         }
         else
         {
-            if(m_robotState == WalkingFSM::OnTheFly)
+            if(!solveQPIK(m_QPIKSolver_qpOASES, m_tickData.desiredCoMPosition,
+                          m_tickData.desiredCoMVelocity, m_tickData.measuredCoM,
+                          yawRotation, m_dqDesired_qpOASES))
+            {
+                yError() << "[runInverseKinematicsStage] Unable to solve the QP problem with osqp.";
+                return false;
+            }
+
+            BufferViews::view(m_dqDesiredYarp) = iDynTree::toEigen(m_dqDesired_qpOASES);
+            m_tickData.ikStatistics = m_QPIKSolver_qpOASES->getStatistics();
+            m_tickData.statistics.isIKSolved = true;
+
+            if(m_IKProblemRecorder)
             {
-                iDynTree::VectorDynSize desiredJointInRad(m_actuatedDOFs);
-                m_jointsSmoother->computeNextValues(m_desiredJointInRadYarp);
-                iDynTree::toiDynTree(m_jointsSmoother->getPos(), desiredJointInRad);
-                if (!m_IKSolver->setDesiredJointConfiguration(desiredJointInRad))
+                m_QPIKSolver_qpOASES->getProblem(m_recordedProblem);
+                m_IKProblemRecorder->record(m_recordedProblem);
+                if(m_IKProblemRecorder->isCheckpointRequired())
                 {
-                    yError() << "[updateModule] Unable to set the desired Joint Configuration.";
-                    return false;
+                    m_QPIKSolver_qpOASES->getCheckpoint(m_recordedPrimal, m_recordedDual);
+                    m_IKProblemRecorder->recordCheckpoint(m_recordedPrimal, m_recordedDual);
                 }
             }
+        }
 
-            if(m_IKSolver->usingAdditionalRotationTarget())
+        BufferViews::view(m_qDesired) =
+            BufferViews::view(m_velocityIntegral->integrate(m_dqDesiredYarp));
+    }
+    else
+    {
+        MemoryScope memoryScope(MemorySubsystem::IK);
+        if(m_robotState == WalkingFSM::OnTheFly)
+        {
+            iDynTree::VectorDynSize desiredJointInRad(m_actuatedDOFs);
+            m_jointsSmoother->computeNextValues(m_desiredJointInRadYarp);
+            iDynTree::toiDynTree(m_jointsSmoother->getPos(), desiredJointInRad);
+            if (!m_IKSolver->setDesiredJointConfiguration(desiredJointInRad))
             {
+                yError() << "[runInverseKinematicsStage] Unable to set the desired Joint Configuration.";
+                return false;
+            }
+        }
 
-                if(m_robotState == WalkingFSM::OnTheFly)
-                {
-                    m_additionalRotationWeightSmoother->computeNextValues(yarp::sig::Vector(1,
-                                                                                            m_additionalRotationWeightDesired));
-                    double rotationWeight = m_additionalRotationWeightSmoother->getPos()[0];
-                    if (!m_IKSolver->setAdditionalRotationWeight(rotationWeight))
-                    {
-                        yError() << "[updateModule] Unable to set the additional rotational weight.";
-                        return false;
-                    }
-
-                    m_desiredJointWeightSmoother->computeNextValues(yarp::sig::Vector(1, m_desiredJointsWeight));
-                    double jointWeight = m_desiredJointWeightSmoother->getPos()[0];
-                    if (!m_IKSolver->setDesiredJointsWeight(jointWeight))
-                    {
-                        yError() << "[updateModule] Unable to set the desired joint weight.";
-                        return false;
-                    }
-                }
+        if(m_IKSolver->usingAdditionalRotationTarget())
+        {
 
-                if(!m_IKSolver->updateIntertiaToWorldFrameRotation(modifiedInertial))
+            if(m_robotState == WalkingFSM::OnTheFly)
+            {
+                m_additionalRotationWeightSmoother->computeNextValues(yarp::sig::Vector(1,
+                                                                                        m_additionalRotationWeightDesired));
+                double rotationWeight = m_additionalRotationWeightSmoother->getPos()[0];
+                if (!m_IKSolver->setAdditionalRotationWeight(rotationWeight))
                 {
-                    yError() << "[updateModule] Error updating the inertia to world frame rotation.";
+                    yError() << "[runInverseKinematicsStage] Unable to set the additional rotational weight.";
                     return false;
                 }
 
-                if(!m_IKSolver->setFullModelFeedBack(m_positionFeedbackInRadians))
+                m_desiredJointWeightSmoother->computeNextValues(yarp::sig::Vector(1, m_desiredJointsWeight));
+                double jointWeight = m_desiredJointWeightSmoother->getPos()[0];
+                if (!m_IKSolver->setDesiredJointsWeight(jointWeight))
                 {
-                    yError() << "[updateModule] Error while setting the feedback to the inverse Kinematics.";
+                    yError() << "[runInverseKinematicsStage] Unable to set the desired joint weight.";
                     return false;
                 }
+            }
 
-                if(!m_IKSolver->computeIK(m_leftTrajectory.front(), m_rightTrajectory.front(),
-                                          desiredCoMPosition, m_qDesired))
-                {
-                    yError() << "[updateModule] Error during the inverse Kinematics iteration.";
-                    return false;
-                }
+            if(!m_IKSolver->updateIntertiaToWorldFrameRotation(modifiedInertial))
+            {
+                yError() << "[runInverseKinematicsStage] Error updating the inertia to world frame rotation.";
+                return false;
             }
-        }
-        m_profiler->setEndTime("IK");
 
-        if(m_useQPIK)
-        {
-            if(!setDirectPositionReferences(m_qDesired))
+            if(!m_IKSolver->setFullModelFeedBack(m_positionFeedbackInRadians))
             {
-                yError() << "[updateModule] Error while setting the reference position to iCub.";
+                yError() << "[runInverseKinematicsStage] Error while setting the feedback to the inverse Kinematics.";
                 return false;
             }
-        }
-        else
-        {
-            if(!setDirectPositionReferences(m_qDesired))
+
+            if(!m_IKSolver->computeIK(m_leftTrajectory.front(), m_rightTrajectory.front(),
+                                      m_tickData.desiredCoMPosition, m_qDesired))
             {
-                yError() << "[updateModule] Error while setting the reference position to iCub.";
+                yError() << "[runInverseKinematicsStage] Error during the inverse Kinematics iteration.";
                 return false;
             }
+            m_tickData.statistics.isIKSolved = true;
         }
+    }
+    m_profiler->setEndTime("IK");
 
-        m_profiler->setEndTime("Total");
-
-        // print timings
-        m_profiler->profiling();
+    return true;
+}
 
-        iDynTree::VectorDynSize errorL(6), errorR(6);
-        if(m_robotState != WalkingFSM::OnTheFly && m_useQPIK)
+bool WalkingModule::runCommandStage()
+{
+    if(m_useQPIK)
+    {
+        if(!setDirectPositionReferences(m_qDesired))
         {
-            if(m_useOSQP)
-            {
-                m_QPIKSolver_osqp->getRightFootError(errorR);
-                m_QPIKSolver_osqp->getLeftFootError(errorL);
-            }
-            else
-            {
-                m_QPIKSolver_qpOASES->getRightFootError(errorR);
-                m_QPIKSolver_qpOASES->getLeftFootError(errorL);
-            }
+            yError() << "[runCommandStage] Error while setting the reference position to iCub.";
+            return false;
         }
-
-        // send data to the WalkingLogger
-        if(m_dumpData)
+    }
+    else
+    {
+        if(!setDirectPositionReferences(m_qDesired))
         {
-            auto leftFoot = m_FKSolver->getLeftFootToWorldTransform();
-            auto rightFoot = m_FKSolver->getRightFootToWorldTransform();
-            m_walkingLogger->sendData(measuredDCM, m_DCMPositionDesired.front(), m_DCMVelocityDesired.front(),
-                                      measuredZMP, desiredZMP, measuredCoM,
-                                      desiredCoMPositionXY, desiredCoMVelocityXY,
-                                      leftFoot.getPosition(), leftFoot.getRotation().asRPY(),
-                                      rightFoot.getPosition(), rightFoot.getRotation().asRPY(),
-                                      m_leftTrajectory.front().getPosition(), m_leftTrajectory.front().getRotation().asRPY(),
-                                      m_rightTrajectory.front().getPosition(), m_rightTrajectory.front().getRotation().asRPY(),
-                                      errorL, errorR);
+            yError() << "[runCommandStage] Error while setting the reference position to iCub.";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WalkingModule::runTelemetryStage()
+{
+    m_profiler->setEndTime("Total");
+
+    // print timings
+    m_profiler->profiling();
 
-            // m_walkingLogger->sendData(m_dqDesired_osqp, m_dqDesired_qpOASES);
+    iDynTree::VectorDynSize errorL(6), errorR(6);
+    if(m_robotState != WalkingFSM::OnTheFly && m_useQPIK)
+    {
+        if(m_useOSQP)
+        {
+            m_QPIKSolver_osqp->getRightFootError(errorR);
+            m_QPIKSolver_osqp->getLeftFootError(errorL);
+        }
+        else
+        {
+            m_QPIKSolver_qpOASES->getRightFootError(errorR);
+            m_QPIKSolver_qpOASES->getLeftFootError(errorL);
         }
+    }
+
+    // send data to the WalkingLogger
+    if(m_dumpData)
+    {
+        auto leftFoot = m_FKSolver->getLeftFootToWorldTransform();
+        auto rightFoot = m_FKSolver->getRightFootToWorldTransform();
+
+        yarp::sig::Vector solverStatistics(7);
+        solverStatistics(0) = static_cast<int>(m_accuracySchedule->getPhase());
+        solverStatistics(1) = m_tickData.mpcStatistics.iterations;
+        solverStatistics(2) = m_tickData.mpcStatistics.primalResidual;
+        solverStatistics(3) = m_tickData.mpcStatistics.dualResidual;
+        solverStatistics(4) = m_tickData.ikStatistics.iterations;
+        solverStatistics(5) = m_tickData.ikStatistics.primalResidual;
+        solverStatistics(6) = m_tickData.ikStatistics.dualResidual;
+
+        m_walkingLogger->setTimestamps(m_tickData.initTime, m_feedbackTime);
+        m_walkingLogger->sendData(m_tickData.measuredDCM, m_DCMPositionDesired.front(), m_DCMVelocityDesired.front(),
+                                  m_tickData.measuredZMP, m_tickData.desiredZMP, m_tickData.measuredCoM,
+                                  m_tickData.desiredCoMPositionXY, m_tickData.desiredCoMVelocityXY,
+                                  leftFoot.getPosition(), leftFoot.getRotation().asRPY(),
+                                  rightFoot.getPosition(), rightFoot.getRotation().asRPY(),
+                                  m_leftTrajectory.front().getPosition(), m_leftTrajectory.front().getRotation().asRPY(),
+                                  m_rightTrajectory.front().getPosition(), m_rightTrajectory.front().getRotation().asRPY(),
+                                  errorL, errorR, solverStatistics);
+
+        // m_walkingLogger->sendData(m_dqDesired_osqp, m_dqDesired_qpOASES);
+    }
+
+    double tickEndTime = yarp::os::Time::now();
+
+    // update the statistics of the controller
+    m_tickData.statistics.mpcDuration = m_stageGraph->getDuration("dcm_control");
+    m_tickData.statistics.ikDuration = m_stageGraph->getDuration("inverse_kinematics");
+    m_tickData.statistics.period = getPeriod();
+    m_tickData.statistics.totalDuration = tickEndTime - m_tickData.initTime;
+    m_tickData.statistics.isSteadyState = m_tickData.isSteadyState;
+    m_tickData.statistics.mpcStatistics = m_tickData.mpcStatistics;
+    m_tickData.statistics.ikStatistics = m_tickData.ikStatistics;
+    m_statistics->update(m_tickData.statistics);
+
+    // the threads are sampled after the end of the tick, every thread_telemetry_period ticks
+    m_threadTelemetry->update(m_tickData.statistics.totalDuration > m_tickData.statistics.period);
+
+    if(m_publishMetrics && tickEndTime - m_metricsPublishTime >= m_metricsPeriod)
+    {
+        // the statistics are collected and sent by the thread pool, a message is skipped if
+        // the previous one is still pending
+        bool isMetricsPending = false;
+        if(m_isMetricsPending.compare_exchange_strong(isMetricsPending, true)
+           && !m_threadPool->submit(TaskPriority::Low, [this]{publishMetrics();}))
+            m_isMetricsPending = false;
+        m_metricsPublishTime = tickEndTime;
+    }
+
+    // the record is copied in a preallocated ring, no disk I/O is performed
+    if(m_flightRecorder)
+    {
+        auto leftFoot = m_FKSolver->getLeftFootToWorldTransform();
+        auto rightFoot = m_FKSolver->getRightFootToWorldTransform();
+        m_flightRecorder->record(m_tickData.initTime, m_feedbackTime,
+                                 static_cast<int>(m_robotState), static_cast<int>(m_tickData.isSteadyState),
+                                 m_tickData.measuredDCM, m_DCMPositionDesired.front(),
+                                 m_tickData.measuredZMP, m_tickData.desiredZMP,
+                                 m_tickData.measuredCoM, m_tickData.desiredCoMPositionXY,
+                                 leftFoot.getPosition(), leftFoot.getRotation().asRPY(),
+                                 rightFoot.getPosition(), rightFoot.getRotation().asRPY(),
+                                 m_leftTrajectory.front().getPosition(),
+                                 m_leftTrajectory.front().getRotation().asRPY(),
+                                 m_rightTrajectory.front().getPosition(),
+                                 m_rightTrajectory.front().getRotation().asRPY(),
+                                 static_cast<int>(m_accuracySchedule->getPhase()),
+                                 m_tickData.mpcStatistics.iterations,
+                                 m_tickData.mpcStatistics.primalResidual, m_tickData.mpcStatistics.dualResidual,
+                                 m_tickData.ikStatistics.iterations,
+                                 m_tickData.ikStatistics.primalResidual, m_tickData.ikStatistics.dualResidual,
+                                 m_tickData.statistics.totalDuration,
+                                 m_positionFeedbackInRadians, m_qDesired);
+
+        if(m_watchdogTickDuration > 0)
+            m_flightRecorder->watchdog(m_tickData.statistics.totalDuration > m_watchdogTickDuration);
+    }
+
+    // publish the state of the controller (the control thread is never blocked)
+    if(m_statePublisher)
+    {
+        WalkingStateSnapshot& snapshot = m_statePublisher->getSnapshot();
+        snapshot.time = tickEndTime;
+        snapshot.robotState = static_cast<int>(m_robotState);
+        snapshot.isSteadyState = m_tickData.isSteadyState;
+        snapshot.measuredDCM = m_tickData.measuredDCM;
+        snapshot.desiredDCM = m_DCMPositionDesired.front();
+        snapshot.measuredZMP = m_tickData.measuredZMP;
+        snapshot.desiredZMP = m_tickData.desiredZMP;
+        snapshot.measuredCoM = m_tickData.measuredCoM;
+        snapshot.desiredCoM = m_tickData.desiredCoMPositionXY;
+        snapshot.leftFoot = m_FKSolver->getLeftFootToWorldTransform();
+        snapshot.rightFoot = m_FKSolver->getRightFootToWorldTransform();
+        snapshot.desiredLeftFoot = m_leftTrajectory.front();
+        snapshot.desiredRightFoot = m_rightTrajectory.front();
+        snapshot.solverPhase = static_cast<int>(m_accuracySchedule->getPhase());
+        snapshot.mpcStatistics = m_tickData.mpcStatistics;
+        snapshot.ikStatistics = m_tickData.ikStatistics;
+        snapshot.tickDuration = m_tickData.statistics.totalDuration;
+        m_statePublisher->publish();
+    }
+
+    return true;
+}
+
+bool WalkingModule::runPropagationStage()
+{
+    updateSteadyStateSnapshot(m_tickData.measuredDCM, m_tickData.measuredZMP,
+                              m_tickData.desiredZMP, m_tickData.isSteadyState);
 
+    // one sample of the reference signals is consumed every m_dT seconds
+    for(int i = 0; i < m_rateMultiplier; i++)
+    {
         propagateTime();
 
         if(m_robotState != WalkingFSM::OnTheFly)
             // propagate all the signals
             propagateReferenceSignals();
+    }
 
-        if((m_robotState == WalkingFSM::OnTheFly) && (m_time > m_onTheFlySmoothingTime))
+    if((m_robotState == WalkingFSM::OnTheFly) && (m_time > m_onTheFlySmoothingTime))
+    {
+        // reset gains and desired joint position
+        iDynTree::VectorDynSize desiredJointInRad(m_actuatedDOFs);
+        iDynTree::toiDynTree(m_desiredJointInRadYarp, desiredJointInRad);
+        if (!m_IKSolver->setDesiredJointConfiguration(desiredJointInRad))
         {
-            // reset gains and desired joint position
-            iDynTree::VectorDynSize desiredJointInRad(m_actuatedDOFs);
-            iDynTree::toiDynTree(m_desiredJointInRadYarp, desiredJointInRad);
-            if (!m_IKSolver->setDesiredJointConfiguration(desiredJointInRad))
-            {
-                yError() << "[updateModule] Unable to set the desired Joint Configuration.";
-                return false;
-            }
+            yError() << "[runPropagationStage] Unable to set the desired Joint Configuration.";
+            return false;
+        }
 
-            if (!m_IKSolver->setAdditionalRotationWeight(m_additionalRotationWeightDesired))
-            {
-                yError() << "[updateModule] Unable to set the additional rotational weight.";
-                return false;
-            }
+        if (!m_IKSolver->setAdditionalRotationWeight(m_additionalRotationWeightDesired))
+        {
+            yError() << "[runPropagationStage] Unable to set the additional rotational weight.";
+            return false;
+        }
 
-            if (!m_IKSolver->setDesiredJointsWeight(m_desiredJointsWeight))
-            {
-                yError() << "[updateModule] Unable to set the desired joint weight.";
-                return false;
-            }
-            m_robotState = WalkingFSM::Stance;
-            m_firstStep = true;
+        if (!m_IKSolver->setDesiredJointsWeight(m_desiredJointsWeight))
+        {
+            yError() << "[runPropagationStage] Unable to set the desired joint weight.";
+            return false;
+        }
+        m_robotState = WalkingFSM::Stance;
+        m_firstStep = true;
 
-            // reset time
-            m_time = 0.0;
+        // reset time
+        m_time = 0.0;
 
-            yarp::sig::Vector buffer(m_qDesired.size());
-            iDynTree::toYarp(m_qDesired, buffer);
-            // instantiate Integrator object
-            m_velocityIntegral = std::make_unique<iCub::ctrl::Integrator>(m_dT, buffer);
-        }
-        else if(m_firstStep)
-            m_firstStep = false;
+        yarp::sig::Vector buffer(m_qDesired.size());
+        iDynTree::toYarp(m_qDesired, buffer);
+        // instantiate Integrator object
+        m_velocityIntegral = std::make_unique<iCub::ctrl::Integrator>(m_dT, buffer);
+
+        // the solutions evaluated during the onTheFly procedure cannot be reused
+        m_isSteadyStateSnapshotValid = false;
+    }
+    else if(m_firstStep)
+        m_firstStep = false;
+
+    return true;
+}
+
+bool WalkingModule::updateController()
+{
+    if(m_robotState != WalkingFSM::Walking
+       && m_robotState != WalkingFSM::Stance
+       && m_robotState != WalkingFSM::OnTheFly)
+        return true;
 
+    m_profiler->setInitTime("Total");
+
+    // the quantities of the previous tick are not reused
+    m_tickData = WalkingTickData();
+    m_tickData.initTime = yarp::os::Time::now();
+
+    // the events of the tick are used to attribute the latency spikes
+    if(m_firstStep)
+        m_tickData.statistics.events |= WalkingEvent::FirstTick;
+
+    if(!m_stageGraph->run())
+    {
+        yError() << "[updateController] Unable to run the stages of the tick.";
+        return false;
     }
+
     return true;
 }
 
@@ -1100,6 +1918,24 @@ bool WalkingModule::getFeedbacks(unsigned int maxAttempts)
         return false;
     }
 
+    // the feedback is prefetched by the I/O thread
+    if(m_useIOThread && m_IOHandler->isRunning())
+    {
+        if(!m_IOHandler->getFeedback(m_tickReleaseTime, getPeriod(), maxAttempts * 0.001))
+        {
+            yError() << "[getFeedbacks] Unable to get the feedback from the I/O thread.";
+            return false;
+        }
+
+        const WalkingFeedbackSnapshot& snapshot = m_IOHandler->getFeedbackSnapshot();
+        m_positionFeedbackInDegrees = snapshot.positionInDegrees;
+        m_velocityFeedbackInDegrees = snapshot.velocityInDegrees;
+        m_leftWrenchInput = snapshot.leftWrench;
+        m_rightWrenchInput = snapshot.rightWrench;
+        m_feedbackTime = snapshot.time;
+        return evaluateFeedbacks();
+    }
+
     bool okPosition = false;
     bool okVelocity = false;
 
@@ -1140,59 +1976,8 @@ bool WalkingModule::getFeedbacks(unsigned int maxAttempts)
 
         if(okVelocity && okPosition && okLeftWrench && okRightWrench)
         {
-            if(m_useVelocityFilter)
-            {
-                // filter the joint position and the velocity
-                m_velocityFeedbackInDegreesFiltered = m_velocityFilter->filt(m_velocityFeedbackInDegrees);
-                for(unsigned j = 0; j < m_actuatedDOFs; ++j)
-                {
-                    m_positionFeedbackInRadians(j) = iDynTree::deg2rad(m_positionFeedbackInDegrees(j));
-                    m_velocityFeedbackInRadians(j) = iDynTree::deg2rad(m_velocityFeedbackInDegreesFiltered(j));
-                }
-            }
-            else
-            {
-                for(unsigned j = 0; j < m_actuatedDOFs; ++j)
-                {
-                    m_positionFeedbackInRadians(j) = iDynTree::deg2rad(m_positionFeedbackInDegrees(j));
-                    m_velocityFeedbackInRadians(j) = iDynTree::deg2rad(m_velocityFeedbackInDegrees(j));
-                }
-            }
-            if(m_useWrenchFilter)
-            {
-                if(m_firstStep)
-                {
-                    m_leftWrenchFilter->init(m_leftWrenchInput);
-                    m_rightWrenchFilter->init(m_rightWrenchInput);
-                }
-                m_leftWrenchInputFiltered = m_leftWrenchFilter->filt(m_leftWrenchInput);
-                m_rightWrenchInputFiltered = m_rightWrenchFilter->filt(m_rightWrenchInput);
-
-                if(!iDynTree::toiDynTree(m_leftWrenchInputFiltered, m_leftWrench))
-                {
-                    yError() << "[getFeedbacks] Unable to convert left foot wrench.";
-                    return false;
-                }
-                if(!iDynTree::toiDynTree(m_rightWrenchInputFiltered, m_rightWrench))
-                {
-                    yError() << "[getFeedbacks] Unable to convert right foot wrench.";
-                    return false;
-                }
-            }
-            else
-            {
-                if(!iDynTree::toiDynTree(m_leftWrenchInput, m_leftWrench))
-                {
-                    yError() << "[getFeedbacks] Unable to convert left foot wrench.";
-                    return false;
-                }
-                if(!iDynTree::toiDynTree(m_rightWrenchInput, m_rightWrench))
-                {
-                    yError() << "[getFeedbacks] Unable to convert right foot wrench.";
-                    return false;
-                }
-            }
-            return true;
+            m_feedbackTime = yarp::os::Time::now();
+            return evaluateFeedbacks();
         }
 
         yarp::os::Time::delay(0.001);
@@ -1215,6 +2000,74 @@ bool WalkingModule::getFeedbacks(unsigned int maxAttempts)
     return false;
 }
 
+bool WalkingModule::evaluateFeedbacks()
+{
+    BufferViews::view(m_positionFeedbackInRadians) =
+        iDynTree::deg2rad(1) * BufferViews::view(m_positionFeedbackInDegrees);
+
+    if(m_useVelocityFilter)
+    {
+        // filter the joint velocity
+        m_velocityFeedbackInDegreesFiltered = m_velocityFilter->filt(m_velocityFeedbackInDegrees);
+        BufferViews::view(m_velocityFeedbackInRadians) =
+            iDynTree::deg2rad(1) * BufferViews::view(m_velocityFeedbackInDegreesFiltered);
+    }
+    else
+        BufferViews::view(m_velocityFeedbackInRadians) =
+            iDynTree::deg2rad(1) * BufferViews::view(m_velocityFeedbackInDegrees);
+
+    if(m_useWrenchFilter)
+    {
+        if(m_firstStep)
+        {
+            m_leftWrenchFilter->init(m_leftWrenchInput);
+            m_rightWrenchFilter->init(m_rightWrenchInput);
+        }
+        m_leftWrenchInputFiltered = m_leftWrenchFilter->filt(m_leftWrenchInput);
+        m_rightWrenchInputFiltered = m_rightWrenchFilter->filt(m_rightWrenchInput);
+
+        if(!iDynTree::toiDynTree(m_leftWrenchInputFiltered, m_leftWrench))
+        {
+            yError() << "[getFeedbacks] Unable to convert left foot wrench.";
+            return false;
+        }
+        if(!iDynTree::toiDynTree(m_rightWrenchInputFiltered, m_rightWrench))
+        {
+            yError() << "[getFeedbacks] Unable to convert right foot wrench.";
+            return false;
+        }
+    }
+    else
+    {
+        if(!iDynTree::toiDynTree(m_leftWrenchInput, m_leftWrench))
+        {
+            yError() << "[getFeedbacks] Unable to convert left foot wrench.";
+            return false;
+        }
+        if(!iDynTree::toiDynTree(m_rightWrenchInput, m_rightWrench))
+        {
+            yError() << "[getFeedbacks] Unable to convert right foot wrench.";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WalkingModule::startIOThread()
+{
+    if(!m_useIOThread || m_IOHandler->isRunning())
+        return true;
+
+    if(!m_IOHandler->start(m_encodersInterface, m_positionDirectInterface,
+                           &m_leftWrenchPort, &m_rightWrenchPort, m_actuatedDOFs,
+                           m_realTimeSettings))
+    {
+        yError() << "[startIOThread] Unable to start the I/O thread.";
+        return false;
+    }
+    return true;
+}
+
 bool WalkingModule::evaluateZMP(iDynTree::Vector2& zmp)
 {
     if(m_FKSolver == nullptr)
@@ -1276,10 +2129,14 @@ bool WalkingModule::getWorstError(const iDynTree::VectorDynSize& desiredJointPos
         return false;
     }
 
-    if(!m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data()))
+    // if the I/O thread is running the feedback of the current tick is used
+    if(!(m_useIOThread && m_IOHandler->isRunning()))
     {
-        yError() << "[getWorstError] Error reading encoders.";
-        return false;
+        if(!m_encodersInterface->getEncoders(m_positionFeedbackInDegrees.data()))
+        {
+            yError() << "[getWorstError] Error reading encoders.";
+            return false;
+        }
     }
 
     // clear the std::pair
@@ -1459,6 +2316,17 @@ bool WalkingModule::setDirectPositionReferences(const iDynTree::VectorDynSize& d
 
     iDynTree::toEigen(m_toDegBuffer) = iDynTree::toEigen(desiredPositionsRad) * iDynTree::rad2deg(1);
 
+    // the references are written by the I/O thread
+    if(m_useIOThread && m_IOHandler->isRunning())
+    {
+        if(!m_IOHandler->setDirectPositionReferences(m_toDegBuffer.data()))
+        {
+            yError() << "[setDirectPositionReferences] Error while setting the desired position.";
+            return false;
+        }
+        return true;
+    }
+
     if(!m_positionDirectInterface->setPositions(m_toDegBuffer.data()))
     {
         yError() << "[setDirectPositionReferences] Error while setting the desired position.";
@@ -1509,6 +2377,9 @@ bool WalkingModule::setVelocityReferences(const iDynTree::VectorDynSize& desired
 
 bool WalkingModule::prepareRobot(bool onTheFly)
 {
+    // the rpc commands are served by a YARP thread, it is named for the thread telemetry
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
     if(m_robotState != WalkingFSM::Configured)
     {
         yError() << "[prepareRobot] You cannot prepare the robot again.";
@@ -1661,6 +2532,8 @@ bool WalkingModule::prepareRobot(bool onTheFly)
 
 bool WalkingModule::generateFirstTrajectories(const iDynTree::Transform &leftToRightTransform)
 {
+    MemoryScope memoryScope(MemorySubsystem::Trajectories);
+
     if(m_trajectoryGenerator == nullptr)
     {
         yError() << "[generateFirstTrajectories] Unicycle planner not available.";
@@ -1687,6 +2560,8 @@ bool WalkingModule::generateFirstTrajectories(const iDynTree::Transform &leftToR
 
 bool WalkingModule::generateFirstTrajectories()
 {
+    MemoryScope memoryScope(MemorySubsystem::Trajectories);
+
     if(m_trajectoryGenerator == nullptr)
     {
         yError() << "[generateFirstTrajectories] Unicycle planner not available.";
@@ -1715,6 +2590,8 @@ bool WalkingModule::askNewTrajectories(const double& initTime, const bool& isLef
                                        const iDynTree::Transform& measuredTransform,
                                        const size_t& mergePoint, const iDynTree::Vector2& desiredPosition)
 {
+    MemoryScope memoryScope(MemorySubsystem::Planner);
+
     if(m_trajectoryGenerator == nullptr)
     {
         yError() << "[askNewTrajectories] Unicycle planner not available.";
@@ -1741,6 +2618,8 @@ bool WalkingModule::askNewTrajectories(const double& initTime, const bool& isLef
 
 bool WalkingModule::updateTrajectories(const size_t& mergePoint)
 {
+    MemoryScope memoryScope(MemorySubsystem::Trajectories);
+
     if(!(m_trajectoryGenerator->isTrajectoryComputed()))
     {
         yError() << "[updateTrajectories] The trajectory is not computed.";
@@ -1798,11 +2677,15 @@ bool WalkingModule::updateTrajectories(const size_t& mergePoint)
     // the first merge point is always equal to 0
     m_mergePoints.pop_front();
 
+    evaluateNonStationarySamples();
+
     return true;
 }
 
 bool WalkingModule::updateFKSolver()
 {
+    MemoryScope memoryScope(MemorySubsystem::FK);
+
     // if(m_firstStep)
     // {
     //     if(!m_FKSolver->evaluateFirstWorldToBaseTransformation(m_leftTrajectory.front()))
@@ -1839,6 +2722,8 @@ bool WalkingModule::updateFKSolver()
 
 bool WalkingModule::evaluateCoM(iDynTree::Position& comPosition, iDynTree::Vector3& comVelocity)
 {
+    MemoryScope memoryScope(MemorySubsystem::FK);
+
     if(m_FKSolver == nullptr)
     {
         yError() << "[evaluateCoM] The FK solver is not ready.";
@@ -1868,6 +2753,8 @@ bool WalkingModule::evaluateCoM(iDynTree::Position& comPosition, iDynTree::Vecto
 
 bool WalkingModule::evaluateDCM(iDynTree::Vector2& dcm)
 {
+    MemoryScope memoryScope(MemorySubsystem::FK);
+
     if(m_FKSolver == nullptr)
     {
         yError() << "[evaluateDCM] The FK solver is not ready.";
@@ -1891,6 +2778,8 @@ bool WalkingModule::evaluateDCM(iDynTree::Vector2& dcm)
 
 bool WalkingModule::startWalking()
 {
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
     if(m_robotState != WalkingFSM::Prepared)
     {
         yError() << "[startWalking] Unable to start walking if the robot is not prepared.";
@@ -1918,7 +2807,10 @@ bool WalkingModule::startWalking()
                     "lf_err_x", "lf_err_y", "lf_err_z",
                     "lf_err_roll", "lf_err_pitch", "lf_err_yaw",
                     "rf_err_x", "rf_err_y", "rf_err_z",
-                    "rf_err_roll", "rf_err_pitch", "rf_err_yaw"});
+                    "rf_err_roll", "rf_err_pitch", "rf_err_yaw",
+                    "solver_phase",
+                    "mpc_iter", "mpc_pri_res", "mpc_dua_res",
+                    "ik_iter", "ik_pri_res", "ik_dua_res"});
         // "torso_pitch", "torso_roll", "torso_yaw",
         // "l_shoulder_pitch", "l_shoulder_roll", "l_shoulder_yaw", "l_elbow",
         // "r_shoulder_pitch", "r_shoulder_roll", "r_shoulder_yaw", "r_elbow",
@@ -1937,6 +2829,12 @@ bool WalkingModule::startWalking()
     //             "l_hip_pitch_qpOASES", "l_hip_roll_qpOASES", "l_hip_yaw_qpOASES", "l_knee_qpOASES", "l_ankle_pitch_qpOASES", "l_ankle_roll_qpOASES",
     //             "r_hip_pitch_qpOASES", "r_hip_roll_qpOASES", "r_hip_yaw_qpOASES", "r_knee_qpOASES", "r_ankle_pitch_qpOASES", "r_ankle_roll_qpOASES"});
     }
+    if(!startIOThread())
+    {
+        yError() << "[startWalking] Unable to start the I/O thread.";
+        return false;
+    }
+
     {
         std::lock_guard<std::mutex> guard(m_mutex);
         m_robotState = WalkingFSM::Stance;
@@ -1948,8 +2846,15 @@ bool WalkingModule::startWalking()
 
 bool WalkingModule::setGoal(double x, double y)
 {
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
     std::lock_guard<std::mutex> guard(m_mutex);
 
+    return applyGoal(x, y);
+}
+
+bool WalkingModule::applyGoal(const double& x, const double& y)
+{
     if(m_robotState != WalkingFSM::Walking && m_robotState != WalkingFSM::Stance)
         return false;
 
@@ -1961,7 +2866,7 @@ bool WalkingModule::setGoal(double x, double y)
     {
         if(!(m_leftInContact.front() && m_rightInContact.front()))
         {
-            yError() << "[setGoal] The trajectory has already finished but the system is not in double support.";
+            yError() << "[applyGoal] The trajectory has already finished but the system is not in double support.";
             return false;
         }
 
@@ -2150,10 +3055,121 @@ bool WalkingModule::onTheFlyStartWalking(const double smoothingTime)
                     "lf_err_x", "lf_err_y", "lf_err_z",
                     "lf_err_roll", "lf_err_pitch", "lf_err_yaw",
                     "rf_err_x", "rf_err_y", "rf_err_z",
-                    "rf_err_roll", "rf_err_pitch", "rf_err_yaw"});
+                    "rf_err_roll", "rf_err_pitch", "rf_err_yaw",
+                    "solver_phase",
+                    "mpc_iter", "mpc_pri_res", "mpc_dua_res",
+                    "ik_iter", "ik_pri_res", "ik_dua_res"});
+    }
+
+    if(!startIOThread())
+    {
+        yError() << "[onTheFlyStartWalking] Unable to start the I/O thread.";
+        return false;
     }
 
     m_robotState = WalkingFSM::OnTheFly;
 
     return true;
 }
+
+void WalkingModule::publishMetrics()
+{
+    yarp::os::Bottle& metrics = m_metricsPort.prepare();
+    metrics.clear();
+    getStatistics(metrics);
+    m_metricsPort.write();
+    m_isMetricsPending = false;
+}
+
+void WalkingModule::getStatistics(yarp::os::Bottle& statistics)
+{
+    m_statistics->toBottle(statistics);
+    if(m_threadTelemetry && m_threadTelemetry->isEnabled())
+        m_threadTelemetry->toBottle(statistics);
+    MemoryAccounting::toBottle(statistics);
+    if(m_stageGraph)
+        m_stageGraph->toBottle(statistics);
+    if(m_threadPool)
+        m_threadPool->toBottle(statistics);
+    if(m_walkingLogger)
+        m_walkingLogger->toBottle(statistics);
+    if(m_IOHandler)
+        m_IOHandler->toBottle(statistics);
+    if(m_flightRecorder)
+        m_flightRecorder->toBottle(statistics);
+
+    int numberOfSwitches = 0;
+    double meanSwitchDuration = 0.0, maxSwitchDuration = 0.0;
+    if(m_PIDHandler)
+        m_PIDHandler->getSwitchStatistics(numberOfSwitches, meanSwitchDuration, maxSwitchDuration);
+
+    yarp::os::Bottle& pid = statistics.addList();
+    pid.addString("pid_switches");
+    yarp::os::Bottle& pidList = pid.addList();
+    yarp::os::Bottle& count = pidList.addList();
+    count.addString("count");
+    count.addInt(numberOfSwitches);
+    yarp::os::Bottle& mean = pidList.addList();
+    mean.addString("mean_ms");
+    mean.addDouble(meanSwitchDuration * 1e3);
+    yarp::os::Bottle& max = pidList.addList();
+    max.addString("max_ms");
+    max.addDouble(maxSwitchDuration * 1e3);
+}
+
+yarp::os::Bottle WalkingModule::getStats()
+{
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
+    // the module mutex is not required, the statistics are protected by their own mutex
+    yarp::os::Bottle statistics;
+    if(m_statistics)
+        getStatistics(statistics);
+
+    return statistics;
+}
+
+bool WalkingModule::resetStats()
+{
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
+    if(!m_statistics)
+    {
+        yError() << "[resetStats] The module is not configured.";
+        return false;
+    }
+
+    m_statistics->reset();
+    if(m_threadTelemetry)
+        m_threadTelemetry->reset();
+    MemoryAccounting::reset();
+    if(m_stageGraph)
+        m_stageGraph->resetStatistics();
+    if(m_threadPool)
+        m_threadPool->resetStatistics();
+    if(m_walkingLogger)
+        m_walkingLogger->resetStatistics();
+    if(m_IOHandler)
+        m_IOHandler->resetStatistics();
+    if(m_flightRecorder)
+        m_flightRecorder->resetStatistics();
+    if(m_PIDHandler)
+        m_PIDHandler->resetSwitchStatistics();
+
+    return true;
+}
+
+bool WalkingModule::dumpFlightRecorder()
+{
+    ThreadTelemetry::setCurrentThreadName("rpc");
+
+    if(!m_flightRecorder)
+    {
+        yError() << "[dumpFlightRecorder] The flight recorder is not enabled.";
+        return false;
+    }
+
+    // the ring is frozen by the control thread after the next record
+    m_flightRecorder->requestDump();
+    return true;
+}
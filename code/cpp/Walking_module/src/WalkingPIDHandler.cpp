@@ -19,9 +19,11 @@
 #include <yarp/dev/IRemoteVariables.h>
 #include <yarp/os/Value.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
 
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 WalkingPIDHandler::WalkingPIDHandler()
     :m_useGainScheduling(false)
@@ -30,23 +32,23 @@ WalkingPIDHandler::WalkingPIDHandler()
     ,m_previousPhase(PIDPhase::Default)
     ,m_currentPIDIndex(-1) //DEFAULT
     ,m_desiredPIDIndex(-1)
+    ,m_isActivationRequested(false)
     ,m_firmwareDelay(0.0)
     ,m_smoothingTime(1.0)
+    ,m_numberOfSwitches(0)
+    ,m_meanSwitchDuration(0.0)
+    ,m_maxSwitchDuration(0.0)
+    ,m_threadPool(nullptr)
+    ,m_isSwitchPending(false)
 {
 }
 
 WalkingPIDHandler::~WalkingPIDHandler()
 {
-    {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        m_useGainScheduling = false;
-        m_conditionVariable.notify_one();
-    }
-
-    if (m_handlerThread.joinable()){
-        m_handlerThread.join();
-        m_handlerThread = std::thread();
-    }
+    //the switch task of the pool uses the handler
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_useGainScheduling = false;
+    m_conditionVariable.wait(lock, [&]{return !m_isSwitchPending;});
 }
 
 bool WalkingPIDHandler::parsePIDGroup(const yarp::os::Bottle *group, PIDmap& pidMap)
@@ -248,7 +250,7 @@ bool WalkingPIDHandler::guessPhases(const std::deque<bool> &leftIsFixed, const s
     return true;
 }
 
-void WalkingPIDHandler::setPIDThread()
+void WalkingPIDHandler::setPIDTask()
 {
     double smoothingTime = 1.0;
     std::string name;
@@ -256,33 +258,35 @@ void WalkingPIDHandler::setPIDThread()
     bool previousWasDefault = false;
     AxisMap axisMap;
 
-    while (m_useGainScheduling){
+    while (true){
         {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_conditionVariable.wait(lock, [&]{return (((m_desiredPIDIndex != -1) && (m_desiredPIDIndex != m_currentPIDIndex)) || !m_useGainScheduling);});
-            if (m_useGainScheduling){
-
-                if (m_currentPIDIndex == -1){
-                    previousWasDefault = true;
-                    oldPIDs = m_defaultPID;
-                } else {
-                    oldPIDs = m_PIDs[static_cast<size_t>(m_currentPIDIndex)].getDesiredGains();
-                    previousWasDefault = false;
-                }
-
-                m_currentPIDIndex = m_desiredPIDIndex;
-                defaultPIDs = m_defaultPID;
-                axisMap = m_axisMap;
-                smoothingTime = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].smoothingTime();
-                desiredPIDs = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].getDesiredGains();
-                name = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].name();
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (!m_useGainScheduling || (m_desiredPIDIndex == -1) || (m_desiredPIDIndex == m_currentPIDIndex)){
+                //notified while the mutex is locked, so the handler is not destroyed before the end of the task.
+                m_isSwitchPending = false;
+                m_conditionVariable.notify_all();
+                return;
+            }
 
-                yInfo() << "Inserting " << name << " PID group.";
+            if (m_currentPIDIndex == -1){
+                previousWasDefault = true;
+                oldPIDs = m_defaultPID;
+            } else {
+                oldPIDs = m_PIDs[static_cast<size_t>(m_currentPIDIndex)].getDesiredGains();
+                previousWasDefault = false;
             }
+
+            m_currentPIDIndex = m_desiredPIDIndex;
+            defaultPIDs = m_defaultPID;
+            axisMap = m_axisMap;
+            smoothingTime = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].smoothingTime();
+            desiredPIDs = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].getDesiredGains();
+            name = m_PIDs[static_cast<size_t>(m_desiredPIDIndex)].name();
+
+            yInfo() << "Inserting " << name << " PID group.";
         }
-        if (!m_useGainScheduling)
-            break;
 
+        double switchInitTime = yarp::os::Time::now();
         if (previousWasDefault){
             if (!setPID(desiredPIDs, axisMap, smoothingTime)){
                 yError() << "Unable to set the PIDs for group " << name;
@@ -292,6 +296,14 @@ void WalkingPIDHandler::setPIDThread()
                 yError() << "Unable to set the PIDs for group " << name;
             }
         }
+        double switchDuration = yarp::os::Time::now() - switchInitTime;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_numberOfSwitches++;
+            m_meanSwitchDuration += (switchDuration - m_meanSwitchDuration) / m_numberOfSwitches;
+            m_maxSwitchDuration = std::max(m_maxSwitchDuration, switchDuration);
+        }
     }
 }
 
@@ -566,11 +578,12 @@ bool WalkingPIDHandler::isPIDElement(const yarp::os::Value &groupElement)
     return yes;
 }
 
-bool WalkingPIDHandler::initialize(const yarp::os::Bottle &PIDSettings, yarp::dev::PolyDriver &robotDriver, yarp::os::Bottle& remoteControlBords)
+bool WalkingPIDHandler::initialize(const yarp::os::Bottle &PIDSettings, yarp::dev::PolyDriver &robotDriver, yarp::os::Bottle& remoteControlBords, WalkingThreadPool& threadPool)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
     m_remoteControlBoards = remoteControlBords;
+    m_threadPool = &threadPool;
 
     m_originalPID.clear();
     m_defaultPID.clear();
@@ -633,8 +646,6 @@ bool WalkingPIDHandler::initialize(const yarp::os::Bottle &PIDSettings, yarp::de
               } else */if (!setGeneralSmoothingTime(m_smoothingTime)) {
                 yError() << "Error while setting the default smoothing time. Deactivating gain scheduling.";
                 m_useGainScheduling = false;
-            } else {
-                m_handlerThread = std::thread(&WalkingPIDHandler::setPIDThread, this);
             }
         }
 
@@ -703,14 +714,28 @@ bool WalkingPIDHandler::updatePhases(const std::deque<bool> &leftIsFixed, const
         yWarning("%s", message.str().c_str());
     }
 
+    m_isActivationRequested = desiredPIDs.size() > 0 && m_desiredPIDIndex != static_cast<int>(desiredPIDs[0]);
     if (desiredPIDs.size() > 0)
         m_desiredPIDIndex = static_cast<int>(desiredPIDs[0]);
 
-    m_conditionVariable.notify_one();
+    //the PIDs are set by a task of the thread pool. A pending task sets the latest desired group.
+    if ((m_desiredPIDIndex != -1) && (m_desiredPIDIndex != m_currentPIDIndex) && !m_isSwitchPending){
+        if (!m_threadPool->submit(TaskPriority::High, [this]{setPIDTask();})){
+            yError() << "Unable to submit the PID switch task.";
+            return false;
+        }
+        m_isSwitchPending = true;
+    }
 
     return true;
 }
 
+bool WalkingPIDHandler::isActivationRequested()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_isActivationRequested;
+}
+
 bool WalkingPIDHandler::reset()
 {
     if (m_useGainScheduling && (m_desiredPIDIndex != -1)) {
@@ -724,10 +749,27 @@ bool WalkingPIDHandler::reset()
     m_previousPhase = PIDPhase::Default;
     m_currentPIDIndex = -1; //DEFAULT
     m_desiredPIDIndex = -1;
+    m_isActivationRequested = false;
 
     return true;
 }
 
+void WalkingPIDHandler::getSwitchStatistics(int &numberOfSwitches, double &meanDuration, double &maxDuration)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    numberOfSwitches = m_numberOfSwitches;
+    meanDuration = m_meanSwitchDuration;
+    maxDuration = m_maxSwitchDuration;
+}
+
+void WalkingPIDHandler::resetSwitchStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_numberOfSwitches = 0;
+    m_meanSwitchDuration = 0.0;
+    m_maxSwitchDuration = 0.0;
+}
+
 PIDSchedulingObject::PIDSchedulingObject(const std::string &name, const PIDPhase &activationPhase, double activationOffset, const PIDmap &desiredPIDs)
     :m_name(name)
     ,m_desiredPIDs(desiredPIDs)
@@ -42,52 +42,65 @@ bool WalkingQPIK_osqp::initializeMatrices(const yarp::os::Searchable& config)
         m_comWeightMatrix.setFromConstTriplets(comWeightMatrix);
     }
 
-    tempValue = config.find("neckWeightTriplets");
-    iDynTree::Triplets neckWeightMatrix;
-    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, 3, neckWeightMatrix))
+    if(m_tasks.isNeckEnabled())
     {
-        yError() << "Initialization failed while reading neckWeightTriplets vector.";
-        return false;
+        tempValue = config.find("neckWeightTriplets");
+        iDynTree::Triplets neckWeightMatrix;
+        if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, 3, neckWeightMatrix))
+        {
+            yError() << "Initialization failed while reading neckWeightTriplets vector.";
+            return false;
+        }
+        m_neckWeightMatrix.resize(3, 3);
+        m_neckWeightMatrix.setFromConstTriplets(neckWeightMatrix);
+
+        if(!YarpHelper::getDoubleFromSearchable(config, "k_neck", m_kNeck))
+        {
+            yError() << "Initialization failed while reading k_neck.";
+            return false;
+        }
+
+        m_neckJacobian.resize(3, m_numberOfVariables);
     }
-    m_neckWeightMatrix.resize(3, 3);
-    m_neckWeightMatrix.setFromConstTriplets(neckWeightMatrix);
 
-    // set the matrix related to the joint regularization
-    tempValue = config.find("jointRegularizationWeights");
-    iDynTree::VectorDynSize jointRegularizationWeights(m_actuatedDOFs);
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationWeights))
+    if(m_tasks.isJointRegularizationEnabled())
     {
-        yError() << "Initialization failed while reading jointRegularizationWeights vector.";
-        return false;
-    }
+        // set the matrix related to the joint regularization
+        tempValue = config.find("jointRegularizationWeights");
+        iDynTree::VectorDynSize jointRegularizationWeights(m_actuatedDOFs);
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationWeights))
+        {
+            yError() << "Initialization failed while reading jointRegularizationWeights vector.";
+            return false;
+        }
+
+        //  m_jointRegulatizationHessian = H' \lamda H
+        m_jointRegulatizationHessian.resize(m_numberOfVariables, m_numberOfVariables);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationHessian(i + 6, i + 6) = jointRegularizationWeights(i);
 
-    //  m_jointRegulatizationHessian = H' \lamda H
-    m_jointRegulatizationHessian.resize(m_numberOfVariables, m_numberOfVariables);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationHessian(i + 6, i + 6) = jointRegularizationWeights(i);
+        // evaluate constant sub-matrix of the gradient matrix
+        m_jointRegulatizationGradient.resize(m_numberOfVariables, m_actuatedDOFs);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationGradient(i + 6, i) = jointRegularizationWeights(i);
 
-    // evaluate constant sub-matrix of the gradient matrix
-    m_jointRegulatizationGradient.resize(m_numberOfVariables, m_actuatedDOFs);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationGradient(i + 6, i) = jointRegularizationWeights(i);
+        tempValue = config.find("jointRegularizationGains");
+        iDynTree::VectorDynSize jointRegularizationGains(m_actuatedDOFs);
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationGains))
+        {
+            yError() << "Initialization failed while reading jointRegularizationGains vector.";
+            return false;
+        }
+        m_jointRegulatizationGains.resize(m_actuatedDOFs, m_actuatedDOFs);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationGains(i, i) = jointRegularizationGains(i);
+    }
 
     // resize matrices
     m_comJacobian.resize(3, m_numberOfVariables);
-    m_neckJacobian.resize(3, m_numberOfVariables);
     m_leftFootJacobian.resize(6, m_numberOfVariables);
     m_rightFootJacobian.resize(6, m_numberOfVariables);
 
-    tempValue = config.find("jointRegularizationGains");
-    iDynTree::VectorDynSize jointRegularizationGains(m_actuatedDOFs);
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationGains))
-    {
-        yError() << "Initialization failed while reading jointRegularizationGains vector.";
-        return false;
-    }
-    m_jointRegulatizationGains.resize(m_actuatedDOFs, m_actuatedDOFs);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationGains(i, i) = jointRegularizationGains(i);
-
     if(!YarpHelper::getDoubleFromSearchable(config, "k_posFoot", m_kPosFoot))
     {
         yError() << "Initialization failed while reading k_posFoot.";
@@ -100,12 +113,6 @@ bool WalkingQPIK_osqp::initializeMatrices(const yarp::os::Searchable& config)
         return false;
     }
 
-    if(!YarpHelper::getDoubleFromSearchable(config, "k_neck", m_kNeck))
-    {
-        yError() << "Initialization failed while reading k_neck.";
-        return false;
-    }
-
     if(!YarpHelper::getDoubleFromSearchable(config, "k_posCom", m_kCom))
     {
         yError() << "Initialization failed while reading k_posCom.";
@@ -161,6 +168,23 @@ bool WalkingQPIK_osqp::initialize(const yarp::os::Searchable& config,
 
     m_useCoMAsConstraint = config.check("useCoMAsConstraint", yarp::os::Value(false)).asBool();
 
+    // get the tasks of the cost function
+    if(!m_tasks.initialize(config))
+    {
+        yError() << "[initialize] Unable to get the tasks of the QP-IK problem.";
+        return false;
+    }
+
+    if(m_useCoMAsConstraint && !m_tasks.isNeckEnabled() && !m_tasks.isJointRegularizationEnabled())
+    {
+        yError() << "[initialize] The cost function of the QP-IK problem does not contain any task.";
+        return false;
+    }
+
+    // if the neck and the CoM are not in the cost function the hessian matrix depends only
+    // on the joint regularization
+    m_isHessianConstant = m_useCoMAsConstraint && !m_tasks.isNeckEnabled();
+
     // TODO in the future the number of constraints should be added inside
     // the configuration file
     // set the number of variables and the number of constraints
@@ -184,16 +208,19 @@ bool WalkingQPIK_osqp::initialize(const yarp::os::Searchable& config,
     m_jointPosition.resize(m_actuatedDOFs);
 
     // get the regularization term
-    yarp::os::Value jointRegularization = config.find("jointRegularization");
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(jointRegularization, m_regularizationTerm))
+    if(m_tasks.isJointRegularizationEnabled())
     {
-        yError() << "[initialize] Unable to convert a YARP list to an iDynTree::VectorDynSize, "
-                 << "joint regularization";
-        return false;
-    }
+        yarp::os::Value jointRegularization = config.find("jointRegularization");
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(jointRegularization, m_regularizationTerm))
+        {
+            yError() << "[initialize] Unable to convert a YARP list to an iDynTree::VectorDynSize, "
+                     << "joint regularization";
+            return false;
+        }
 
-    iDynTree::toEigen(m_regularizationTerm) = iDynTree::toEigen(m_regularizationTerm) *
-        iDynTree::deg2rad(1);
+        iDynTree::toEigen(m_regularizationTerm) = iDynTree::toEigen(m_regularizationTerm) *
+            iDynTree::deg2rad(1);
+    }
 
     // preprare constant matrix necessary for the QP problem
     if(!initializeMatrices(config))
@@ -215,14 +242,31 @@ bool WalkingQPIK_osqp::initialize(const yarp::os::Searchable& config,
         return false;
     }
 
-    // instantiate the solver
+    // instantiate the solver (the workspace of the previous one is freed)
     m_optimizerSolver = std::make_unique<OsqpEigen::Solver>();
+    m_solverMemory.release();
     m_optimizerSolver->data()->setNumberOfVariables(m_numberOfVariables);
     m_optimizerSolver->data()->setNumberOfConstraints(m_numberOfConstraints);
 
     m_optimizerSolver->settings()->setVerbosity(false);
     m_optimizerSolver->settings()->setLinearSystemSolver(0);
 
+    // set the solver settings (osqp_* keys, e.g. generated by the solver autotuner)
+    OsqpSettings solverSettings;
+    if(!SolverSettings::parseOsqpSettings(config, solverSettings))
+    {
+        yError() << "[initialize] Unable to get the solver settings.";
+        return false;
+    }
+
+    if(!SolverSettings::applyOsqpSettings(solverSettings, *m_optimizerSolver))
+    {
+        yError() << "[initialize] Unable to set the solver settings.";
+        return false;
+    }
+
+    m_isStructureChanged = true;
+
     return true;
 }
 
@@ -308,6 +352,11 @@ bool WalkingQPIK_osqp::setRightFootJacobian(const iDynTree::MatrixDynSize& right
 
 bool WalkingQPIK_osqp::setNeckJacobian(const iDynTree::MatrixDynSize& neckJacobian)
 {
+    if(!m_tasks.isNeckEnabled())
+    {
+        yError() << "[setNeckMJacobian] the neck task is not enabled.";
+        return false;
+    }
     if(neckJacobian.rows() != 6)
     {
         yError() << "[setNeckMJacobian] the number of rows has to be equal to 6.";
@@ -330,12 +379,22 @@ bool WalkingQPIK_osqp::setHessianMatrix()
     // evaluate the hessian matrix
     Eigen::SparseMatrix<double> hessianEigenSparse;
 
-    // in that case the hessian matrix is related only to neck orientation and to
-    // the joint angle
-    m_hessianEigenDense = Eigen::MatrixXd(iDynTree::toEigen(m_jointRegulatizationHessian)) +
-        iDynTree::toEigen(m_neckJacobian).transpose() *
-        iDynTree::toEigen(m_neckWeightMatrix) *
-        iDynTree::toEigen(m_neckJacobian);
+    // the joint regularization does not depend on the robot state, so the hessian matrix
+    // is set only the first time
+    if(m_isHessianConstant && m_optimizerSolver->isInitialized())
+        return true;
+
+    // the hessian matrix contains only the enabled tasks
+    if(m_tasks.isJointRegularizationEnabled())
+        m_hessianEigenDense = Eigen::MatrixXd(iDynTree::toEigen(m_jointRegulatizationHessian));
+    else
+        m_hessianEigenDense = Eigen::MatrixXd::Zero(m_numberOfVariables, m_numberOfVariables);
+
+    if(m_tasks.isNeckEnabled())
+    {
+        m_hessianEigenDense = m_hessianEigenDense + iDynTree::toEigen(m_neckJacobian).transpose() *
+            iDynTree::toEigen(m_neckWeightMatrix) * iDynTree::toEigen(m_neckJacobian);
+    }
 
     if(!m_useCoMAsConstraint)
     {
@@ -366,25 +425,26 @@ bool WalkingQPIK_osqp::setHessianMatrix()
 
 bool WalkingQPIK_osqp::setGradientVector()
 {
-    iDynTree::Matrix3x3 errorNeckAttitude = iDynTreeHelper::Rotation::skewSymmetric(m_neckOrientation * m_desiredNeckOrientation.inverse());
+    // the gradient vector contains only the enabled tasks
+    m_gradient.setZero();
 
-    // todo
-    if(m_useCoMAsConstraint)
+    if(!m_useCoMAsConstraint)
     {
-        m_gradient = -iDynTree::toEigen(m_neckJacobian).transpose()
-            * iDynTree::toEigen(m_neckWeightMatrix) *
-            m_kAttFoot * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)))
-            - iDynTree::toEigen(m_jointRegulatizationGradient) *
-            (iDynTree::toEigen(m_jointRegulatizationGains) * (iDynTree::toEigen(m_regularizationTerm)
-                                                              - iDynTree::toEigen(m_jointPosition)));
+        m_gradient -= iDynTree::toEigen(m_comJacobian).transpose()
+            * iDynTree::toEigen(m_comWeightMatrix) * iDynTree::toEigen(m_comVelocity);
     }
-    else
+
+    if(m_tasks.isNeckEnabled())
+    {
+        iDynTree::Matrix3x3 errorNeckAttitude = iDynTreeHelper::Rotation::skewSymmetric(m_neckOrientation * m_desiredNeckOrientation.inverse());
+
+        m_gradient -= iDynTree::toEigen(m_neckJacobian).transpose() * iDynTree::toEigen(m_neckWeightMatrix) *
+            m_kAttFoot * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)));
+    }
+
+    if(m_tasks.isJointRegularizationEnabled())
     {
-        m_gradient = -iDynTree::toEigen(m_comJacobian).transpose()
-            * iDynTree::toEigen(m_comWeightMatrix) * iDynTree::toEigen(m_comVelocity)
-            - iDynTree::toEigen(m_neckJacobian).transpose() * iDynTree::toEigen(m_neckWeightMatrix) *
-            m_kAttFoot * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)))
-            - iDynTree::toEigen(m_jointRegulatizationGradient) *
+        m_gradient -= iDynTree::toEigen(m_jointRegulatizationGradient) *
             (iDynTree::toEigen(m_jointRegulatizationGains) * (iDynTree::toEigen(m_regularizationTerm)
                                                               - iDynTree::toEigen(m_jointPosition)));
     }
@@ -598,7 +658,10 @@ bool WalkingQPIK_osqp::solve()
 
     if(!m_optimizerSolver->isInitialized())
     {
-        if(!m_optimizerSolver->initSolver())
+        m_solverMemory.beginSampling();
+        bool ok = m_optimizerSolver->initSolver();
+        m_solverMemory.endSampling();
+        if(!ok)
         {
             yError() << "[solve] Unable to initialize the solver";
             return false;
@@ -623,6 +686,62 @@ bool WalkingQPIK_osqp::solve()
     return true;
 }
 
+bool WalkingQPIK_osqp::setAccuracy(const SolverAccuracy& accuracy)
+{
+    if(m_optimizerSolver->isInitialized())
+    {
+        OSQPWorkspace* workspace = m_optimizerSolver->workspace().get();
+        if(osqp_update_eps_abs(workspace, accuracy.absoluteTolerance) != 0
+           || osqp_update_eps_rel(workspace, accuracy.relativeTolerance) != 0
+           || osqp_update_max_iter(workspace, accuracy.maxIterations) != 0)
+        {
+            yError() << "[setAccuracy] Unable to update the solver settings.";
+            return false;
+        }
+    }
+    else
+    {
+        OSQPSettings* settings = m_optimizerSolver->settings()->getSettings();
+        settings->eps_abs = accuracy.absoluteTolerance;
+        settings->eps_rel = accuracy.relativeTolerance;
+        settings->max_iter = accuracy.maxIterations;
+    }
+    return true;
+}
+
+SolverStatistics WalkingQPIK_osqp::getStatistics()
+{
+    SolverStatistics statistics;
+    if(!m_optimizerSolver->isInitialized())
+        return statistics;
+
+    const OSQPInfo* info = m_optimizerSolver->workspace()->info;
+    statistics.iterations = info->iter;
+    statistics.primalResidual = info->pri_res;
+    statistics.dualResidual = info->dua_res;
+    return statistics;
+}
+
+void WalkingQPIK_osqp::getProblem(QPProblem& problem)
+{
+    problem.hessian = m_hessianEigenDense.sparseView();
+    problem.gradient = m_gradient;
+    problem.constraintsMatrix = m_constraintsMatrixEigenDense.sparseView();
+    problem.lowerBound = m_lowerBound;
+    problem.upperBound = m_upperBound;
+    problem.hasVariableBounds = false;
+
+    problem.isStructureChanged = m_isStructureChanged;
+    m_isStructureChanged = false;
+}
+
+void WalkingQPIK_osqp::getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual)
+{
+    primal = m_optimizerSolver->getSolution();
+    const OSQPSolution* solution = m_optimizerSolver->workspace()->solution;
+    dual = Eigen::Map<const Eigen::VectorXd>(solution->y, m_constraintsMatrixEigenDense.rows());
+}
+
 bool WalkingQPIK_osqp::isSolutionFeasible()
 {
     double tolerance = 1;
@@ -684,6 +803,11 @@ bool WalkingQPIK_osqp::getRightFootError(iDynTree::VectorDynSize& output)
     return true;
 }
 
+const QPIKTaskSet& WalkingQPIK_osqp::getTaskSet() const
+{
+    return m_tasks;
+}
+
 const Eigen::MatrixXd& WalkingQPIK_osqp::getHessianMatrix() const
 {
     return m_hessianEigenDense;
@@ -6,6 +6,9 @@
  * @date 2018
  */
 
+// std
+#include <limits>
+
 // YARP
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Value.h>
@@ -41,53 +44,66 @@ bool WalkingQPIK_qpOASES::initializeMatrices(const yarp::os::Searchable& config)
         m_comWeightMatrix.setFromConstTriplets(comWeightMatrix);
     }
 
-    // get the CoM weight
-    tempValue = config.find("neckWeightTriplets");
-    iDynTree::Triplets neckWeightMatrix;
-    if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, 3, neckWeightMatrix))
+    if(m_tasks.isNeckEnabled())
     {
-        yError() << "Initialization failed while reading neckWeightTriplets vector.";
-        return false;
+        // get the neck weight
+        tempValue = config.find("neckWeightTriplets");
+        iDynTree::Triplets neckWeightMatrix;
+        if(!iDynTreeHelper::Triplets::getTripletsFromValues(tempValue, 3, neckWeightMatrix))
+        {
+            yError() << "Initialization failed while reading neckWeightTriplets vector.";
+            return false;
+        }
+        m_neckWeightMatrix.resize(3, 3);
+        m_neckWeightMatrix.setFromConstTriplets(neckWeightMatrix);
+
+        if(!YarpHelper::getDoubleFromSearchable(config, "k_neck", m_kNeck))
+        {
+            yError() << "Initialization failed while reading k_neck.";
+            return false;
+        }
+
+        m_neckJacobian.resize(3, m_numberOfVariables);
     }
-    m_neckWeightMatrix.resize(3, 3);
-    m_neckWeightMatrix.setFromConstTriplets(neckWeightMatrix);
 
-    // set the matrix related to the joint regularization
-    tempValue = config.find("jointRegularizationWeights");
-    iDynTree::VectorDynSize jointRegularizationWeights(m_actuatedDOFs);
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationWeights))
+    if(m_tasks.isJointRegularizationEnabled())
     {
-        yError() << "Initialization failed while reading neckWeightTriplets vector.";
-        return false;
-    }
+        // set the matrix related to the joint regularization
+        tempValue = config.find("jointRegularizationWeights");
+        iDynTree::VectorDynSize jointRegularizationWeights(m_actuatedDOFs);
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationWeights))
+        {
+            yError() << "Initialization failed while reading jointRegularizationWeights vector.";
+            return false;
+        }
 
-    //  m_jointRegulatizationHessian = H' \lamda H
-    m_jointRegulatizationHessian.resize(m_numberOfVariables, m_numberOfVariables);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationHessian(i + 6, i + 6) = jointRegularizationWeights(i);
+        //  m_jointRegulatizationHessian = H' \lamda H
+        m_jointRegulatizationHessian.resize(m_numberOfVariables, m_numberOfVariables);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationHessian(i + 6, i + 6) = jointRegularizationWeights(i);
 
-    // evaluate constant sub-matrix of the gradient matrix
-    m_jointRegulatizationGradient.resize(m_numberOfVariables, m_actuatedDOFs);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationGradient(i + 6, i) = jointRegularizationWeights(i);
+        // evaluate constant sub-matrix of the gradient matrix
+        m_jointRegulatizationGradient.resize(m_numberOfVariables, m_actuatedDOFs);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationGradient(i + 6, i) = jointRegularizationWeights(i);
+
+        tempValue = config.find("jointRegularizationGains");
+        iDynTree::VectorDynSize jointRegularizationGains(m_actuatedDOFs);
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationGains))
+        {
+            yError() << "Initialization failed while reading jointRegularizationGains vector.";
+            return false;
+        }
+        m_jointRegulatizationGains.resize(m_actuatedDOFs, m_actuatedDOFs);
+        for(int i = 0; i < m_actuatedDOFs; i++)
+            m_jointRegulatizationGains(i, i) = jointRegularizationGains(i);
+    }
 
     // resize matrices
     m_comJacobian.resize(3, m_numberOfVariables);
-    m_neckJacobian.resize(3, m_numberOfVariables);
     m_leftFootJacobian.resize(6, m_numberOfVariables);
     m_rightFootJacobian.resize(6, m_numberOfVariables);
 
-    tempValue = config.find("jointRegularizationGains");
-    iDynTree::VectorDynSize jointRegularizationGains(m_actuatedDOFs);
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(tempValue, jointRegularizationGains))
-    {
-        yError() << "Initialization failed while reading neckWeightTriplets vector.";
-        return false;
-    }
-    m_jointRegulatizationGains.resize(m_actuatedDOFs, m_actuatedDOFs);
-    for(int i = 0; i < m_actuatedDOFs; i++)
-        m_jointRegulatizationGains(i, i) = jointRegularizationGains(i);
-
     if(!YarpHelper::getDoubleFromSearchable(config, "k_posFoot", m_kPosFoot))
     {
         yError() << "Initialization failed while reading k_posFoot.";
@@ -100,12 +116,6 @@ bool WalkingQPIK_qpOASES::initializeMatrices(const yarp::os::Searchable& config)
         return false;
     }
 
-    if(!YarpHelper::getDoubleFromSearchable(config, "k_neck", m_kNeck))
-    {
-        yError() << "Initialization failed while reading k_neck.";
-        return false;
-    }
-
     if(!YarpHelper::getDoubleFromSearchable(config, "k_posCom", m_kCom))
     {
         yError() << "Initialization failed while reading k_posCom.";
@@ -160,6 +170,23 @@ bool WalkingQPIK_qpOASES::initialize(const yarp::os::Searchable& config,
 
     m_useCoMAsConstraint = config.check("useCoMAsConstraint", yarp::os::Value(false)).asBool();
 
+    // get the tasks of the cost function
+    if(!m_tasks.initialize(config))
+    {
+        yError() << "[initialize] Unable to get the tasks of the QP-IK problem.";
+        return false;
+    }
+
+    if(m_useCoMAsConstraint && !m_tasks.isNeckEnabled() && !m_tasks.isJointRegularizationEnabled())
+    {
+        yError() << "[initialize] The cost function of the QP-IK problem does not contain any task.";
+        return false;
+    }
+
+    // if the neck and the CoM are not in the cost function the hessian matrix depends only
+    // on the joint regularization
+    m_isHessianConstant = m_useCoMAsConstraint && !m_tasks.isNeckEnabled();
+
     // TODO in the future the number of constraints should be added inside
     // the configuration file
     // set the number of variables and the number of constraints
@@ -182,20 +209,25 @@ bool WalkingQPIK_qpOASES::initialize(const yarp::os::Searchable& config,
     m_lowerBound.resize(m_numberOfConstraints);
     m_minJointLimit.resize(m_numberOfVariables);
     m_maxJointLimit.resize(m_numberOfVariables);
+    m_primalSolution.resize(m_numberOfVariables);
+    m_dualSolution.resize(m_numberOfVariables + m_numberOfConstraints);
     m_regularizationTerm.resize(m_actuatedDOFs);
     m_jointPosition.resize(m_actuatedDOFs);
 
     // get the regularization term
-    yarp::os::Value jointRegularization = config.find("jointRegularization");
-    if(!YarpHelper::yarpListToiDynTreeVectorDynSize(jointRegularization, m_regularizationTerm))
+    if(m_tasks.isJointRegularizationEnabled())
     {
-        yError() << "[initialize] Unable to convert a YARP list to an iDynTree::VectorDynSize, "
-                 << "joint regularization";
-        return false;
-    }
+        yarp::os::Value jointRegularization = config.find("jointRegularization");
+        if(!YarpHelper::yarpListToiDynTreeVectorDynSize(jointRegularization, m_regularizationTerm))
+        {
+            yError() << "[initialize] Unable to convert a YARP list to an iDynTree::VectorDynSize, "
+                     << "joint regularization";
+            return false;
+        }
 
-    iDynTree::toEigen(m_regularizationTerm) = iDynTree::toEigen(m_regularizationTerm) *
-        iDynTree::deg2rad(1);
+        iDynTree::toEigen(m_regularizationTerm) = iDynTree::toEigen(m_regularizationTerm) *
+            iDynTree::deg2rad(1);
+    }
 
     // preprare constant matrix necessary for the QP problem
     if(!initializeMatrices(config))
@@ -223,7 +255,23 @@ bool WalkingQPIK_qpOASES::initialize(const yarp::os::Searchable& config,
 
     m_optimizer->setPrintLevel(qpOASES::PL_LOW);
 
+    // set the solver settings (qpoases_* keys, e.g. generated by the solver autotuner)
+    QpOASESSettings solverSettings;
+    if(!SolverSettings::parseQpOASESSettings(config, solverSettings))
+    {
+        yError() << "[initialize] Unable to get the solver settings.";
+        return false;
+    }
+
+    if(!SolverSettings::applyQpOASESSettings(solverSettings, *m_optimizer))
+    {
+        yError() << "[initialize] Unable to set the solver settings.";
+        return false;
+    }
+
+    m_maxWorkingSetRecalculations = solverSettings.maxWorkingSetRecalculations;
     m_isFirstTime = true;
+    m_isStructureChanged = true;
     return true;
 }
 
@@ -310,6 +358,11 @@ bool WalkingQPIK_qpOASES::setRightFootJacobian(const iDynTree::MatrixDynSize& ri
 
 bool WalkingQPIK_qpOASES::setNeckJacobian(const iDynTree::MatrixDynSize& neckJacobian)
 {
+    if(!m_tasks.isNeckEnabled())
+    {
+        yError() << "[setNeckMJacobian] the neck task is not enabled.";
+        return false;
+    }
     if(neckJacobian.rows() != 6)
     {
         yError() << "[setNeckMJacobian] the number of rows has to be equal to 6.";
@@ -329,18 +382,27 @@ bool WalkingQPIK_qpOASES::setNeckJacobian(const iDynTree::MatrixDynSize& neckJac
 
 bool WalkingQPIK_qpOASES::setHessianMatrix()
 {
-    // evaluate the hessian matrix
-    Eigen::Map<MatrixXd>(m_hessian.data(), m_numberOfVariables, m_numberOfVariables) =
-        MatrixXd(iDynTree::toEigen(m_jointRegulatizationHessian)) +
-        iDynTree::toEigen(m_neckJacobian).transpose() *
-        iDynTree::toEigen(m_neckWeightMatrix) *
-        iDynTree::toEigen(m_neckJacobian);
+    // the joint regularization does not depend on the robot state, so the hessian matrix
+    // is evaluated only the first time
+    if(m_isHessianConstant && !m_isFirstTime)
+        return true;
+
+    // evaluate the hessian matrix (it contains only the enabled tasks)
+    Eigen::Map<MatrixXd> hessian(m_hessian.data(), m_numberOfVariables, m_numberOfVariables);
+    if(m_tasks.isJointRegularizationEnabled())
+        hessian = MatrixXd(iDynTree::toEigen(m_jointRegulatizationHessian));
+    else
+        hessian.setZero();
+
+    if(m_tasks.isNeckEnabled())
+    {
+        hessian = hessian + iDynTree::toEigen(m_neckJacobian).transpose() *
+            iDynTree::toEigen(m_neckWeightMatrix) * iDynTree::toEigen(m_neckJacobian);
+    }
 
     if(!m_useCoMAsConstraint)
     {
-        Eigen::Map<MatrixXd>(m_hessian.data(), m_numberOfVariables, m_numberOfVariables) =
-            Eigen::Map<MatrixXd>(m_hessian.data(), m_numberOfVariables, m_numberOfVariables) +
-            iDynTree::toEigen(m_comJacobian).transpose() *
+        hessian = hessian + iDynTree::toEigen(m_comJacobian).transpose() *
             iDynTree::toEigen(m_comWeightMatrix) * iDynTree::toEigen(m_comJacobian);
     }
 
@@ -349,26 +411,27 @@ bool WalkingQPIK_qpOASES::setHessianMatrix()
 
 bool WalkingQPIK_qpOASES::setGradientVector()
 {
-    iDynTree::Matrix3x3 errorNeckAttitude = iDynTreeHelper::Rotation::skewSymmetric(m_neckOrientation * m_desiredNeckOrientation.inverse());
+    // the gradient vector contains only the enabled tasks
+    Eigen::Map<Eigen::VectorXd> gradient(m_gradient.data(), m_numberOfVariables);
+    gradient.setZero();
 
-    if(m_useCoMAsConstraint)
+    if(!m_useCoMAsConstraint)
     {
-        Eigen::Map<MatrixXd>(m_gradient.data(), m_numberOfVariables, 1) =
-            -iDynTree::toEigen(m_neckJacobian).transpose()
-            * iDynTree::toEigen(m_neckWeightMatrix)
-            * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)))
-            - iDynTree::toEigen(m_jointRegulatizationGradient) *
-            (iDynTree::toEigen(m_jointRegulatizationGains) * (iDynTree::toEigen(m_regularizationTerm)
-                                                              - iDynTree::toEigen(m_jointPosition)));
+        gradient -= iDynTree::toEigen(m_comJacobian).transpose()
+            * iDynTree::toEigen(m_comWeightMatrix) * iDynTree::toEigen(m_comVelocity);
     }
-    else
+
+    if(m_tasks.isNeckEnabled())
     {
-        Eigen::Map<MatrixXd>(m_gradient.data(), m_numberOfVariables, 1)
-            = -iDynTree::toEigen(m_comJacobian).transpose()
-            * iDynTree::toEigen(m_comWeightMatrix) * iDynTree::toEigen(m_comVelocity)
-            - iDynTree::toEigen(m_neckJacobian).transpose() * iDynTree::toEigen(m_neckWeightMatrix)
-            * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)))
-            - iDynTree::toEigen(m_jointRegulatizationGradient) *
+        iDynTree::Matrix3x3 errorNeckAttitude = iDynTreeHelper::Rotation::skewSymmetric(m_neckOrientation * m_desiredNeckOrientation.inverse());
+
+        gradient -= iDynTree::toEigen(m_neckJacobian).transpose() * iDynTree::toEigen(m_neckWeightMatrix)
+            * (-m_kNeck * iDynTree::unskew(iDynTree::toEigen(errorNeckAttitude)));
+    }
+
+    if(m_tasks.isJointRegularizationEnabled())
+    {
+        gradient -= iDynTree::toEigen(m_jointRegulatizationGradient) *
             (iDynTree::toEigen(m_jointRegulatizationGains) * (iDynTree::toEigen(m_regularizationTerm)
                                                               - iDynTree::toEigen(m_jointPosition)));
     }
@@ -541,7 +604,7 @@ bool WalkingQPIK_qpOASES::solve()
         return false;
     }
 
-    int nWSR = 100;
+    int nWSR = m_maxWorkingSetRecalculations;
 
     if(!m_isFirstTime)
     {
@@ -567,9 +630,91 @@ bool WalkingQPIK_qpOASES::solve()
     }
     m_isSolutionEvaluated = true;
 
+    // evaluate the statistics of the solution (nWSR contains the performed recalculations)
+    m_statistics.iterations = nWSR;
+    if(!m_isResidualRequired)
+    {
+        // NaN means that the residuals are not evaluated (0 would be a valid residual)
+        m_statistics.primalResidual = std::numeric_limits<double>::quiet_NaN();
+        m_statistics.dualResidual = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+
+    m_optimizer->getPrimalSolution(m_primalSolution.data());
+    m_optimizer->getDualSolution(m_dualSolution.data());
+
+    double stationarity, feasibility, complementarity;
+    qpOASES::getKktViolation(m_numberOfVariables, m_numberOfConstraints,
+                             m_hessian.data(), m_gradient.data(), m_constraintMatrix.data(),
+                             m_minJointLimit.data(), m_maxJointLimit.data(),
+                             m_upperBound.data(), m_lowerBound.data(),
+                             m_primalSolution.data(), m_dualSolution.data(),
+                             stationarity, feasibility, complementarity);
+
+    m_statistics.primalResidual = feasibility;
+    m_statistics.dualResidual = stationarity;
+
+    return true;
+}
+
+bool WalkingQPIK_qpOASES::setAccuracy(const SolverAccuracy& accuracy)
+{
+    // the absolute tolerance is the osqp eps_abs, it has a different meaning from
+    // the termination tolerance of qpOASES, which is left unchanged
+    m_maxWorkingSetRecalculations = accuracy.maxWorkingSetRecalculations;
     return true;
 }
 
+void WalkingQPIK_qpOASES::getProblem(QPProblem& problem)
+{
+    typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> MatrixMap;
+    typedef Eigen::Map<const Eigen::VectorXd> VectorMap;
+
+    problem.hessian = MatrixMap(m_hessian.data(), m_numberOfVariables, m_numberOfVariables).sparseView();
+    problem.gradient = VectorMap(m_gradient.data(), m_numberOfVariables);
+
+    // please note that the solver takes m_upperBound as lower bound and m_lowerBound as
+    // upper bound of the constraints
+    problem.constraintsMatrix = MatrixMap(m_constraintMatrix.data(), m_numberOfConstraints,
+                                          m_numberOfVariables).sparseView();
+    problem.lowerBound = VectorMap(m_upperBound.data(), m_numberOfConstraints);
+    problem.upperBound = VectorMap(m_lowerBound.data(), m_numberOfConstraints);
+
+    // the joint limits are the bounds of the variables
+    problem.hasVariableBounds = true;
+    problem.lowerVariableBound = VectorMap(m_minJointLimit.data(), m_numberOfVariables);
+    problem.upperVariableBound = VectorMap(m_maxJointLimit.data(), m_numberOfVariables);
+
+    problem.isStructureChanged = m_isStructureChanged;
+    m_isStructureChanged = false;
+}
+
+void WalkingQPIK_qpOASES::getCheckpoint(Eigen::VectorXd& primal, Eigen::VectorXd& dual)
+{
+    primal.resize(m_numberOfVariables);
+    m_optimizer->getPrimalSolution(primal.data());
+
+    // qpOASES stores the multipliers of the bounds (joint limits) before the ones of the
+    // constraints, as the recorded problem
+    dual.resize(m_numberOfVariables + m_numberOfConstraints);
+    m_optimizer->getDualSolution(dual.data());
+}
+
+SolverStatistics WalkingQPIK_qpOASES::getStatistics()
+{
+    return m_statistics;
+}
+
+void WalkingQPIK_qpOASES::setResidualRequired(const bool& isResidualRequired)
+{
+    m_isResidualRequired = isResidualRequired;
+}
+
+const QPIKTaskSet& WalkingQPIK_qpOASES::getTaskSet() const
+{
+    return m_tasks;
+}
+
 bool WalkingQPIK_qpOASES::getSolution(iDynTree::VectorDynSize& output)
 {
     if(!m_isSolutionEvaluated)
@@ -0,0 +1,271 @@
+/**
+ * @file WalkingStageGraph.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <chrono>
+
+// YARP
+#include <yarp/os/LogStream.h>
+
+#include "ThreadTelemetry.hpp"
+#include "WalkingStageGraph.hpp"
+
+WalkingStageGraph::~WalkingStageGraph()
+{
+    close();
+}
+
+bool WalkingStageGraph::addStage(const std::string& name, const std::vector<std::string>& dependencies,
+                                 const std::function<bool()>& function,
+                                 const std::vector<std::string>& reads,
+                                 const std::vector<std::string>& writes)
+{
+    if(!m_levels.empty())
+    {
+        yError() << "[addStage] The stages cannot be added after the initialization.";
+        return false;
+    }
+
+    auto isNamed = [](const std::string& stageName)
+        {
+            return [&stageName](const Stage& stage){return stage.name == stageName;};
+        };
+
+    if(std::find_if(m_stages.begin(), m_stages.end(), isNamed(name)) != m_stages.end())
+    {
+        yError() << "[addStage] The stage" << name << "already exists.";
+        return false;
+    }
+
+    Stage stage;
+    stage.name = name;
+    stage.function = function;
+    stage.reads = reads;
+    stage.writes = writes;
+    for(const auto& dependency : dependencies)
+    {
+        auto it = std::find_if(m_stages.begin(), m_stages.end(), isNamed(dependency));
+        if(it == m_stages.end())
+        {
+            yError() << "[addStage] The stage" << name << "depends on the unknown stage" << dependency;
+            return false;
+        }
+        stage.dependencies.push_back(std::distance(m_stages.begin(), it));
+        stage.level = std::max(stage.level, it->level + 1);
+    }
+
+    m_stages.push_back(stage);
+    return true;
+}
+
+bool WalkingStageGraph::initialize(const int& workers)
+{
+    if(m_stages.empty())
+    {
+        yError() << "[initialize] The graph does not contain any stage.";
+        return false;
+    }
+
+    if(workers < 0)
+    {
+        yError() << "[initialize] The number of workers cannot be negative.";
+        return false;
+    }
+
+    // the dependencies are added before the stage, so the levels are already sorted
+    for(std::size_t i = 0; i < m_stages.size(); i++)
+    {
+        // the level is never negative
+        std::size_t level = static_cast<std::size_t>(m_stages[i].level);
+        if(level >= m_levels.size())
+            m_levels.resize(level + 1);
+        m_levels[level].push_back(static_cast<int>(i));
+    }
+
+    // the check does not depend on the number of workers, so a race is detected also
+    // when the stages are run by the calling thread
+    for(const auto& level : m_levels)
+        for(std::size_t i = 0; i < level.size(); i++)
+            for(std::size_t j = i + 1; j < level.size(); j++)
+                if(!checkDataRace(m_stages[level[i]], m_stages[level[j]]))
+                {
+                    m_levels.clear();
+                    return false;
+                }
+
+    m_isRunning = true;
+    for(int i = 0; i < workers; i++)
+        m_workers.emplace_back(&WalkingStageGraph::workerThread, this, i);
+
+    return true;
+}
+
+bool WalkingStageGraph::checkDataRace(const Stage& first, const Stage& second) const
+{
+    auto isAccessed = [](const std::string& data, const Stage& stage)
+        {
+            return std::find(stage.reads.begin(), stage.reads.end(), data) != stage.reads.end()
+                || std::find(stage.writes.begin(), stage.writes.end(), data) != stage.writes.end();
+        };
+
+    for(const auto& data : first.writes)
+        if(isAccessed(data, second))
+        {
+            yError() << "[checkDataRace] The stages" << first.name << "and" << second.name
+                     << "may run concurrently, but" << first.name << "writes" << data;
+            return false;
+        }
+
+    for(const auto& data : second.writes)
+        if(isAccessed(data, first))
+        {
+            yError() << "[checkDataRace] The stages" << first.name << "and" << second.name
+                     << "may run concurrently, but" << second.name << "writes" << data;
+            return false;
+        }
+
+    return true;
+}
+
+void WalkingStageGraph::runStage(const int& index)
+{
+    Stage& stage = m_stages[index];
+
+    auto initTime = std::chrono::steady_clock::now();
+    stage.isOk = stage.function();
+    stage.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - initTime).count();
+
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+    stage.histogram.add(stage.duration);
+}
+
+void WalkingStageGraph::runLevelStages()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_currentLevel != nullptr && m_nextStage < m_currentLevel->size())
+    {
+        int index = (*m_currentLevel)[m_nextStage++];
+
+        lock.unlock();
+        runStage(index);
+        lock.lock();
+
+        if(--m_pendingStages == 0)
+            m_levelCompleted.notify_one();
+    }
+}
+
+void WalkingStageGraph::workerThread(const int worker)
+{
+    ThreadTelemetry::setCurrentThreadName("stage" + std::to_string(worker));
+
+    unsigned long generation = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_levelStarted.wait(lock, [&]{return !m_isRunning || m_generation != generation;});
+        if(!m_isRunning)
+            return;
+
+        generation = m_generation;
+        lock.unlock();
+        runLevelStages();
+        lock.lock();
+    }
+}
+
+bool WalkingStageGraph::run()
+{
+    for(const auto& level : m_levels)
+    {
+        if(level.size() == 1 || m_workers.empty())
+        {
+            for(const auto& index : level)
+                runStage(index);
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_currentLevel = &level;
+                m_nextStage = 0;
+                m_pendingStages = level.size();
+                m_generation++;
+            }
+            m_levelStarted.notify_all();
+
+            // the calling thread runs the stages as well
+            runLevelStages();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_levelCompleted.wait(lock, [this]{return m_pendingStages == 0;});
+            m_currentLevel = nullptr;
+        }
+
+        for(const auto& index : level)
+        {
+            if(!m_stages[index].isOk)
+            {
+                yError() << "[run] The stage" << m_stages[index].name << "failed.";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+double WalkingStageGraph::getDuration(const std::string& name) const
+{
+    for(const auto& stage : m_stages)
+        if(stage.name == name)
+            return stage.duration;
+    return 0.0;
+}
+
+void WalkingStageGraph::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+    }
+    m_levelStarted.notify_all();
+
+    for(auto& worker : m_workers)
+        if(worker.joinable())
+            worker.join();
+    m_workers.clear();
+}
+
+void WalkingStageGraph::resetStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+    for(auto& stage : m_stages)
+        stage.histogram.reset();
+}
+
+void WalkingStageGraph::toBottle(yarp::os::Bottle& bottle)
+{
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+
+    // (stages ((name (level l) (count n) (mean_ms m) ...) ...))
+    yarp::os::Bottle& stages = bottle.addList();
+    stages.addString("stages");
+    yarp::os::Bottle& stagesList = stages.addList();
+    for(const auto& stage : m_stages)
+    {
+        yarp::os::Bottle& entry = stagesList.addList();
+        entry.addString(stage.name);
+        yarp::os::Bottle& list = entry.addList();
+        yarp::os::Bottle& level = list.addList();
+        level.addString("level");
+        level.addInt(stage.level);
+        stage.histogram.toBottle(list);
+    }
+}
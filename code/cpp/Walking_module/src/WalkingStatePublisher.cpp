@@ -0,0 +1,156 @@
+/**
+ * @file WalkingStatePublisher.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <chrono>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "ThreadTelemetry.hpp"
+#include "WalkingStatePublisher.hpp"
+
+namespace
+{
+    /**
+     * Add a pose (position and roll-pitch-yaw angles) to a bottle.
+     */
+    void addPose(const iDynTree::Transform& transform, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& list = bottle.addList();
+        iDynTree::Position position = transform.getPosition();
+        iDynTree::Vector3 rpy = transform.getRotation().asRPY();
+        for(unsigned i = 0; i < 3; i++)
+            list.addDouble(position(i));
+        for(unsigned i = 0; i < 3; i++)
+            list.addDouble(rpy(i));
+    }
+}
+
+WalkingStatePublisher::~WalkingStatePublisher()
+{
+    close();
+}
+
+bool WalkingStatePublisher::initialize(const yarp::os::Searchable& config, const std::string& portPrefix)
+{
+    m_period = config.check("period", yarp::os::Value(0.05)).asDouble();
+    if(m_period <= 0)
+    {
+        yError() << "[initialize] The period of the state publisher has to be positive.";
+        return false;
+    }
+
+    std::string portName = config.check("port_name", yarp::os::Value("/state:o")).asString();
+    if(!m_port.open(portPrefix + portName))
+    {
+        yError() << "[initialize] Unable to open the port " << portPrefix + portName;
+        return false;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&WalkingStatePublisher::publisherThread, this);
+    return true;
+}
+
+WalkingStateSnapshot& WalkingStatePublisher::getSnapshot()
+{
+    return m_buffer.getWriteBuffer();
+}
+
+void WalkingStatePublisher::publish()
+{
+    m_buffer.getWriteBuffer().tick = m_tick++;
+    m_buffer.publish();
+}
+
+void WalkingStatePublisher::publisherThread()
+{
+    ThreadTelemetry::setCurrentThreadName("publisher");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_isRunning)
+    {
+        m_conditionVariable.wait_for(lock, std::chrono::duration<double>(m_period));
+        if(!m_isRunning)
+            break;
+
+        // the snapshot is sent only if the control thread published a new one
+        if(!m_buffer.update())
+            continue;
+
+        const WalkingStateSnapshot& snapshot = m_buffer.getReadBuffer();
+        yarp::os::Bottle& bottle = m_port.prepare();
+        bottle.clear();
+
+        yarp::os::Bottle& status = bottle.addList();
+        status.addInt(static_cast<int>(snapshot.tick));
+        status.addDouble(snapshot.time);
+        status.addInt(snapshot.robotState);
+        status.addInt(snapshot.isSteadyState);
+
+        yarp::os::Bottle& dcm = bottle.addList();
+        dcm.addDouble(snapshot.measuredDCM(0));
+        dcm.addDouble(snapshot.measuredDCM(1));
+        dcm.addDouble(snapshot.desiredDCM(0));
+        dcm.addDouble(snapshot.desiredDCM(1));
+
+        yarp::os::Bottle& zmp = bottle.addList();
+        zmp.addDouble(snapshot.measuredZMP(0));
+        zmp.addDouble(snapshot.measuredZMP(1));
+        zmp.addDouble(snapshot.desiredZMP(0));
+        zmp.addDouble(snapshot.desiredZMP(1));
+
+        yarp::os::Bottle& com = bottle.addList();
+        com.addDouble(snapshot.measuredCoM(0));
+        com.addDouble(snapshot.measuredCoM(1));
+        com.addDouble(snapshot.measuredCoM(2));
+        com.addDouble(snapshot.desiredCoM(0));
+        com.addDouble(snapshot.desiredCoM(1));
+
+        addPose(snapshot.leftFoot, bottle);
+        addPose(snapshot.rightFoot, bottle);
+        addPose(snapshot.desiredLeftFoot, bottle);
+        addPose(snapshot.desiredRightFoot, bottle);
+
+        yarp::os::Bottle& solvers = bottle.addList();
+        solvers.addInt(snapshot.solverPhase);
+        solvers.addInt(snapshot.mpcStatistics.iterations);
+        solvers.addDouble(snapshot.mpcStatistics.primalResidual);
+        solvers.addDouble(snapshot.mpcStatistics.dualResidual);
+        solvers.addInt(snapshot.ikStatistics.iterations);
+        solvers.addDouble(snapshot.ikStatistics.primalResidual);
+        solvers.addDouble(snapshot.ikStatistics.dualResidual);
+
+        yarp::os::Bottle& timings = bottle.addList();
+        timings.addDouble(snapshot.tickDuration);
+
+        // the port is not strict, a slow reader does not slow down the publisher
+        lock.unlock();
+        m_port.write();
+        lock.lock();
+    }
+}
+
+void WalkingStatePublisher::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+        m_conditionVariable.notify_all();
+    }
+
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+        m_thread = std::thread();
+    }
+
+    m_port.close();
+}
@@ -0,0 +1,229 @@
+/**
+ * @file WalkingStatistics.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <vector>
+
+#include "WalkingStatistics.hpp"
+
+namespace
+{
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const int& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addInt(value);
+    }
+
+    void addEntry(const std::string& key, const double& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addDouble(value);
+    }
+
+    void addEntry(const std::string& key, const std::string& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addString(value);
+    }
+
+    /**
+     * Names of the events of a tick separated by '+' ("none" if there are no events).
+     */
+    std::string eventsToString(const unsigned int& events)
+    {
+        const std::vector<std::pair<unsigned int, std::string>> names{
+            {WalkingEvent::Merge, "merge"},
+            {WalkingEvent::ContactSwitch, "contact_switch"},
+            {WalkingEvent::PIDActivation, "pid_activation"},
+            {WalkingEvent::PlannerRequest, "planner_request"},
+            {WalkingEvent::FirstTick, "first_tick"}};
+
+        std::string output;
+        for(const auto& name : names)
+        {
+            if(events & name.first)
+                output += (output.empty() ? "" : "+") + name.second;
+        }
+        return output.empty() ? "none" : output;
+    }
+
+    /**
+     * Add a (key (histogram)) list to a bottle.
+     */
+    void addHistogram(const std::string& key, const LatencyHistogram& histogram, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        histogram.toBottle(entry.addList());
+    }
+
+    /**
+     * Add a (key (counters)) list to a bottle.
+     */
+    void addCounters(const std::string& key, const SolverCounters& counters, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        yarp::os::Bottle& list = entry.addList();
+        addEntry("solves", counters.solves, list);
+        addEntry("skipped", counters.skipped, list);
+        addEntry("mean_iterations", counters.solves > 0 ?
+                 static_cast<double>(counters.iterations) / counters.solves : 0.0, list);
+        addEntry("max_iterations", counters.maxIterations, list);
+    }
+
+    /**
+     * Update the counters of a solver.
+     */
+    void updateCounters(const bool& isSolved, const bool& isSkipped,
+                        const SolverStatistics& statistics, SolverCounters& counters)
+    {
+        if(isSkipped)
+            counters.skipped++;
+
+        if(!isSolved)
+            return;
+
+        counters.solves++;
+        counters.iterations += statistics.iterations;
+        counters.maxIterations = std::max(counters.maxIterations, statistics.iterations);
+    }
+}
+
+const std::array<double, 11> LatencyHistogram::s_bounds{{0.0005, 0.001, 0.002, 0.003, 0.004, 0.005,
+                                                        0.0075, 0.01, 0.015, 0.02, 0.05}};
+
+LatencyHistogram::LatencyHistogram()
+{
+    m_bins.fill(0);
+}
+
+void LatencyHistogram::add(const double& duration)
+{
+    auto bin = std::lower_bound(s_bounds.begin(), s_bounds.end(), duration);
+    m_bins[std::distance(s_bounds.begin(), bin)]++;
+
+    m_count++;
+    m_sum += duration;
+    m_max = std::max(m_max, duration);
+}
+
+void LatencyHistogram::reset()
+{
+    m_bins.fill(0);
+    m_count = 0;
+    m_sum = 0.0;
+    m_max = 0.0;
+}
+
+int LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+void LatencyHistogram::toBottle(yarp::os::Bottle& bottle) const
+{
+    addEntry("count", m_count, bottle);
+    addEntry("mean_ms", m_count > 0 ? m_sum / m_count * 1e3 : 0.0, bottle);
+    addEntry("max_ms", m_max * 1e3, bottle);
+
+    yarp::os::Bottle& bounds = bottle.addList();
+    bounds.addString("bounds_ms");
+    yarp::os::Bottle& boundsList = bounds.addList();
+    for(const auto& bound : s_bounds)
+        boundsList.addDouble(bound * 1e3);
+
+    yarp::os::Bottle& bins = bottle.addList();
+    bins.addString("bins");
+    yarp::os::Bottle& binsList = bins.addList();
+    for(const auto& bin : m_bins)
+        binsList.addInt(bin);
+}
+
+void WalkingStatistics::update(const WalkingTickStatistics& tick)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    m_counters.ticks++;
+    if(tick.totalDuration > tick.period)
+        m_counters.overruns++;
+
+    m_counters.total.add(tick.totalDuration);
+    m_counters.feedback.add(tick.feedbackDuration);
+    m_counters.mpc.add(tick.mpcDuration);
+    m_counters.ik.add(tick.ikDuration);
+
+    updateCounters(tick.isMPCSolved, tick.isSteadyState, tick.mpcStatistics, m_counters.mpcCounters);
+    updateCounters(tick.isIKSolved, tick.isSteadyState, tick.ikStatistics, m_counters.ikCounters);
+
+    if(tick.isMerged)
+    {
+        m_counters.merges++;
+        m_counters.planner.add(tick.plannerDuration);
+    }
+
+    EventLatency& eventLatency = m_counters.events[tick.events % WalkingEvent::NumberOfCombinations];
+    eventLatency.total.add(tick.totalDuration);
+    eventLatency.mpc.add(tick.mpcDuration);
+    eventLatency.ik.add(tick.ikDuration);
+}
+
+void WalkingStatistics::reset()
+{
+    Counters counters;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_counters = counters;
+}
+
+void WalkingStatistics::toBottle(yarp::os::Bottle& bottle)
+{
+    // the counters are copied under the mutex, so update() is never blocked by the formatting
+    Counters counters;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        counters = m_counters;
+    }
+
+    addEntry("ticks", counters.ticks, bottle);
+    addEntry("overruns", counters.overruns, bottle);
+    addHistogram("total", counters.total, bottle);
+    addHistogram("feedback", counters.feedback, bottle);
+    addHistogram("mpc", counters.mpc, bottle);
+    addHistogram("ik", counters.ik, bottle);
+    addCounters("mpc_solver", counters.mpcCounters, bottle);
+    addCounters("ik_solver", counters.ikCounters, bottle);
+    addEntry("merges", counters.merges, bottle);
+    addHistogram("planner", counters.planner, bottle);
+
+    // (events ((events name) (mask m) (total (...)) (mpc (...)) (ik (...))) ...)
+    yarp::os::Bottle& events = bottle.addList();
+    events.addString("events");
+    yarp::os::Bottle& eventsList = events.addList();
+    for(unsigned int mask = 0; mask < counters.events.size(); mask++)
+    {
+        // only the combinations that happened are reported
+        const EventLatency& eventLatency = counters.events[mask];
+        if(eventLatency.total.getCount() == 0)
+            continue;
+
+        yarp::os::Bottle& combination = eventsList.addList();
+        addEntry("events", eventsToString(mask), combination);
+        addEntry("mask", static_cast<int>(mask), combination);
+        addHistogram("total", eventLatency.total, combination);
+        addHistogram("mpc", eventLatency.mpc, combination);
+        addHistogram("ik", eventLatency.ik, combination);
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * @file WalkingThreadPool.cpp
+ * @authors Giulio Romualdi <giulio.romualdi@iit.it>
+ * @copyright 2018 iCub Facility - Istituto Italiano di Tecnologia
+ *            Released under the terms of the LGPLv2.1 or later, see LGPL.TXT
+ * @date 2018
+ */
+
+// std
+#include <algorithm>
+#include <string>
+
+// YARP
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include "ThreadTelemetry.hpp"
+#include "WalkingThreadPool.hpp"
+
+namespace
+{
+    const int numberOfPriorities = static_cast<int>(TaskPriority::NumberOfPriorities);
+
+    const char* priorityNames[numberOfPriorities] = {"high", "low"};
+
+    /**
+     * Pool and index of the worker running in the calling thread (nullptr and -1 outside the workers).
+     */
+    thread_local const WalkingThreadPool* currentPool = nullptr;
+    thread_local int currentWorker = -1;
+
+    /**
+     * Add a (key value) list to a bottle.
+     */
+    void addEntry(const std::string& key, const int& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addInt(value);
+    }
+
+    void addEntry(const std::string& key, const double& value, yarp::os::Bottle& bottle)
+    {
+        yarp::os::Bottle& entry = bottle.addList();
+        entry.addString(key);
+        entry.addDouble(value);
+    }
+}
+
+WalkingThreadPool::~WalkingThreadPool()
+{
+    close();
+}
+
+bool WalkingThreadPool::initialize(const yarp::os::Searchable& config)
+{
+    int workers = config.check("workers", yarp::os::Value(2)).asInt();
+    if(workers < 1)
+    {
+        yError() << "[initialize] The thread pool requires at least one worker.";
+        return false;
+    }
+
+    m_maxQueuedTasks = config.check("max_queued_tasks", yarp::os::Value(64)).asInt();
+    if(m_maxQueuedTasks < 1)
+    {
+        yError() << "[initialize] The maximum number of queued tasks has to be positive.";
+        return false;
+    }
+
+    // the workers are bound to the CPUs in cpu_affinity (e.g. the ones not used by the control thread)
+    if(!m_workerSettings.initialize(config))
+    {
+        yError() << "[initialize] Unable to read the settings of the workers.";
+        return false;
+    }
+
+    m_isRunning = true;
+    for(int i = 0; i < workers; i++)
+        m_workers.push_back(std::make_unique<Worker>());
+    for(int i = 0; i < workers; i++)
+        m_workers[i]->thread = std::thread(&WalkingThreadPool::workerThread, this, i);
+
+    return true;
+}
+
+bool WalkingThreadPool::submit(const TaskPriority& priority, const std::function<void()>& task)
+{
+    int priorityIndex = static_cast<int>(priority);
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if(m_isRunning && m_queuedTasks < m_maxQueuedTasks)
+        {
+            // a worker keeps the tasks it submits, the other tasks are distributed
+            int worker = currentPool == this ? currentWorker : m_nextWorker++ % m_workers.size();
+            {
+                std::lock_guard<std::mutex> workerGuard(m_workers[worker]->mutex);
+                m_workers[worker]->queues[priorityIndex].push_back({task, std::chrono::steady_clock::now()});
+            }
+            m_queuedTasks++;
+            m_conditionVariable.notify_one();
+
+            std::lock_guard<std::mutex> statisticsGuard(m_statisticsMutex);
+            m_counters[priorityIndex].submitted++;
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> statisticsGuard(m_statisticsMutex);
+    m_counters[priorityIndex].rejected++;
+    return false;
+}
+
+bool WalkingThreadPool::takeTask(const int& worker, Task& task, TaskPriority& priority, bool& isStolen)
+{
+    for(int priorityIndex = 0; priorityIndex < numberOfPriorities; priorityIndex++)
+    {
+        // the own queue is visited first
+        for(int i = 0; i < m_workers.size(); i++)
+        {
+            int victim = (worker + i) % m_workers.size();
+            std::lock_guard<std::mutex> guard(m_workers[victim]->mutex);
+            std::deque<Task>& queue = m_workers[victim]->queues[priorityIndex];
+            if(queue.empty())
+                continue;
+
+            // the oldest own task is taken, while the newest task of the others is stolen
+            isStolen = victim != worker;
+            if(isStolen)
+            {
+                task = std::move(queue.back());
+                queue.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            priority = static_cast<TaskPriority>(priorityIndex);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WalkingThreadPool::workerThread(const int worker)
+{
+    ThreadTelemetry::setCurrentThreadName("pool" + std::to_string(worker));
+    currentPool = this;
+    currentWorker = worker;
+
+    if(m_workerSettings.isEnabled() && !m_workerSettings.apply())
+        yError() << "[workerThread] Unable to apply the settings of the worker" << worker;
+
+    while(true)
+    {
+        Task task;
+        TaskPriority priority;
+        bool isStolen;
+        if(takeTask(worker, task, priority, isStolen))
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_queuedTasks--;
+            }
+
+            auto initTime = std::chrono::steady_clock::now();
+            task.function();
+            auto endTime = std::chrono::steady_clock::now();
+
+            double waitDuration = std::chrono::duration<double>(initTime - task.submissionTime).count();
+            double runDuration = std::chrono::duration<double>(endTime - initTime).count();
+
+            std::lock_guard<std::mutex> guard(m_statisticsMutex);
+            TaskCounters& counters = m_counters[static_cast<int>(priority)];
+            counters.executed++;
+            if(isStolen)
+                counters.stolen++;
+            counters.waitSum += waitDuration;
+            counters.waitMax = std::max(counters.waitMax, waitDuration);
+            counters.runSum += runDuration;
+            counters.runMax = std::max(counters.runMax, runDuration);
+            continue;
+        }
+
+        // the queued tasks are completed before stopping
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_conditionVariable.wait(lock, [this]{return m_queuedTasks > 0 || !m_isRunning;});
+        if(!m_isRunning && m_queuedTasks == 0)
+            break;
+    }
+}
+
+void WalkingThreadPool::close()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+    }
+    m_conditionVariable.notify_all();
+
+    for(auto& worker : m_workers)
+        if(worker->thread.joinable())
+            worker->thread.join();
+}
+
+void WalkingThreadPool::resetStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+    for(auto& counters : m_counters)
+        counters = TaskCounters();
+}
+
+void WalkingThreadPool::toBottle(yarp::os::Bottle& bottle)
+{
+    std::lock_guard<std::mutex> guard(m_statisticsMutex);
+
+    // (thread_pool ((high (submitted s) (rejected r) ...) (low (...))))
+    yarp::os::Bottle& pool = bottle.addList();
+    pool.addString("thread_pool");
+    yarp::os::Bottle& poolList = pool.addList();
+    for(int i = 0; i < numberOfPriorities; i++)
+    {
+        const TaskCounters& counters = m_counters[i];
+        yarp::os::Bottle& entry = poolList.addList();
+        entry.addString(priorityNames[i]);
+        yarp::os::Bottle& list = entry.addList();
+        addEntry("submitted", counters.submitted, list);
+        addEntry("rejected", counters.rejected, list);
+        addEntry("executed", counters.executed, list);
+        addEntry("stolen", counters.stolen, list);
+        addEntry("mean_wait_ms", counters.executed > 0 ? counters.waitSum / counters.executed * 1e3 : 0.0, list);
+        addEntry("max_wait_ms", counters.waitMax * 1e3, list);
+        addEntry("mean_run_ms", counters.executed > 0 ? counters.runSum / counters.executed * 1e3 : 0.0, list);
+        addEntry("max_run_ms", counters.runMax * 1e3, list);
+    }
+}
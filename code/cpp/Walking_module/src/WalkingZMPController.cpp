@@ -16,6 +16,7 @@
 
 #include "WalkingZMPController.hpp"
 #include "Utils.hpp"
+#include "BufferViews.hpp"
 
 bool WalkingZMPController::initialize(const yarp::os::Searchable& config)
 {
@@ -56,6 +57,7 @@ bool WalkingZMPController::initialize(const yarp::os::Searchable& config)
 
     yarp::sig::Vector buffer;
     buffer.resize(2, 0.0);
+    m_desiredCoMVelocity.resize(2, 0.0);
 
     // instantiate Integrator object
     m_velocityIntegral = std::make_unique<iCub::ctrl::Integrator>(samplingTime, buffer);
@@ -92,20 +94,15 @@ bool WalkingZMPController::evaluateControl()
     }
 
     // evaluate the control law
-    iDynTree::toEigen(m_desiredCoMVelocity) = m_kCoM * (iDynTree::toEigen(m_comPositionDesired) -
+    BufferViews::view(m_desiredCoMVelocity) = m_kCoM * (iDynTree::toEigen(m_comPositionDesired) -
                                                         iDynTree::toEigen(m_comFeedback))
                                              -m_kZMP * (iDynTree::toEigen(m_zmpDesired) -
                                                         iDynTree::toEigen(m_zmpFeedback))
                                              +iDynTree::toEigen(m_comVelocityDesired);
 
     // integrate the velocity
-    yarp::sig::Vector desiredCoMVelocityYarp(2);
-    yarp::sig::Vector desiredCoMPositionYarp(2);
-    iDynTree::toYarp(m_desiredCoMVelocity, desiredCoMVelocityYarp);
-
-    desiredCoMPositionYarp = m_velocityIntegral->integrate(desiredCoMVelocityYarp);
-
-    iDynTree::toiDynTree(desiredCoMPositionYarp, m_controllerOutput);
+    iDynTree::toEigen(m_controllerOutput) =
+        BufferViews::view(m_velocityIntegral->integrate(m_desiredCoMVelocity));
 
     m_controlEvaluated = true;
     return true;
@@ -121,7 +118,7 @@ bool WalkingZMPController::getControllerOutput(iDynTree::Vector2& controllerOutp
     }
 
     controllerOutputPosition = m_controllerOutput;
-    controllerOutputVelocity = m_desiredCoMVelocity;
+    iDynTree::toEigen(controllerOutputVelocity) = BufferViews::view(m_desiredCoMVelocity);
     return true;
 }
 
@@ -139,3 +136,21 @@ bool WalkingZMPController::reset(const iDynTree::Vector2& initialValue)
     m_velocityIntegral->reset(buffer);
     return true;
 }
+
+bool WalkingZMPController::setSamplingTime(const double& samplingTime)
+{
+    if(m_velocityIntegral == nullptr)
+    {
+        yError() << "[setSamplingTime] The integrator is not initialized.";
+        return false;
+    }
+
+    if(samplingTime <= 0)
+    {
+        yError() << "[setSamplingTime] The sampling time has to be a positive number.";
+        return false;
+    }
+
+    m_velocityIntegral->setTs(samplingTime);
+    return true;
+}
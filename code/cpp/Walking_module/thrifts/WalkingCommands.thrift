@@ -6,6 +6,12 @@
  * @date 2018
  */
 
+struct Bottle {
+} (
+  yarp.name = "yarp::os::Bottle"
+  yarp.includefile = "yarp/os/Bottle.h"
+)
+
 service WalkingCommands
 {
     /**
@@ -34,4 +40,30 @@ service WalkingCommands
      * @return true/false in case of success/failure;
      */
     bool setGoal(1:double x, 2:double y);
+
+    /**
+     * Get the statistics of the controller (stage latency histograms, overruns,
+     * solver counters, planner durations, merges and PID switches). The latency
+     * is also grouped by the events of the tick (merge, contact switch, PID
+     * activation, planner request and first tick). If the thread telemetry is
+     * enabled the scheduler statistics of the threads are added. The memory
+     * allocated by each subsystem, the latency of each stage of the tick and
+     * the counters of the thread pool, of the logger sender and of the I/O thread
+     * are also reported.
+     * The statistics are a list of (key value) pairs.
+     * @return the statistics;
+     */
+    Bottle getStats();
+
+    /**
+     * Reset the statistics of the controller.
+     * @return true/false in case of success/failure;
+     */
+    bool resetStats();
+
+    /**
+     * Save the last seconds of telemetry stored by the flight recorder.
+     * @return true/false in case of success/failure;
+     */
+    bool dumpFlightRecorder();
 }